@@ -29,6 +29,12 @@
 #include <polyfem/NLProblem.hpp>
 #include <polyfem/LbfgsSolver.hpp>
 #include <polyfem/SparseNewtonDescentSolver.hpp>
+#include <polyfem/MatrixFreeSolver.hpp>
+#include <polyfem/BlockSparseSolve.hpp>
+#include <polyfem/SymmetricSolve.hpp>
+#include <polyfem/FactorizedDirichletSolve.hpp>
+#include <polyfem/AdaptiveTimeStep.hpp>
+#include <polyfem/MatrixUtils.hpp>
 #include <polyfem/NavierStokesSolver.hpp>
 #include <polyfem/TransientNavierStokesSolver.hpp>
 
@@ -49,6 +55,7 @@
 
 #include <iostream>
 #include <algorithm>
+#include <deque>
 #include <memory>
 
 #include <polyfem/autodiff.h>
@@ -157,6 +164,89 @@ namespace polyfem
 		logger().info("havg: {}", average_edge_length);
 	}
 
+	double State::stable_time_step() const
+	{
+		const LameParameters &lame_params = assembler.lame_params();
+		double dt = std::numeric_limits<double>::max();
+
+		for (size_t e = 0; e < bases.size(); ++e)
+		{
+			if (mesh->is_polytope(e))
+				continue;
+
+			//nodes of the element, their spacing shrinks with the order
+			std::vector<RowVectorNd> nodes;
+			for (const auto &b : bases[e].bases)
+			{
+				for (const auto &g : b.global())
+					nodes.push_back(g.node);
+			}
+			if (nodes.size() < 2)
+				continue;
+
+			RowVectorNd center = RowVectorNd::Zero(nodes.front().size());
+			for (const auto &n : nodes)
+				center += n;
+			center /= nodes.size();
+
+			double h = std::numeric_limits<double>::max();
+			if (mesh->is_simplex(e))
+			{
+				//the first local bases are at the vertices, the smallest altitude is d times the volume over the largest facet
+				//and the nodes of order p split it in p
+				std::vector<RowVectorNd> v;
+				for (int i = 0; i <= mesh->dimension(); ++i)
+					v.push_back(bases[e].bases[i].global().front().node);
+
+				const RowVectorNd e0 = v[1] - v[0], e1 = v[2] - v[0];
+				double det, max_facet = 0;
+				if (mesh->is_volume())
+				{
+					const Eigen::Vector3d a = e0.transpose(), b = e1.transpose(), c = (v[3] - v[0]).transpose();
+					det = std::abs(a.dot(b.cross(c)));
+					for (int f = 0; f < 4; ++f)
+					{
+						//facet opposite to vertex f
+						const Eigen::Vector3d p0 = v[(f + 1) % 4].transpose(), p1 = v[(f + 2) % 4].transpose(), p2 = v[(f + 3) % 4].transpose();
+						max_facet = std::max(max_facet, (p1 - p0).cross(p2 - p0).norm());
+					}
+				}
+				else
+				{
+					det = std::abs(e0(0) * e1(1) - e0(1) * e1(0));
+					max_facet = std::max({e0.norm(), e1.norm(), (v[2] - v[1]).norm()});
+				}
+
+				//det is d! times the volume and max_facet (d-1)! times the facet area, their ratio is the altitude
+				if (max_facet > 0)
+					h = det / max_facet / disc_orders(e);
+			}
+			else
+			{
+				for (size_t i = 0; i < nodes.size(); ++i)
+				{
+					for (size_t j = i + 1; j < nodes.size(); ++j)
+					{
+						const double dist = (nodes[i] - nodes[j]).norm();
+						if (dist > 0)
+							h = std::min(h, dist);
+					}
+				}
+			}
+
+			const double x = center(0), y = center(1), z = center.size() > 2 ? center(2) : 0.;
+			double lambda, mu;
+			lame_params.lambda_mu(x, y, z, e, lambda, mu);
+			const double rho = density(x, y, z, e);
+
+			const double c = std::sqrt((lambda + 2 * mu) / rho);
+			if (c > 0)
+				dt = std::min(dt, h / c);
+		}
+
+		return dt;
+	}
+
 	void State::set_multimaterial(const std::function<void(const Eigen::MatrixXd &, const Eigen::MatrixXd &, const Eigen::MatrixXd &)> &setter)
 	{
 		if (args.find("body_params") == args.end())
@@ -298,6 +388,7 @@ namespace polyfem
 		polys.clear();
 		poly_edge_to_data.clear();
 		stiffness.resize(0, 0);
+		block_stiffness.clear();
 		rhs.resize(0, 0);
 		sol.resize(0, 0);
 		pressure.resize(0, 0);
@@ -314,6 +405,8 @@ namespace polyfem
 
 		const auto params = build_json_params();
 		assembler.set_parameters(params);
+		assembler.set_cache_max_memory(args["assembly_cache_max_memory"]);
+		assembler.set_quadrature_psd_projection(args["quadrature_psd_projection"]);
 		density.init(params);
 		problem->init(*mesh);
 
@@ -544,6 +637,7 @@ namespace polyfem
 		}
 
 		stiffness.resize(0, 0);
+		block_stiffness.clear();
 		rhs.resize(0, 0);
 		sol.resize(0, 0);
 		pressure.resize(0, 0);
@@ -623,6 +717,7 @@ namespace polyfem
 		}
 
 		stiffness.resize(0, 0);
+		block_stiffness.clear();
 		sol.resize(0, 0);
 		pressure.resize(0, 0);
 		mass.resize(0, 0);
@@ -670,9 +765,23 @@ namespace polyfem
 				}
 			}
 		}
+		else if (use_explicit_integrator())
+		{
+			logger().info("explicit time integration, assembling only the lumped mass");
+			assembler.assemble_lumped_mass_matrix(formulation(), mesh->is_volume(), n_bases, density, bases, iso_parametric() ? bases : geom_bases, lumped_mass);
+			avg_mass = lumped_mass.mean();
+		}
+		else if (is_matrix_free())
+		{
+			logger().info("matrix-free, skipping assembly");
+		}
+		else if (use_block_matrix())
+		{
+			assembler.assemble_problem(formulation(), mesh->is_volume(), n_bases, bases, iso_parametric() ? bases : geom_bases, block_stiffness);
+		}
 		else
 		{
-			assembler.assemble_problem(formulation(), mesh->is_volume(), n_bases, bases, iso_parametric() ? bases : geom_bases, stiffness);
+			assembler.assemble_problem(formulation(), mesh->is_volume(), n_bases, bases, iso_parametric() ? bases : geom_bases, stiffness, use_symmetric_storage());
 			if (problem->is_time_dependent())
 			{
 				assembler.assemble_mass_matrix(formulation(), mesh->is_volume(), n_bases, density, bases, iso_parametric() ? bases : geom_bases, mass);
@@ -717,9 +826,12 @@ namespace polyfem
 		assembling_stiffness_mat_time = timer.getElapsedTime();
 		logger().info(" took {}s", assembling_stiffness_mat_time);
 
-		nn_zero = stiffness.nonZeros();
-		num_dofs = stiffness.rows();
-		mat_size = (long long)stiffness.rows() * (long long)stiffness.cols();
+		nn_zero = use_block_matrix() ? block_stiffness.non_zeros() : stiffness.nonZeros();
+		if (is_matrix_free() || use_explicit_integrator())
+			num_dofs = n_bases * (problem->is_scalar() ? 1 : mesh->dimension());
+		else
+			num_dofs = use_block_matrix() ? block_stiffness.rows() : stiffness.rows();
+		mat_size = (long long)num_dofs * (long long)num_dofs;
 		logger().info("sparsity: {}/{}", nn_zero, mat_size);
 	}
 
@@ -837,7 +949,7 @@ namespace polyfem
 			return;
 		}
 
-		if (assembler.is_linear(formulation()) && stiffness.rows() <= 0)
+		if (assembler.is_linear(formulation()) && !is_matrix_free() && !use_explicit_integrator() && stiffness.rows() <= 0 && block_stiffness.empty())
 		{
 			logger().error("Assemble the stiffness matrix first!");
 			return;
@@ -861,7 +973,20 @@ namespace polyfem
 		const std::string full_mat_path = args["export"]["full_mat"];
 		if (!full_mat_path.empty())
 		{
-			Eigen::saveMarket(stiffness, full_mat_path);
+			if (use_block_matrix())
+			{
+				StiffnessMatrix tmp;
+				block_stiffness.to_sparse(tmp);
+				Eigen::saveMarket(tmp, full_mat_path);
+			}
+			else if (use_symmetric_storage())
+			{
+				StiffnessMatrix tmp;
+				symmetric_to_full(stiffness, tmp);
+				Eigen::saveMarket(tmp, full_mat_path);
+			}
+			else
+				Eigen::saveMarket(stiffness, full_mat_path);
 		}
 
 		if (problem->is_time_dependent())
@@ -871,6 +996,8 @@ namespace polyfem
 			const int time_steps = args["time_steps"];
 			const double dt = tend / time_steps;
 			logger().info("dt={}", dt);
+			if (args["time_integrator"] != "Implicit" && !use_explicit_integrator())
+				logger().warn("time integrator {} is not supported for {}, using the implicit one", args["time_integrator"].get<std::string>(), formulation());
 
 			const auto &gbases = iso_parametric() ? bases : geom_bases;
 			json rhs_solver_params = args["rhs_solver_params"];
@@ -941,7 +1068,6 @@ namespace polyfem
 						current_rhs.block(prev_size, 0, n_larger, current_rhs.cols()).setZero();
 					}
 
-					assembler.clear_cache();
 					ns_solver.minimize(*this, bdf.alpha(), current_dt, prev_sol,
 									   velocity_stiffness, mixed_stiffness, pressure_stiffness,
 									   velocity_mass, current_rhs, c_sol);
@@ -1002,12 +1128,28 @@ namespace polyfem
 					const int problem_dim = problem->is_scalar() ? 1 : mesh->dimension();
 					const int precond_num = problem_dim * n_bases;
 
-					for (int t = 1; t <= time_steps; ++t)
-					{
-						double time = t * dt;
-						double current_dt = dt;
+					//A only depends on alpha/dt, it is factorized again only when it changes (the first BDF steps have a lower order)
+					FactorizedDirichletSolve factorized_solve;
+					double factorized_coeff = 0;
+
+					//with adaptivity the error is the difference between the solution and the extrapolation of the previous ones
+					const bool adaptive = args["time_adaptivity"]["enabled"];
+					AdaptiveTimeStep time_control(args["time_adaptivity"], dt, tend);
+					Eigen::VectorXd error;
 
-						logger().info("{}/{} {}s", t, time_steps, time);
+					int t = 0;
+					while (adaptive ? !time_control.finished() : t < time_steps)
+					{
+						const double current_dt = adaptive ? time_control.next_dt() : dt;
+						const double time = adaptive ? time_control.time() + current_dt : (t + 1) * dt;
+						const bool is_last_step = adaptive ? time_control.next_dt() >= tend - time_control.time() : t + 1 == time_steps;
+						if (adaptive)
+							bdf.set_dt(current_dt);
+
+						if (adaptive)
+							logger().info("{}s dt={}s", time, current_dt);
+						else
+							logger().info("{}/{} {}s", t + 1, time_steps, time);
 						rhs_assembler.compute_energy_grad(local_boundary, boundary_nodes, density, args["n_boundary_samples"], local_neumann_boundary, rhs, time, current_rhs);
 						rhs_assembler.set_bc(local_boundary, boundary_nodes, args["n_boundary_samples"], local_neumann_boundary, current_rhs, time);
 
@@ -1019,14 +1161,37 @@ namespace polyfem
 							current_rhs.block(current_rhs.rows() - n_pressure_bases - use_avg_pressure, 0, n_pressure_bases + use_avg_pressure, current_rhs.cols()).setZero();
 						}
 
-						A = (bdf.alpha() / current_dt) * mass + stiffness;
+						const double coeff = bdf.alpha() / current_dt;
 						bdf.rhs(x);
 						b = (mass * x) / current_dt;
 						for (int i : boundary_nodes)
 							b[i] = 0;
 						b += current_rhs;
 
-						spectrum = dirichlet_solve(*solver, A, b, boundary_nodes, x, precond_num, args["export"]["stiffness_mat"], t == time_steps && args["export"]["spectrum"]);
+						const bool compute_spectrum = is_last_step && args["export"]["spectrum"];
+						if (!factorized_solve.is_factorized() || coeff != factorized_coeff || compute_spectrum)
+						{
+							A = coeff * mass + stiffness;
+							spectrum = factorized_solve.factorize_and_solve(*solver, A, b, boundary_nodes, x, precond_num, args["export"]["stiffness_mat"], compute_spectrum);
+							factorized_coeff = coeff;
+						}
+						else
+							factorized_solve.solve(*solver, b, x);
+
+						if (adaptive)
+						{
+							if (!bdf.has_error_estimate())
+								time_control.accept();
+							else
+							{
+								//the pressure is not part of the error
+								bdf.error_estimate(x, error);
+								if (!time_control.step(error.head(precond_num), x.head(precond_num), bdf.current_order()))
+									continue;
+							}
+						}
+
+						++t;
 						bdf.new_solution(x);
 						sol = x;
 
@@ -1044,6 +1209,9 @@ namespace polyfem
 							save_wire("step_" + std::to_string(t) + ".obj");
 						}
 					}
+
+					if (adaptive)
+						time_control.get_info(solver_info["time_adaptivity"]);
 				}
 				else //tensor time dependent
 				{
@@ -1054,7 +1222,71 @@ namespace polyfem
 					const int problem_dim = problem->is_scalar() ? 1 : mesh->dimension();
 					const int precond_num = problem_dim * n_bases;
 
-					if (assembler.is_linear(formulation()) && !args["has_collision"])
+					if (use_explicit_integrator())
+					{
+						//central differences in velocity Verlet form, the mass is diagonal so there is no linear solve
+						const double cfl_factor = args["cfl_factor"];
+						const double stable_dt = stable_time_step();
+						const int n_steps = std::max(time_steps, int(std::ceil(tend / (cfl_factor * stable_dt))));
+						const double explicit_dt = tend / n_steps;
+						logger().info("central differences, critical dt={} using dt={} and {} steps", stable_dt, explicit_dt, n_steps);
+						solver_info["explicit_stable_dt"] = stable_dt;
+						solver_info["explicit_dt"] = explicit_dt;
+						solver_info["explicit_steps"] = n_steps;
+
+						//displacement, velocity, and acceleration are only prescribed on the dirichlet nodes
+						const std::vector<LocalBoundary> no_neumann;
+						const bool is_matrix_free_formulation = assembler.is_matrix_free(formulation());
+						Eigen::MatrixXd internal_forces;
+						Eigen::VectorXd x, y;
+
+						//a = M^-1 (f_ext - f_int(u)), the internal forces are evaluated element by element
+						const auto compute_acceleration = [&](const double time) {
+							if (is_matrix_free_formulation)
+							{
+								x = sol;
+								assembler.apply_problem(formulation(), mesh->is_volume(), n_bases, bases, gbases, x, y);
+								internal_forces = y;
+							}
+							else
+								assembler.assemble_energy_gradient(formulation(), mesh->is_volume(), n_bases, bases, gbases, sol, internal_forces);
+
+							rhs_assembler.compute_energy_grad(local_boundary, boundary_nodes, density, args["n_boundary_samples"], local_neumann_boundary, rhs, time, current_rhs);
+
+							acceleration.resize(sol.rows(), 1);
+							for (int i = 0; i < sol.rows(); ++i)
+								acceleration(i) = lumped_mass(i) > 0 ? (current_rhs(i) - internal_forces(i)) / lumped_mass(i) : 0;
+							rhs_assembler.set_acceleration_bc(local_boundary, boundary_nodes, args["n_boundary_samples"], no_neumann, acceleration, time);
+						};
+
+						//the initial acceleration is the one in equilibrium with the initial displacement
+						compute_acceleration(0);
+
+						for (int t = 1; t <= n_steps; ++t)
+						{
+							const double time = t * explicit_dt;
+
+							velocity += (explicit_dt / 2) * acceleration;
+							sol += explicit_dt * velocity;
+							rhs_assembler.set_bc(local_boundary, boundary_nodes, args["n_boundary_samples"], no_neumann, sol, time);
+
+							compute_acceleration(time);
+
+							velocity += (explicit_dt / 2) * acceleration;
+							rhs_assembler.set_velocity_bc(local_boundary, boundary_nodes, args["n_boundary_samples"], no_neumann, velocity, time);
+
+							if (args["save_time_sequence"])
+							{
+								if (!solve_export_to_file)
+									solution_frames.emplace_back();
+								save_vtu("step_" + std::to_string(t) + ".vtu", time);
+								save_wire("step_" + std::to_string(t) + ".obj");
+							}
+
+							logger().debug("{}/{}", t, n_steps);
+						}
+					}
+					else if (assembler.is_linear(formulation()) && !args["has_collision"])
 					{
 						//Newmark
 						const double gamma = 0.5;
@@ -1065,9 +1297,21 @@ namespace polyfem
 						StiffnessMatrix A;
 						Eigen::VectorXd x, btmp;
 
-						for (int t = 1; t <= time_steps; ++t)
+						//A is factorized at the first step, and again only if the step size changes
+						FactorizedDirichletSolve factorized_solve;
+						double factorized_dt = 0;
+
+						//with adaptivity the local error of the displacement is (beta - 1/6) dt^2 (a_{n+1} - a_n)
+						const bool adaptive = args["time_adaptivity"]["enabled"];
+						AdaptiveTimeStep time_control(args["time_adaptivity"], dt, tend);
+						Eigen::VectorXd error;
+
+						int t = 0;
+						while (adaptive ? !time_control.finished() : t < time_steps)
 						{
-							const double dt2 = dt * dt;
+							const double current_dt = adaptive ? time_control.next_dt() : dt;
+							const double time = adaptive ? time_control.time() + current_dt : (t + 1) * dt;
+							const double dt2 = current_dt * current_dt;
 
 							const Eigen::MatrixXd aOld = acceleration;
 							const Eigen::MatrixXd vOld = velocity;
@@ -1075,36 +1319,58 @@ namespace polyfem
 
 							if (!problem->is_linear_in_time())
 							{
-								rhs_assembler.assemble(density, current_rhs, dt * t);
+								rhs_assembler.assemble(density, current_rhs, time);
 								current_rhs *= -1;
 							}
-							temp = -(uOld + dt * vOld + ((1 / 2. - beta) * dt2) * aOld);
+							temp = -(uOld + current_dt * vOld + ((1 / 2. - beta) * dt2) * aOld);
 							b = stiffness * temp + current_rhs;
 
-							rhs_assembler.set_acceleration_bc(local_boundary, boundary_nodes, args["n_boundary_samples"], local_neumann_boundary, b, dt * t);
+							rhs_assembler.set_acceleration_bc(local_boundary, boundary_nodes, args["n_boundary_samples"], local_neumann_boundary, b, time);
 
-							A = stiffness * beta * dt2 + mass;
 							btmp = b;
-							spectrum = dirichlet_solve(*solver, A, btmp, boundary_nodes, x, precond_num, args["export"]["stiffness_mat"], t == 1 && args["export"]["spectrum"]);
+							if (!factorized_solve.is_factorized() || current_dt != factorized_dt)
+							{
+								A = stiffness * beta * dt2 + mass;
+								spectrum = factorized_solve.factorize_and_solve(*solver, A, btmp, boundary_nodes, x, precond_num, args["export"]["stiffness_mat"], args["export"]["spectrum"] && !factorized_solve.is_factorized());
+								factorized_dt = current_dt;
+							}
+							else
+								factorized_solve.solve(*solver, btmp, x);
+
+							if (adaptive)
+							{
+								error = ((beta - 1 / 6.) * dt2) * (x - aOld);
+								const Eigen::VectorXd new_sol = uOld + current_dt * vOld + dt2 * ((1 / 2.0 - beta) * aOld + beta * x);
+								if (!time_control.step(error, new_sol, 2))
+									continue;
+							}
+
+							++t;
 							acceleration = x;
 
-							sol += dt * vOld + dt2 * ((1 / 2.0 - beta) * aOld + beta * acceleration);
-							velocity += dt * ((1 - gamma) * aOld + gamma * acceleration);
+							sol += current_dt * vOld + dt2 * ((1 / 2.0 - beta) * aOld + beta * acceleration);
+							velocity += current_dt * ((1 - gamma) * aOld + gamma * acceleration);
 
-							rhs_assembler.set_bc(local_boundary, boundary_nodes, args["n_boundary_samples"], local_neumann_boundary, sol, dt * t);
-							rhs_assembler.set_velocity_bc(local_boundary, boundary_nodes, args["n_boundary_samples"], local_neumann_boundary, velocity, dt * t);
-							rhs_assembler.set_acceleration_bc(local_boundary, boundary_nodes, args["n_boundary_samples"], local_neumann_boundary, acceleration, dt * t);
+							rhs_assembler.set_bc(local_boundary, boundary_nodes, args["n_boundary_samples"], local_neumann_boundary, sol, time);
+							rhs_assembler.set_velocity_bc(local_boundary, boundary_nodes, args["n_boundary_samples"], local_neumann_boundary, velocity, time);
+							rhs_assembler.set_acceleration_bc(local_boundary, boundary_nodes, args["n_boundary_samples"], local_neumann_boundary, acceleration, time);
 
 							if (args["save_time_sequence"])
 							{
 								if (!solve_export_to_file)
 									solution_frames.emplace_back();
-								save_vtu("step_" + std::to_string(t) + ".vtu", dt * t);
+								save_vtu("step_" + std::to_string(t) + ".vtu", time);
 								save_wire("step_" + std::to_string(t) + ".obj");
 							}
 
-							logger().info("{}/{}", t, time_steps);
+							if (adaptive)
+								logger().info("{}s dt={}s", time, current_dt);
+							else
+								logger().info("{}/{}", t, time_steps);
 						}
+
+						if (adaptive)
+							time_control.get_info(solver_info["time_adaptivity"]);
 					}
 					else //if (!assembler.is_linear(formulation()) || collision)
 					{
@@ -1179,10 +1445,12 @@ namespace polyfem
 						nl_problem.init_timestep(sol, velocity, acceleration, dt);
 						nl_problem.full_to_reduced(sol, tmp_sol);
 
+						//shared by all time steps to reuse the symbolic factorization
+						cppoptlib::SparseNewtonDescentSolver<NLProblem> nlsolver(solver_params(), solver_type(), precond_type());
+						nlsolver.setLineSearch(args["line_search"]);
+
 						for (int t = 1; t <= time_steps; ++t)
 						{
-							cppoptlib::SparseNewtonDescentSolver<NLProblem> nlsolver(solver_params(), solver_type(), precond_type());
-							nlsolver.setLineSearch(args["line_search"]);
 							nl_problem.init(sol);
 							nlsolver.minimize(nl_problem, tmp_sol);
 
@@ -1258,10 +1526,47 @@ namespace polyfem
 		}
 		else //if(!problem->is_time_dependent())
 		{
-			if (assembler.is_linear(formulation()) && !args["has_collision"])
+			if (is_matrix_free())
+			{
+				const auto &gbases = iso_parametric() ? bases : geom_bases;
+				const int size = problem->is_scalar() ? 1 : mesh->dimension();
+
+				MatrixFreeSolver solver(args["matrix_free_params"]);
+				logger().info("{}...", solver.name());
+				json rhs_solver_params = args["rhs_solver_params"];
+				rhs_solver_params["mtype"] = -2; // matrix type for Pardiso (2 = SPD)
+				RhsAssembler rhs_assembler(assembler, *mesh,
+										   n_bases, size,
+										   bases, gbases,
+										   formulation(), *problem,
+										   args["rhs_solver_type"], args["rhs_precond_type"], rhs_solver_params);
+				rhs_assembler.set_bc(local_boundary, boundary_nodes, args["n_boundary_samples"], local_neumann_boundary, rhs);
+
+				solver.set_operator(n_bases * size, [&](const Eigen::VectorXd &x, Eigen::VectorXd &y) {
+					assembler.apply_problem(formulation(), mesh->is_volume(), n_bases, bases, gbases, x, y);
+				}, boundary_nodes);
+
+				Eigen::VectorXd diag;
+				assembler.assemble_problem_diagonal(formulation(), mesh->is_volume(), n_bases, bases, gbases, diag);
+				solver.set_diagonal(diag);
+
+				Eigen::VectorXd x;
+				solver.solve(rhs, x);
+				sol = x;
+				solver.getInfo(solver_info);
+			}
+			else if (assembler.is_linear(formulation()) && !args["has_collision"])
 			{
 				auto solver = LinearSolver::create(args["solver_type"], args["precond_type"]);
-				solver->setParameters(params);
+				if (use_symmetric_storage() && solver_type() == "Pardiso")
+				{
+					//the upper triangle of an spd matrix
+					json symmetric_params = params;
+					symmetric_params["mtype"] = 2;
+					solver->setParameters(symmetric_params);
+				}
+				else
+					solver->setParameters(params);
 				StiffnessMatrix A;
 				Eigen::VectorXd b;
 				logger().info("{}...", solver->name());
@@ -1282,14 +1587,49 @@ namespace polyfem
 				const int problem_dim = problem->is_scalar() ? 1 : mesh->dimension();
 				const int precond_num = problem_dim * n_bases;
 
-				A = stiffness;
 				Eigen::VectorXd x;
 				b = rhs;
-				spectrum = dirichlet_solve(*solver, A, b, boundary_nodes, x, precond_num, args["export"]["stiffness_mat"], args["export"]["spectrum"]);
-				sol = x;
-				solver->getInfo(solver_info);
+				if (use_block_matrix() && args["block_matrix_solver"] == "pcg")
+				{
+					//conjugate gradient with the block product, the scalar matrix is never built
+					MatrixFreeSolver block_solver(args["matrix_free_params"]);
+					logger().info("{} with block matrix...", block_solver.name());
+					block_solver.set_operator(block_stiffness, boundary_nodes);
+					block_solver.solve(b, x);
+					sol = x;
+					block_solver.getInfo(solver_info);
+				}
+				else if (use_symmetric_storage() && args["symmetric_storage_solver"] == "pcg")
+				{
+					MatrixFreeSolver symmetric_solver(args["matrix_free_params"]);
+					logger().info("{} with symmetric matrix...", symmetric_solver.name());
+					symmetric_solver.set_operator(stiffness.rows(), [&](const Eigen::VectorXd &x, Eigen::VectorXd &y) { symmetric_multiply(stiffness, x, y); }, boundary_nodes);
+					symmetric_solver.set_diagonal(stiffness.diagonal());
+					symmetric_solver.solve(b, x);
+					sol = x;
+					symmetric_solver.getInfo(solver_info);
+				}
+				else if (use_symmetric_storage())
+				{
+					spectrum = dirichlet_solve_symmetric(*solver, solver_type(), stiffness, b, boundary_nodes, x, precond_num, args["export"]["stiffness_mat"], args["export"]["spectrum"]);
+					sol = x;
+					solver->getInfo(solver_info);
+				}
+				else if (use_block_matrix())
+				{
+					spectrum = dirichlet_solve(*solver, block_stiffness, b, boundary_nodes, x, precond_num, args["export"]["stiffness_mat"], args["export"]["spectrum"]);
+					sol = x;
+					solver->getInfo(solver_info);
+				}
+				else
+				{
+					A = stiffness;
+					spectrum = dirichlet_solve(*solver, A, b, boundary_nodes, x, precond_num, args["export"]["stiffness_mat"], args["export"]["spectrum"]);
+					sol = x;
+					solver->getInfo(solver_info);
 
-				logger().debug("Solver error: {}", (A * sol - b).norm());
+					logger().debug("Solver error: {}", (A * sol - b).norm());
+				}
 
 				if (assembler.is_mixed(formulation()))
 				{
@@ -1304,7 +1644,6 @@ namespace polyfem
 					const double viscosity = params.count("viscosity") ? double(params["viscosity"]) : 1.;
 					NavierStokesSolver ns_solver(viscosity, solver_params(), build_json_params(), solver_type(), precond_type());
 					Eigen::VectorXd x;
-					assembler.clear_cache();
 					json rhs_solver_params = args["rhs_solver_params"];
 					rhs_solver_params["mtype"] = -2; // matrix type for Pardiso (2 = SPD)
 
@@ -1379,6 +1718,26 @@ namespace polyfem
 
 					const auto &gbases = iso_parametric() ? bases : geom_bases;
 					igl::Timer update_timer;
+
+					//shared by all load steps to reuse the symbolic factorization
+					cppoptlib::SparseNewtonDescentSolver<NLProblem> newton_solver(solver_params(), solver_type(), precond_type());
+					if (args["nl_solver"] == "newton")
+						newton_solver.setLineSearch(args["line_search"]);
+
+					//starting point of a load step: tangent (assembles and solves), tangent_reuse (last newton factorization), linear or quadratic (extrapolation of the converged steps)
+					//with an inexact newton the last factorization is only a preconditioner, tangent_reuse falls back to tangent
+					const std::string predictor = args["nl_solver_predictor"];
+					const bool reuse_tangent = predictor == "tangent_reuse" && !newton_solver.is_inexact();
+					if (predictor == "tangent_reuse" && !reuse_tangent)
+						logger().warn("tangent_reuse predictor needs an exact newton solver, using tangent");
+					//last converged load steps and their solutions, used by the extrapolations
+					std::deque<std::pair<double, Eigen::MatrixXd>> converged;
+					converged.emplace_back(0, sol);
+					//true when the previous attempt of the step failed, it restarts from the last converged solution
+					bool retry = false;
+					int n_predictor_assemblies = 0;
+					int n_retries = 0;
+
 					while (t <= 1)
 					{
 						if (step_t < 1e-10)
@@ -1394,7 +1753,54 @@ namespace polyfem
 						logger().debug("Updating starting point...");
 						update_timer.start();
 
+						const int n_extrapolation = predictor == "linear" ? 2 : (predictor == "quadratic" ? 3 : 0);
+						bool has_start = false;
+						if (retry)
+						{
+							x = sol;
+							has_start = true;
+						}
+						else if (n_extrapolation > 0 && converged.size() >= 2)
 						{
+							//lagrange extrapolation in the load parameter
+							const int n = std::min(n_extrapolation, int(converged.size()));
+							const int offset = int(converged.size()) - n;
+							x.setZero(sol.size());
+							for (int i = offset; i < int(converged.size()); ++i)
+							{
+								double l = 1;
+								for (int m = offset; m < int(converged.size()); ++m)
+								{
+									if (m != i)
+										l *= (t - converged[m].first) / (converged[i].first - converged[m].first);
+								}
+								x += l * converged[i].second;
+							}
+							if (!nl_problem.is_step_valid(sol, x))
+								x = sol;
+							has_start = true;
+						}
+						else if (reuse_tangent)
+						{
+							//one newton step with the new boundary conditions and the hessian of the last converged step
+							Eigen::VectorXd reduced_grad, delta;
+							nl_problem.full_to_reduced(sol, tmp_sol);
+							nl_problem.gradient(tmp_sol, reduced_grad);
+							if (newton_solver.solve_with_last_factorization(reduced_grad, delta))
+							{
+								tmp_sol -= delta;
+								Eigen::MatrixXd full;
+								nl_problem.reduced_to_full(tmp_sol, full);
+								x = full;
+								if (!nl_problem.is_step_valid(sol, x))
+									x = sol;
+								has_start = true;
+							}
+						}
+
+						if (!has_start)
+						{
+							++n_predictor_assemblies;
 							nl_problem.hessian_full(sol, nlstiffness);
 							nl_problem.gradient_no_rhs(sol, grad);
 							rhs_assembler.set_bc(local_boundary, boundary_nodes, args["n_boundary_samples"], local_neumann_boundary, grad, t);
@@ -1449,25 +1855,25 @@ namespace polyfem
 								step_t /= 2;
 								t = prev_t + step_t;
 							} while (t >= 1);
+							retry = true;
+							++n_retries;
 							continue;
 						}
 
-						assembler.clear_cache();
-
 						if (args["nl_solver"] == "newton")
 						{
-							cppoptlib::SparseNewtonDescentSolver<NLProblem> nlsolver(solver_params(), solver_type(), precond_type());
-							nlsolver.setLineSearch(args["line_search"]);
 							nl_problem.init(x);
-							nlsolver.minimize(nl_problem, tmp_sol);
+							newton_solver.minimize(nl_problem, tmp_sol);
 
-							if (nlsolver.error_code() == -10) //Nan
+							if (newton_solver.error_code() == -10) //Nan
 							{
 								do
 								{
 									step_t /= 2;
 									t = prev_t + step_t;
 								} while (t >= 1);
+								retry = true;
+								++n_retries;
 								continue;
 							}
 							else
@@ -1479,7 +1885,7 @@ namespace polyfem
 							if (step_t > 1.0 / steps)
 								step_t = 1.0 / steps;
 
-							nlsolver.getInfo(solver_info);
+							newton_solver.getInfo(solver_info);
 						}
 						else if (args["nl_solver"] == "lbfgs")
 						{
@@ -1500,6 +1906,10 @@ namespace polyfem
 							t = 1;
 
 						nl_problem.reduced_to_full(tmp_sol, sol);
+						retry = false;
+						converged.emplace_back(prev_t, sol);
+						if (converged.size() > 3)
+							converged.pop_front();
 
 						// std::ofstream of("sol.txt");
 						// of<<sol<<std::endl;
@@ -1514,6 +1924,13 @@ namespace polyfem
 						}
 					}
 
+					if (args["nl_solver"] == "newton")
+					{
+						solver_info["predictor"] = predictor;
+						solver_info["predictor_assemblies"] = n_predictor_assemblies;
+						solver_info["load_step_retries"] = n_retries;
+					}
+
 					if (assembler.is_mixed(formulation()))
 					{
 						sol_to_pressure();
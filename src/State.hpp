@@ -126,6 +126,11 @@ namespace polyfem
 		//Stiffness is not compute for non linea problems
 		//Mass is computed only for time dependent problems
 		StiffnessMatrix stiffness, mass;
+		//diagonal lumped mass, used instead of mass by the explicit time integrator
+		Eigen::VectorXd lumped_mass;
+		//stiffness with one dense block per pair of nodes, used instead of stiffness if use_block_matrix()
+		BlockSparseMatrix block_stiffness;
+		//if use_symmetric_storage() stiffness contains only its upper triangle
 		//System righ-hand side.
 		//rhs_in is an input that, if not empty, gets copied to rhs
 		Eigen::MatrixXd rhs, rhs_in;
@@ -226,6 +231,8 @@ namespace polyfem
 		//uses curved_mesh_size (false by default) to compute the size of
 		//the linear mesh
 		void compute_mesh_size(const Mesh &mesh, const std::vector<ElementBases> &bases, const int n_samples);
+		//largest stable time step of the explicit integrator, min over the elements of the smallest altitude over the order (node spacing for quads and hexes) over the dilatational wave speed
+		double stable_time_step() const;
 
 		//loads the mesh from the json arguments
 		void load_mesh();
@@ -474,6 +481,27 @@ namespace polyfem
 		inline std::string precond_type() const { return args["precond_type"]; }
 		inline const json &solver_params() const { return args["solver_params"]; }
 
+		//true if the linear problem is solved with a matrix-free operator instead of the assembled stiffness
+		inline bool is_matrix_free() const
+		{
+			return args["matrix_free"] && assembler.is_matrix_free(formulation()) && !problem->is_time_dependent() && !args["has_collision"];
+		}
+		//true if the transient elastic problem is integrated with explicit central differences and the lumped mass
+		inline bool use_explicit_integrator() const
+		{
+			return args["time_integrator"] == "CentralDifference" && problem->is_time_dependent() && !problem->is_scalar() && !assembler.is_mixed(formulation()) && !assembler.is_fluid(formulation()) && !args["has_collision"];
+		}
+		//true if the stiffness of the static linear vector problem is stored in blocks
+		inline bool use_block_matrix() const
+		{
+			return args["block_matrix"] && !is_matrix_free() && assembler.is_linear(formulation()) && !assembler.is_mixed(formulation()) && !problem->is_scalar() && !problem->is_time_dependent() && !args["has_collision"];
+		}
+		//true if only the upper triangle of the stiffness of the static linear problem is stored
+		inline bool use_symmetric_storage() const
+		{
+			return args["symmetric_storage"] && !is_matrix_free() && !use_block_matrix() && assembler.is_linear(formulation()) && !assembler.is_mixed(formulation()) && !problem->is_time_dependent() && !args["has_collision"];
+		}
+
 		//returns the tensor and scalar formulation (wrappers around the arguments)
 		inline std::string scalar_formulation() const { return args["scalar_formulation"]; }
 		inline std::string tensor_formulation() const { return args["tensor_formulation"]; }
@@ -14,12 +14,15 @@
 #include <polyfem/NavierStokes.hpp>
 #include <polyfem/IncompressibleLinElast.hpp>
 
+#include <polyfem/SumFactorization.hpp>
 #include <polyfem/Logger.hpp>
 
 #include <igl/Timer.h>
 
 #include <ipc/utils/eigen_ext.hpp>
 
+#include <map>
+
 #ifdef POLYFEM_WITH_TBB
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_reduce.h>
@@ -52,6 +55,7 @@ namespace polyfem
 		{
 		public:
 			Eigen::MatrixXd vec;
+			double val;
 			ElementAssemblyValues vals;
 			QuadratureVector da;
 
@@ -59,9 +63,17 @@ namespace polyfem
 			{
 				vec.resize(size, 1);
 				vec.setZero();
+				val = 0;
 			}
 		};
 
+		class LocalThreadElementStorage
+		{
+		public:
+			ElementAssemblyValues vals;
+			QuadratureVector da;
+		};
+
 		class LocalThreadScalarStorage
 		{
 		public:
@@ -102,192 +114,818 @@ namespace polyfem
 						i->tmp_mat.resize(0, 0);
 						i->tmp_mat.data().squeeze();
 
-						i->stiffness.makeCompressed();
+						i->stiffness.makeCompressed();
+
+						tmp += i->stiffness;
+						i->stiffness.resize(0, 0);
+						i->stiffness.data().squeeze();
+
+						tmp.makeCompressed();
+					}
+
+					return tmp;
+				},
+				[](const StiffnessMatrix &a, const StiffnessMatrix &b) {
+					return a + b;
+				});
+
+			mat.makeCompressed();
+		}
+#endif
+
+		//values of a compressed matrix laid out by a sparsity pattern
+		class PatternValues
+		{
+		public:
+			PatternValues(const SparsityPattern &pattern, double *values) : pattern_(pattern), values_(values) {}
+
+			inline int size() const { return pattern_.size(); }
+			inline long find(const int node_i, const int node_j) const { return pattern_.find(node_i, node_j); }
+			//adds value to the entry (node_i*size+m, node_j*size+n), pos is the output of find(node_i, node_j)
+			//the entries of the lower triangle are skipped if the pattern is symmetric
+			inline void add(const long pos, const int node_i, const int node_j, const int m, const int n, const double value) const
+			{
+				if (!pattern_.stores(node_i, node_j, m, n))
+					return;
+
+				assert(pos >= 0);
+				values_[pattern_.value_index(pos, node_j, m, n)] += value;
+			}
+
+		private:
+			const SparsityPattern &pattern_;
+			double *values_;
+		};
+
+		//values of a block sparse matrix, same interface as PatternValues
+		class BlockValues
+		{
+		public:
+			BlockValues(BlockSparseMatrix &mat) : mat_(mat), size_(mat.block_size()) {}
+
+			inline int size() const { return size_; }
+			inline long find(const int node_i, const int node_j) const { return mat_.find(node_i, node_j); }
+			inline void add(const long pos, const int node_i, const int node_j, const int m, const int n, const double value) const
+			{
+				assert(pos >= 0);
+				mat_.block(pos)[n * size_ + m] += value;
+			}
+
+		private:
+			BlockSparseMatrix &mat_;
+			const int size_;
+		};
+
+		//scatters a full element matrix with entries (i*size+m, j*size+n) into the values of a matrix, Target is PatternValues or BlockValues
+		template <typename Mat, typename Target>
+		void scatter_element_matrix(const ElementAssemblyValues &vals, const Mat &local, const Target &values)
+		{
+			const int size = values.size();
+			const int n_loc_bases = int(vals.basis_values.size());
+
+			for(int i = 0; i < n_loc_bases; ++i)
+			{
+				const auto &global_i = vals.basis_values[i].global;
+
+				for(int j = 0; j < n_loc_bases; ++j)
+				{
+					const auto &global_j = vals.basis_values[j].global;
+
+					for(size_t ii = 0; ii < global_i.size(); ++ii)
+					{
+						const int node_i = global_i[ii].index;
+						const auto wi = global_i[ii].val;
+
+						for(size_t jj = 0; jj < global_j.size(); ++jj)
+						{
+							const int node_j = global_j[jj].index;
+							const auto wj = global_j[jj].val;
+
+							const long pos = values.find(node_i, node_j);
+
+							for(int n = 0; n < size; ++n)
+							{
+								for(int m = 0; m < size; ++m)
+									values.add(pos, node_i, node_j, m, n, local(i*size + m, j*size + n) * wi * wj);
+							}
+						}
+					}
+				}
+			}
+		}
+
+		template <typename... Ts>
+		struct make_void { typedef void type; };
+
+		//true if the local assembler computes the whole element matrix at once with assemble_element(vals, da)
+		template <typename LocalAssembler, typename = void>
+		struct has_element_assembly : std::false_type {};
+
+		template <typename LocalAssembler>
+		struct has_element_assembly<LocalAssembler, typename make_void<decltype(std::declval<const LocalAssembler &>().assemble_element(std::declval<const ElementAssemblyValues &>(), std::declval<const QuadratureVector &>()))>::type> : std::true_type {};
+
+		//true if the local assembler caches its material at the quadrature points with init_material_cache(is_volume, bases, gbases)
+		template <typename LocalAssembler, typename = void>
+		struct has_material_cache : std::false_type {};
+
+		template <typename LocalAssembler>
+		struct has_material_cache<LocalAssembler, typename make_void<decltype(std::declval<const LocalAssembler &>().init_material_cache(std::declval<bool>(), std::declval<const std::vector<ElementBases> &>(), std::declval<const std::vector<ElementBases> &>()))>::type> : std::true_type {};
+
+		//must be called outside of the parallel loops, the cache is only read by the elements
+		template <typename LocalAssembler>
+		void init_material_cache(const LocalAssembler &local_assembler, const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases, std::true_type)
+		{
+			local_assembler.init_material_cache(is_volume, bases, gbases);
+		}
+
+		template <typename LocalAssembler>
+		void init_material_cache(const LocalAssembler &local_assembler, const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases, std::false_type)
+		{
+		}
+
+		//whole element kernel
+		template <typename LocalAssembler, typename Target>
+		void assemble_element_values(const LocalAssembler &local_assembler, const ElementAssemblyValues &vals, const QuadratureVector &da, const Target &values, std::true_type)
+		{
+			const Eigen::MatrixXd local = local_assembler.assemble_element(vals, da);
+			assert(local.rows() == int(vals.basis_values.size()) * values.size());
+			assert(local.cols() == local.rows());
+
+			scatter_element_matrix(vals, local, values);
+		}
+
+		//one pair of bases at the time, only the lower triangle is computed
+		template <typename LocalAssembler, typename Target>
+		void assemble_element_values(const LocalAssembler &local_assembler, const ElementAssemblyValues &vals, const QuadratureVector &da, const Target &values, std::false_type)
+		{
+			const int size = values.size();
+			const int n_loc_bases = int(vals.basis_values.size());
+
+			for(int i = 0; i < n_loc_bases; ++i)
+			{
+				const auto &global_i = vals.basis_values[i].global;
+
+				for(int j = 0; j <= i; ++j)
+				{
+					const auto &global_j = vals.basis_values[j].global;
+
+					const auto stiffness_val = local_assembler.assemble(vals, i, j, da);
+					assert(stiffness_val.size() == size * size);
+
+					for(size_t ii = 0; ii < global_i.size(); ++ii)
+					{
+						const int node_i = global_i[ii].index;
+						const auto wi = global_i[ii].val;
+
+						for(size_t jj = 0; jj < global_j.size(); ++jj)
+						{
+							const int node_j = global_j[jj].index;
+							const auto wj = global_j[jj].val;
+
+							const long pos_ij = values.find(node_i, node_j);
+							const long pos_ji = j < i ? values.find(node_j, node_i) : -1;
+
+							for(int n = 0; n < size; ++n)
+							{
+								for(int m = 0; m < size; ++m)
+								{
+									const double local_value = stiffness_val(n*size+m) * wi * wj;
+
+									values.add(pos_ij, node_i, node_j, m, n, local_value);
+									if (j < i)
+										values.add(pos_ji, node_j, node_i, n, m, local_value);
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+
+		//dense element matrix with entries (i*size+m, j*size+n)
+		template <typename LocalAssembler>
+		Eigen::MatrixXd element_matrix(const LocalAssembler &local_assembler, const ElementAssemblyValues &vals, const QuadratureVector &da, const int size, std::true_type)
+		{
+			return local_assembler.assemble_element(vals, da);
+		}
+
+		template <typename LocalAssembler>
+		Eigen::MatrixXd element_matrix(const LocalAssembler &local_assembler, const ElementAssemblyValues &vals, const QuadratureVector &da, const int size, std::false_type)
+		{
+			const int n_loc_bases = int(vals.basis_values.size());
+			Eigen::MatrixXd res(n_loc_bases * size, n_loc_bases * size);
+
+			for(int i = 0; i < n_loc_bases; ++i)
+			{
+				for(int j = 0; j <= i; ++j)
+				{
+					const auto stiffness_val = local_assembler.assemble(vals, i, j, da);
+					assert(stiffness_val.size() == size * size);
+
+					for(int n = 0; n < size; ++n)
+					{
+						for(int m = 0; m < size; ++m)
+						{
+							res(i*size + m, j*size + n) = stiffness_val(n*size+m);
+							res(j*size + n, i*size + m) = stiffness_val(n*size+m);
+						}
+					}
+				}
+			}
+
+			return res;
+		}
+
+		template <typename LocalAssembler, typename = void>
+		struct has_flux : std::false_type {};
+
+		//true if the local assembler provides the pointwise flux used by the sum factorized product
+		template <typename LocalAssembler>
+		struct has_flux<LocalAssembler, typename make_void<decltype(std::declval<const LocalAssembler &>().compute_flux(0, 0, std::declval<const RowVectorNd &>(), std::declval<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &>()))>::type> : std::true_type {};
+
+		//1d kernels indexed by (bases order, quadrature order)
+		typedef std::map<std::pair<int, int>, HexSumFactorization> SumFactorizations;
+
+		//true if all elements are tensor product hexes, the missing kernels are added to kernels
+		//the existing ones are reused since they only depend on the orders
+		bool init_sum_factorizations(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases, SumFactorizations &kernels)
+		{
+			if (!is_volume || bases.empty())
+				return false;
+
+			for (std::size_t e = 0; e < bases.size(); ++e)
+			{
+				if (bases[e].tensor_order < 1 || gbases[e].tensor_order < 1)
+					return false;
+			}
+
+			for (std::size_t e = 0; e < bases.size(); ++e)
+			{
+				//the geometry is evaluated at the quadrature of the bases
+				const int quadrature_order = bases[e].tensor_quadrature_order;
+				for (const int order : {bases[e].tensor_order, gbases[e].tensor_order})
+				{
+					const auto key = std::make_pair(order, quadrature_order);
+					if (kernels.find(key) == kernels.end())
+						kernels[key].init(order, quadrature_order);
+				}
+			}
+
+			return true;
+		}
+
+		//element contribution of the matrix-free product with sum factorization, accumulated in y
+		template <typename LocalAssembler>
+		void apply_sum_factorization(const LocalAssembler &local_assembler, const int e, const ElementBases &bs, const ElementBases &gbs, const SumFactorizations &kernels, const Eigen::VectorXd &x, Eigen::MatrixXd &y, std::true_type)
+		{
+			typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> Mat33;
+
+			const int size = local_assembler.size();
+			const HexSumFactorization &kernel = kernels.at(std::make_pair(bs.tensor_order, bs.tensor_quadrature_order));
+			const HexSumFactorization &gkernel = kernels.at(std::make_pair(gbs.tensor_order, bs.tensor_quadrature_order));
+			assert(kernel.n_bases() == int(bs.bases.size()));
+			assert(gkernel.n_bases() == int(gbs.bases.size()));
+
+			Eigen::MatrixXd u = Eigen::MatrixXd::Zero(bs.bases.size(), size);
+			for (std::size_t i = 0; i < bs.bases.size(); ++i)
+			{
+				for (const auto &g : bs.bases[i].global())
+				{
+					for (int m = 0; m < size; ++m)
+						u(i, m) += g.val * x(g.index * size + m);
+				}
+			}
+
+			Eigen::MatrixXd nodes = Eigen::MatrixXd::Zero(gbs.bases.size(), 3);
+			for (std::size_t i = 0; i < gbs.bases.size(); ++i)
+			{
+				for (const auto &g : gbs.bases[i].global())
+					nodes.row(i) += g.val * g.node;
+			}
+
+			Eigen::MatrixXd u_val, pts;
+			std::array<Eigen::MatrixXd, 3> u_grad, jac;
+			kernel.interpolate(u, u_val, u_grad);
+			gkernel.interpolate(nodes, pts, jac);
+
+			const int n_pts = kernel.n_quadrature_points();
+			std::array<Eigen::MatrixXd, 3> flux;
+			for (auto &f : flux)
+				f.resize(n_pts, size);
+
+			Mat33 tmp(3, 3), grad_u(size, 3), ref_grad(size, 3);
+			for (int k = 0; k < n_pts; ++k)
+			{
+				//transpose of the jacobian of the geometric mapping, as in ElementAssemblyValues
+				for (int d = 0; d < 3; ++d)
+				{
+					tmp.row(d) = jac[d].row(k);
+					ref_grad.col(d) = u_grad[d].row(k).transpose();
+				}
+
+				const double da = tmp.determinant() * kernel.weights()(k);
+				const Mat33 jac_it = tmp.inverse().transpose();
+
+				grad_u = ref_grad * jac_it;
+				const Mat33 stress = local_assembler.compute_flux(e, k, pts.row(k), grad_u);
+				const Mat33 ref_flux = da * stress * jac_it.transpose();
+
+				for (int d = 0; d < 3; ++d)
+					flux[d].row(k) = ref_flux.col(d).transpose();
+			}
+
+			Eigen::MatrixXd res;
+			kernel.integrate_grad(flux, res);
+
+			for (std::size_t i = 0; i < bs.bases.size(); ++i)
+			{
+				for (const auto &g : bs.bases[i].global())
+				{
+					for (int m = 0; m < size; ++m)
+						y(g.index * size + m) += g.val * res(i, m);
+				}
+			}
+		}
+
+		template <typename LocalAssembler>
+		void apply_sum_factorization(const LocalAssembler &local_assembler, const int e, const ElementBases &bs, const ElementBases &gbs, const SumFactorizations &kernels, const Eigen::VectorXd &x, Eigen::MatrixXd &y, std::false_type)
+		{
+			assert(false);
+		}
+
+		//assembles the matrix of a linear local assembler into values
+		//elements of the same color share no node, they are scattered concurrently into the shared values
+		template <typename LocalAssembler, typename Target>
+		void assemble_colored(const LocalAssembler &local_assembler, const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases, const SparsityPattern &pattern, const Target &values)
+		{
+			init_material_cache(local_assembler, is_volume, bases, gbases, has_material_cache<LocalAssembler>());
+
+#ifdef POLYFEM_WITH_TBB
+			typedef tbb::enumerable_thread_specific<LocalThreadElementStorage> LocalStorage;
+			LocalStorage storages((LocalThreadElementStorage()));
+#else
+			LocalThreadElementStorage loc_storage;
+#endif
+
+			for (const std::vector<int> &color : pattern.colors())
+			{
+				const int n_color_elements = int(color.size());
+#ifdef POLYFEM_WITH_TBB
+				tbb::parallel_for(tbb::blocked_range<int>(0, n_color_elements), [&](const tbb::blocked_range<int> &r) {
+			LocalStorage::reference loc_storage = storages.local();
+			for (int k = r.begin(); k != r.end(); ++k) {
+#else
+				for (int k = 0; k < n_color_elements; ++k)
+				{
+#endif
+				const int e = color[k];
+				ElementAssemblyValues &vals = loc_storage.vals;
+				vals.compute(e, is_volume, bases[e], gbases[e]);
+
+				const Quadrature &quadrature = vals.quadrature;
+
+				assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+				loc_storage.da = vals.det.array() * quadrature.weights.array();
+				assemble_element_values(local_assembler, vals, loc_storage.da, values, has_element_assembly<LocalAssembler>());
+#ifdef POLYFEM_WITH_TBB
+			} });
+#else
+				}
+#endif
+			}
+		}
+
+		//true if the local assembler can project dP/dF to psd at the quadrature points with assemble_hessian(vals, displacement, da, project_to_psd)
+		template <typename LocalAssembler, typename = void>
+		struct has_quadrature_psd_projection : std::false_type {};
+
+		template <typename LocalAssembler>
+		struct has_quadrature_psd_projection<LocalAssembler, typename make_void<decltype(std::declval<const LocalAssembler &>().assemble_hessian(std::declval<const ElementAssemblyValues &>(), std::declval<const Eigen::MatrixXd &>(), std::declval<const QuadratureVector &>(), std::declval<bool>()))>::type> : std::true_type {};
+
+		template <typename LocalAssembler>
+		Eigen::MatrixXd element_hessian(const LocalAssembler &local_assembler, const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, const bool project_points, std::true_type)
+		{
+			return local_assembler.assemble_hessian(vals, displacement, da, project_points);
+		}
+
+		template <typename LocalAssembler>
+		Eigen::MatrixXd element_hessian(const LocalAssembler &local_assembler, const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, const bool project_points, std::false_type)
+		{
+			assert(!project_points);
+			return local_assembler.assemble_hessian(vals, displacement, da);
+		}
+
+		//the projection is done per quadrature point only if requested and supported, otherwise on the element hessian
+		template <typename LocalAssembler>
+		bool projects_quadrature_points(const bool project_to_psd, const bool quadrature_psd_projection)
+		{
+			return project_to_psd && quadrature_psd_projection && has_quadrature_psd_projection<LocalAssembler>::value;
+		}
+
+		//assembles the hessian of a non linear local assembler into values, same coloring as assemble_colored
+		//if project_points the local assembler makes the hessian psd per quadrature point, if project_to_psd the element hessian is projected
+		template <typename LocalAssembler, typename Target>
+		void assemble_hessian_colored(const LocalAssembler &local_assembler, const AssemblyValsCache &cache, const bool is_volume, const bool project_to_psd, const bool project_points, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases, const SparsityPattern &pattern, const Eigen::MatrixXd &displacement, const Target &values)
+		{
+			init_material_cache(local_assembler, is_volume, bases, gbases, has_material_cache<LocalAssembler>());
+
+#ifdef POLYFEM_WITH_TBB
+			typedef tbb::enumerable_thread_specific<LocalThreadElementStorage> LocalStorage;
+			LocalStorage storages((LocalThreadElementStorage()));
+#else
+			LocalThreadElementStorage loc_storage;
+#endif
+
+			for (const std::vector<int> &color : pattern.colors())
+			{
+				const int n_color_elements = int(color.size());
+#ifdef POLYFEM_WITH_TBB
+				tbb::parallel_for(tbb::blocked_range<int>(0, n_color_elements), [&](const tbb::blocked_range<int> &r) {
+			LocalStorage::reference loc_storage = storages.local();
+			for (int k = r.begin(); k != r.end(); ++k) {
+#else
+				for (int k = 0; k < n_color_elements; ++k)
+				{
+#endif
+				const int e = color[k];
+				const bool is_cached = cache.is_cached(e);
+				if (!is_cached)
+				{
+					loc_storage.vals.compute(e, is_volume, bases[e], gbases[e]);
+					assert(MAX_QUAD_POINTS == -1 || loc_storage.vals.quadrature.weights.size() < MAX_QUAD_POINTS);
+					loc_storage.da = loc_storage.vals.det.array() * loc_storage.vals.quadrature.weights.array();
+				}
+				const ElementAssemblyValues &vals = is_cached ? cache.vals(e) : loc_storage.vals;
+				const QuadratureVector &da = is_cached ? cache.da(e) : loc_storage.da;
+
+				Eigen::MatrixXd stiffness_val = element_hessian(local_assembler, vals, displacement, da, project_points, has_quadrature_psd_projection<LocalAssembler>());
+				assert(stiffness_val.rows() == int(vals.basis_values.size()) * local_assembler.size());
+				assert(stiffness_val.cols() == int(vals.basis_values.size()) * local_assembler.size());
+
+				if (project_to_psd)
+					stiffness_val = Eigen::project_to_psd(stiffness_val);
+
+				scatter_element_matrix(vals, stiffness_val, values);
+#ifdef POLYFEM_WITH_TBB
+			} });
+#else
+				}
+#endif
+			}
+		}
+
+		//true if the local assembler computes energy, gradient, and hessian at once with assemble_all(vals, displacement, da, project_to_psd, energy, grad, hessian)
+		template <typename LocalAssembler, typename = void>
+		struct has_fused_energy : std::false_type {};
+
+		template <typename LocalAssembler>
+		struct has_fused_energy<LocalAssembler, typename make_void<decltype(std::declval<const LocalAssembler &>().assemble_all(std::declval<const ElementAssemblyValues &>(), std::declval<const Eigen::MatrixXd &>(), std::declval<const QuadratureVector &>(), std::declval<bool>(), std::declval<double &>(), std::declval<Eigen::VectorXd &>(), std::declval<Eigen::MatrixXd &>()))>::type> : std::true_type {};
+
+		template <typename LocalAssembler>
+		void element_energy_derivatives(const LocalAssembler &local_assembler, const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, const bool project_points, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian, std::true_type)
+		{
+			local_assembler.assemble_all(vals, displacement, da, project_points, energy, grad, hessian);
+		}
+
+		//the three quantities are computed separately, but the element values are still computed once
+		template <typename LocalAssembler>
+		void element_energy_derivatives(const LocalAssembler &local_assembler, const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, const bool project_points, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian, std::false_type)
+		{
+			energy = local_assembler.compute_energy(vals, displacement, da);
+			grad = local_assembler.assemble_grad(vals, displacement, da);
+			hessian = element_hessian(local_assembler, vals, displacement, da, project_points, has_quadrature_psd_projection<LocalAssembler>());
+		}
+
+		template <typename LocalAssembler, typename = void>
+		struct has_fused_energy_grad : std::false_type {};
+
+		template <typename LocalAssembler>
+		struct has_fused_energy_grad<LocalAssembler, typename make_void<decltype(std::declval<const LocalAssembler &>().assemble_energy_grad(std::declval<const ElementAssemblyValues &>(), std::declval<const Eigen::MatrixXd &>(), std::declval<const QuadratureVector &>(), std::declval<double &>(), std::declval<Eigen::VectorXd &>()))>::type> : std::true_type {};
+
+		template <typename LocalAssembler>
+		void element_energy_grad(const LocalAssembler &local_assembler, const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, double &energy, Eigen::VectorXd &grad, std::true_type)
+		{
+			local_assembler.assemble_energy_grad(vals, displacement, da, energy, grad);
+		}
+
+		template <typename LocalAssembler>
+		void element_energy_grad(const LocalAssembler &local_assembler, const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, double &energy, Eigen::VectorXd &grad, std::false_type)
+		{
+			energy = local_assembler.compute_energy(vals, displacement, da);
+			grad = local_assembler.assemble_grad(vals, displacement, da);
+		}
+
+		//energy, gradient, and hessian in a single sweep with the coloring of assemble_colored
+		//elements of the same color share no node, so the gradient is also scattered directly into grad
+		template <typename LocalAssembler, typename Target>
+		double assemble_all_colored(const LocalAssembler &local_assembler, const AssemblyValsCache &cache, const bool is_volume, const bool project_to_psd, const bool project_points, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases, const SparsityPattern &pattern, const Eigen::MatrixXd &displacement, Eigen::MatrixXd &grad, const Target &values)
+		{
+			const int size = local_assembler.size();
+			init_material_cache(local_assembler, is_volume, bases, gbases, has_material_cache<LocalAssembler>());
+
+#ifdef POLYFEM_WITH_TBB
+			typedef tbb::enumerable_thread_specific<LocalThreadScalarStorage> LocalStorage;
+			LocalStorage storages((LocalThreadScalarStorage()));
+#else
+			LocalThreadScalarStorage loc_storage;
+#endif
+
+			for (const std::vector<int> &color : pattern.colors())
+			{
+				const int n_color_elements = int(color.size());
+#ifdef POLYFEM_WITH_TBB
+				tbb::parallel_for(tbb::blocked_range<int>(0, n_color_elements), [&](const tbb::blocked_range<int> &r) {
+			LocalStorage::reference loc_storage = storages.local();
+			for (int k = r.begin(); k != r.end(); ++k) {
+#else
+				for (int k = 0; k < n_color_elements; ++k)
+				{
+#endif
+				const int e = color[k];
+				const bool is_cached = cache.is_cached(e);
+				if (!is_cached)
+				{
+					loc_storage.vals.compute(e, is_volume, bases[e], gbases[e]);
+					assert(MAX_QUAD_POINTS == -1 || loc_storage.vals.quadrature.weights.size() < MAX_QUAD_POINTS);
+					loc_storage.da = loc_storage.vals.det.array() * loc_storage.vals.quadrature.weights.array();
+				}
+				const ElementAssemblyValues &vals = is_cached ? cache.vals(e) : loc_storage.vals;
+				const QuadratureVector &da = is_cached ? cache.da(e) : loc_storage.da;
+				const int n_loc_bases = int(vals.basis_values.size());
+
+				double energy;
+				Eigen::VectorXd local_grad;
+				Eigen::MatrixXd stiffness_val;
+				element_energy_derivatives(local_assembler, vals, displacement, da, project_points, energy, local_grad, stiffness_val, has_fused_energy<LocalAssembler>());
+				assert(local_grad.size() == n_loc_bases * size);
+				assert(stiffness_val.rows() == n_loc_bases * size);
+				assert(stiffness_val.cols() == n_loc_bases * size);
+
+				loc_storage.val += energy;
+
+				for (int j = 0; j < n_loc_bases; ++j)
+				{
+					for (const auto &g : vals.basis_values[j].global)
+					{
+						for (int m = 0; m < size; ++m)
+							grad(g.index * size + m) += g.val * local_grad(j * size + m);
+					}
+				}
+
+				if (project_to_psd)
+					stiffness_val = Eigen::project_to_psd(stiffness_val);
+
+				scatter_element_matrix(vals, stiffness_val, values);
+#ifdef POLYFEM_WITH_TBB
+			} });
+#else
+				}
+#endif
+			}
+
+#ifdef POLYFEM_WITH_TBB
+			double res = 0;
+			for (LocalStorage::iterator i = storages.begin(); i != storages.end(); ++i)
+				res += i->val;
+
+			return res;
+#else
+			return loc_storage.val;
+#endif
+		}
+	} // namespace
+
+	template <class LocalAssembler>
+	void Assembler<LocalAssembler>::assemble(
+		const bool is_volume,
+		const int n_basis,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		StiffnessMatrix &stiffness,
+		const bool symmetric) const
+	{
+		const int size = local_assembler_.size();
+
+		igl::Timer timerg;
+		timerg.start();
+		SparsityPattern pattern;
+		pattern.init(n_basis, size, bases, symmetric);
+		pattern.create_matrix(stiffness);
+		timerg.stop();
+		logger().debug("done pattern {}s, nnz {}", timerg.getElapsedTime(), stiffness.nonZeros());
+
+		try
+		{
+			timerg.start();
+			assemble_colored(local_assembler_, is_volume, bases, gbases, pattern, PatternValues(pattern, stiffness.valuePtr()));
+			timerg.stop();
+			logger().debug("done assembly {}s, {} colors", timerg.getElapsedTime(), pattern.n_colors());
+		}
+		catch (std::bad_alloc &ba)
+		{
+			logger().error("bad alloc {}", ba.what());
+			exit(0);
+		}
+	}
+
+	template <class LocalAssembler>
+	void Assembler<LocalAssembler>::assemble(
+		const bool is_volume,
+		const int n_basis,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		BlockSparseMatrix &stiffness) const
+	{
+		const int size = local_assembler_.size();
+
+		igl::Timer timerg;
+		timerg.start();
+		SparsityPattern pattern;
+		pattern.init(n_basis, size, bases);
+		stiffness.init(pattern);
+		timerg.stop();
+		logger().debug("done pattern {}s, {} blocks", timerg.getElapsedTime(), stiffness.n_blocks());
+
+		try
+		{
+			timerg.start();
+			assemble_colored(local_assembler_, is_volume, bases, gbases, pattern, BlockValues(stiffness));
+			timerg.stop();
+			logger().debug("done block assembly {}s, {} colors", timerg.getElapsedTime(), pattern.n_colors());
+		}
+		catch (std::bad_alloc &ba)
+		{
+			logger().error("bad alloc {}", ba.what());
+			exit(0);
+		}
+	}
+
+	template <class LocalAssembler>
+	void Assembler<LocalAssembler>::apply(
+		const bool is_volume,
+		const int n_basis,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const Eigen::VectorXd &x,
+		Eigen::VectorXd &y) const
+	{
+		//tensor product hexes are applied with sum factorization and need no per element values
+		//the other elements recompute their values at every product, storing them would take as much memory as K
+		SumFactorizations &kernels = sum_factorizations_;
+		const bool sum_factorization = has_flux<LocalAssembler>::value && init_sum_factorizations(is_volume, bases, gbases, kernels);
+
+		if (!sum_factorization)
+			logger().debug("matrix-free product without sum factorization, {}", has_flux<LocalAssembler>::value ? "not all elements are tensor product hexes" : "the formulation has no pointwise flux");
+		//the sum factorized points are the quadrature points of the bases, the flux reads the same cache
+		init_material_cache(local_assembler_, is_volume, bases, gbases, has_material_cache<LocalAssembler>());
+
+		const int size = local_assembler_.size();
+		assert(x.size() == n_basis * size);
+
+		y.resize(n_basis * size);
+		y.setZero();
+
+#ifdef POLYFEM_WITH_TBB
+		typedef tbb::enumerable_thread_specific<LocalThreadVecStorage> LocalStorage;
+		LocalStorage storages(LocalThreadVecStorage(y.size()));
+#else
+		LocalThreadVecStorage loc_storage(y.size());
+#endif
+
+		const int n_bases = int(bases.size());
+
+#ifdef POLYFEM_WITH_TBB
+		tbb::parallel_for(tbb::blocked_range<int>(0, n_bases), [&](const tbb::blocked_range<int> &r) {
+		LocalStorage::reference loc_storage = storages.local();
+		Eigen::VectorXd x_loc, y_loc;
+		for (int e = r.begin(); e != r.end(); ++e) {
+#else
+		Eigen::VectorXd x_loc, y_loc;
+		for (int e = 0; e < n_bases; ++e)
+		{
+#endif
+			if (sum_factorization)
+			{
+				apply_sum_factorization(local_assembler_, e, bases[e], gbases[e], kernels, x, loc_storage.vec, has_flux<LocalAssembler>());
+				continue;
+			}
+
+			loc_storage.vals.compute(e, is_volume, bases[e], gbases[e]);
+			assert(MAX_QUAD_POINTS == -1 || loc_storage.vals.quadrature.weights.size() < MAX_QUAD_POINTS);
+			loc_storage.da = loc_storage.vals.det.array() * loc_storage.vals.quadrature.weights.array();
+			const ElementAssemblyValues &vals = loc_storage.vals;
+			const QuadratureVector &da = loc_storage.da;
+			const int n_loc_bases = int(vals.basis_values.size());
 
-						tmp += i->stiffness;
-						i->stiffness.resize(0, 0);
-						i->stiffness.data().squeeze();
+			//gathers the local coefficients
+			x_loc.setZero(n_loc_bases * size);
+			for(int i = 0; i < n_loc_bases; ++i)
+			{
+				for(const auto &g : vals.basis_values[i].global)
+					x_loc.segment(i * size, size) += g.val * x.segment(g.index * size, size);
+			}
 
-						tmp.makeCompressed();
-					}
+			y_loc.noalias() = element_matrix(local_assembler_, vals, da, size, has_element_assembly<LocalAssembler>()) * x_loc;
 
-					return tmp;
-				},
-				[](const StiffnessMatrix &a, const StiffnessMatrix &b) {
-					return a + b;
-				});
+			for(int i = 0; i < n_loc_bases; ++i)
+			{
+				for(const auto &g : vals.basis_values[i].global)
+					loc_storage.vec.block(g.index * size, 0, size, 1) += g.val * y_loc.segment(i * size, size);
+			}
+#ifdef POLYFEM_WITH_TBB
+		} });
+#else
+		}
+#endif
 
-			mat.makeCompressed();
+#ifdef POLYFEM_WITH_TBB
+		for (LocalStorage::iterator i = storages.begin(); i != storages.end(); ++i)
+		{
+			y += i->vec;
 		}
+#else
+		y = loc_storage.vec;
 #endif
-	} // namespace
+	}
 
 	template <class LocalAssembler>
-	void Assembler<LocalAssembler>::assemble(
+	void Assembler<LocalAssembler>::assemble_diagonal(
 		const bool is_volume,
 		const int n_basis,
 		const std::vector<ElementBases> &bases,
 		const std::vector<ElementBases> &gbases,
-		StiffnessMatrix &stiffness) const
+		Eigen::VectorXd &diag) const
 	{
-		const int buffer_size = std::min(long(1e8), long(n_basis) * local_assembler_.size());
-		// #ifdef POLYFEM_WITH_TBB
-		// 		buffer_size /= tbb::task_scheduler_init::default_num_threads();
-		// #endif
-		logger().debug("buffer_size {}", buffer_size);
-		try
-		{
-			stiffness.resize(n_basis * local_assembler_.size(), n_basis * local_assembler_.size());
-			stiffness.setZero();
+		//the diagonal is computed once, the values are not stored
+		init_material_cache(local_assembler_, is_volume, bases, gbases, has_material_cache<LocalAssembler>());
+
+		const int size = local_assembler_.size();
+
+		diag.resize(n_basis * size);
+		diag.setZero();
 
 #ifdef POLYFEM_WITH_TBB
-			typedef tbb::enumerable_thread_specific<LocalThreadMatStorage> LocalStorage;
-			LocalStorage storages(LocalThreadMatStorage(buffer_size, stiffness.rows(), stiffness.cols()));
+		typedef tbb::enumerable_thread_specific<LocalThreadVecStorage> LocalStorage;
+		LocalStorage storages(LocalThreadVecStorage(diag.size()));
 #else
-			LocalThreadMatStorage loc_storage(buffer_size, stiffness.rows(), stiffness.cols());
+		LocalThreadVecStorage loc_storage(diag.size());
 #endif
 
-			const int n_bases = int(bases.size());
-			igl::Timer timerg;
-			timerg.start();
+		const int n_bases = int(bases.size());
+
 #ifdef POLYFEM_WITH_TBB
-			tbb::parallel_for(tbb::blocked_range<int>(0, n_bases), [&](const tbb::blocked_range<int> &r) {
+		tbb::parallel_for(tbb::blocked_range<int>(0, n_bases), [&](const tbb::blocked_range<int> &r) {
 		LocalStorage::reference loc_storage = storages.local();
-		loc_storage.entries.reserve(buffer_size);
-		loc_storage.stiffness.resize(stiffness.rows(), stiffness.cols());
-		loc_storage.tmp_mat.resize(stiffness.rows(), stiffness.cols());
-
 		for (int e = r.begin(); e != r.end(); ++e) {
 #else
-			for (int e = 0; e < n_bases; ++e)
-			{
+		for (int e = 0; e < n_bases; ++e)
+		{
 #endif
-            ElementAssemblyValues &vals = loc_storage.vals;
-			// igl::Timer timer; timer.start();
-			vals.compute(e, is_volume, bases[e], gbases[e]);
-
-			const Quadrature &quadrature = vals.quadrature;
-
-			assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-			loc_storage.da = vals.det.array() * quadrature.weights.array();
+			loc_storage.vals.compute(e, is_volume, bases[e], gbases[e]);
+			assert(MAX_QUAD_POINTS == -1 || loc_storage.vals.quadrature.weights.size() < MAX_QUAD_POINTS);
+			loc_storage.da = loc_storage.vals.det.array() * loc_storage.vals.quadrature.weights.array();
+			const ElementAssemblyValues &vals = loc_storage.vals;
+			const QuadratureVector &da = loc_storage.da;
 			const int n_loc_bases = int(vals.basis_values.size());
 
+			const Eigen::MatrixXd local = element_matrix(local_assembler_, vals, da, size, has_element_assembly<LocalAssembler>());
+
+			//a global node gets contributions from every pair of local bases that share it
 			for(int i = 0; i < n_loc_bases; ++i)
 			{
-				// const AssemblyValues &values_i = vals.basis_values[i];
-				// const Eigen::MatrixXd &gradi = values_i.grad_t_m;
 				const auto &global_i = vals.basis_values[i].global;
 
-				for(int j = 0; j <= i; ++j)
+				for(int j = 0; j < n_loc_bases; ++j)
 				{
-					// const AssemblyValues &values_j = vals.basis_values[j];
-					// const Eigen::MatrixXd &gradj = values_j.grad_t_m;
 					const auto &global_j = vals.basis_values[j].global;
 
-					const auto stiffness_val = local_assembler_.assemble(vals, i, j, loc_storage.da);
-					assert(stiffness_val.size() == local_assembler_.size() * local_assembler_.size());
-
-					// igl::Timer t1; t1.start();
-					for(int n = 0; n < local_assembler_.size(); ++n)
+					for(const auto &gi : global_i)
 					{
-						for(int m = 0; m < local_assembler_.size(); ++m)
+						for(const auto &gj : global_j)
 						{
-							const double local_value = stiffness_val(n*local_assembler_.size()+m);
-							if (std::abs(local_value) < 1e-30) { continue; }
-
-							for(size_t ii = 0; ii < global_i.size(); ++ii)
-							{
-								const auto gi = global_i[ii].index*local_assembler_.size()+m;
-								const auto wi = global_i[ii].val;
-
-								for(size_t jj = 0; jj < global_j.size(); ++jj)
-								{
-									const auto gj = global_j[jj].index*local_assembler_.size()+n;
-									const auto wj = global_j[jj].val;
-
-									loc_storage.entries.emplace_back(gi, gj, local_value * wi * wj);
-									if (j < i) {
-										loc_storage.entries.emplace_back(gj, gi, local_value * wj * wi);
-									}
-
-									if(loc_storage.entries.size() >= 1e8)
-									{
-										loc_storage.tmp_mat.setFromTriplets(loc_storage.entries.begin(), loc_storage.entries.end());
-										loc_storage.stiffness += loc_storage.tmp_mat;
-
-										loc_storage.tmp_mat.setZero();
-										loc_storage.tmp_mat.data().squeeze();
-
-										loc_storage.stiffness.makeCompressed();
+							if (gi.index != gj.index)
+								continue;
 
-										loc_storage.entries.clear();
-										logger().debug("cleaning memory. Current storage: {}. mat nnz: {}", loc_storage.entries.capacity(), loc_storage.stiffness.nonZeros());
-									}
-								}
-							}
+							for(int m = 0; m < size; ++m)
+								loc_storage.vec(gi.index * size + m) += gi.val * gj.val * local(i*size + m, j*size + m);
 						}
 					}
-
-					// t1.stop();
-					// if (!vals.has_parameterization) { std::cout << "-- t1: " << t1.getElapsedTime() << std::endl; }
-
 				}
-
 			}
-
-					// timer.stop();
-					// if (!vals.has_parameterization) { std::cout << "-- Timer: " << timer.getElapsedTime() << std::endl; }
 #ifdef POLYFEM_WITH_TBB
 		} });
 #else
-			}
+		}
 #endif
-			timerg.stop();
-			logger().debug("done separate assembly {}s...", timerg.getElapsedTime());
 
-			timerg.start();
 #ifdef POLYFEM_WITH_TBB
-			merge_matrices(storages, stiffness);
-			// for (LocalStorage::iterator i = storages.begin(); i != storages.end();  ++i)
-			// {
-			// 	logger().debug("local stiffness: {}, entries: {}", i->stiffness.nonZeros(), i->entries.size());
-
-			// 	i->tmp_mat.setFromTriplets(i->entries.begin(), i->entries.end());
-			// 	i->entries.clear();
-			// 	i->entries.shrink_to_fit();
-
-			// 	i->stiffness += i->tmp_mat;
-
-			// 	i->tmp_mat.resize(0,0);
-			// 	i->tmp_mat.data().squeeze();
-
-			// 	i->stiffness.makeCompressed();
-
-			// 	stiffness += i->stiffness;
-
-			// 	i->stiffness.resize(0,0);
-			// 	i->stiffness.data().squeeze();
-
-			// 	stiffness.makeCompressed();
-			// }
-#else
-			stiffness = loc_storage.stiffness;
-			loc_storage.tmp_mat.setFromTriplets(loc_storage.entries.begin(), loc_storage.entries.end());
-			stiffness += loc_storage.tmp_mat;
-			stiffness.makeCompressed();
-#endif
-
-			timerg.stop();
-			logger().debug("done merge assembly {}s...", timerg.getElapsedTime());
-		}
-		catch (std::bad_alloc &ba)
+		for (LocalStorage::iterator i = storages.begin(); i != storages.end(); ++i)
 		{
-			logger().error("bad alloc {}", ba.what());
-			exit(0);
+			diag += i->vec;
 		}
-
-		// stiffness.resize(n_basis*local_assembler_.size(), n_basis*local_assembler_.size());
-		// stiffness.setFromTriplets(entries.begin(), entries.end());
+#else
+		diag = loc_storage.vec;
+#endif
 	}
 
 	template <class LocalAssembler>
@@ -433,6 +1071,10 @@ namespace polyfem
 		const Eigen::MatrixXd &displacement,
 		Eigen::MatrixXd &rhs) const
 	{
+		if (!cache_.is_initialized(is_volume, bases, gbases))
+			cache_.init(is_volume, bases, gbases);
+		init_material_cache(local_assembler_, is_volume, bases, gbases, has_material_cache<LocalAssembler>());
+
 		rhs.resize(n_basis * local_assembler_.size(), 1);
 		rhs.setZero();
 
@@ -455,15 +1097,17 @@ namespace polyfem
 #endif
 			// igl::Timer timer; timer.start();
 
-			ElementAssemblyValues &vals = loc_storage.vals;
-			vals.compute(e, is_volume, bases[e], gbases[e]);
-
-			const Quadrature &quadrature = vals.quadrature;
-
-			assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-			loc_storage.da = vals.det.array() * quadrature.weights.array();
+			const bool is_cached = cache_.is_cached(e);
+			if (!is_cached)
+			{
+				loc_storage.vals.compute(e, is_volume, bases[e], gbases[e]);
+				assert(MAX_QUAD_POINTS == -1 || loc_storage.vals.quadrature.weights.size() < MAX_QUAD_POINTS);
+				loc_storage.da = loc_storage.vals.det.array() * loc_storage.vals.quadrature.weights.array();
+			}
+			const ElementAssemblyValues &vals = is_cached ? cache_.vals(e) : loc_storage.vals;
+			const QuadratureVector &da = is_cached ? cache_.da(e) : loc_storage.da;
 			const int n_loc_bases = int(vals.basis_values.size());
-			const auto val = local_assembler_.assemble_grad(vals, displacement, loc_storage.da);
+			const auto val = local_assembler_.assemble_grad(vals, displacement, da);
 			assert(val.size() == n_loc_bases*local_assembler_.size());
 
 			for(int j = 0; j < n_loc_bases; ++j)
@@ -518,22 +1162,108 @@ namespace polyfem
 		const Eigen::MatrixXd &displacement,
 		StiffnessMatrix &grad) const
 	{
-		const int buffer_size = std::min(long(1e8), long(n_basis) * local_assembler_.size());
-		// std::cout<<"buffer_size "<<buffer_size<<std::endl;
+		const int size = local_assembler_.size();
 
-		grad.resize(n_basis * local_assembler_.size(), n_basis * local_assembler_.size());
-		grad.setZero();
+		//the pattern and the element coloring are built once for these bases
+		const long n_local_bases = AssemblyValsCache::n_local_bases(bases);
+		if (pattern_bases_ != &bases || pattern_.n_basis() != n_basis || pattern_.size() != size || pattern_n_elements_ != int(bases.size()) || pattern_n_local_bases_ != n_local_bases)
+		{
+			pattern_.init(n_basis, size, bases);
+			pattern_bases_ = &bases;
+			pattern_n_elements_ = int(bases.size());
+			pattern_n_local_bases_ = n_local_bases;
+		}
+
+		assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, pattern_, displacement, grad);
+	}
+
+	template <class LocalAssembler>
+	void NLAssembler<LocalAssembler>::assemble_hessian(
+		const bool is_volume,
+		const int n_basis,
+		const bool project_to_psd,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const SparsityPattern &pattern,
+		const Eigen::MatrixXd &displacement,
+		StiffnessMatrix &hessian) const
+	{
+		if (!cache_.is_initialized(is_volume, bases, gbases))
+			cache_.init(is_volume, bases, gbases);
+
+		assert(pattern.n_basis() == n_basis);
+		assert(pattern.size() == local_assembler_.size());
+
+		if (pattern.matches(hessian))
+			std::fill(hessian.valuePtr(), hessian.valuePtr() + hessian.nonZeros(), 0.0);
+		else
+			pattern.create_matrix(hessian);
+
+		const bool project_points = projects_quadrature_points<LocalAssembler>(project_to_psd, quadrature_psd_projection_);
+
+		igl::Timer timerg;
+		timerg.start();
+		assemble_hessian_colored(local_assembler_, cache_, is_volume, project_to_psd && !project_points, project_points, bases, gbases, pattern, displacement, PatternValues(pattern, hessian.valuePtr()));
+		timerg.stop();
+		logger().trace("done assembly {}s, {} colors", timerg.getElapsedTime(), pattern.n_colors());
+	}
+
+	template <class LocalAssembler>
+	void NLAssembler<LocalAssembler>::assemble_hessian(
+		const bool is_volume,
+		const int n_basis,
+		const bool project_to_psd,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const SparsityPattern &pattern,
+		const Eigen::MatrixXd &displacement,
+		BlockSparseMatrix &hessian) const
+	{
+		if (!cache_.is_initialized(is_volume, bases, gbases))
+			cache_.init(is_volume, bases, gbases);
+
+		assert(pattern.n_basis() == n_basis);
+		assert(pattern.size() == local_assembler_.size());
+
+		if (hessian.matches(pattern))
+			hessian.set_zero();
+		else
+			hessian.init(pattern);
+
+		const bool project_points = projects_quadrature_points<LocalAssembler>(project_to_psd, quadrature_psd_projection_);
+
+		igl::Timer timerg;
+		timerg.start();
+		assemble_hessian_colored(local_assembler_, cache_, is_volume, project_to_psd && !project_points, project_points, bases, gbases, pattern, displacement, BlockValues(hessian));
+		timerg.stop();
+		logger().trace("done block assembly {}s, {} colors", timerg.getElapsedTime(), pattern.n_colors());
+	}
+
+	template <class LocalAssembler>
+	void NLAssembler<LocalAssembler>::assemble_energy_grad(
+		const bool is_volume,
+		const int n_basis,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const Eigen::MatrixXd &displacement,
+		double &energy,
+		Eigen::MatrixXd &grad) const
+	{
+		if (!cache_.is_initialized(is_volume, bases, gbases))
+			cache_.init(is_volume, bases, gbases);
+		init_material_cache(local_assembler_, is_volume, bases, gbases, has_material_cache<LocalAssembler>());
+
+		const int size = local_assembler_.size();
+		grad.resize(n_basis * size, 1);
 
 #ifdef POLYFEM_WITH_TBB
-		typedef tbb::enumerable_thread_specific<LocalThreadMatStorage> LocalStorage;
-		LocalStorage storages(LocalThreadMatStorage(buffer_size, grad.rows(), grad.cols()));
+		typedef tbb::enumerable_thread_specific<LocalThreadVecStorage> LocalStorage;
+		LocalStorage storages(LocalThreadVecStorage(grad.size()));
 #else
-		LocalThreadMatStorage loc_storage(buffer_size, grad.rows(), grad.cols());
+		LocalThreadVecStorage loc_storage(grad.size());
 #endif
 
 		const int n_bases = int(bases.size());
-		igl::Timer timerg;
-		timerg.start();
 
 #ifdef POLYFEM_WITH_TBB
 		tbb::parallel_for(tbb::blocked_range<int>(0, n_bases), [&](const tbb::blocked_range<int> &r) {
@@ -543,134 +1273,85 @@ namespace polyfem
 		for (int e = 0; e < n_bases; ++e)
 		{
 #endif
-			ElementAssemblyValues &vals = loc_storage.vals;
-			// igl::Timer timer; timer.start();
-			vals.compute(e, is_volume, bases[e], gbases[e]);
-
-			const Quadrature &quadrature = vals.quadrature;
-
-			assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-			loc_storage.da = vals.det.array() * quadrature.weights.array();
+			const bool is_cached = cache_.is_cached(e);
+			if (!is_cached)
+			{
+				loc_storage.vals.compute(e, is_volume, bases[e], gbases[e]);
+				assert(MAX_QUAD_POINTS == -1 || loc_storage.vals.quadrature.weights.size() < MAX_QUAD_POINTS);
+				loc_storage.da = loc_storage.vals.det.array() * loc_storage.vals.quadrature.weights.array();
+			}
+			const ElementAssemblyValues &vals = is_cached ? cache_.vals(e) : loc_storage.vals;
+			const QuadratureVector &da = is_cached ? cache_.da(e) : loc_storage.da;
 			const int n_loc_bases = int(vals.basis_values.size());
 
-			auto stiffness_val = local_assembler_.assemble_hessian(vals, displacement, loc_storage.da);
-			assert(stiffness_val.rows() == n_loc_bases * local_assembler_.size());
-			assert(stiffness_val.cols() == n_loc_bases * local_assembler_.size());
-
-			if (project_to_psd)
-				stiffness_val = Eigen::project_to_psd(stiffness_val);
-
-			// bool has_nan = false;
-			// for(int k = 0; k < stiffness_val.size(); ++k)
-			// {
-			// 	if(std::isnan(stiffness_val(k)))
-			// 	{
-			// 		has_nan = true;
-			// 		break;
-			// 	}
-			// }
+			double local_energy;
+			Eigen::VectorXd local_grad;
+			element_energy_grad(local_assembler_, vals, displacement, da, local_energy, local_grad, has_fused_energy_grad<LocalAssembler>());
+			assert(local_grad.size() == n_loc_bases * size);
 
-			// if(has_nan)
-			// {
-			// 	loc_storage.entries.emplace_back(0, 0, std::nan(""));
-			// 	break;
-			// }
-
-
-				// igl::Timer t1; t1.start();
-			for(int i = 0; i < n_loc_bases; ++i)
+			loc_storage.val += local_energy;
+			for (int j = 0; j < n_loc_bases; ++j)
 			{
-				const auto &global_i = vals.basis_values[i].global;
-
-				for(int j = 0; j < n_loc_bases; ++j)
-				// for(int j = 0; j <= i; ++j)
+				for (const auto &g : vals.basis_values[j].global)
 				{
-					const auto &global_j = vals.basis_values[j].global;
-
-					for(int n = 0; n < local_assembler_.size(); ++n)
-					{
-						for(int m = 0; m < local_assembler_.size(); ++m)
-						{
-							const double local_value = stiffness_val(i*local_assembler_.size() + m, j*local_assembler_.size() + n);
-							if (std::abs(local_value) < 1e-30) { continue; }
-
-							for(size_t ii = 0; ii < global_i.size(); ++ii)
-							{
-								const auto gi = global_i[ii].index*local_assembler_.size() + m;
-								const auto wi = global_i[ii].val;
-
-								for(size_t jj = 0; jj < global_j.size(); ++jj)
-								{
-									const auto gj = global_j[jj].index*local_assembler_.size() + n;
-									const auto wj = global_j[jj].val;
-
-									loc_storage.entries.emplace_back(gi, gj, local_value * wi * wj);
-									// if (j < i) {
-									// 	loc_storage.entries.emplace_back(gj, gi, local_value * wj * wi);
-									// }
-
-									if(loc_storage.entries.size() >= 1e8)
-									{
-										loc_storage.tmp_mat.setFromTriplets(loc_storage.entries.begin(), loc_storage.entries.end());
-										loc_storage.stiffness += loc_storage.tmp_mat;
-										loc_storage.stiffness.makeCompressed();
-
-										loc_storage.entries.clear();
-										logger().debug("cleaning memory...");
-									}
-								}
-							}
-						}
-					}
+					for (int m = 0; m < size; ++m)
+						loc_storage.vec(g.index * size + m) += g.val * local_grad(j * size + m);
 				}
-				// t1.stop();
-				// if (!vals.has_parameterization) { std::cout << "-- t1: " << t1.getElapsedTime() << std::endl; }
 			}
-
-				// timer.stop();
-				// if (!vals.has_parameterization) { std::cout << "-- Timer: " << timer.getElapsedTime() << std::endl; }
 #ifdef POLYFEM_WITH_TBB
 		} });
 #else
 		}
 #endif
 
-		timerg.stop();
-		logger().trace("done separate assembly {}s...", timerg.getElapsedTime());
-
-		timerg.start();
-
 #ifdef POLYFEM_WITH_TBB
-		merge_matrices(storages, grad);
-		// for (LocalStorage::iterator i = storages.begin(); i != storages.end(); ++i)
-		// {
-		// 	// logger().debug("local stiffness: {}, entries: {}", i->stiffness.nonZeros(), i->entries.size());
-		// 	i->tmp_mat.setFromTriplets(i->entries.begin(), i->entries.end());
-		// 	i->entries.clear();
-		// 	i->entries.shrink_to_fit();
+		energy = 0;
+		grad.setZero();
+		for (LocalStorage::iterator i = storages.begin(); i != storages.end(); ++i)
+		{
+			energy += i->val;
+			grad += i->vec;
+		}
+#else
+		energy = loc_storage.val;
+		grad = loc_storage.vec;
+#endif
+	}
 
-		// 	i->stiffness += i->tmp_mat;
+	template <class LocalAssembler>
+	void NLAssembler<LocalAssembler>::assemble_all(
+		const bool is_volume,
+		const int n_basis,
+		const bool project_to_psd,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const SparsityPattern &pattern,
+		const Eigen::MatrixXd &displacement,
+		double &energy,
+		Eigen::MatrixXd &grad,
+		StiffnessMatrix &hessian) const
+	{
+		if (!cache_.is_initialized(is_volume, bases, gbases))
+			cache_.init(is_volume, bases, gbases);
 
-		// 	i->tmp_mat.resize(0, 0);
-		// 	i->tmp_mat.data().squeeze();
+		assert(pattern.n_basis() == n_basis);
+		assert(pattern.size() == local_assembler_.size());
 
-		// 	i->stiffness.makeCompressed();
+		grad.resize(n_basis * local_assembler_.size(), 1);
+		grad.setZero();
 
-		// 	grad += i->stiffness;
-		// 	i->stiffness.resize(0, 0);
-		// 	i->stiffness.data().squeeze();
+		if (pattern.matches(hessian))
+			std::fill(hessian.valuePtr(), hessian.valuePtr() + hessian.nonZeros(), 0.0);
+		else
+			pattern.create_matrix(hessian);
 
-		// 	grad.makeCompressed();
-		// }
-#else
-		grad = loc_storage.stiffness;
-		loc_storage.tmp_mat.setFromTriplets(loc_storage.entries.begin(), loc_storage.entries.end());
-		grad += loc_storage.tmp_mat;
-		grad.makeCompressed();
-#endif
+		const bool project_points = projects_quadrature_points<LocalAssembler>(project_to_psd, quadrature_psd_projection_);
 
+		igl::Timer timerg;
+		timerg.start();
+		energy = assemble_all_colored(local_assembler_, cache_, is_volume, project_to_psd && !project_points, project_points, bases, gbases, pattern, displacement, grad, PatternValues(pattern, hessian.valuePtr()));
 		timerg.stop();
-		logger().trace("done merge assembly {}s...", timerg.getElapsedTime());
+		logger().trace("done energy, gradient, and hessian assembly {}s, {} colors", timerg.getElapsedTime(), pattern.n_colors());
 	}
 
 	template <class LocalAssembler>
@@ -680,6 +1361,10 @@ namespace polyfem
 		const std::vector<ElementBases> &gbases,
 		const Eigen::MatrixXd &displacement) const
 	{
+		if (!cache_.is_initialized(is_volume, bases, gbases))
+			cache_.init(is_volume, bases, gbases);
+		init_material_cache(local_assembler_, is_volume, bases, gbases, has_material_cache<LocalAssembler>());
+
 #ifdef POLYFEM_WITH_TBB
 		typedef tbb::enumerable_thread_specific<LocalThreadScalarStorage> LocalStorage;
 		LocalStorage storages((LocalThreadScalarStorage()));
@@ -698,15 +1383,17 @@ namespace polyfem
 #endif
 			// igl::Timer timer; timer.start();
 
-			ElementAssemblyValues &vals = loc_storage.vals;
-			vals.compute(e, is_volume, bases[e], gbases[e]);
-
-			const Quadrature &quadrature = vals.quadrature;
-
-			assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-			loc_storage.da = vals.det.array() * quadrature.weights.array();
+			const bool is_cached = cache_.is_cached(e);
+			if (!is_cached)
+			{
+				loc_storage.vals.compute(e, is_volume, bases[e], gbases[e]);
+				assert(MAX_QUAD_POINTS == -1 || loc_storage.vals.quadrature.weights.size() < MAX_QUAD_POINTS);
+				loc_storage.da = loc_storage.vals.det.array() * loc_storage.vals.quadrature.weights.array();
+			}
+			const ElementAssemblyValues &vals = is_cached ? cache_.vals(e) : loc_storage.vals;
+			const QuadratureVector &da = is_cached ? cache_.da(e) : loc_storage.da;
 
-			const double val = local_assembler_.compute_energy(vals, displacement, loc_storage.da);
+			const double val = local_assembler_.compute_energy(vals, displacement, da);
 			loc_storage.val += val;
 #ifdef POLYFEM_WITH_TBB
 		} });
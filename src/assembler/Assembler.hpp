@@ -2,9 +2,14 @@
 #define ASSEMBLER_HPP
 
 #include <polyfem/ElementAssemblyValues.hpp>
+#include <polyfem/SparsityPattern.hpp>
+#include <polyfem/BlockSparseMatrix.hpp>
+#include <polyfem/AssemblyValsCache.hpp>
+#include <polyfem/SumFactorization.hpp>
 
 #include <Eigen/Sparse>
 #include <vector>
+#include <map>
 #include <iostream>
 #include <cmath>
 #include <memory>
@@ -21,12 +26,37 @@ namespace polyfem
 	public:
 		//assembler stiffness matrix, is the mesh is volumetric, number of bases and bases (FE and geom)
 		//gbases and bases can be the same (ie isoparametric)
+		//if symmetric only the upper triangle is assembled
 		void assemble(
 			const bool is_volume,
 			const int n_basis,
 			const std::vector<ElementBases> &bases,
 			const std::vector<ElementBases> &gbases,
-			StiffnessMatrix &stiffness) const;
+			StiffnessMatrix &stiffness,
+			const bool symmetric = false) const;
+		//same as above with size x size blocks per pair of nodes
+		void assemble(
+			const bool is_volume,
+			const int n_basis,
+			const std::vector<ElementBases> &bases,
+			const std::vector<ElementBases> &gbases,
+			BlockSparseMatrix &stiffness) const;
+
+		//matrix-free product y = K x, element by element without assembling K
+		void apply(
+			const bool is_volume,
+			const int n_basis,
+			const std::vector<ElementBases> &bases,
+			const std::vector<ElementBases> &gbases,
+			const Eigen::VectorXd &x,
+			Eigen::VectorXd &y) const;
+		//diagonal of K, without assembling K
+		void assemble_diagonal(
+			const bool is_volume,
+			const int n_basis,
+			const std::vector<ElementBases> &bases,
+			const std::vector<ElementBases> &gbases,
+			Eigen::VectorXd &diag) const;
 
 		//references to local assemblers
 		inline LocalAssembler &local_assembler() { return local_assembler_; }
@@ -34,6 +64,9 @@ namespace polyfem
 
 	private:
 		LocalAssembler local_assembler_;
+		//1d kernels of the sum factorized product indexed by (bases order, quadrature order)
+		//they only depend on the orders, so they are built at the first product and kept
+		mutable std::map<std::pair<int, int>, HexSumFactorization> sum_factorizations_;
 	};
 
 	//mixed formulation assembler
@@ -81,6 +114,27 @@ namespace polyfem
 			const std::vector<ElementBases> &gbases,
 			const Eigen::MatrixXd &displacement,
 			StiffnessMatrix &grad) const;
+		//assemble hessian of energy into a matrix with a fixed pattern
+		//if hessian does not have the pattern it is created, otherwise only its values are zeroed and refilled
+		void assemble_hessian(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<ElementBases> &bases,
+			const std::vector<ElementBases> &gbases,
+			const SparsityPattern &pattern,
+			const Eigen::MatrixXd &displacement,
+			StiffnessMatrix &hessian) const;
+		//same as above with size x size blocks per pair of nodes
+		void assemble_hessian(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<ElementBases> &bases,
+			const std::vector<ElementBases> &gbases,
+			const SparsityPattern &pattern,
+			const Eigen::MatrixXd &displacement,
+			BlockSparseMatrix &hessian) const;
 
 		//assemble energy
 		double assemble(
@@ -89,14 +143,60 @@ namespace polyfem
 			const std::vector<ElementBases> &gbases,
 			const Eigen::MatrixXd &displacement) const;
 
+		//energy and gradient in a single pass over the elements
+		//local assemblers with assemble_energy_grad get both from the same evaluation
+		void assemble_energy_grad(
+			const bool is_volume,
+			const int n_basis,
+			const std::vector<ElementBases> &bases,
+			const std::vector<ElementBases> &gbases,
+			const Eigen::MatrixXd &displacement,
+			double &energy,
+			Eigen::MatrixXd &grad) const;
+
+		//energy, gradient, and hessian (on the fixed pattern) in a single pass over the elements
+		//local assemblers with assemble_all get the three from the same evaluation
+		void assemble_all(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<ElementBases> &bases,
+			const std::vector<ElementBases> &gbases,
+			const SparsityPattern &pattern,
+			const Eigen::MatrixXd &displacement,
+			double &energy,
+			Eigen::MatrixXd &grad,
+			StiffnessMatrix &hessian) const;
+
 		inline LocalAssembler &local_assembler() { return local_assembler_; }
 		inline const LocalAssembler &local_assembler() const { return local_assembler_; }
 
-		//unused
-		void clear_cache() {}
+		//per element assembly values are cached up to max_memory_mb, clear_cache invalidates them
+		//the cache and the pattern are rebuilt when the bases address or sizes change, clear_cache is needed if the same bases are refilled with the same sizes
+		inline void set_cache_max_memory(const double max_memory_mb) { cache_.set_max_memory(max_memory_mb); }
+		inline void clear_cache()
+		{
+			cache_.clear();
+			pattern_.clear();
+			pattern_bases_ = nullptr;
+			pattern_n_elements_ = 0;
+			pattern_n_local_bases_ = 0;
+		}
+
+		//with project_to_psd, project dP/dF at every quadrature point instead of the element hessian
+		//only used if the local assembler supports it, ie has assemble_hessian(vals, displacement, da, project_to_psd)
+		inline void set_quadrature_psd_projection(const bool val) { quadrature_psd_projection_ = val; }
 
 	private:
 		LocalAssembler local_assembler_;
+		bool quadrature_psd_projection_ = false;
+		//filled lazily by the assembly functions
+		mutable AssemblyValsCache cache_;
+		//pattern used by the hessian assembly without an explicit pattern
+		mutable SparsityPattern pattern_;
+		mutable const std::vector<ElementBases> *pattern_bases_ = nullptr;
+		mutable int pattern_n_elements_ = 0;
+		mutable long pattern_n_local_bases_ = 0;
 	};
 } // namespace polyfem
 
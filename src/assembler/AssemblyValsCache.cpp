@@ -0,0 +1,118 @@
+#include <polyfem/AssemblyValsCache.hpp>
+
+#include <polyfem/Logger.hpp>
+
+#ifdef POLYFEM_WITH_TBB
+#include <tbb/parallel_for.h>
+#endif
+
+namespace polyfem
+{
+	void AssemblyValsCache::set_max_memory(const double max_memory_mb)
+	{
+		max_memory_mb_ = max_memory_mb;
+		clear();
+	}
+
+	void AssemblyValsCache::init(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases)
+	{
+		clear();
+
+		is_volume_ = is_volume;
+		bases_ = &bases;
+		gbases_ = &gbases;
+		n_elements_ = int(bases.size());
+		n_local_bases_ = n_local_bases(bases);
+		n_local_gbases_ = n_local_bases(gbases);
+		initialized_ = true;
+
+		const int n_elements = int(bases.size());
+		if (max_memory_mb_ <= 0 || n_elements <= 0)
+			return;
+
+		//estimate the size of an element from the first one
+		Entry first;
+		first.vals.compute(0, is_volume, bases[0], gbases[0]);
+		first.da = first.vals.det.array() * first.vals.quadrature.weights.array();
+		const size_t element_memory = memory_usage(first.vals) + first.da.size() * sizeof(double) + sizeof(Entry);
+
+		const double max_bytes = max_memory_mb_ * 1024. * 1024.;
+		const int n_cached = int(std::min(double(n_elements), std::floor(max_bytes / element_memory)));
+		if (n_cached <= 0)
+			return;
+
+		cache_.resize(n_cached);
+		cache_[0] = std::move(first);
+
+		const auto compute_element = [&](const int e) {
+			Entry &entry = cache_[e];
+			entry.vals.compute(e, is_volume, bases[e], gbases[e]);
+			entry.da = entry.vals.det.array() * entry.vals.quadrature.weights.array();
+		};
+
+#ifdef POLYFEM_WITH_TBB
+		tbb::parallel_for(tbb::blocked_range<int>(1, n_cached), [&](const tbb::blocked_range<int> &r) {
+			for (int e = r.begin(); e != r.end(); ++e)
+				compute_element(e);
+		});
+#else
+		for (int e = 1; e < n_cached; ++e)
+			compute_element(e);
+#endif
+
+		logger().debug("assembly values cache: {}/{} elements, ~{}MB", n_cached, n_elements, n_cached * element_memory / (1024. * 1024.));
+	}
+
+	void AssemblyValsCache::clear()
+	{
+		cache_.clear();
+		cache_.shrink_to_fit();
+
+		bases_ = nullptr;
+		gbases_ = nullptr;
+		n_elements_ = 0;
+		n_local_bases_ = 0;
+		n_local_gbases_ = 0;
+		initialized_ = false;
+	}
+
+	bool AssemblyValsCache::is_initialized(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases) const
+	{
+		if (!initialized_ || is_volume != is_volume_ || &bases != bases_ || &gbases != gbases_)
+			return false;
+
+		//the sizes are compared too, the same vectors may have been refilled with other bases
+		if (int(bases.size()) != n_elements_ || n_local_bases(bases) != n_local_bases_ || n_local_bases(gbases) != n_local_gbases_)
+			return false;
+
+		return true;
+	}
+
+	long AssemblyValsCache::n_local_bases(const std::vector<ElementBases> &bases)
+	{
+		long n = 0;
+		for (const auto &b : bases)
+			n += b.bases.size();
+		return n;
+	}
+
+	size_t AssemblyValsCache::memory_usage(const ElementAssemblyValues &vals)
+	{
+		size_t n_doubles = 0;
+		size_t bytes = 0;
+
+		for (const auto &v : vals.basis_values)
+		{
+			n_doubles += v.val.size() + v.grad.size() + v.grad_t_m.size();
+			bytes += v.global.size() * sizeof(Local2Global) + sizeof(AssemblyValues);
+		}
+
+		for (const auto &j : vals.jac_it)
+			n_doubles += j.size();
+
+		n_doubles += vals.quadrature.points.size() + vals.quadrature.weights.size();
+		n_doubles += vals.val.size() + vals.det.size();
+
+		return bytes + n_doubles * sizeof(double) + sizeof(ElementAssemblyValues);
+	}
+} // namespace polyfem
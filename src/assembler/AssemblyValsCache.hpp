@@ -0,0 +1,56 @@
+#pragma once
+
+#include <polyfem/ElementAssemblyValues.hpp>
+#include <polyfem/Types.hpp>
+
+#include <vector>
+
+namespace polyfem
+{
+	//cache of the per element assembly values (quadrature, bases, jacobians) and da = det * weights
+	//these only depend on the geometry and are reused by all the non-linear assembly calls
+	class AssemblyValsCache
+	{
+	public:
+		//maximum memory used by the cache in MB, 0 disables it
+		void set_max_memory(const double max_memory_mb);
+		inline double max_memory() const { return max_memory_mb_; }
+
+		//computes the values of the first elements until the memory budget is reached
+		void init(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases);
+		void clear();
+
+		//true if the cache has been built for these bases, they are identified by their address and their number of elements and local bases
+		//bases refilled in place with the same sizes are not detected, clear must be called when they change
+		bool is_initialized(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases) const;
+
+		//total number of local bases of all the elements
+		static long n_local_bases(const std::vector<ElementBases> &bases);
+
+		inline bool is_cached(const int e) const { return e < int(cache_.size()); }
+		inline const ElementAssemblyValues &vals(const int e) const { return cache_[e].vals; }
+		inline const QuadratureVector &da(const int e) const { return cache_[e].da; }
+
+		//approximate memory used by the values of one element, in bytes
+		static size_t memory_usage(const ElementAssemblyValues &vals);
+
+	private:
+		struct Entry
+		{
+			ElementAssemblyValues vals;
+			QuadratureVector da;
+		};
+
+		double max_memory_mb_ = 0;
+		std::vector<Entry> cache_;
+
+		//bases used to build the cache
+		bool is_volume_ = false;
+		const std::vector<ElementBases> *bases_ = nullptr;
+		const std::vector<ElementBases> *gbases_ = nullptr;
+		int n_elements_ = 0;
+		long n_local_bases_ = 0;
+		long n_local_gbases_ = 0;
+		bool initialized_ = false;
+	};
+} // namespace polyfem
@@ -0,0 +1,169 @@
+#include <polyfem/BlockSparseMatrix.hpp>
+
+#include <algorithm>
+
+#ifdef POLYFEM_WITH_TBB
+#include <tbb/parallel_for.h>
+#endif
+
+namespace polyfem
+{
+	namespace
+	{
+		//y_i = sum_j A_ij x_j for the block rows in [begin, end), the block size is known at compile time for 1, 2, and 3
+		template <int S>
+		void multiply_rows(const int size, const int begin, const int end, const std::vector<long> &row_offsets, const std::vector<int> &col_indices, const std::vector<double> &values, const Eigen::VectorXd &x, Eigen::VectorXd &y)
+		{
+			typedef Eigen::Matrix<double, S, S> Block;
+			typedef Eigen::Matrix<double, S, 1> Vec;
+
+			Vec res;
+			for (int i = begin; i < end; ++i)
+			{
+				res.setZero(size);
+				for (long k = row_offsets[i]; k < row_offsets[i + 1]; ++k)
+				{
+					const Eigen::Map<const Block> block(values.data() + k * size * size, size, size);
+					res.noalias() += block * x.segment(col_indices[k] * size, size);
+				}
+				y.segment(i * size, size) = res;
+			}
+		}
+	} // namespace
+
+	void BlockSparseMatrix::init(const SparsityPattern &pattern)
+	{
+		assert(!pattern.is_symmetric());
+
+		n_basis_ = pattern.n_basis();
+		size_ = pattern.size();
+
+		row_offsets_ = pattern.offsets();
+		col_indices_ = pattern.adjacency();
+
+		values_.assign(col_indices_.size() * size_ * size_, 0.0);
+	}
+
+	void BlockSparseMatrix::clear()
+	{
+		n_basis_ = 0;
+		size_ = 0;
+		row_offsets_.clear();
+		col_indices_.clear();
+		values_.clear();
+	}
+
+	bool BlockSparseMatrix::matches(const SparsityPattern &pattern) const
+	{
+		return !empty() && !pattern.is_symmetric() && pattern.n_basis() == n_basis_ && pattern.size() == size_ && pattern.offsets() == row_offsets_ && pattern.adjacency() == col_indices_;
+	}
+
+	void BlockSparseMatrix::set_zero()
+	{
+		std::fill(values_.begin(), values_.end(), 0.0);
+	}
+
+	long BlockSparseMatrix::find(const int node_i, const int node_j) const
+	{
+		const auto begin = col_indices_.begin() + row_offsets_[node_i];
+		const auto end = col_indices_.begin() + row_offsets_[node_i + 1];
+		const auto it = std::lower_bound(begin, end, node_j);
+
+		if (it == end || *it != node_j)
+			return -1;
+
+		return long(it - col_indices_.begin());
+	}
+
+	void BlockSparseMatrix::multiply(const Eigen::VectorXd &x, Eigen::VectorXd &y) const
+	{
+		assert(x.size() == cols());
+		y.resize(rows());
+
+		const auto multiply_range = [&](const int begin, const int end) {
+			if (size_ == 1)
+				multiply_rows<1>(size_, begin, end, row_offsets_, col_indices_, values_, x, y);
+			else if (size_ == 2)
+				multiply_rows<2>(size_, begin, end, row_offsets_, col_indices_, values_, x, y);
+			else if (size_ == 3)
+				multiply_rows<3>(size_, begin, end, row_offsets_, col_indices_, values_, x, y);
+			else
+				multiply_rows<Eigen::Dynamic>(size_, begin, end, row_offsets_, col_indices_, values_, x, y);
+		};
+
+#ifdef POLYFEM_WITH_TBB
+		tbb::parallel_for(tbb::blocked_range<int>(0, n_basis_), [&](const tbb::blocked_range<int> &r) {
+			multiply_range(r.begin(), r.end());
+		});
+#else
+		multiply_range(0, n_basis_);
+#endif
+	}
+
+	Eigen::VectorXd BlockSparseMatrix::diagonal() const
+	{
+		Eigen::VectorXd diag = Eigen::VectorXd::Zero(rows());
+
+		for (int i = 0; i < n_basis_; ++i)
+		{
+			const long k = find(i, i);
+			if (k < 0)
+				continue;
+
+			const double *b = block(k);
+			for (int m = 0; m < size_; ++m)
+				diag(i * size_ + m) = b[m * size_ + m];
+		}
+
+		return diag;
+	}
+
+	void BlockSparseMatrix::to_sparse(StiffnessMatrix &mat) const
+	{
+		typedef StiffnessMatrix::StorageIndex StorageIndex;
+
+		//the structure is symmetric, column node_j*size+n has the rows of the blocks in row node_j
+		const int n = rows();
+		mat.resize(n, n);
+		mat.resizeNonZeros(non_zeros());
+
+		StorageIndex *outer = mat.outerIndexPtr();
+		StorageIndex *inner = mat.innerIndexPtr();
+		double *values = mat.valuePtr();
+
+		const auto fill_columns = [&](const int node_j) {
+			const long offset = row_offsets_[node_j];
+			const long degree = row_offsets_[node_j + 1] - offset;
+
+			for (int c = 0; c < size_; ++c)
+			{
+				long index = size_ * (size_ * offset + c * degree);
+				outer[node_j * size_ + c] = StorageIndex(index);
+
+				for (long k = offset; k < offset + degree; ++k)
+				{
+					const int node_i = col_indices_[k];
+					const double *b = block(find(node_i, node_j));
+
+					for (int m = 0; m < size_; ++m)
+					{
+						inner[index] = StorageIndex(node_i * size_ + m);
+						values[index] = b[c * size_ + m];
+						++index;
+					}
+				}
+			}
+		};
+
+#ifdef POLYFEM_WITH_TBB
+		tbb::parallel_for(tbb::blocked_range<int>(0, n_basis_), [&](const tbb::blocked_range<int> &r) {
+			for (int node_j = r.begin(); node_j != r.end(); ++node_j)
+				fill_columns(node_j);
+		});
+#else
+		for (int node_j = 0; node_j < n_basis_; ++node_j)
+			fill_columns(node_j);
+#endif
+		outer[n] = StorageIndex(non_zeros());
+	}
+} // namespace polyfem
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <polyfem/SparsityPattern.hpp>
+#include <polyfem/Types.hpp>
+
+#include <Eigen/Dense>
+#include <vector>
+
+namespace polyfem
+{
+	//block compressed sparse row matrix, every coupling of two nodes is a dense size x size block
+	//the structure comes from a sparsity pattern, it stores one column index per block instead of one per entry
+	class BlockSparseMatrix
+	{
+	public:
+		//creates the blocks of the pattern, with zero values
+		void init(const SparsityPattern &pattern);
+		void clear();
+
+		inline bool empty() const { return row_offsets_.empty(); }
+		inline int block_size() const { return size_; }
+		inline int n_block_rows() const { return n_basis_; }
+		inline long n_blocks() const { return long(col_indices_.size()); }
+		inline int rows() const { return n_basis_ * size_; }
+		inline int cols() const { return rows(); }
+		inline long non_zeros() const { return long(values_.size()); }
+
+		//true if the blocks are the one of the pattern
+		bool matches(const SparsityPattern &pattern) const;
+		void set_zero();
+
+		//index of the block (node_i, node_j), -1 if they are not coupled
+		long find(const int node_i, const int node_j) const;
+
+		//values of block k, size x size column major
+		inline double *block(const long k) { return values_.data() + k * size_ * size_; }
+		inline const double *block(const long k) const { return values_.data() + k * size_ * size_; }
+		inline std::vector<double> &values() { return values_; }
+		inline const std::vector<double> &values() const { return values_; }
+
+		//y = A x
+		void multiply(const Eigen::VectorXd &x, Eigen::VectorXd &y) const;
+		Eigen::VectorXd diagonal() const;
+
+		//scalar compressed matrix with the same entries, for the direct solvers
+		void to_sparse(StiffnessMatrix &mat) const;
+
+	private:
+		int n_basis_ = 0;
+		int size_ = 0;
+
+		//blocks of row i are in [row_offsets_[i], row_offsets_[i+1]), sorted by column
+		std::vector<long> row_offsets_;
+		std::vector<int> col_indices_;
+		std::vector<double> values_;
+	};
+} // namespace polyfem
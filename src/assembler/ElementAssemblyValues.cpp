@@ -195,8 +195,45 @@ namespace polyfem
 
 	void ElementAssemblyValues::compute(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis)
 	{
-		basis.compute_quadrature(quadrature);
-		compute(el_index, is_volume, quadrature.points, basis, gbasis);
+		const Quadrature *shared = basis.shared_quadrature();
+		if (!shared)
+			basis.compute_quadrature(quadrature);
+		else if (shared != quadrature_source_)
+			quadrature = *shared;
+		quadrature_source_ = shared;
+
+		element_id = el_index;
+
+		evaluate_at_quadrature(basis, basis_values, tabulation_);
+		if (&basis != &gbasis)
+			evaluate_at_quadrature(gbasis, g_basis_values_cache_, g_tabulation_);
+
+		compute_mapping(is_volume, quadrature.points, basis, gbasis);
+	}
+
+	void ElementAssemblyValues::evaluate_at_quadrature(const ElementBases &b, std::vector<AssemblyValues> &values, const BasisTabulation *&tabulation) const
+	{
+		if (b.reference_type == BasisTabulation::Type::None || !quadrature_source_)
+		{
+			tabulation = nullptr;
+			b.evaluate_bases(quadrature.points, values);
+			b.evaluate_grads(quadrature.points, values);
+			return;
+		}
+
+		//the values are already there if the previous element had the same type, order, and rule
+		if (tabulation && tabulation->type == b.reference_type && tabulation->order == b.reference_order && tabulation->quadrature == quadrature_source_ && values.size() == tabulation->val.size())
+			return;
+
+		tabulation = &BasisTabulation::get(b.reference_type, b.reference_order, *quadrature_source_, b);
+		assert(tabulation->val.size() == b.bases.size());
+
+		values.resize(tabulation->val.size());
+		for (size_t j = 0; j < values.size(); ++j)
+		{
+			values[j].val = tabulation->val[j];
+			values[j].grad = tabulation->grad[j];
+		}
 	}
 
 	void ElementAssemblyValues::compute(const int el_index, const bool is_volume, const Eigen::MatrixXd &pts, const ElementBases &basis, const ElementBases &gbasis)
@@ -251,18 +288,25 @@ namespace polyfem
 		// if (poly) { std::cout << "-- eval quadr points: " << t << std::endl; }
 
 
-		const int n_local_bases = int(basis.bases.size());
-		const int n_local_g_bases = int(gbasis.bases.size());
-
 		basis.evaluate_bases(pts, basis_values);
 		basis.evaluate_grads(pts, basis_values);
+		tabulation_ = nullptr;
 
 		if (&basis != &gbasis)
 		{
 			gbasis.evaluate_bases(pts, g_basis_values_cache_);
 			gbasis.evaluate_grads(pts, g_basis_values_cache_);
+			g_tabulation_ = nullptr;
 		}
 
+		compute_mapping(is_volume, pts, basis, gbasis);
+	}
+
+	void ElementAssemblyValues::compute_mapping(const bool is_volume, const Eigen::MatrixXd &pts, const ElementBases &basis, const ElementBases &gbasis)
+	{
+		const int n_local_bases = int(basis.bases.size());
+		const int n_local_g_bases = int(gbasis.bases.size());
+
 		for(int j = 0; j < n_local_bases; ++j)
 		{
 			AssemblyValues &ass_val = basis_values[j];
@@ -360,8 +404,10 @@ namespace polyfem
 			return true;
 
 
-		Quadrature quad;
-		gbasis.compute_quadrature(quad);
+		Quadrature tmp_quad;
+		if (!gbasis.shared_quadrature())
+			gbasis.compute_quadrature(tmp_quad);
+		const Quadrature &quad = gbasis.shared_quadrature() ? *gbasis.shared_quadrature() : tmp_quad;
 
 		std::vector<AssemblyValues> tmp;
 
@@ -37,6 +37,16 @@ namespace polyfem
 
 	private:
 		std::vector<AssemblyValues> g_basis_values_cache_;
+		//shared rule currently copied in quadrature, the copy is skipped when the next element uses the same one
+		const Quadrature *quadrature_source_ = nullptr;
+		//tabulations currently copied in basis_values and g_basis_values_cache_, nullptr if they were evaluated
+		const BasisTabulation *tabulation_ = nullptr;
+		const BasisTabulation *g_tabulation_ = nullptr;
+
+		//values and gradients of b at the quadrature points, copied from the shared tabulation when b has one
+		void evaluate_at_quadrature(const ElementBases &b, std::vector<AssemblyValues> &values, const BasisTabulation *&tabulation) const;
+		//global ids, geometric mapping, and jacobians once the values and gradients of the bases at pts are set
+		void compute_mapping(const bool is_volume, const Eigen::MatrixXd &pts, const ElementBases &basis, const ElementBases &gbasis);
 
 		void finalize_global_element(const Eigen::MatrixXd &v);
 
@@ -16,6 +16,53 @@ namespace polyfem
 		return Eigen::Matrix<double, 1, 1>::Constant(res);
 	}
 
+	Eigen::MatrixXd Laplacian::assemble_element(const ElementAssemblyValues &vals, const QuadratureVector &da) const
+	{
+		//number of local bases
+		switch (vals.basis_values.size())
+		{
+		case 3: //P1 2d
+			return assemble_element_aux<3>(vals, da);
+		case 4: //Q1 2d, P1 3d
+			return assemble_element_aux<4>(vals, da);
+		case 6: //P2 2d
+			return assemble_element_aux<6>(vals, da);
+		case 8: //Q1 3d
+			return assemble_element_aux<8>(vals, da);
+		case 9: //Q2 2d
+			return assemble_element_aux<9>(vals, da);
+		case 10: //P3 2d, P2 3d
+			return assemble_element_aux<10>(vals, da);
+		case 27: //Q2 3d
+			return assemble_element_aux<27>(vals, da);
+		default:
+			return assemble_element_aux<Eigen::Dynamic>(vals, da);
+		}
+	}
+
+	template <int N>
+	Eigen::MatrixXd Laplacian::assemble_element_aux(const ElementAssemblyValues &vals, const QuadratureVector &da) const
+	{
+		const int n_bases = int(vals.basis_values.size());
+		const int dim = int(vals.basis_values.front().grad_t_m.cols());
+
+		Eigen::Matrix<double, N, N> res(n_bases, n_bases);
+		res.setZero();
+
+		//gradients of all bases at one quadrature point
+		Eigen::Matrix<double, Eigen::Dynamic, N, 0, 3, N> G(dim, n_bases);
+
+		for (long k = 0; k < da.size(); ++k)
+		{
+			for (int i = 0; i < n_bases; ++i)
+				G.col(i) = vals.basis_values[i].grad_t_m.row(k).transpose();
+
+			res.noalias() += da(k) * (G.transpose() * G);
+		}
+
+		return res;
+	}
+
 	Eigen::Matrix<double, 1, 1> Laplacian::compute_rhs(const AutodiffHessianPt &pt) const
 	{
 		Eigen::Matrix<double, 1, 1> result;
@@ -17,6 +17,10 @@ namespace polyfem
 		//vals stores the evaluation for that element
 		//da contains both the quadrature weight and the change of metric in the integral
 		Eigen::Matrix<double, 1, 1> assemble(const ElementAssemblyValues &vals, const int i, const int j, const QuadratureVector &da) const;
+		//computes the whole element stiffness matrix (n_bases x n_bases)
+		Eigen::MatrixXd assemble_element(const ElementAssemblyValues &vals, const QuadratureVector &da) const;
+		//flux for the sum factorized matrix-free product, grad_u is the gradient (1 x dim) of u
+		Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> compute_flux(const int el_id, const int p, const RowVectorNd &pt, const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &grad_u) const { return grad_u; }
 
 		//uses autodiff to compute the rhs for a fabbricated solution
 		//in this case it just return pt.getHessian().trace()
@@ -32,6 +36,11 @@ namespace polyfem
 		//laplacian has no parameters.
 		//in case these are passes trough params
 		void set_parameters(const json &params) {}
+
+	private:
+		//aux function for assemble_element with fixed size N = n_bases
+		template <int N>
+		Eigen::MatrixXd assemble_element_aux(const ElementAssemblyValues &vals, const QuadratureVector &da) const;
 	};
 } // namespace polyfem
 
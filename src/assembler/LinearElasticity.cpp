@@ -51,13 +51,14 @@ namespace polyfem
 			//            res_k.setZero();
 			const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> outer = gradi.row(k).transpose() * gradj.row(k);
 			const double dot = gradi.row(k).dot(gradj.row(k));
+
+			double lambda, mu;
+			params_.lambda_mu(vals, k, lambda, mu);
+
 			for (int ii = 0; ii < size(); ++ii)
 			{
 				for (int jj = 0; jj < size(); ++jj)
 				{
-					double lambda, mu;
-					params_.lambda_mu(vals.val(k, 0), vals.val(k, 1), size_ == 2 ? 0. : vals.val(k, 2), vals.element_id, lambda, mu);
-
 					res_k(jj * size() + ii) = outer(ii * size() + jj) * mu + outer(jj * size() + ii) * lambda;
 					if (ii == jj)
 						res_k(jj * size() + ii) += mu * dot;
@@ -69,6 +70,106 @@ namespace polyfem
 		return res;
 	}
 
+	Eigen::MatrixXd LinearElasticity::assemble_element(const ElementAssemblyValues &vals, const QuadratureVector &da) const
+	{
+		const int n = int(vals.basis_values.size()) * size();
+
+		//number of local dofs: bases times dimension
+		switch (n)
+		{
+		case 6: //P1 2d
+			return assemble_element_aux<6>(vals, da);
+		case 8: //Q1 2d
+			return assemble_element_aux<8>(vals, da);
+		case 12: //P2 2d, P1 3d
+			return assemble_element_aux<12>(vals, da);
+		case 18: //Q2 2d
+			return assemble_element_aux<18>(vals, da);
+		case 24: //Q1 3d
+			return assemble_element_aux<24>(vals, da);
+		case 30: //P2 3d
+			return assemble_element_aux<30>(vals, da);
+		case 81: //Q2 3d
+			return assemble_element_aux<81>(vals, da);
+		default:
+			return assemble_element_aux<Eigen::Dynamic>(vals, da);
+		}
+	}
+
+	template <int N>
+	Eigen::MatrixXd LinearElasticity::assemble_element_aux(const ElementAssemblyValues &vals, const QuadratureVector &da) const
+	{
+		//strains in voigt notation with engineering shear: xx, yy, xy in 2d and xx, yy, zz, yz, xz, xy in 3d
+		typedef Eigen::Matrix<double, Eigen::Dynamic, N, 0, 6, N> BMat;
+		typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 6, 6> DMat;
+
+		const int n_bases = int(vals.basis_values.size());
+		const int n = n_bases * size();
+		const int n_voigt = size() == 2 ? 3 : 6;
+
+		Eigen::Matrix<double, N, N> res(n, n);
+		res.setZero();
+
+		BMat B(n_voigt, n);
+		B.setZero();
+		DMat D(n_voigt, n_voigt);
+		BMat DB(n_voigt, n);
+
+		for (long k = 0; k < da.size(); ++k)
+		{
+			//material is evaluated once per quadrature point
+			double lambda, mu;
+			params_.lambda_mu(vals, k, lambda, mu);
+
+			D.setZero();
+			D.topLeftCorner(size(), size()).setConstant(lambda);
+			D.topLeftCorner(size(), size()).diagonal().array() += 2 * mu;
+			D.bottomRightCorner(n_voigt - size(), n_voigt - size()).diagonal().setConstant(mu);
+
+			for (int i = 0; i < n_bases; ++i)
+			{
+				const auto grad = vals.basis_values[i].grad_t_m.row(k);
+				const int c = i * size();
+
+				if (size() == 2)
+				{
+					B(0, c) = grad(0);
+					B(1, c + 1) = grad(1);
+					B(2, c) = grad(1);
+					B(2, c + 1) = grad(0);
+				}
+				else
+				{
+					B(0, c) = grad(0);
+					B(1, c + 1) = grad(1);
+					B(2, c + 2) = grad(2);
+					B(3, c + 1) = grad(2);
+					B(3, c + 2) = grad(1);
+					B(4, c) = grad(2);
+					B(4, c + 2) = grad(0);
+					B(5, c) = grad(1);
+					B(5, c + 1) = grad(0);
+				}
+			}
+
+			DB.noalias() = (D * da(k)) * B;
+			res.noalias() += B.transpose() * DB;
+		}
+
+		return res;
+	}
+
+	Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> LinearElasticity::compute_flux(const int el_id, const int p, const RowVectorNd &pt, const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &grad_u) const
+	{
+		double lambda, mu;
+		params_.lambda_mu(el_id, p, pt, lambda, mu);
+
+		Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> stress = mu * (grad_u + grad_u.transpose());
+		stress.diagonal().array() += lambda * grad_u.trace();
+
+		return stress;
+	}
+
 	double LinearElasticity::compute_energy(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const
 	{
 		return compute_energy_aux<double>(vals, displacement, da);
@@ -94,8 +195,8 @@ namespace polyfem
 
 	Eigen::MatrixXd LinearElasticity::assemble_hessian(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const
 	{
-		assert(false);
-		return Eigen::MatrixXd(0, 0);
+		//the energy is quadratic, its hessian is the stiffness matrix
+		return assemble_element(vals, da);
 	}
 
 	//Compute \int mu eps : eps + lambda/2 tr(eps)^2 = \int mu tr(eps^2) + lambda/2 tr(eps)^2
@@ -164,7 +265,7 @@ namespace polyfem
 			const AutoDiffGradMat strain = (def_grad + def_grad.transpose()) / T(2);
 
 			double lambda, mu;
-			params_.lambda_mu(vals.val(p, 0), vals.val(p, 1), size_ == 2 ? 0. : vals.val(p, 2), vals.element_id, lambda, mu);
+			params_.lambda_mu(vals, p, lambda, mu);
 
 			const T val = mu * (strain.transpose() * strain).trace() + lambda / 2 * strain.trace() * strain.trace();
 
@@ -247,7 +348,7 @@ namespace polyfem
 			compute_diplacement_grad(size(), bs, vals, local_pts, p, displacement, displacement_grad);
 
 			double lambda, mu;
-			params_.lambda_mu(vals.val(p, 0), vals.val(p, 1), size_ == 2 ? 0. : vals.val(p, 2), vals.element_id, lambda, mu);
+			params_.lambda_mu(vals, p, lambda, mu);
 
 			const Eigen::MatrixXd strain = (displacement_grad + displacement_grad.transpose()) / 2;
 			const Eigen::MatrixXd stress = 2 * mu * strain + lambda * strain.trace() * Eigen::MatrixXd::Identity(size(), size());
@@ -22,6 +22,11 @@ namespace polyfem
 		//da contains both the quadrature weight and the change of metric in the integral
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1>
 		assemble(const ElementAssemblyValues &vals, const int i, const int j, const QuadratureVector &da) const;
+		//computes the whole element stiffness matrix B^T D B, R^{n_bases*dim x n_bases*dim}
+		//entry (i*dim+m, j*dim+n) is the coupling of component m of basis i with component n of basis j
+		Eigen::MatrixXd assemble_element(const ElementAssemblyValues &vals, const QuadratureVector &da) const;
+		//stress for the sum factorized matrix-free product, grad_u is the gradient (dim x dim) of u at the quadrature point p (at pt) of element el_id
+		Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> compute_flux(const int el_id, const int p, const RowVectorNd &pt, const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &grad_u) const;
 
 		//neccessary for mixing linear model with non-linear collision response
 		Eigen::MatrixXd assemble_hessian(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const;
@@ -55,6 +60,8 @@ namespace polyfem
 
 		//class that stores and compute lame parameters per point
 		const LameParameters &lame_params() const { return params_; }
+		//evaluates the lame parameters once at the quadrature points of all elements, called before the assembly loops
+		void init_material_cache(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases) const { params_.init_cache(is_volume, bases, gbases); }
 
 	private:
 		int size_ = 2;
@@ -68,5 +75,9 @@ namespace polyfem
 		//assemble_grad is the same with T=DScalar1 and return .getGradient()
 		template <typename T>
 		T compute_energy_aux(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const;
+
+		//aux function for assemble_element with fixed size N = n_bases*dim
+		template <int N>
+		Eigen::MatrixXd assemble_element_aux(const ElementAssemblyValues &vals, const QuadratureVector &da) const;
 	};
 } // namespace polyfem
@@ -18,6 +18,8 @@ namespace polyfem
 			std::vector<Eigen::Triplet<double>> entries;
 			StiffnessMatrix tmp_mat;
 			StiffnessMatrix mass_mat;
+			ElementAssemblyValues vals;
+			QuadratureVector da, rho_da;
 
 			LocalThreadMatStorage(const int buffer_size, const int mat_size)
 			{
@@ -26,6 +28,21 @@ namespace polyfem
 				mass_mat.resize(mat_size, mat_size);
 			}
 		};
+
+		class LocalThreadVecStorage
+		{
+		public:
+			Eigen::VectorXd vec;
+			ElementAssemblyValues vals;
+			QuadratureVector da, rho_da;
+			Eigen::VectorXd diag;
+
+			LocalThreadVecStorage(const int size)
+			{
+				vec.resize(size);
+				vec.setZero();
+			}
+		};
 	} // namespace
 
 	void MassMatrixAssembler::assemble(
@@ -51,6 +68,7 @@ namespace polyfem
 #endif
 
 		const int n_bases = int(bases.size());
+		density.init_cache(is_volume, bases, gbases);
 
 #ifdef POLYFEM_WITH_TBB
 		tbb::parallel_for(tbb::blocked_range<int>(0, n_bases), [&](const tbb::blocked_range<int> &r) {
@@ -60,15 +78,22 @@ namespace polyfem
 		for (int e = 0; e < n_bases; ++e)
 		{
 #endif
-			ElementAssemblyValues vals;
+			//the element values and buffers are reused by all the elements of the thread
+			ElementAssemblyValues &vals = loc_storage.vals;
 			vals.compute(e, is_volume, bases[e], gbases[e]);
 
 			const Quadrature &quadrature = vals.quadrature;
 
 			assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-			const QuadratureVector da = vals.det.array() * quadrature.weights.array();
+			QuadratureVector &da = loc_storage.da;
+			da = vals.det.array() * quadrature.weights.array();
 			const int n_loc_bases = int(vals.basis_values.size());
 
+			QuadratureVector &rho_da = loc_storage.rho_da;
+			rho_da.resize(da.size());
+			for(int q = 0; q < da.size(); ++q)
+				rho_da(q) = density(vals, q) * da(q);
+
 			for(int i = 0; i < n_loc_bases; ++i)
 			{
 				const auto &global_i = vals.basis_values[i].global;
@@ -78,10 +103,8 @@ namespace polyfem
 					const auto &global_j = vals.basis_values[j].global;
 
 					double tmp = 0; //(vals.basis_values[i].val.array() * vals.basis_values[j].val.array() * da.array()).sum();
-					for(int q = 0; q < da.size(); ++q){
-						const double rho = density(vals.val(q, 0), vals.val(q, 1), vals.val.cols() == 2 ? 0. : vals.val(q, 2), vals.element_id);
-						tmp += rho * vals.basis_values[i].val(q) * vals.basis_values[j].val(q) * da(q);
-					}
+					for(int q = 0; q < da.size(); ++q)
+						tmp += vals.basis_values[i].val(q) * vals.basis_values[j].val(q) * rho_da(q);
 					if (std::abs(tmp) < 1e-30) { continue; }
 
 
@@ -150,4 +173,91 @@ namespace polyfem
 #endif
 		mass.makeCompressed();
 	}
-} // namespace polyfem
\ No newline at end of file
+
+	void MassMatrixAssembler::assemble_lumped(
+		const bool is_volume,
+		const int size,
+		const int n_basis,
+		const Density &density,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		Eigen::VectorXd &mass) const
+	{
+		mass.resize(n_basis * size);
+		mass.setZero();
+
+#ifdef POLYFEM_WITH_TBB
+		typedef tbb::enumerable_thread_specific<LocalThreadVecStorage> LocalStorage;
+		LocalStorage storages(LocalThreadVecStorage(mass.size()));
+#else
+		LocalThreadVecStorage loc_storage(mass.size());
+#endif
+
+		const int n_bases = int(bases.size());
+		density.init_cache(is_volume, bases, gbases);
+
+#ifdef POLYFEM_WITH_TBB
+		tbb::parallel_for(tbb::blocked_range<int>(0, n_bases), [&](const tbb::blocked_range<int> &r) {
+		LocalStorage::reference loc_storage = storages.local();
+		for (int e = r.begin(); e != r.end(); ++e) {
+#else
+		for (int e = 0; e < n_bases; ++e)
+		{
+#endif
+			//the element values and buffers are reused by all the elements of the thread
+			ElementAssemblyValues &vals = loc_storage.vals;
+			vals.compute(e, is_volume, bases[e], gbases[e]);
+
+			const Quadrature &quadrature = vals.quadrature;
+
+			assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+			QuadratureVector &da = loc_storage.da;
+			da = vals.det.array() * quadrature.weights.array();
+			const int n_loc_bases = int(vals.basis_values.size());
+
+			QuadratureVector &rho_da = loc_storage.rho_da;
+			rho_da.resize(da.size());
+			for(int q = 0; q < da.size(); ++q)
+				rho_da(q) = density(vals, q) * da(q);
+
+			//diagonal of the consistent mass
+			Eigen::VectorXd &diag = loc_storage.diag;
+			diag.resize(n_loc_bases);
+			for(int i = 0; i < n_loc_bases; ++i)
+			{
+				const auto &val = vals.basis_values[i].val;
+				double tmp = 0;
+				for(int q = 0; q < da.size(); ++q)
+					tmp += val(q) * val(q) * rho_da(q);
+				diag(i) = tmp;
+			}
+
+			const double diag_sum = diag.sum();
+			if (diag_sum <= 0)
+				continue;
+			diag *= rho_da.sum() / diag_sum;
+
+			for(int i = 0; i < n_loc_bases; ++i)
+			{
+				for(const auto &gi : vals.basis_values[i].global)
+				{
+					for(int m = 0; m < size; ++m)
+						loc_storage.vec(gi.index * size + m) += gi.val * diag(i);
+				}
+			}
+#ifdef POLYFEM_WITH_TBB
+		} });
+#else
+		}
+#endif
+
+#ifdef POLYFEM_WITH_TBB
+		for (LocalStorage::iterator i = storages.begin(); i != storages.end(); ++i)
+		{
+			mass += i->vec;
+		}
+#else
+		mass = loc_storage.vec;
+#endif
+	}
+} // namespace polyfem
@@ -28,5 +28,17 @@ namespace polyfem
 			const std::vector<ElementBases> &bases,
 			const std::vector<ElementBases> &gbases,
 			StiffnessMatrix &mass) const;
+
+		//assembles the diagonal lumped mass (one entry per dof), same arguments as assemble
+		//every element uses the HRZ scaling: the diagonal of the consistent mass scaled to preserve the element mass
+		//with a constant density it is equal to the row-sum only for linear simplices and affine (parallelogram, parallelepiped) quads and hexes, it stays positive for higher orders
+		void assemble_lumped(
+			const bool is_volume,
+			const int size,
+			const int n_basis,
+			const Density &density,
+			const std::vector<ElementBases> &bases,
+			const std::vector<ElementBases> &gbases,
+			Eigen::VectorXd &mass) const;
 	};
 } // namespace polyfem
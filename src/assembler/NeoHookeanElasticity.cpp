@@ -4,13 +4,13 @@
 
 #include <polyfem/Basis.hpp>
 #include <polyfem/auto_elasticity_rhs.hpp>
+#include <polyfem/auto_hyperelasticity.hpp>
 
 #include <polyfem/MatrixUtils.hpp>
 #include <igl/Timer.h>
 
 namespace polyfem
 {
-
 	NeoHookeanElasticity::NeoHookeanElasticity()
 	{
 		set_size(size_);
@@ -55,39 +55,138 @@ namespace polyfem
 	Eigen::VectorXd
 	NeoHookeanElasticity::assemble_grad(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const
 	{
-		const int n_bases = vals.basis_values.size();
-
-		return polyfem::gradient_from_energy(
-			size(), n_bases, vals, displacement, da,
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 6, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 8, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 12, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 18, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 24, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 30, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 60, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 81, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, BIG_N, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::VectorXd>>(vals, displacement, da); });
+		double energy;
+		Eigen::VectorXd grad;
+		Eigen::MatrixXd hessian;
+		compute_derivatives(vals, displacement, da, true, false, false, energy, grad, hessian);
+
+		return grad;
 	}
 
 	Eigen::MatrixXd
-	NeoHookeanElasticity::assemble_hessian(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const
+	NeoHookeanElasticity::assemble_hessian(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, const bool project_to_psd) const
+	{
+		double energy;
+		Eigen::VectorXd grad;
+		Eigen::MatrixXd hessian;
+		compute_derivatives(vals, displacement, da, false, true, project_to_psd, energy, grad, hessian);
+
+		return hessian;
+	}
+
+	void NeoHookeanElasticity::assemble_energy_grad(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, double &energy, Eigen::VectorXd &grad) const
 	{
-		const int n_bases = vals.basis_values.size();
-		return polyfem::hessian_from_energy(
-			size(), n_bases, vals, displacement, da,
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 6, 1>, Eigen::Matrix<double, 6, 6>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 8, 1>, Eigen::Matrix<double, 8, 8>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 12, 1>, Eigen::Matrix<double, 12, 12>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 18, 1>, Eigen::Matrix<double, 18, 18>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 24, 1>, Eigen::Matrix<double, 24, 24>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 30, 1>, Eigen::Matrix<double, 30, 30>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 60, 1>, Eigen::Matrix<double, 60, 60>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 81, 1>, Eigen::Matrix<double, 81, 81>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, SMALL_N, SMALL_N>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>>(vals, displacement, da); });
+		Eigen::MatrixXd hessian;
+		compute_derivatives(vals, displacement, da, true, false, false, energy, grad, hessian);
+	}
+
+	void NeoHookeanElasticity::assemble_all(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, const bool project_to_psd, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian) const
+	{
+		compute_derivatives(vals, displacement, da, true, true, project_to_psd, energy, grad, hessian);
+	}
+
+	void NeoHookeanElasticity::compute_derivatives(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, const bool with_grad, const bool with_hessian, const bool project_to_psd, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian) const
+	{
+		polyfem::derivatives_from_def_grad(
+			size(), vals, displacement, da, with_grad, with_hessian,
+			[&](const int p, const DefGradMatrix &def_grad, double &density, DefGradMatrix &stress, StressGradMatrix &stress_grad) {
+				double lambda, mu;
+				params_.lambda_mu(vals, p, lambda, mu);
+
+				if (size() == 2)
+				{
+					density = autogen::neo_hookean_2d_energy(def_grad, lambda, mu);
+					if (with_grad)
+						autogen::neo_hookean_2d_stress(def_grad, lambda, mu, stress);
+					if (with_hessian)
+						autogen::neo_hookean_2d_stress_grad(def_grad, lambda, mu, stress_grad);
+				}
+				else
+				{
+					density = autogen::neo_hookean_3d_energy(def_grad, lambda, mu);
+					if (with_grad)
+						autogen::neo_hookean_3d_stress(def_grad, lambda, mu, stress);
+					if (with_hessian)
+						autogen::neo_hookean_3d_stress_grad(def_grad, lambda, mu, stress_grad);
+				}
+
+				if (with_hessian && project_to_psd)
+					project_stress_grad_to_psd(def_grad, lambda, mu, stress_grad);
+			},
+			energy, grad, hessian);
+	}
+
+	//the hessian is mu Id + W_JJ g g^T + W_J d2J/dF2 with g = dJ/dF, W_J = (lambda ln J - mu)/J, and W_JJ = (mu + lambda (1 - ln J))/J^2
+	//with F = U S V^T (U, V rotations) its eigenvectors are U E V^T, E being the twists, the flips, and the diagonal scalings (analytic eigensystems of isotropic energies)
+	void NeoHookeanElasticity::project_stress_grad_to_psd(const DefGradMatrix &def_grad, const double lambda, const double mu, StressGradMatrix &stress_grad)
+	{
+		typedef Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> SizeVector;
+		const int size = int(def_grad.rows());
+
+		Eigen::JacobiSVD<DefGradMatrix> svd(def_grad, Eigen::ComputeFullU | Eigen::ComputeFullV);
+		DefGradMatrix U = svd.matrixU();
+		const DefGradMatrix V = svd.matrixV();
+		SizeVector s = svd.singularValues();
+		if (U.determinant() * V.determinant() < 0)
+		{
+			U.col(size - 1) *= -1;
+			s(size - 1) *= -1;
+		}
+
+		const double J = s.prod();
+		const double log_J = std::log(J);
+		const double W_J = (lambda * log_J - mu) / J;
+		const double W_JJ = (mu + lambda * (1 - log_J)) / (J * J);
+
+		DefGradMatrix mode(size, size);
+		const auto remove_mode = [&](const double eigenvalue, const DefGradMatrix &E) {
+			if (eigenvalue >= 0)
+				return;
+
+			mode = U * E * V.transpose();
+			const Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1>> m(mode.data(), size * size);
+			stress_grad.noalias() -= eigenvalue * m * m.transpose();
+		};
+
+		//twist and flip in the plane (i, j), d2J/dF2 has eigenvalue +-1 in 2D and +-s_k in 3D
+		DefGradMatrix E(size, size);
+		for (int k = 0; k < (size == 2 ? 1 : 3); ++k)
+		{
+			const int i = size == 2 ? 0 : (k + 1) % 3;
+			const int j = size == 2 ? 1 : (k + 2) % 3;
+			const double s_k = size == 2 ? 1 : s(k);
+
+			E.setZero();
+			E(i, j) = -1 / std::sqrt(2.);
+			E(j, i) = 1 / std::sqrt(2.);
+			remove_mode(mu + W_J * s_k, E);
+
+			E(i, j) = 1 / std::sqrt(2.);
+			remove_mode(mu - W_J * s_k, E);
+		}
+
+		//scalings, d2W/ds2 = mu Id + W_JJ g g^T + W_J d2J/ds2
+		SizeVector g(size);
+		for (int i = 0; i < size; ++i)
+			g(i) = size == 2 ? s(1 - i) : s((i + 1) % 3) * s((i + 2) % 3);
+
+		DefGradMatrix A = W_JJ * g * g.transpose();
+		for (int i = 0; i < size; ++i)
+		{
+			A(i, i) += mu;
+			for (int j = 0; j < size; ++j)
+			{
+				if (i != j)
+					A(i, j) += W_J * (size == 2 ? 1 : s(3 - i - j));
+			}
+		}
+
+		Eigen::SelfAdjointEigenSolver<DefGradMatrix> eigs(A);
+		for (int i = 0; i < size; ++i)
+		{
+			E = eigs.eigenvectors().col(i).asDiagonal();
+			remove_mode(eigs.eigenvalues()(i), E);
+		}
 	}
 
 	void NeoHookeanElasticity::compute_stress_tensor(const int el_id, const ElementBases &bs, const ElementBases &gbs, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &displacement, Eigen::MatrixXd &stresses) const
@@ -128,7 +227,7 @@ namespace polyfem
 			// const double J = def_grad.determinant();
 
 			double lambda, mu;
-			params_.lambda_mu(vals.val(p, 0), vals.val(p, 1), size_ == 2 ? 0. : vals.val(p, 2), vals.element_id, lambda, mu);
+			params_.lambda_mu(vals, p, lambda, mu);
 
 			//stress = mu (F - F^{-T}) + lambda ln J F^{-T}
 			//stress = mu * (def_grad - def_grad^{-T}) + lambda ln (det def_grad) def_grad^{-T}
@@ -143,84 +242,11 @@ namespace polyfem
 
 	double NeoHookeanElasticity::compute_energy(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const
 	{
-		return compute_energy_aux<double>(vals, displacement, da);
-	}
-
-	//Compute \int (mu/2 (trace(F^T F) - 3 - 2*ln(J)) + lambda/2 ln^2(J))
-	template <typename T>
-	T NeoHookeanElasticity::compute_energy_aux(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const
-	{
-		typedef Eigen::Matrix<T, Eigen::Dynamic, 1> AutoDiffVect;
-		typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> AutoDiffGradMat;
-
-		assert(displacement.cols() == 1);
-
-		const int n_pts = da.size();
-
-		Eigen::Matrix<double, Eigen::Dynamic, 1> local_dispv(vals.basis_values.size() * size(), 1);
-		local_dispv.setZero();
-		for (size_t i = 0; i < vals.basis_values.size(); ++i)
-		{
-			const auto &bs = vals.basis_values[i];
-			for (size_t ii = 0; ii < bs.global.size(); ++ii)
-			{
-				for (int d = 0; d < size(); ++d)
-				{
-					local_dispv(i * size() + d) += bs.global[ii].val * displacement(bs.global[ii].index * size() + d);
-				}
-			}
-		}
-
-		DiffScalarBase::setVariableCount(local_dispv.rows());
-		AutoDiffVect local_disp(local_dispv.rows(), 1);
-		T energy = T(0.0);
-
-		const AutoDiffAllocator<T> allocate_auto_diff_scalar;
+		double energy;
+		Eigen::VectorXd grad;
+		Eigen::MatrixXd hessian;
+		compute_derivatives(vals, displacement, da, false, false, false, energy, grad, hessian);
 
-		for (long i = 0; i < local_dispv.rows(); ++i)
-		{
-			local_disp(i) = allocate_auto_diff_scalar(i, local_dispv(i));
-		}
-
-		AutoDiffGradMat def_grad(size(), size());
-
-		for (long p = 0; p < n_pts; ++p)
-		{
-			for (long k = 0; k < def_grad.size(); ++k)
-				def_grad(k) = T(0);
-
-			for (size_t i = 0; i < vals.basis_values.size(); ++i)
-			{
-				const auto &bs = vals.basis_values[i];
-				const Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> grad = bs.grad.row(p);
-				assert(grad.size() == size());
-
-				for (int d = 0; d < size(); ++d)
-				{
-					for (int c = 0; c < size(); ++c)
-					{
-						def_grad(d, c) += grad(c) * local_disp(i * size() + d);
-					}
-				}
-			}
-
-			AutoDiffGradMat jac_it(size(), size());
-			for (long k = 0; k < jac_it.size(); ++k)
-				jac_it(k) = T(vals.jac_it[p](k));
-			def_grad = def_grad * jac_it;
-
-			//Id + grad d
-			for (int d = 0; d < size(); ++d)
-				def_grad(d, d) += T(1);
-
-			double lambda, mu;
-			params_.lambda_mu(vals.val(p, 0), vals.val(p, 1), size_ == 2 ? 0. : vals.val(p, 2), vals.element_id, lambda, mu);
-
-			const T log_det_j = log(polyfem::determinant(def_grad));
-			const T val = mu / 2 * ((def_grad.transpose() * def_grad).trace() - size() - 2 * log_det_j) + lambda / 2 * log_det_j * log_det_j;
-
-			energy += val * da(p);
-		}
 		return energy;
 	}
 } // namespace polyfem
@@ -20,9 +20,14 @@ namespace polyfem
 		NeoHookeanElasticity();
 
 		//energy, gradient, and hessian used in newton method
-		Eigen::MatrixXd assemble_hessian(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const;
+		//if project_to_psd dP/dF is projected at every quadrature point, so the element hessian is psd
+		Eigen::MatrixXd assemble_hessian(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, const bool project_to_psd = false) const;
 		Eigen::VectorXd assemble_grad(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const;
 		double compute_energy(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const;
+		//energy and gradient in one evaluation
+		void assemble_energy_grad(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, double &energy, Eigen::VectorXd &grad) const;
+		//energy, gradient, and hessian in one evaluation
+		void assemble_all(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, const bool project_to_psd, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian) const;
 
 		//rhs for fabbricated solution, compute with automatic sympy code
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1>
@@ -35,18 +40,22 @@ namespace polyfem
 		void compute_von_mises_stresses(const int el_id, const ElementBases &bs, const ElementBases &gbs, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &displacement, Eigen::MatrixXd &stresses) const;
 		void compute_stress_tensor(const int el_id, const ElementBases &bs, const ElementBases &gbs, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &displacement, Eigen::MatrixXd &tensor) const;
 
+		//closed form psd projection of dP/dF (column major in F) at def_grad, only the modes with negative eigenvalue are removed
+		static void project_stress_grad_to_psd(const DefGradMatrix &def_grad, const double lambda, const double mu, StressGradMatrix &stress_grad);
+
 		//sets material params
 		void set_parameters(const json &params);
 		void init_multimaterial(const Eigen::MatrixXd &Es, const Eigen::MatrixXd &nus);
+		//evaluates the lame parameters once at the quadrature points of all elements, called before the assembly loops
+		void init_material_cache(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases) const { params_.init_cache(is_volume, bases, gbases); }
 
 	private:
 		int size_ = 2;
 
 		LameParameters params_;
 
-		//utulity function that computes energy, the template is used for double, DScalar1, and DScalar2 in energy, gradient and hessian
-		template <typename T>
-		T compute_energy_aux(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const;
+		//energy, and if requested gradient and hessian, from the generated closed form stress and stress derivative
+		void compute_derivatives(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, const bool with_grad, const bool with_hessian, const bool project_to_psd, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian) const;
 
 		void assign_stress_tensor(const int el_id, const ElementBases &bs, const ElementBases &gbs, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &displacement, const int all_size, Eigen::MatrixXd &all, const std::function<Eigen::MatrixXd(const Eigen::MatrixXd &)> &fun) const;
 	};
@@ -26,13 +26,41 @@ namespace polyfem
 		{
 		public:
 			double val;
-			ElementAssemblyValues vals;
 
 			LocalThreadScalarStorage()
 			{
 				val = 0;
 			}
 		};
+
+		class LocalThreadVecStorage
+		{
+		public:
+			Eigen::MatrixXd vec;
+
+			LocalThreadVecStorage(const int size)
+			{
+				vec.resize(size, 1);
+				vec.setZero();
+			}
+		};
+
+		//element, type, and primitives of every local boundary flattened, used to compare boundaries by content
+		void boundary_key(const std::vector<LocalBoundary> &local_boundary, std::vector<int> &key)
+		{
+			key.clear();
+			for (const auto &lb : local_boundary)
+			{
+				key.push_back(lb.element_id());
+				key.push_back(int(lb.type()));
+				key.push_back(lb.size());
+				for (int i = 0; i < lb.size(); ++i)
+				{
+					key.push_back(lb[i]);
+					key.push_back(lb.global_primitive_id(i));
+				}
+			}
+		}
 	} // namespace
 
 	RhsAssembler::RhsAssembler(const AssemblerUtils &assembler, const Mesh &mesh,
@@ -48,46 +76,148 @@ namespace polyfem
 	{
 	}
 
-	void RhsAssembler::assemble(const Density &density, Eigen::MatrixXd &rhs, const double t) const
+	void RhsAssembler::clear_cache() const
 	{
-		rhs = Eigen::MatrixXd::Zero(n_basis_ * size_, 1);
-		if (!problem_.is_rhs_zero())
+		quadrature_offsets_.clear();
+		mass_solver_.reset();
+		dirichlet_resolution_ = -1;
+		dirichlet_solver_.reset();
+		neumann_resolution_ = -1;
+	}
+
+	void RhsAssembler::init_quadrature_cache() const
+	{
+		const int n_elements = int(bases_.size());
+		if (int(quadrature_offsets_.size()) == n_elements + 1)
+			return;
+
+		std::vector<Eigen::MatrixXd> element_points(n_elements);
+		std::vector<QuadratureVector> element_da(n_elements);
+		quadrature_basis_values_.resize(n_elements);
+
+		const auto compute_element = [&](const int e, ElementAssemblyValues &vals) {
+			vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
+
+			element_points[e] = vals.val;
+			element_da[e] = vals.det.array() * vals.quadrature.weights.array();
+
+			Eigen::MatrixXd &basis_values = quadrature_basis_values_[e];
+			basis_values.resize(vals.val.rows(), vals.basis_values.size());
+			for (int i = 0; i < int(vals.basis_values.size()); ++i)
+				basis_values.col(i) = vals.basis_values[i].val;
+		};
+
+#ifdef POLYFEM_WITH_TBB
+		tbb::enumerable_thread_specific<ElementAssemblyValues> storages;
+		tbb::parallel_for(tbb::blocked_range<int>(0, n_elements), [&](const tbb::blocked_range<int> &r) {
+			ElementAssemblyValues &vals = storages.local();
+			for (int e = r.begin(); e != r.end(); ++e)
+				compute_element(e, vals);
+		});
+#else
+		ElementAssemblyValues vals;
+		for (int e = 0; e < n_elements; ++e)
+			compute_element(e, vals);
+#endif
+
+		quadrature_offsets_.resize(n_elements + 1);
+		quadrature_offsets_[0] = 0;
+		for (int e = 0; e < n_elements; ++e)
+			quadrature_offsets_[e + 1] = quadrature_offsets_[e] + int(element_points[e].rows());
+
+		const int n_points = quadrature_offsets_.back();
+		quadrature_points_.resize(n_points, mesh_.dimension());
+		quadrature_element_ids_.resize(n_points, 1);
+		quadrature_da_.resize(n_points);
+		for (int e = 0; e < n_elements; ++e)
 		{
-			Eigen::MatrixXd rhs_fun;
+			const int offset = quadrature_offsets_[e];
+			const int n_loc_points = quadrature_offsets_[e + 1] - offset;
 
-			const int n_elements = int(bases_.size());
-			ElementAssemblyValues vals;
-			for (int e = 0; e < n_elements; ++e)
-			{
-				vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
+			quadrature_points_.middleRows(offset, n_loc_points) = element_points[e];
+			quadrature_element_ids_.middleRows(offset, n_loc_points).setConstant(e);
+			quadrature_da_.segment(offset, n_loc_points) = element_da[e];
+		}
+	}
 
-				const Quadrature &quadrature = vals.quadrature;
+	void RhsAssembler::integrate_cached(const Eigen::MatrixXd &vals, Eigen::MatrixXd &res) const
+	{
+		assert(vals.rows() == quadrature_points_.rows());
+		assert(vals.cols() == size_);
 
-				problem_.rhs(assembler_, formulation_, vals.val, t, rhs_fun);
+		const int n_elements = int(bases_.size());
+
+		const auto integrate_element = [&](const int e, Eigen::MatrixXd &vec) {
+			const int offset = quadrature_offsets_[e];
+			const int n_loc_points = quadrature_offsets_[e + 1] - offset;
+			const Eigen::MatrixXd &basis_values = quadrature_basis_values_[e];
+
+			for (int i = 0; i < basis_values.cols(); ++i)
+			{
+				const auto &global = bases_[e].bases[i].global();
 
 				for (int d = 0; d < size_; ++d)
 				{
-					//rhs_fun.col(d) = rhs_fun.col(d).array() * vals.det.array() * quadrature.weights.array();
-					for (int q = 0; q < quadrature.weights.size(); ++q)
-					{
-						const double rho = density(vals.val(q, 0), vals.val(q, 1), vals.val.cols() == 2 ? 0. : vals.val(q, 2), vals.element_id);
-						rhs_fun(q, d) *= vals.det(q) * quadrature.weights(q) * rho;
-					}
+					const double value = basis_values.col(i).dot(vals.col(d).segment(offset, n_loc_points));
+					for (std::size_t ii = 0; ii < global.size(); ++ii)
+						vec(global[ii].index * size_ + d) += value * global[ii].val;
 				}
+			}
+		};
 
-				const int n_loc_bases_ = int(vals.basis_values.size());
-				for (int i = 0; i < n_loc_bases_; ++i)
-				{
-					const AssemblyValues &v = vals.basis_values[i];
+#ifdef POLYFEM_WITH_TBB
+		typedef tbb::enumerable_thread_specific<LocalThreadVecStorage> LocalStorage;
+		LocalStorage storages(LocalThreadVecStorage(n_basis_ * size_));
+		tbb::parallel_for(tbb::blocked_range<int>(0, n_elements), [&](const tbb::blocked_range<int> &r) {
+			LocalStorage::reference loc_storage = storages.local();
+			for (int e = r.begin(); e != r.end(); ++e)
+				integrate_element(e, loc_storage.vec);
+		});
+
+		res = Eigen::MatrixXd::Zero(n_basis_ * size_, 1);
+		for (LocalStorage::iterator i = storages.begin(); i != storages.end(); ++i)
+			res += i->vec;
+#else
+		res = Eigen::MatrixXd::Zero(n_basis_ * size_, 1);
+		for (int e = 0; e < n_elements; ++e)
+			integrate_element(e, res);
+#endif
+	}
 
-					for (int d = 0; d < size_; ++d)
-					{
-						const double rhs_value = (rhs_fun.col(d).array() * v.val.array()).sum();
-						for (std::size_t ii = 0; ii < v.global.size(); ++ii)
-							rhs(v.global[ii].index * size_ + d) += rhs_value * v.global[ii].val;
-					}
-				}
-			}
+	void RhsAssembler::quadrature_density(const Density &density, Eigen::VectorXd &rho) const
+	{
+		//the cached quadrature points are the ones of the density cache
+		density.init_cache(mesh_.is_volume(), bases_, gbases_);
+
+		rho.resize(quadrature_points_.rows());
+		Eigen::VectorXd loc_rho;
+		for (int e = 0; e < int(bases_.size()); ++e)
+		{
+			const int offset = quadrature_offsets_[e];
+			const int n_loc_points = quadrature_offsets_[e + 1] - offset;
+
+			density(quadrature_points_.middleRows(offset, n_loc_points), e, loc_rho);
+			rho.segment(offset, n_loc_points) = loc_rho;
+		}
+	}
+
+	void RhsAssembler::assemble(const Density &density, Eigen::MatrixXd &rhs, const double t) const
+	{
+		rhs = Eigen::MatrixXd::Zero(n_basis_ * size_, 1);
+		if (!problem_.is_rhs_zero())
+		{
+			init_quadrature_cache();
+
+			//the problem and the density are not thread safe, they are evaluated once on all the points
+			Eigen::MatrixXd rhs_fun;
+			problem_.rhs(assembler_, formulation_, quadrature_points_, t, rhs_fun);
+
+			Eigen::VectorXd rho;
+			quadrature_density(density, rho);
+			for (int q = 0; q < quadrature_points_.rows(); ++q)
+				rhs_fun.row(q) *= quadrature_da_(q) * rho(q);
+
+			integrate_cached(rhs_fun, rhs);
 		}
 	}
 
@@ -108,69 +238,56 @@ namespace polyfem
 
 	void RhsAssembler::time_bc(const std::function<void(const Mesh &, const Eigen::MatrixXi &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &fun, Eigen::MatrixXd &sol) const
 	{
-		sol = Eigen::MatrixXd::Zero(n_basis_ * size_, 1);
-		Eigen::MatrixXd loc_sol;
+		init_quadrature_cache();
 
-		const int n_elements = int(bases_.size());
-		ElementAssemblyValues vals;
-		Eigen::MatrixXi ids;
-		for (int e = 0; e < n_elements; ++e)
-		{
-			vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
-			ids.resize(vals.val.rows(), 1);
-			ids.setConstant(e);
+		Eigen::MatrixXd loc_sol;
+		fun(mesh_, quadrature_element_ids_, quadrature_points_, loc_sol);
 
-			const Quadrature &quadrature = vals.quadrature;
-			//problem_.initial_solution(vals.val, loc_sol);
-			fun(mesh_, ids, vals.val, loc_sol);
+		for (int d = 0; d < size_; ++d)
+			loc_sol.col(d) = loc_sol.col(d).array() * quadrature_da_.array();
 
-			for (int d = 0; d < size_; ++d)
-				loc_sol.col(d) = loc_sol.col(d).array() * vals.det.array() * quadrature.weights.array();
+		integrate_cached(loc_sol, sol);
 
-			const int n_loc_bases_ = int(vals.basis_values.size());
-			for (int i = 0; i < n_loc_bases_; ++i)
-			{
-				const AssemblyValues &v = vals.basis_values[i];
-
-				for (int d = 0; d < size_; ++d)
-				{
-					const double sol_value = (loc_sol.col(d).array() * v.val.array()).sum();
-					for (std::size_t ii = 0; ii < v.global.size(); ++ii)
-						sol(v.global[ii].index * size_ + d) += sol_value * v.global[ii].val;
-				}
-			}
+		//the mass matrix is the same for the initial solution, velocity, and acceleration
+		if (!mass_solver_)
+		{
+			Density d;
+			assembler_.assemble_mass_matrix(formulation_, size_ == 3, n_basis_, d, bases_, gbases_, mass_);
+			mass_solver_ = LinearSolver::create(solver_, preconditioner_);
+			mass_solver_->setParameters(solver_params_);
+			mass_solver_->analyzePattern(mass_, mass_.rows());
+			mass_solver_->factorize(mass_);
 		}
-
-		StiffnessMatrix mass;
-		Density d;
-		assembler_.assemble_mass_matrix(formulation_, size_ == 3, n_basis_, d, bases_, gbases_, mass);
-		auto solver = LinearSolver::create(solver_, preconditioner_);
-		solver->setParameters(solver_params_);
-		solver->analyzePattern(mass, mass.rows());
-		solver->factorize(mass);
 		Eigen::MatrixXd b = sol;
 		sol.setZero();
 		for (long i = 0; i < b.cols(); ++i)
 		{
-			solver->solve(b.col(i), sol.col(i));
+			mass_solver_->solve(b.col(i), sol.col(i));
 		}
-		logger().trace("mass matrix error {}", (mass * sol - b).norm());
+		logger().trace("mass matrix error {}", (mass_ * sol - b).norm());
 	}
 
-	void RhsAssembler::set_bc(
-		const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &df,
-		const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &nf,
-		const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, const std::vector<LocalBoundary> &local_neumann_boundary, Eigen::MatrixXd &rhs) const
+	void RhsAssembler::init_dirichlet_cache(const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution) const
 	{
+		std::vector<int> key;
+		boundary_key(local_boundary, key);
+		if (dirichlet_resolution_ == resolution && key == dirichlet_boundary_key_ && bounday_nodes == dirichlet_nodes_)
+			return;
+
+		dirichlet_boundary_key_ = key;
+		dirichlet_nodes_ = bounday_nodes;
+		dirichlet_resolution_ = resolution;
+		dirichlet_solver_.reset();
+
 		const int n_el = int(bases_.size());
 
-		Eigen::MatrixXd uv, samples, gtmp, rhs_fun;
+		Eigen::MatrixXd uv, samples;
 		Eigen::VectorXi global_primitive_ids;
 
 		int index = 0;
-		std::vector<int> indices;
+		std::vector<int> &indices = dirichlet_indices_;
+		indices.clear();
 		indices.reserve(n_el * 10);
-		// std::map<int, int> global_index_to_col;
 
 		long total_size = 0;
 
@@ -183,6 +300,7 @@ namespace polyfem
 
 		// assert((bounday_nodes.size()/actual_dim)*actual_dim == bounday_nodes.size());
 
+		is_boundary_dof_.assign(n_basis_ * size_, false);
 		int skipped_count = 0;
 		for (int b : bounday_nodes)
 		{
@@ -192,6 +310,9 @@ namespace polyfem
 				is_boundary[bindex] = true;
 			else
 				skipped_count++;
+
+			if (b < int(is_boundary_dof_.size()))
+				is_boundary_dof_[b] = true;
 		}
 		assert(skipped_count <= 1);
 
@@ -215,13 +336,10 @@ namespace polyfem
 				for (std::size_t ii = 0; ii < b.global().size(); ++ii)
 				{
 					//pt found
-					// if(std::find(bounday_nodes.begin(), bounday_nodes.end(), size_ * b.global()[ii].index) != bounday_nodes.end())
 					if (is_boundary[b.global()[ii].index])
 					{
-						//if(global_index_to_col.find( b.global()[ii].index ) == global_index_to_col.end())
 						if (global_index_to_col(b.global()[ii].index) == -1)
 						{
-							// global_index_to_col[b.global()[ii].index] = index++;
 							global_index_to_col(b.global()[ii].index) = index++;
 							indices.push_back(b.global()[ii].index);
 							assert(indices.size() == size_t(index));
@@ -231,21 +349,17 @@ namespace polyfem
 			}
 		}
 
-		// Eigen::MatrixXd global_mat = Eigen::MatrixXd::Zero(total_size, indices.size());
-		Eigen::MatrixXd global_rhs = Eigen::MatrixXd::Zero(total_size, size_);
-
-		const long buffer_size = total_size * long(indices.size());
-		std::vector<Eigen::Triplet<double>> entries, entries_t;
-		// entries.reserve(buffer_size);
-		// entries_t.reserve(buffer_size);
-
-		index = 0;
+		std::vector<Eigen::Triplet<double>> entries_t;
 
 		int global_counter = 0;
 		Eigen::MatrixXd mapped;
 
 		std::vector<AssemblyValues> tmp_val;
 
+		dirichlet_uv_.resize(0, 0);
+		dirichlet_points_.resize(total_size, mesh_.dimension());
+		dirichlet_ids_.resize(total_size, 1);
+
 		for (const auto &lb : local_boundary)
 		{
 			const int e = lb.element_id();
@@ -268,41 +382,53 @@ namespace polyfem
 
 				for (std::size_t ii = 0; ii < b.global().size(); ++ii)
 				{
-					// auto item = global_index_to_col.find(b.global()[ii].index);
-					// if(item != global_index_to_col.end()){
 					auto item = global_index_to_col(b.global()[ii].index);
 					if (item != -1)
 					{
 						for (int k = 0; k < int(tmp.size()); ++k)
-						{
-							// entries.push_back(Eigen::Triplet<double>(global_counter+k, item->second, tmp(k, j) * b.global()[ii].val));
-							// entries_t.push_back(Eigen::Triplet<double>(item->second, global_counter+k, tmp(k, j) * b.global()[ii].val));
-							entries.push_back(Eigen::Triplet<double>(global_counter + k, item, tmp(k) * b.global()[ii].val));
 							entries_t.push_back(Eigen::Triplet<double>(item, global_counter + k, tmp(k) * b.global()[ii].val));
-						}
-						// global_mat.block(global_counter, item->second, tmp.size(), 1) = tmp;
 					}
 				}
 			}
 
-			// problem_.bc(mesh_, global_primitive_ids, mapped, t, rhs_fun);
-			df(global_primitive_ids, uv, mapped, rhs_fun);
-			global_rhs.block(global_counter, 0, rhs_fun.rows(), rhs_fun.cols()) = rhs_fun;
-			global_counter += rhs_fun.rows();
-
-			//UIState::ui_state().debug_data().add_points(mapped, Eigen::MatrixXd::Constant(1, 3, 0));
+			if (dirichlet_uv_.size() == 0)
+				dirichlet_uv_.resize(total_size, uv.cols());
 
-			//Eigen::MatrixXd asd(mapped.rows(), 3);
-			//asd.col(0)=mapped.col(0);
-			//asd.col(1)=mapped.col(1);
-			//asd.col(2)=rhs_fun;
-			//UIState::ui_state().debug_data().add_points(asd, Eigen::MatrixXd::Constant(1, 3, 0));
+			dirichlet_uv_.middleRows(global_counter, uv.rows()) = uv;
+			dirichlet_points_.middleRows(global_counter, mapped.rows()) = mapped;
+			dirichlet_ids_.middleRows(global_counter, global_primitive_ids.rows()) = global_primitive_ids;
+			global_counter += int(mapped.rows());
 		}
 
 		assert(global_counter == total_size);
 
+		dirichlet_mat_t_.resize(int(indices.size()), int(total_size));
+		dirichlet_mat_t_.setFromTriplets(entries_t.begin(), entries_t.end());
+
+		dirichlet_A_ = dirichlet_mat_t_ * dirichlet_mat_t_.transpose();
+	}
+
+	void RhsAssembler::set_bc(
+		const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &df,
+		const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &nf,
+		const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, const std::vector<LocalBoundary> &local_neumann_boundary, Eigen::MatrixXd &rhs) const
+	{
+		//the samples, the projection matrix, and its factorization only depend on the boundary
+		init_dirichlet_cache(local_boundary, bounday_nodes, resolution);
+
+		Eigen::MatrixXd uv, rhs_fun;
+		Eigen::VectorXi global_primitive_ids;
+
+		const std::vector<int> &indices = dirichlet_indices_;
+		const long total_size = dirichlet_points_.rows();
+
 		if (total_size > 0)
 		{
+			// problem_.bc(mesh_, global_primitive_ids, mapped, t, rhs_fun);
+			df(dirichlet_ids_, dirichlet_uv_, dirichlet_points_, rhs_fun);
+			Eigen::MatrixXd global_rhs = Eigen::MatrixXd::Zero(total_size, size_);
+			global_rhs.leftCols(rhs_fun.cols()) = rhs_fun;
+
 			const double mmin = global_rhs.minCoeff();
 			const double mmax = global_rhs.maxCoeff();
 
@@ -313,31 +439,30 @@ namespace polyfem
 				{
 					for (int d = 0; d < size_; ++d)
 					{
-						if (problem_.all_dimentions_dirichelt() || std::find(bounday_nodes.begin(), bounday_nodes.end(), indices[i] * size_ + d) != bounday_nodes.end())
+						if (problem_.all_dimentions_dirichelt() || is_boundary_dof_[indices[i] * size_ + d])
 							rhs(indices[i] * size_ + d) = 0;
 					}
 				}
 			}
 			else
 			{
-				StiffnessMatrix mat(int(total_size), int(indices.size()));
-				mat.setFromTriplets(entries.begin(), entries.end());
-
-				StiffnessMatrix mat_t(int(indices.size()), int(total_size));
-				mat_t.setFromTriplets(entries_t.begin(), entries_t.end());
+				const StiffnessMatrix &A = dirichlet_A_;
+				Eigen::MatrixXd b = dirichlet_mat_t_ * global_rhs;
 
-				StiffnessMatrix A = mat_t * mat;
-				Eigen::MatrixXd b = mat_t * global_rhs;
+				//factorized on the first non zero boundary condition
+				if (!dirichlet_solver_)
+				{
+					dirichlet_solver_ = LinearSolver::create(solver_, preconditioner_);
+					dirichlet_solver_->setParameters(solver_params_);
+					dirichlet_solver_->analyzePattern(A, A.rows());
+					dirichlet_solver_->factorize(A);
+				}
 
 				Eigen::MatrixXd coeffs(b.rows(), b.cols());
-				auto solver = LinearSolver::create(solver_, preconditioner_);
-				solver->setParameters(solver_params_);
-				solver->analyzePattern(A, A.rows());
-				solver->factorize(A);
 				coeffs.setZero();
 				for (long i = 0; i < b.cols(); ++i)
 				{
-					solver->solve(b.col(i), coeffs.col(i));
+					dirichlet_solver_->solve(b.col(i), coeffs.col(i));
 				}
 				logger().trace("RHS solve error {}", (A * coeffs - b).norm());
 
@@ -345,7 +470,7 @@ namespace polyfem
 				{
 					for (int d = 0; d < size_; ++d)
 					{
-						if (problem_.all_dimentions_dirichelt() || std::find(bounday_nodes.begin(), bounday_nodes.end(), indices[i] * size_ + d) != bounday_nodes.end())
+						if (problem_.all_dimentions_dirichelt() || is_boundary_dof_[indices[i] * size_ + d])
 							rhs(indices[i] * size_ + d) = coeffs(i, d);
 					}
 				}
@@ -353,89 +478,60 @@ namespace polyfem
 		}
 
 		//Neumann
-		Eigen::MatrixXd points, normals;
-		Eigen::VectorXd weights;
-
-		ElementAssemblyValues vals;
-
-		// std::ofstream fff("text.obj");
-		// int aaaa = 0;
-		for (const auto &lb : local_neumann_boundary)
+		if (!local_neumann_boundary.empty())
 		{
-			const int e = lb.element_id();
-			bool has_samples = boundary_quadrature(lb, resolution, false, uv, points, normals, weights, global_primitive_ids);
-
-			if (!has_samples)
-				continue;
+			init_neumann_cache(local_neumann_boundary, resolution);
 
-			const ElementBases &gbs = gbases_[e];
-			const ElementBases &bs = bases_[e];
-
-			vals.compute(e, mesh_.is_volume(), points, bs, gbs);
-
-			for (int n = 0; n < vals.jac_it.size(); ++n)
+			if (neumann_points_.rows() > 0)
 			{
-				normals.row(n) = normals.row(n) * vals.jac_it[n];
-				normals.row(n).normalize();
-			}
-
-			// for (int aa = 0; aa < normals.rows(); ++aa, ++aaaa)
-			// {
-			// 	fff << "v " <<vals.val(aa, 0) << " " << vals.val(aa, 1);
-			// 	if(vals.val.cols() == 2)
-			// 		fff<<" 0\n";
-			// 	else
-			// 		fff << " " << vals.val(aa, 2) << "\n";
-
-			// 	fff << "v " << vals.val(aa, 0) + normals(aa, 0)/100 << " " << vals.val(aa, 1) + normals(aa, 1)/100;
-			// 	if (vals.val.cols() == 2)
-			// 		fff << " 0\n";
-			// 	else
-			// 		fff << " " << vals.val(aa, 2) + normals(aa, 2)/100 << "\n";
+				// problem_.neumann_bc(mesh_, global_primitive_ids, vals.val, t, rhs_fun);
+				nf(neumann_ids_, neumann_uv_, neumann_points_, neumann_normals_, rhs_fun);
 
-			// 	fff << "l " << 2 * aaaa + 1 << " " << 2 * aaaa + 2 <<"\n";
-			// }
-
-			// problem_.neumann_bc(mesh_, global_primitive_ids, vals.val, t, rhs_fun);
-			nf(global_primitive_ids, uv, vals.val, normals, rhs_fun);
-
-			// UIState::ui_state().debug_data().add_points(vals.val, Eigen::RowVector3d(0,1,0));
-
-			for (int d = 0; d < size_; ++d)
-				rhs_fun.col(d) = rhs_fun.col(d).array() * weights.array();
+				for (int d = 0; d < size_; ++d)
+					rhs_fun.col(d) = rhs_fun.col(d).array() * neumann_weights_.array();
 
-			for (int i = 0; i < lb.size(); ++i)
-			{
-				const int primitive_global_id = lb.global_primitive_id(i);
-				const auto nodes = bs.local_nodes_for_primitive(primitive_global_id, mesh_);
+				const int n_boundary = int(local_neumann_boundary.size());
+				const auto integrate_boundary = [&](const int k, Eigen::MatrixXd &vec) {
+					const int offset = neumann_offsets_[k];
+					const int n_loc_points = neumann_offsets_[k + 1] - offset;
+					const ElementBases &bs = bases_[local_neumann_boundary[k].element_id()];
 
-				for (long n = 0; n < nodes.size(); ++n)
-				{
-					// const auto &b = bs.bases[nodes(n)];
-					const AssemblyValues &v = vals.basis_values[nodes(n)];
-					for (int d = 0; d < size_; ++d)
+					for (const int node : neumann_nodes_[k])
 					{
-						const double rhs_value = (rhs_fun.col(d).array() * v.val.array()).sum();
-
-						for (size_t g = 0; g < v.global.size(); ++g)
+						const auto &global = bs.bases[node].global();
+						for (int d = 0; d < size_; ++d)
 						{
-							const int g_index = v.global[g].index * size_ + d;
-							const bool is_neumann = std::find(bounday_nodes.begin(), bounday_nodes.end(), g_index) == bounday_nodes.end();
+							const double rhs_value = neumann_basis_values_[k].col(node).dot(rhs_fun.col(d).segment(offset, n_loc_points));
 
-							if (is_neumann)
+							for (size_t g = 0; g < global.size(); ++g)
 							{
-								rhs(g_index) += rhs_value * v.global[g].val;
-								// UIState::ui_state().debug_data().add_points(v.global[g].node, Eigen::RowVector3d(1,0,0));
+								const int g_index = global[g].index * size_ + d;
+								const bool is_neumann = !is_boundary_dof_[g_index];
+
+								if (is_neumann)
+									vec(g_index) += rhs_value * global[g].val;
 							}
-							// else
-							// std::cout<<"skipping "<<g_index<<" "<<rhs_value * v.global[g].val<<std::endl;
 						}
 					}
-				}
+				};
+
+#ifdef POLYFEM_WITH_TBB
+				typedef tbb::enumerable_thread_specific<LocalThreadVecStorage> LocalStorage;
+				LocalStorage storages(LocalThreadVecStorage(n_basis_ * size_));
+				tbb::parallel_for(tbb::blocked_range<int>(0, n_boundary), [&](const tbb::blocked_range<int> &r) {
+					LocalStorage::reference loc_storage = storages.local();
+					for (int k = r.begin(); k != r.end(); ++k)
+						integrate_boundary(k, loc_storage.vec);
+				});
+
+				for (LocalStorage::iterator i = storages.begin(); i != storages.end(); ++i)
+					rhs += i->vec;
+#else
+				for (int k = 0; k < n_boundary; ++k)
+					integrate_boundary(k, rhs);
+#endif
 			}
 		}
-
-		// fff.close();
 	}
 
 	void RhsAssembler::set_bc(const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, const std::vector<LocalBoundary> &local_neumann_boundary, Eigen::MatrixXd &rhs, const double t) const
@@ -481,144 +577,196 @@ namespace polyfem
 
 	double RhsAssembler::compute_energy(const Eigen::MatrixXd &displacement, const std::vector<LocalBoundary> &local_neumann_boundary, const Density &density, const int resolution, const double t) const
 	{
-
 		double res = 0;
 		Eigen::MatrixXd forces;
 
-		if (!problem_.is_rhs_zero())
-		{
-#ifdef POLYFEM_WITH_TBB
-			typedef tbb::enumerable_thread_specific<LocalThreadScalarStorage> LocalStorage;
-			LocalStorage storages((LocalThreadScalarStorage()));
-#else
-			LocalThreadScalarStorage loc_storage;
-#endif
-
-			const int n_bases = int(bases_.size());
-
-#ifdef POLYFEM_WITH_TBB
-			tbb::parallel_for(tbb::blocked_range<int>(0, n_bases), [&](const tbb::blocked_range<int> &r) {
-		LocalStorage::reference loc_storage = storages.local();
-		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> local_displacement(size_);
-
-		for (int e = r.begin(); e != r.end(); ++e) {
-#else
+		//f . u at the points of element (or boundary) k, its points are [offset, offset+n) in the stacked values and basis_values has its bases
+		const auto energy_density = [&](const Eigen::MatrixXd &basis_values, const std::vector<Basis> &bases, const int offset, const Eigen::VectorXd &weights, double &val) {
 			Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> local_displacement(size_);
 
-			for (int e = 0; e < n_bases; ++e)
-			{
-#endif
-			ElementAssemblyValues &vals = loc_storage.vals;
-			vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
-
-			const Quadrature &quadrature = vals.quadrature;
-			const Eigen::VectorXd da = vals.det.array() * quadrature.weights.array();
-
-
-			problem_.rhs(assembler_, formulation_, vals.val, t, forces);
-			assert(forces.rows() == da.size());
-			assert(forces.cols() == size_);
-
-			for(long p = 0; p < da.size(); ++p)
+			for (long p = 0; p < basis_values.rows(); ++p)
 			{
 				local_displacement.setZero();
 
-				for(size_t i = 0; i < vals.basis_values.size(); ++i)
+				for (long i = 0; i < basis_values.cols(); ++i)
 				{
-					const auto &bs = vals.basis_values[i];
-					assert(bs.val.size() == da.size());
-					const double b_val = bs.val(p);
+					const auto &global = bases[i].global();
+					const double b_val = basis_values(p, i);
 
-					for(int d = 0; d < size_; ++d)
+					for (int d = 0; d < size_; ++d)
 					{
-						for(std::size_t ii = 0; ii < bs.global.size(); ++ii)
-						{
-							local_displacement(d) += (bs.global[ii].val * b_val) * displacement(bs.global[ii].index*size_ + d);
-						}
+						for (std::size_t ii = 0; ii < global.size(); ++ii)
+							local_displacement(d) += (global[ii].val * b_val) * displacement(global[ii].index * size_ + d);
 					}
 				}
-				const double rho = density(vals.val(p, 0), vals.val(p, 1), vals.val.cols() == 2 ? 0. : vals.val(p, 2), vals.element_id);
 
-				for(int d = 0; d < size_; ++d){
-					loc_storage.val += forces(p, d) * local_displacement(d) * da(p) * rho;
-					// res += forces(p, d) * local_displacement(d) * da(p);
-				}
-			}
-#ifdef POLYFEM_WITH_TBB
-		} });
-#else
+				for (int d = 0; d < size_; ++d)
+					val += forces(offset + p, d) * local_displacement(d) * weights(offset + p);
 			}
-#endif
+		};
 
+		//sum over [0, n) of the energy density of element (or boundary) k, in parallel
+		const auto sum_energy = [&](const int n, const std::function<void(const int, double &)> &fun) {
 #ifdef POLYFEM_WITH_TBB
+			typedef tbb::enumerable_thread_specific<LocalThreadScalarStorage> LocalStorage;
+			LocalStorage storages((LocalThreadScalarStorage()));
+			tbb::parallel_for(tbb::blocked_range<int>(0, n), [&](const tbb::blocked_range<int> &r) {
+				LocalStorage::reference loc_storage = storages.local();
+				for (int k = r.begin(); k != r.end(); ++k)
+					fun(k, loc_storage.val);
+			});
+
+			double sum = 0;
 			for (LocalStorage::iterator i = storages.begin(); i != storages.end(); ++i)
-			{
-				res += i->val;
-			}
+				sum += i->val;
+			return sum;
 #else
-			res = loc_storage.val;
+			double sum = 0;
+			for (int k = 0; k < n; ++k)
+				fun(k, sum);
+			return sum;
 #endif
+		};
+
+		if (!problem_.is_rhs_zero())
+		{
+			init_quadrature_cache();
+
+			//the problem and the density are not thread safe, they are evaluated once on all the points
+			problem_.rhs(assembler_, formulation_, quadrature_points_, t, forces);
+			assert(forces.rows() == quadrature_points_.rows());
+			assert(forces.cols() == size_);
+
+			Eigen::VectorXd weights;
+			quadrature_density(density, weights);
+			weights.array() *= quadrature_da_.array();
+
+			res = sum_energy(int(bases_.size()), [&](const int e, double &val) {
+				energy_density(quadrature_basis_values_[e], bases_[e].bases, quadrature_offsets_[e], weights, val);
+			});
 		}
 
 		if (problem_.is_linear_in_time() && !problem_.is_time_dependent())
 			res *= t;
 
-		// #ifdef POLYFEM_WITH_TBB
-		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> local_displacement(size_);
-		// #endif
-
-		ElementAssemblyValues vals;
 		//Neumann
-		Eigen::MatrixXd points, uv, normals;
-		Eigen::VectorXd weights;
-		Eigen::VectorXi global_primitive_ids;
-		for (const auto &lb : local_neumann_boundary)
+		if (!local_neumann_boundary.empty())
 		{
+			init_neumann_cache(local_neumann_boundary, resolution);
+
+			if (neumann_points_.rows() > 0)
+			{
+				problem_.neumann_bc(mesh_, neumann_ids_, neumann_uv_, neumann_points_, neumann_normals_, t, forces);
+
+				res -= sum_energy(int(local_neumann_boundary.size()), [&](const int k, double &val) {
+					const LocalBoundary &lb = local_neumann_boundary[k];
+					energy_density(neumann_basis_values_[k], bases_[lb.element_id()].bases, neumann_offsets_[k], neumann_weights_, val);
+				});
+			}
+		}
+
+		return res;
+	}
+
+	void RhsAssembler::init_neumann_cache(const std::vector<LocalBoundary> &local_neumann_boundary, const int resolution) const
+	{
+		std::vector<int> key;
+		boundary_key(local_neumann_boundary, key);
+		if (neumann_resolution_ == resolution && key == neumann_boundary_key_)
+			return;
+
+		neumann_boundary_key_ = key;
+		neumann_resolution_ = resolution;
+
+		const int n_boundary = int(local_neumann_boundary.size());
+
+		std::vector<Eigen::MatrixXd> uvs(n_boundary), points(n_boundary), normals(n_boundary);
+		std::vector<Eigen::VectorXd> weights(n_boundary);
+		std::vector<Eigen::VectorXi> global_primitive_ids(n_boundary);
+		neumann_basis_values_.assign(n_boundary, Eigen::MatrixXd());
+		neumann_nodes_.assign(n_boundary, std::vector<int>());
+
+		const auto compute_boundary = [&](const int k, ElementAssemblyValues &vals) {
+			const LocalBoundary &lb = local_neumann_boundary[k];
 			const int e = lb.element_id();
-			bool has_samples = boundary_quadrature(lb, resolution, false, uv, points, normals, weights, global_primitive_ids);
+			Eigen::MatrixXd ref_points;
+			bool has_samples = boundary_quadrature(lb, resolution, false, uvs[k], ref_points, normals[k], weights[k], global_primitive_ids[k]);
 
 			if (!has_samples)
-				continue;
+			{
+				uvs[k].resize(0, 0);
+				weights[k].resize(0);
+				return;
+			}
 
 			const ElementBases &gbs = gbases_[e];
 			const ElementBases &bs = bases_[e];
 
-			vals.compute(e, mesh_.is_volume(), points, bs, gbs);
+			vals.compute(e, mesh_.is_volume(), ref_points, bs, gbs);
+			points[k] = vals.val;
 
 			for (int n = 0; n < vals.jac_it.size(); ++n)
 			{
-				normals.row(n) = normals.row(n) * vals.jac_it[n];
-				normals.row(n).normalize();
+				normals[k].row(n) = normals[k].row(n) * vals.jac_it[n];
+				normals[k].row(n).normalize();
 			}
-			problem_.neumann_bc(mesh_, global_primitive_ids, uv, vals.val, normals, t, forces);
 
-			// UIState::ui_state().debug_data().add_points(vals.val, Eigen::RowVector3d(1,0,0));
+			Eigen::MatrixXd &basis_values = neumann_basis_values_[k];
+			basis_values.resize(ref_points.rows(), vals.basis_values.size());
+			for (int i = 0; i < int(vals.basis_values.size()); ++i)
+				basis_values.col(i) = vals.basis_values[i].val;
 
-			for (long p = 0; p < weights.size(); ++p)
+			//nodes of every primitive, a node shared by two primitives appears twice
+			for (int i = 0; i < lb.size(); ++i)
 			{
-				local_displacement.setZero();
-
-				for (size_t i = 0; i < vals.basis_values.size(); ++i)
-				{
-					const auto &vv = vals.basis_values[i];
-					assert(vv.val.size() == weights.size());
-					const double b_val = vv.val(p);
+				const auto nodes = bs.local_nodes_for_primitive(lb.global_primitive_id(i), mesh_);
+				for (long n = 0; n < nodes.size(); ++n)
+					neumann_nodes_[k].push_back(nodes(n));
+			}
+		};
 
-					for (int d = 0; d < size_; ++d)
-					{
-						for (std::size_t ii = 0; ii < vv.global.size(); ++ii)
-						{
-							local_displacement(d) += (vv.global[ii].val * b_val) * displacement(vv.global[ii].index * size_ + d);
-						}
-					}
-				}
+#ifdef POLYFEM_WITH_TBB
+		tbb::enumerable_thread_specific<ElementAssemblyValues> storages;
+		tbb::parallel_for(tbb::blocked_range<int>(0, n_boundary), [&](const tbb::blocked_range<int> &r) {
+			ElementAssemblyValues &vals = storages.local();
+			for (int k = r.begin(); k != r.end(); ++k)
+				compute_boundary(k, vals);
+		});
+#else
+		ElementAssemblyValues vals;
+		for (int k = 0; k < n_boundary; ++k)
+			compute_boundary(k, vals);
+#endif
 
-				for (int d = 0; d < size_; ++d)
-					res -= forces(p, d) * local_displacement(d) * weights(p);
-			}
+		neumann_offsets_.resize(n_boundary + 1);
+		neumann_offsets_[0] = 0;
+		int uv_cols = 0;
+		for (int k = 0; k < n_boundary; ++k)
+		{
+			neumann_offsets_[k + 1] = neumann_offsets_[k] + int(weights[k].size());
+			if (weights[k].size() > 0)
+				uv_cols = int(uvs[k].cols());
 		}
 
-		return res;
+		const int n_points = neumann_offsets_.back();
+		neumann_uv_.resize(n_points, uv_cols);
+		neumann_points_.resize(n_points, mesh_.dimension());
+		neumann_normals_.resize(n_points, mesh_.dimension());
+		neumann_weights_.resize(n_points);
+		neumann_ids_.resize(n_points, 1);
+		for (int k = 0; k < n_boundary; ++k)
+		{
+			const int offset = neumann_offsets_[k];
+			const int n_loc_points = neumann_offsets_[k + 1] - offset;
+			if (n_loc_points == 0)
+				continue;
+
+			neumann_uv_.middleRows(offset, n_loc_points) = uvs[k];
+			neumann_points_.middleRows(offset, n_loc_points) = points[k];
+			neumann_normals_.middleRows(offset, n_loc_points) = normals[k];
+			neumann_weights_.segment(offset, n_loc_points) = weights[k];
+			neumann_ids_.middleRows(offset, n_loc_points) = global_primitive_ids[k];
+		}
 	}
 
 	bool RhsAssembler::boundary_quadrature(const LocalBoundary &local_boundary, const int order, const bool skip_computation, Eigen::MatrixXd &uv, Eigen::MatrixXd &points, Eigen::MatrixXd &normals, Eigen::VectorXd &weights, Eigen::VectorXi &global_primitive_ids) const
@@ -9,7 +9,10 @@
 #include <polyfem/ElasticityUtils.hpp>
 #include <polyfem/Types.hpp>
 
+#include <polysolve/LinearSolver.hpp>
+
 #include <functional>
+#include <memory>
 #include <vector>
 
 namespace polyfem
@@ -56,6 +59,10 @@ namespace polyfem
 		//return the formulation
 		inline const std::string &formulation() const { return formulation_; }
 
+		//drops the cached quadrature, mass factorization, and dirichlet and neumann boundary data
+		//they are rebuilt at the next call, needed only if the bases change since the boundaries are compared by content
+		void clear_cache() const;
+
 	private:
 		//set boundary condition
 		//the 2 lambdas are callback to dirichlet df and neumann nf
@@ -65,6 +72,13 @@ namespace polyfem
 			const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &nf,
 			const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, const std::vector<LocalBoundary> &local_neumann_boundary, Eigen::MatrixXd &rhs) const;
 
+		//samples the dirichlet boundary, builds the least squares projection on the boundary nodes, and the boundary dofs bitmap
+		//it is done once and reused while the content of the boundary, the nodes, and the resolution do not change
+		void init_dirichlet_cache(const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution) const;
+
+		//quadrature, normals, and basis values of all the neumann boundary, computed once for a boundary and resolution
+		void init_neumann_cache(const std::vector<LocalBoundary> &local_neumann_boundary, const int resolution) const;
+
 		//sets the time (initial) boundary condition
 		//the lambda depeneds if soltuion, velocity, or acceleration
 		//they are projected on the FEM bases, it inverts a linear system
@@ -75,6 +89,13 @@ namespace polyfem
 		//compute quadrature for boundary facet, uv are local (ref) values, samples are global coordinates, used for neumann
 		bool boundary_quadrature(const LocalBoundary &local_boundary, const int order, const bool skip_computation, Eigen::MatrixXd &uv, Eigen::MatrixXd &points, Eigen::MatrixXd &normals, Eigen::VectorXd &weights, Eigen::VectorXi &global_primitive_ids) const;
 
+		//computes once the quadrature of all elements, used by assemble and time_bc
+		void init_quadrature_cache() const;
+		//res = \int \phi vals, vals has one row per cached quadrature point, already scaled by the quadrature weights
+		void integrate_cached(const Eigen::MatrixXd &vals, Eigen::MatrixXd &res) const;
+		//density at the cached quadrature points, evaluated per element (and read from the density cache when it has one)
+		void quadrature_density(const Density &density, Eigen::VectorXd &rho) const;
+
 		const AssemblerUtils &assembler_;
 		const Mesh &mesh_;
 		const int n_basis_;
@@ -85,6 +106,44 @@ namespace polyfem
 		const Problem &problem_;
 		const std::string solver_, preconditioner_;
 		const json solver_params_;
+
+		//quadrature points of all elements stacked, the ones of element e are the rows [quadrature_offsets_[e], quadrature_offsets_[e+1])
+		//the user functions (rhs, initial conditions) are evaluated in a single call on all the points, only the geometry is cached
+		mutable Eigen::MatrixXd quadrature_points_;
+		mutable Eigen::MatrixXi quadrature_element_ids_;
+		mutable Eigen::VectorXd quadrature_da_;
+		mutable std::vector<int> quadrature_offsets_;
+		//basis values of element e at its quadrature points, n_points x n_local_bases
+		mutable std::vector<Eigen::MatrixXd> quadrature_basis_values_;
+
+		//factorized mass matrix used by time_bc
+		mutable StiffnessMatrix mass_;
+		mutable std::unique_ptr<polysolve::LinearSolver> mass_solver_;
+
+		//copy of the boundary (see boundary_key) and nodes used to build the dirichlet cache
+		mutable std::vector<int> dirichlet_boundary_key_;
+		mutable std::vector<int> dirichlet_nodes_;
+		mutable int dirichlet_resolution_ = -1;
+		//dirichlet samples of all the boundary facets stacked
+		mutable Eigen::MatrixXd dirichlet_uv_, dirichlet_points_;
+		mutable Eigen::MatrixXi dirichlet_ids_;
+		//nodes of the projection, mat_t is the transpose of the bases at the samples and A = mat_t mat^T
+		mutable std::vector<int> dirichlet_indices_;
+		mutable StiffnessMatrix dirichlet_mat_t_, dirichlet_A_;
+		mutable std::unique_ptr<polysolve::LinearSolver> dirichlet_solver_;
+		//true for the dofs in bounday_nodes
+		mutable std::vector<bool> is_boundary_dof_;
+
+		//neumann quadrature stacked, the points of local_neumann_boundary[k] are the rows [neumann_offsets_[k], neumann_offsets_[k+1])
+		mutable std::vector<int> neumann_boundary_key_;
+		mutable int neumann_resolution_ = -1;
+		mutable Eigen::MatrixXd neumann_uv_, neumann_points_, neumann_normals_;
+		mutable Eigen::VectorXd neumann_weights_;
+		mutable Eigen::MatrixXi neumann_ids_;
+		mutable std::vector<int> neumann_offsets_;
+		//basis values of the element at the points of local_neumann_boundary[k], and the local nodes of its primitives
+		mutable std::vector<Eigen::MatrixXd> neumann_basis_values_;
+		mutable std::vector<std::vector<int>> neumann_nodes_;
 	};
 } // namespace polyfem
 
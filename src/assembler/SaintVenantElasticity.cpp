@@ -4,8 +4,10 @@
 
 #include <polyfem/Basis.hpp>
 #include <polyfem/auto_elasticity_rhs.hpp>
+#include <polyfem/auto_hyperelasticity.hpp>
 
 #include <igl/Timer.h>
+#include <ipc/utils/eigen_ext.hpp>
 
 namespace polyfem
 {
@@ -105,43 +107,63 @@ namespace polyfem
 	Eigen::VectorXd
 	SaintVenantElasticity::assemble_grad(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const
 	{
-		// igl::Timer time; time.start();
-
-		const int n_bases = vals.basis_values.size();
-
-		return polyfem::gradient_from_energy(
-			size(), n_bases, vals, displacement, da,
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 6, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 8, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 12, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 18, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 24, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 30, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 60, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 81, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, BIG_N, 1>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar1<double, Eigen::VectorXd>>(vals, displacement, da); });
+		double energy;
+		Eigen::VectorXd grad;
+		Eigen::MatrixXd hessian;
+		compute_derivatives(vals, displacement, da, true, false, false, energy, grad, hessian);
+
+		return grad;
 	}
 
 	Eigen::MatrixXd
-	SaintVenantElasticity::assemble_hessian(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const
+	SaintVenantElasticity::assemble_hessian(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, const bool project_to_psd) const
+	{
+		double energy;
+		Eigen::VectorXd grad;
+		Eigen::MatrixXd hessian;
+		compute_derivatives(vals, displacement, da, false, true, project_to_psd, energy, grad, hessian);
+
+		return hessian;
+	}
+
+	void SaintVenantElasticity::assemble_energy_grad(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, double &energy, Eigen::VectorXd &grad) const
+	{
+		Eigen::MatrixXd hessian;
+		compute_derivatives(vals, displacement, da, true, false, false, energy, grad, hessian);
+	}
+
+	void SaintVenantElasticity::assemble_all(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, const bool project_to_psd, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian) const
+	{
+		compute_derivatives(vals, displacement, da, true, true, project_to_psd, energy, grad, hessian);
+	}
+
+	void SaintVenantElasticity::compute_derivatives(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, const bool with_grad, const bool with_hessian, const bool project_to_psd, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian) const
 	{
-		// igl::Timer time; time.start();
-
-		const int n_bases = vals.basis_values.size();
-		return polyfem::hessian_from_energy(
-			size(), n_bases, vals, displacement, da,
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 6, 1>, Eigen::Matrix<double, 6, 6>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 8, 1>, Eigen::Matrix<double, 8, 8>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 12, 1>, Eigen::Matrix<double, 12, 12>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 18, 1>, Eigen::Matrix<double, 18, 18>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 24, 1>, Eigen::Matrix<double, 24, 24>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 30, 1>, Eigen::Matrix<double, 30, 30>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 60, 1>, Eigen::Matrix<double, 60, 60>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 81, 1>, Eigen::Matrix<double, 81, 81>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, SMALL_N, SMALL_N>>>(vals, displacement, da); },
-			[&](const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) { return compute_energy_aux<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>>(vals, displacement, da); });
+		polyfem::derivatives_from_def_grad(
+			size(), vals, displacement, da, with_grad, with_hessian,
+			[&](const int p, const DefGradMatrix &def_grad, double &density, DefGradMatrix &stress, StressGradMatrix &stress_grad) {
+				if (size() == 2)
+				{
+					density = autogen::saint_venant_2d_energy(def_grad, elasticity_tensor_);
+					if (with_grad)
+						autogen::saint_venant_2d_stress(def_grad, elasticity_tensor_, stress);
+					if (with_hessian)
+						autogen::saint_venant_2d_stress_grad(def_grad, elasticity_tensor_, stress_grad);
+				}
+				else
+				{
+					density = autogen::saint_venant_3d_energy(def_grad, elasticity_tensor_);
+					if (with_grad)
+						autogen::saint_venant_3d_stress(def_grad, elasticity_tensor_, stress);
+					if (with_hessian)
+						autogen::saint_venant_3d_stress_grad(def_grad, elasticity_tensor_, stress_grad);
+				}
+
+				//no closed form eigen system for a general elasticity tensor, the 4x4 (9x9) eigen decomposition is still much smaller than the element one
+				if (with_hessian && project_to_psd)
+					stress_grad = Eigen::project_to_psd(stress_grad);
+			},
+			energy, grad, hessian);
 	}
 
 	void SaintVenantElasticity::compute_stress_tensor(const int el_id, const ElementBases &bs, const ElementBases &gbs, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &displacement, Eigen::MatrixXd &stresses) const
@@ -213,103 +235,11 @@ namespace polyfem
 
 	double SaintVenantElasticity::compute_energy(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const
 	{
-		return compute_energy_aux<double>(vals, displacement, da);
-	}
-
-	//Compute \int \sigma : E
-	template <typename T>
-	T SaintVenantElasticity::compute_energy_aux(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const
-	{
-		typedef Eigen::Matrix<T, Eigen::Dynamic, 1> AutoDiffVect;
-		typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> AutoDiffGradMat;
-
-		assert(displacement.cols() == 1);
-
-		const int n_pts = da.size();
-
-		Eigen::Matrix<double, Eigen::Dynamic, 1> local_dispv(vals.basis_values.size() * size(), 1);
-		local_dispv.setZero();
-		for (size_t i = 0; i < vals.basis_values.size(); ++i)
-		{
-			const auto &bs = vals.basis_values[i];
-			for (size_t ii = 0; ii < bs.global.size(); ++ii)
-			{
-				for (int d = 0; d < size(); ++d)
-				{
-					local_dispv(i * size() + d) += bs.global[ii].val * displacement(bs.global[ii].index * size() + d);
-				}
-			}
-		}
-
-		DiffScalarBase::setVariableCount(local_dispv.rows());
-		AutoDiffVect local_disp(local_dispv.rows(), 1);
-		T energy = T(0.0);
-
-		const AutoDiffAllocator<T> allocate_auto_diff_scalar;
-
-		for (long i = 0; i < local_dispv.rows(); ++i)
-		{
-			local_disp(i) = allocate_auto_diff_scalar(i, local_dispv(i));
-		}
-
-		AutoDiffGradMat displacement_grad(size(), size());
-
-		for (long p = 0; p < n_pts; ++p)
-		{
-			for (long k = 0; k < displacement_grad.size(); ++k)
-				displacement_grad(k) = T(0);
-
-			for (size_t i = 0; i < vals.basis_values.size(); ++i)
-			{
-				const auto &bs = vals.basis_values[i];
-				const Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> grad = bs.grad.row(p);
-				assert(grad.size() == size());
-
-				for (int d = 0; d < size(); ++d)
-				{
-					for (int c = 0; c < size(); ++c)
-					{
-						displacement_grad(d, c) += grad(c) * local_disp(i * size() + d);
-					}
-				}
-			}
-
-			AutoDiffGradMat jac_it(size(), size());
-			for (long k = 0; k < jac_it.size(); ++k)
-				jac_it(k) = T(vals.jac_it[p](k));
-			displacement_grad = displacement_grad * jac_it;
-
-			AutoDiffGradMat strain = strain_from_disp_grad(displacement_grad);
-			AutoDiffGradMat stress_tensor(size(), size());
-
-			if (size() == 2)
-			{
-				std::array<T, 3> eps;
-				eps[0] = strain(0, 0);
-				eps[1] = strain(1, 1);
-				eps[2] = 2 * strain(0, 1);
-
-				stress_tensor << stress(eps, 0), stress(eps, 2),
-					stress(eps, 2), stress(eps, 1);
-			}
-			else
-			{
-				std::array<T, 6> eps;
-				eps[0] = strain(0, 0);
-				eps[1] = strain(1, 1);
-				eps[2] = strain(2, 2);
-				eps[3] = 2 * strain(1, 2);
-				eps[4] = 2 * strain(0, 2);
-				eps[5] = 2 * strain(0, 1);
-
-				stress_tensor << stress(eps, 0), stress(eps, 5), stress(eps, 4),
-					stress(eps, 5), stress(eps, 1), stress(eps, 3),
-					stress(eps, 4), stress(eps, 3), stress(eps, 2);
-			}
-
-			energy += (stress_tensor * strain).trace() * da(p);
-		}
+		double energy;
+		Eigen::VectorXd grad;
+		Eigen::MatrixXd hessian;
+		compute_derivatives(vals, displacement, da, false, false, false, energy, grad, hessian);
 
-		return energy * 0.5;
+		return energy;
 	}
 } // namespace polyfem
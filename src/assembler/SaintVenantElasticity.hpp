@@ -19,9 +19,14 @@ namespace polyfem
 	public:
 		SaintVenantElasticity();
 
-		Eigen::MatrixXd assemble_hessian(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const;
+		//if project_to_psd dP/dF is projected at every quadrature point, so the element hessian is psd
+		Eigen::MatrixXd assemble_hessian(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, const bool project_to_psd = false) const;
 		Eigen::VectorXd assemble_grad(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const;
 		double compute_energy(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const;
+		//energy and gradient in one evaluation
+		void assemble_energy_grad(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, double &energy, Eigen::VectorXd &grad) const;
+		//energy, gradient, and hessian in one evaluation
+		void assemble_all(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, const bool project_to_psd, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian) const;
 
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1>
 		compute_rhs(const AutodiffHessianPt &pt) const;
@@ -45,8 +50,8 @@ namespace polyfem
 		template <typename T, unsigned long N>
 		T stress(const std::array<T, N> &strain, const int j) const;
 
-		template <typename T>
-		T compute_energy_aux(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da) const;
+		//energy, and if requested gradient and hessian, from the generated closed form stress and stress derivative
+		void compute_derivatives(const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da, const bool with_grad, const bool with_hessian, const bool project_to_psd, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian) const;
 
 		void assign_stress_tensor(const int el_id, const ElementBases &bs, const ElementBases &gbs, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &displacement, const int all_size, Eigen::MatrixXd &all, const std::function<Eigen::MatrixXd(const Eigen::MatrixXd &)> &fun) const;
 	};
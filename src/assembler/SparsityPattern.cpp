@@ -0,0 +1,245 @@
+#include <polyfem/SparsityPattern.hpp>
+
+#include <polyfem/Logger.hpp>
+
+#include <algorithm>
+
+#ifdef POLYFEM_WITH_TBB
+#include <tbb/parallel_for.h>
+#endif
+
+namespace polyfem
+{
+	void SparsityPattern::init(const int n_basis, const int size, const std::vector<ElementBases> &bases, const bool symmetric)
+	{
+		n_basis_ = n_basis;
+		size_ = size;
+		symmetric_ = symmetric;
+
+		const int n_elements = int(bases.size());
+
+		//global nodes of every element
+		std::vector<std::vector<int>> element_nodes(n_elements);
+		const auto collect_element_nodes = [&](const int e) {
+			std::vector<int> &nodes = element_nodes[e];
+			for (const Basis &b : bases[e].bases)
+			{
+				for (const auto &g : b.global())
+				{
+					if (g.index >= 0)
+						nodes.push_back(g.index);
+				}
+			}
+			std::sort(nodes.begin(), nodes.end());
+			nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+		};
+
+		//node to element incidence
+		std::vector<int> node_elements_offsets(n_basis + 1, 0);
+		std::vector<int> node_elements;
+
+#ifdef POLYFEM_WITH_TBB
+		tbb::parallel_for(tbb::blocked_range<int>(0, n_elements), [&](const tbb::blocked_range<int> &r) {
+			for (int e = r.begin(); e != r.end(); ++e)
+				collect_element_nodes(e);
+		});
+#else
+		for (int e = 0; e < n_elements; ++e)
+			collect_element_nodes(e);
+#endif
+
+		for (int e = 0; e < n_elements; ++e)
+		{
+			for (const int n : element_nodes[e])
+			{
+				assert(n < n_basis);
+				++node_elements_offsets[n + 1];
+			}
+		}
+		for (int n = 0; n < n_basis; ++n)
+			node_elements_offsets[n + 1] += node_elements_offsets[n];
+
+		node_elements.resize(node_elements_offsets.back());
+		{
+			std::vector<int> current = node_elements_offsets;
+			for (int e = 0; e < n_elements; ++e)
+			{
+				for (const int n : element_nodes[e])
+					node_elements[current[n]++] = e;
+			}
+		}
+
+		//greedy coloring, an element takes the smallest color not used by the elements sharing one of its nodes
+		colors_.clear();
+		{
+			std::vector<int> element_color(n_elements, -1);
+			std::vector<int> forbidden;
+			for (int e = 0; e < n_elements; ++e)
+			{
+				for (const int n : element_nodes[e])
+				{
+					for (int i = node_elements_offsets[n]; i < node_elements_offsets[n + 1]; ++i)
+					{
+						const int c = element_color[node_elements[i]];
+						if (c >= 0)
+							forbidden[c] = e;
+					}
+				}
+
+				int color = 0;
+				while (color < int(forbidden.size()) && forbidden[color] == e)
+					++color;
+				if (color == int(forbidden.size()))
+				{
+					forbidden.push_back(-1);
+					colors_.emplace_back();
+				}
+
+				element_color[e] = color;
+				colors_[color].push_back(e);
+			}
+		}
+
+		//neighbours of every node
+		std::vector<std::vector<int>> neighbours(n_basis);
+		const auto collect_neighbours = [&](const int n) {
+			std::vector<int> &neigh = neighbours[n];
+			for (int i = node_elements_offsets[n]; i < node_elements_offsets[n + 1]; ++i)
+			{
+				const std::vector<int> &nodes = element_nodes[node_elements[i]];
+				neigh.insert(neigh.end(), nodes.begin(), nodes.end());
+			}
+			std::sort(neigh.begin(), neigh.end());
+			neigh.erase(std::unique(neigh.begin(), neigh.end()), neigh.end());
+			//upper triangle, the rows of column n are the neighbours up to n
+			if (symmetric)
+				neigh.erase(std::upper_bound(neigh.begin(), neigh.end(), n), neigh.end());
+		};
+
+#ifdef POLYFEM_WITH_TBB
+		tbb::parallel_for(tbb::blocked_range<int>(0, n_basis), [&](const tbb::blocked_range<int> &r) {
+			for (int n = r.begin(); n != r.end(); ++n)
+				collect_neighbours(n);
+		});
+#else
+		for (int n = 0; n < n_basis; ++n)
+			collect_neighbours(n);
+#endif
+
+		offsets_.resize(n_basis + 1);
+		value_offsets_.resize(n_basis + 1);
+		offsets_[0] = 0;
+		value_offsets_[0] = 0;
+		for (int n = 0; n < n_basis; ++n)
+		{
+			const long degree = long(neighbours[n].size());
+			offsets_[n + 1] = offsets_[n] + degree;
+
+			//in the symmetric case the diagonal block only has its upper triangle
+			long n_values = long(size) * size * degree;
+			if (symmetric && degree > 0)
+				n_values -= long(size) * (size - 1) / 2;
+			value_offsets_[n + 1] = value_offsets_[n] + n_values;
+		}
+
+		adjacency_.resize(offsets_.back());
+		for (int n = 0; n < n_basis; ++n)
+		{
+			std::copy(neighbours[n].begin(), neighbours[n].end(), adjacency_.begin() + offsets_[n]);
+			std::vector<int>().swap(neighbours[n]);
+		}
+
+		logger().debug("sparsity pattern: {} nodes, {} couplings, {} non zeros{}, {} colors", n_basis, adjacency_.size(), non_zeros(), symmetric ? " (upper triangle)" : "", n_colors());
+	}
+
+	void SparsityPattern::clear()
+	{
+		n_basis_ = 0;
+		size_ = 0;
+		symmetric_ = false;
+		adjacency_.clear();
+		offsets_.clear();
+		value_offsets_.clear();
+		colors_.clear();
+	}
+
+	void SparsityPattern::create_matrix(StiffnessMatrix &mat) const
+	{
+		typedef StiffnessMatrix::StorageIndex StorageIndex;
+
+		const int n = rows();
+		mat.resize(n, n);
+		mat.resizeNonZeros(non_zeros());
+
+		StorageIndex *outer = mat.outerIndexPtr();
+		StorageIndex *inner = mat.innerIndexPtr();
+
+		for (int node_j = 0; node_j < n_basis_; ++node_j)
+		{
+			const long offset = offsets_[node_j];
+			const long degree = offsets_[node_j + 1] - offset;
+
+			for (int c = 0; c < size_; ++c)
+			{
+				long index = degree > 0 ? value_index(offset, node_j, 0, c) : value_offsets_[node_j];
+				outer[node_j * size_ + c] = StorageIndex(index);
+
+				for (long k = offset; k < offset + degree; ++k)
+				{
+					const int node_i = adjacency_[k];
+					for (int m = 0; m < size_ && stores(node_i, node_j, m, c); ++m)
+						inner[index++] = StorageIndex(node_i * size_ + m);
+				}
+			}
+		}
+		outer[n] = StorageIndex(non_zeros());
+
+		std::fill(mat.valuePtr(), mat.valuePtr() + non_zeros(), 0.0);
+	}
+
+	bool SparsityPattern::matches(const StiffnessMatrix &mat) const
+	{
+		if (empty() || mat.rows() != rows() || mat.cols() != rows() || !mat.isCompressed() || mat.nonZeros() != non_zeros())
+			return false;
+
+		const auto *outer = mat.outerIndexPtr();
+		const auto *inner = mat.innerIndexPtr();
+
+		for (int node_j = 0; node_j < n_basis_; ++node_j)
+		{
+			const long offset = offsets_[node_j];
+			const long degree = offsets_[node_j + 1] - offset;
+
+			for (int c = 0; c < size_; ++c)
+			{
+				long index = degree > 0 ? value_index(offset, node_j, 0, c) : value_offsets_[node_j];
+				if (outer[node_j * size_ + c] != index)
+					return false;
+
+				for (long k = offset; k < offset + degree; ++k)
+				{
+					const int node_i = adjacency_[k];
+					for (int m = 0; m < size_ && stores(node_i, node_j, m, c); ++m)
+					{
+						if (inner[index++] != node_i * size_ + m)
+							return false;
+					}
+				}
+			}
+		}
+
+		return true;
+	}
+
+	long SparsityPattern::find(const int node_i, const int node_j) const
+	{
+		const auto begin = adjacency_.begin() + offsets_[node_j];
+		const auto end = adjacency_.begin() + offsets_[node_j + 1];
+		const auto it = std::lower_bound(begin, end, node_i);
+
+		if (it == end || *it != node_i)
+			return -1;
+
+		return long(it - adjacency_.begin());
+	}
+} // namespace polyfem
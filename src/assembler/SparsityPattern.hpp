@@ -0,0 +1,77 @@
+#pragma once
+
+#include <polyfem/ElementBases.hpp>
+#include <polyfem/Types.hpp>
+
+#include <Eigen/Sparse>
+#include <vector>
+
+namespace polyfem
+{
+	//compressed sparsity pattern of a global matrix built from the element to dof maps
+	//two nodes are coupled if they share an element, every coupling is a dense size x size block
+	//the pattern is computed once and element matrices are scattered directly into the value array
+	//elements are colored so that two elements of the same color share no node and can be scattered concurrently
+	class SparsityPattern
+	{
+	public:
+		//builds the pattern for n_basis nodes with size components each
+		//if symmetric only the upper triangle (row <= col) is stored
+		void init(const int n_basis, const int size, const std::vector<ElementBases> &bases, const bool symmetric = false);
+		void clear();
+
+		inline bool empty() const { return offsets_.empty(); }
+		inline bool is_symmetric() const { return symmetric_; }
+		inline int n_basis() const { return n_basis_; }
+		inline int size() const { return size_; }
+		inline int rows() const { return n_basis_ * size_; }
+		inline long non_zeros() const { return empty() ? 0 : value_offsets_.back(); }
+
+		//elements grouped by color, elements of the same color have no node in common
+		inline const std::vector<std::vector<int>> &colors() const { return colors_; }
+		inline int n_colors() const { return int(colors_.size()); }
+
+		//sorted neighbours of every node, they are both the rows and the columns coupled to it
+		//for a symmetric pattern only the neighbours up to the node itself, ie the rows of its column
+		inline const std::vector<long> &offsets() const { return offsets_; }
+		inline const std::vector<int> &adjacency() const { return adjacency_; }
+
+		//creates a compressed matrix with this pattern and zero values
+		void create_matrix(StiffnessMatrix &mat) const;
+		//true if mat is compressed and has exactly this pattern
+		bool matches(const StiffnessMatrix &mat) const;
+
+		//position of node_i in the list of neighbours of node_j, -1 if they are not coupled (or node_i > node_j if symmetric)
+		long find(const int node_i, const int node_j) const;
+
+		//true if the entry (node_i*size+m, node_j*size+n) is stored
+		inline bool stores(const int node_i, const int node_j, const int m, const int n) const
+		{
+			return !symmetric_ || node_i < node_j || (node_i == node_j && m <= n);
+		}
+
+		//index in the value array of the entry (node_i*size+m, node_j*size+n), pos is the output of find(node_i, node_j)
+		//if symmetric the diagonal block of node_j is the last in its column and only has the rows m <= n
+		inline long value_index(const long pos, const int node_j, const int m, const int n) const
+		{
+			const long offset = offsets_[node_j];
+			const long degree = offsets_[node_j + 1] - offset;
+			if (symmetric_)
+				return value_offsets_[node_j] + size_ * (n * (degree - 1) + pos - offset) + n * (n + 1) / 2 + m;
+			return value_offsets_[node_j] + size_ * (n * degree + pos - offset) + m;
+		}
+
+	private:
+		int n_basis_ = 0;
+		int size_ = 0;
+
+		//sorted neighbours of every node, node j is in [offsets_[j], offsets_[j+1])
+		std::vector<int> adjacency_;
+		std::vector<long> offsets_;
+		//first value of the columns of node j
+		std::vector<long> value_offsets_;
+		bool symmetric_ = false;
+
+		std::vector<std::vector<int>> colors_;
+	};
+} // namespace polyfem
@@ -0,0 +1,174 @@
+#include <polyfem/SumFactorization.hpp>
+
+#include <polyfem/QuadratureCache.hpp>
+#include <polyfem/auto_q_bases.hpp>
+
+#include <cassert>
+#include <cmath>
+
+namespace polyfem
+{
+	void HexSumFactorization::init(const int q, const int quadrature_order)
+	{
+		assert(q >= 1);
+
+		order_ = q;
+		quadrature_order_ = quadrature_order;
+		n1_ = q + 1;
+
+		const Quadrature &quad = QuadratureCache::line(quadrature_order);
+		nq1_ = int(quad.weights.size());
+
+		//lagrange bases on the equispaced nodes j/q, as in q_bases.py
+		B_.resize(nq1_, n1_);
+		D_.resize(nq1_, n1_);
+		for (int k = 0; k < nq1_; ++k)
+		{
+			const double x = quad.points(k, 0);
+			for (int j = 0; j < n1_; ++j)
+			{
+				const double xj = double(j) / q;
+				double val = 1;
+				double der = 0;
+				for (int m = 0; m < n1_; ++m)
+				{
+					if (m == j)
+						continue;
+					const double xm = double(m) / q;
+					der = der * (x - xm) / (xj - xm) + val / (xj - xm);
+					val *= (x - xm) / (xj - xm);
+				}
+				B_(k, j) = val;
+				D_(k, j) = der;
+			}
+		}
+
+		weights_.resize(n_quadrature_points());
+		for (int i = 0; i < nq1_; ++i)
+		{
+			for (int j = 0; j < nq1_; ++j)
+			{
+				for (int k = 0; k < nq1_; ++k)
+					weights_((i * nq1_ + j) * nq1_ + k) = quad.weights(i) * quad.weights(j) * quad.weights(k);
+			}
+		}
+
+		Eigen::MatrixXd nodes;
+		autogen::q_nodes_3d(q, nodes);
+		assert(nodes.rows() == n_bases());
+
+		lattice_to_local_.assign(n_bases(), -1);
+		for (int i = 0; i < nodes.rows(); ++i)
+		{
+			const int a = int(std::round(nodes(i, 0) * q));
+			const int b = int(std::round(nodes(i, 1) * q));
+			const int c = int(std::round(nodes(i, 2) * q));
+			lattice_to_local_[a + n1_ * (b + n1_ * c)] = i;
+		}
+	}
+
+	void HexSumFactorization::apply_1d(const Eigen::MatrixXd &M, const int dir, const std::array<int, 3> &dims, const int k, const double *in, double *out)
+	{
+		assert(M.cols() == dims[dir]);
+
+		std::array<int, 3> out_dims = dims;
+		out_dims[dir] = int(M.rows());
+
+		const int in_size = dims[0] * dims[1] * dims[2];
+		const int out_size = out_dims[0] * out_dims[1] * out_dims[2];
+		const int in_stride = dir == 0 ? 1 : (dir == 1 ? dims[0] : dims[0] * dims[1]);
+
+		for (int c = 0; c < k; ++c)
+		{
+			const double *in_c = in + c * in_size;
+			double *out_c = out + c * out_size;
+
+			for (int i2 = 0; i2 < out_dims[2]; ++i2)
+			{
+				for (int i1 = 0; i1 < out_dims[1]; ++i1)
+				{
+					for (int i0 = 0; i0 < out_dims[0]; ++i0)
+					{
+						const std::array<int, 3> index = {{i0, i1, i2}};
+						const int o = index[dir];
+
+						std::array<int, 3> in_index = index;
+						in_index[dir] = 0;
+						const double *in_line = in_c + in_index[0] + dims[0] * (in_index[1] + dims[1] * in_index[2]);
+
+						double sum = 0;
+						for (int j = 0; j < dims[dir]; ++j)
+							sum += M(o, j) * in_line[j * in_stride];
+
+						out_c[i0 + out_dims[0] * (i1 + out_dims[1] * i2)] = sum;
+					}
+				}
+			}
+		}
+	}
+
+	void HexSumFactorization::interpolate(const Eigen::MatrixXd &coeffs, Eigen::MatrixXd &val, std::array<Eigen::MatrixXd, 3> &grad) const
+	{
+		assert(coeffs.rows() == n_bases());
+		const int k = int(coeffs.cols());
+		const int n = n1_;
+		const int nq = nq1_;
+
+		Eigen::MatrixXd u(n_bases(), k);
+		for (int i = 0; i < n_bases(); ++i)
+			u.row(i) = coeffs.row(lattice_to_local_[i]);
+
+		//x direction
+		Eigen::MatrixXd bx(nq * n * n, k), dx(nq * n * n, k);
+		apply_1d(B_, 0, {{n, n, n}}, k, u.data(), bx.data());
+		apply_1d(D_, 0, {{n, n, n}}, k, u.data(), dx.data());
+
+		//y direction
+		Eigen::MatrixXd bxby(nq * nq * n, k), bxdy(nq * nq * n, k), dxby(nq * nq * n, k);
+		apply_1d(B_, 1, {{nq, n, n}}, k, bx.data(), bxby.data());
+		apply_1d(D_, 1, {{nq, n, n}}, k, bx.data(), bxdy.data());
+		apply_1d(B_, 1, {{nq, n, n}}, k, dx.data(), dxby.data());
+
+		//z direction
+		val.resize(n_quadrature_points(), k);
+		for (auto &g : grad)
+			g.resize(n_quadrature_points(), k);
+		apply_1d(B_, 2, {{nq, nq, n}}, k, bxby.data(), val.data());
+		apply_1d(D_, 2, {{nq, nq, n}}, k, bxby.data(), grad[2].data());
+		apply_1d(B_, 2, {{nq, nq, n}}, k, bxdy.data(), grad[1].data());
+		apply_1d(B_, 2, {{nq, nq, n}}, k, dxby.data(), grad[0].data());
+	}
+
+	void HexSumFactorization::integrate_grad(const std::array<Eigen::MatrixXd, 3> &g, Eigen::MatrixXd &res) const
+	{
+		const int k = int(g[0].cols());
+		const int n = n1_;
+		const int nq = nq1_;
+
+		const Eigen::MatrixXd Bt = B_.transpose();
+		const Eigen::MatrixXd Dt = D_.transpose();
+
+		//z direction
+		Eigen::MatrixXd zx(nq * nq * n, k), zy(nq * nq * n, k), zz(nq * nq * n, k);
+		apply_1d(Bt, 2, {{nq, nq, nq}}, k, g[0].data(), zx.data());
+		apply_1d(Bt, 2, {{nq, nq, nq}}, k, g[1].data(), zy.data());
+		apply_1d(Dt, 2, {{nq, nq, nq}}, k, g[2].data(), zz.data());
+
+		//y direction, the y and z contributions share the x direction
+		Eigen::MatrixXd yx(nq * n * n, k), yyz(nq * n * n, k), tmp(nq * n * n, k);
+		apply_1d(Bt, 1, {{nq, nq, n}}, k, zx.data(), yx.data());
+		apply_1d(Dt, 1, {{nq, nq, n}}, k, zy.data(), yyz.data());
+		apply_1d(Bt, 1, {{nq, nq, n}}, k, zz.data(), tmp.data());
+		yyz += tmp;
+
+		//x direction
+		Eigen::MatrixXd u(n_bases(), k), utmp(n_bases(), k);
+		apply_1d(Dt, 0, {{nq, n, n}}, k, yx.data(), u.data());
+		apply_1d(Bt, 0, {{nq, n, n}}, k, yyz.data(), utmp.data());
+		u += utmp;
+
+		res.resize(n_bases(), k);
+		for (int i = 0; i < n_bases(); ++i)
+			res.row(lattice_to_local_[i]) = u.row(i);
+	}
+} // namespace polyfem
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <polyfem/Types.hpp>
+
+#include <Eigen/Dense>
+#include <array>
+#include <vector>
+
+namespace polyfem
+{
+	//sum factorization for the tensor product Q_k lagrange bases on hexes with the tensor product HexQuadrature
+	//values and gradients at the quadrature points are computed one direction at the time with 1d matrices,
+	//this costs O(p^4) per element instead of O(p^6) for the dense bases x quadrature points product
+	class HexSumFactorization
+	{
+	public:
+		//tabulates the 1d lagrange bases of order q at the 1d quadrature of order quadrature_order
+		void init(const int q, const int quadrature_order);
+
+		inline int order() const { return order_; }
+		inline int quadrature_order() const { return quadrature_order_; }
+		inline int n_bases() const { return n1_ * n1_ * n1_; }
+		inline int n_quadrature_points() const { return nq1_ * nq1_ * nq1_; }
+		//weights of the quadrature points, same order as HexQuadrature
+		inline const Eigen::VectorXd &weights() const { return weights_; }
+
+		//values (n_quad x k) and reference gradients (3 x n_quad x k) of k fields given by their local coefficients (n_bases x k)
+		void interpolate(const Eigen::MatrixXd &coeffs, Eigen::MatrixXd &val, std::array<Eigen::MatrixXd, 3> &grad) const;
+		//transpose of the gradient interpolation: res(i, c) = sum_q sum_d dphi_i/dx_d(q) g[d](q, c)
+		void integrate_grad(const std::array<Eigen::MatrixXd, 3> &g, Eigen::MatrixXd &res) const;
+
+	private:
+		//applies the 1d matrix M along direction dir of a tensor with sizes dims (x fastest), k times
+		static void apply_1d(const Eigen::MatrixXd &M, const int dir, const std::array<int, 3> &dims, const int k, const double *in, double *out);
+
+		int order_ = -1;
+		int quadrature_order_ = -1;
+		int n1_ = 0;
+		int nq1_ = 0;
+
+		//1d values and derivatives, nq1 x n1
+		Eigen::MatrixXd B_, D_;
+		Eigen::VectorXd weights_;
+
+		//local index of the basis at lattice position a + n1*(b + n1*c)
+		std::vector<int> lattice_to_local_;
+	};
+} // namespace polyfem
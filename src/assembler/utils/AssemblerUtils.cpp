@@ -57,12 +57,57 @@ namespace polyfem
 		return assembler != "SaintVenant" && assembler != "NeoHookean" && assembler != "NavierStokes" /*&& assembler != "Ogden"*/;
 	}
 
+	bool AssemblerUtils::is_matrix_free(const std::string &assembler)
+	{
+		return assembler == "Laplacian" || assembler == "LinearElasticity" || assembler == "HookeLinearElasticity";
+	}
+
+	void AssemblerUtils::assemble_problem(const std::string &assembler,
+										  const bool is_volume,
+										  const int n_basis,
+										  const std::vector<ElementBases> &bases,
+										  const std::vector<ElementBases> &gbases,
+										  StiffnessMatrix &stiffness,
+										  const bool symmetric) const
+	{
+		if (assembler == "Helmholtz")
+			helmholtz_.assemble(is_volume, n_basis, bases, gbases, stiffness, symmetric);
+		else if (assembler == "Laplacian")
+			laplacian_.assemble(is_volume, n_basis, bases, gbases, stiffness, symmetric);
+		else if (assembler == "Bilaplacian")
+			bilaplacian_main_.assemble(is_volume, n_basis, bases, gbases, stiffness, symmetric);
+
+		else if (assembler == "LinearElasticity")
+			linear_elasticity_.assemble(is_volume, n_basis, bases, gbases, stiffness, symmetric);
+		else if (assembler == "HookeLinearElasticity")
+			hooke_linear_elasticity_.assemble(is_volume, n_basis, bases, gbases, stiffness, symmetric);
+		else if (assembler == "Stokes" || assembler == "NavierStokes")
+			stokes_velocity_.assemble(is_volume, n_basis, bases, gbases, stiffness, symmetric);
+		else if (assembler == "IncompressibleLinearElasticity")
+			incompressible_lin_elast_displacement_.assemble(is_volume, n_basis, bases, gbases, stiffness, symmetric);
+
+		else if (assembler == "SaintVenant")
+			return;
+		else if (assembler == "NeoHookean")
+			return;
+		// else if (assembler == "NavierStokes")
+		// return;
+		//else if(assembler == "Ogden")
+		//	return;
+		else
+		{
+			logger().warn("{} not found, fallback to default", assembler);
+			assert(false);
+			laplacian_.assemble(is_volume, n_basis, bases, gbases, stiffness, symmetric);
+		}
+	}
+
 	void AssemblerUtils::assemble_problem(const std::string &assembler,
 										  const bool is_volume,
 										  const int n_basis,
 										  const std::vector<ElementBases> &bases,
 										  const std::vector<ElementBases> &gbases,
-										  StiffnessMatrix &stiffness) const
+										  BlockSparseMatrix &stiffness) const
 	{
 		if (assembler == "Helmholtz")
 			helmholtz_.assemble(is_volume, n_basis, bases, gbases, stiffness);
@@ -84,10 +129,6 @@ namespace polyfem
 			return;
 		else if (assembler == "NeoHookean")
 			return;
-		// else if (assembler == "NavierStokes")
-		// return;
-		//else if(assembler == "Ogden")
-		//	return;
 		else
 		{
 			logger().warn("{} not found, fallback to default", assembler);
@@ -96,6 +137,47 @@ namespace polyfem
 		}
 	}
 
+	void AssemblerUtils::apply_problem(const std::string &assembler,
+									   const bool is_volume,
+									   const int n_basis,
+									   const std::vector<ElementBases> &bases,
+									   const std::vector<ElementBases> &gbases,
+									   const Eigen::VectorXd &x,
+									   Eigen::VectorXd &y) const
+	{
+		if (assembler == "Laplacian")
+			laplacian_.apply(is_volume, n_basis, bases, gbases, x, y);
+		else if (assembler == "LinearElasticity")
+			linear_elasticity_.apply(is_volume, n_basis, bases, gbases, x, y);
+		else if (assembler == "HookeLinearElasticity")
+			hooke_linear_elasticity_.apply(is_volume, n_basis, bases, gbases, x, y);
+		else
+		{
+			logger().error("{} does not support matrix-free products", assembler);
+			assert(false);
+		}
+	}
+
+	void AssemblerUtils::assemble_problem_diagonal(const std::string &assembler,
+												   const bool is_volume,
+												   const int n_basis,
+												   const std::vector<ElementBases> &bases,
+												   const std::vector<ElementBases> &gbases,
+												   Eigen::VectorXd &diag) const
+	{
+		if (assembler == "Laplacian")
+			laplacian_.assemble_diagonal(is_volume, n_basis, bases, gbases, diag);
+		else if (assembler == "LinearElasticity")
+			linear_elasticity_.assemble_diagonal(is_volume, n_basis, bases, gbases, diag);
+		else if (assembler == "HookeLinearElasticity")
+			hooke_linear_elasticity_.assemble_diagonal(is_volume, n_basis, bases, gbases, diag);
+		else
+		{
+			logger().error("{} does not support matrix-free products", assembler);
+			assert(false);
+		}
+	}
+
 	void AssemblerUtils::assemble_mass_matrix(const std::string &assembler,
 											  const bool is_volume,
 											  const int n_basis,
@@ -110,6 +192,20 @@ namespace polyfem
 			mass_mat_assembler_.assemble(is_volume, is_volume ? 3 : 2, n_basis, density, bases, gbases, mass);
 	}
 
+	void AssemblerUtils::assemble_lumped_mass_matrix(const std::string &assembler,
+													 const bool is_volume,
+													 const int n_basis,
+													 const Density &density,
+													 const std::vector<ElementBases> &bases,
+													 const std::vector<ElementBases> &gbases,
+													 Eigen::VectorXd &mass) const
+	{
+		if (assembler == "Helmholtz" || assembler == "Laplacian")
+			mass_mat_assembler_.assemble_lumped(is_volume, 1, n_basis, density, bases, gbases, mass);
+		else
+			mass_mat_assembler_.assemble_lumped(is_volume, is_volume ? 3 : 2, n_basis, density, bases, gbases, mass);
+	}
+
 	void AssemblerUtils::assemble_mixed_problem(const std::string &assembler,
 												const bool is_volume,
 												const int n_psi_basis,
@@ -198,6 +294,26 @@ namespace polyfem
 			return;
 	}
 
+	void AssemblerUtils::assemble_energy_gradient(const std::string &assembler,
+												  const bool is_volume,
+												  const int n_basis,
+												  const std::vector<ElementBases> &bases,
+												  const std::vector<ElementBases> &gbases,
+												  const Eigen::MatrixXd &displacement,
+												  double &energy,
+												  Eigen::MatrixXd &grad) const
+	{
+		if (assembler == "SaintVenant")
+			saint_venant_elasticity_.assemble_energy_grad(is_volume, n_basis, bases, gbases, displacement, energy, grad);
+		else if (assembler == "NeoHookean")
+			neo_hookean_elasticity_.assemble_energy_grad(is_volume, n_basis, bases, gbases, displacement, energy, grad);
+		else
+		{
+			energy = assemble_energy(assembler, is_volume, bases, gbases, displacement);
+			assemble_energy_gradient(assembler, is_volume, n_basis, bases, gbases, displacement, grad);
+		}
+	}
+
 	void AssemblerUtils::assemble_energy_hessian(const std::string &assembler,
 												 const bool is_volume,
 												 const int n_basis,
@@ -221,6 +337,52 @@ namespace polyfem
 			return;
 	}
 
+	void AssemblerUtils::assemble_energy_hessian(const std::string &assembler,
+												 const bool is_volume,
+												 const int n_basis,
+												 const bool project_to_psd,
+												 const std::vector<ElementBases> &bases,
+												 const std::vector<ElementBases> &gbases,
+												 const SparsityPattern &pattern,
+												 const Eigen::MatrixXd &displacement,
+												 StiffnessMatrix &hessian) const
+	{
+		if (assembler == "SaintVenant")
+			saint_venant_elasticity_.assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, pattern, displacement, hessian);
+		else if (assembler == "NeoHookean")
+			neo_hookean_elasticity_.assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, pattern, displacement, hessian);
+		else if (assembler == "NavierStokesPicard")
+			navier_stokes_velocity_picard_.assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, pattern, displacement, hessian);
+		else if (assembler == "NavierStokes")
+			navier_stokes_velocity_.assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, pattern, displacement, hessian);
+		else
+			return;
+	}
+
+	void AssemblerUtils::assemble_energy_all(const std::string &assembler,
+											 const bool is_volume,
+											 const int n_basis,
+											 const bool project_to_psd,
+											 const std::vector<ElementBases> &bases,
+											 const std::vector<ElementBases> &gbases,
+											 const SparsityPattern &pattern,
+											 const Eigen::MatrixXd &displacement,
+											 double &energy,
+											 Eigen::MatrixXd &grad,
+											 StiffnessMatrix &hessian) const
+	{
+		if (assembler == "SaintVenant")
+			saint_venant_elasticity_.assemble_all(is_volume, n_basis, project_to_psd, bases, gbases, pattern, displacement, energy, grad, hessian);
+		else if (assembler == "NeoHookean")
+			neo_hookean_elasticity_.assemble_all(is_volume, n_basis, project_to_psd, bases, gbases, pattern, displacement, energy, grad, hessian);
+		else
+		{
+			energy = assemble_energy(assembler, is_volume, bases, gbases, displacement);
+			assemble_energy_gradient(assembler, is_volume, n_basis, bases, gbases, displacement, grad);
+			assemble_energy_hessian(assembler, is_volume, n_basis, project_to_psd, bases, gbases, pattern, displacement, hessian);
+		}
+	}
+
 	void AssemblerUtils::compute_scalar_value(const std::string &assembler,
 											  const int el_id,
 											  const ElementBases &bs,
@@ -404,6 +566,26 @@ namespace polyfem
 		neo_hookean_elasticity_.clear_cache();
 		// ogden_elasticity_.clear_cache();
 		linear_elasticity_energy_.clear_cache();
+		navier_stokes_velocity_.clear_cache();
+		navier_stokes_velocity_picard_.clear_cache();
+	}
+
+	void AssemblerUtils::set_cache_max_memory(const double max_memory_mb)
+	{
+		saint_venant_elasticity_.set_cache_max_memory(max_memory_mb);
+		neo_hookean_elasticity_.set_cache_max_memory(max_memory_mb);
+		linear_elasticity_energy_.set_cache_max_memory(max_memory_mb);
+		navier_stokes_velocity_.set_cache_max_memory(max_memory_mb);
+		navier_stokes_velocity_picard_.set_cache_max_memory(max_memory_mb);
+	}
+
+	void AssemblerUtils::set_quadrature_psd_projection(const bool val)
+	{
+		saint_venant_elasticity_.set_quadrature_psd_projection(val);
+		neo_hookean_elasticity_.set_quadrature_psd_projection(val);
+		linear_elasticity_energy_.set_quadrature_psd_projection(val);
+		navier_stokes_velocity_.set_quadrature_psd_projection(val);
+		navier_stokes_velocity_picard_.set_quadrature_psd_projection(val);
 	}
 
 	void AssemblerUtils::init_multimaterial(const Eigen::MatrixXd &Es, const Eigen::MatrixXd &nus)
@@ -31,12 +31,36 @@ namespace polyfem
 		AssemblerUtils();
 
 		//Linear, assembler is the name of the formulation
+		//if symmetric only the upper triangle is assembled
 		void assemble_problem(const std::string &assembler,
 							  const bool is_volume,
 							  const int n_basis,
 							  const std::vector<ElementBases> &bases,
 							  const std::vector<ElementBases> &gbases,
-							  StiffnessMatrix &stiffness) const;
+							  StiffnessMatrix &stiffness,
+							  const bool symmetric = false) const;
+		//same as above in block sparse storage, for vector problems
+		void assemble_problem(const std::string &assembler,
+							  const bool is_volume,
+							  const int n_basis,
+							  const std::vector<ElementBases> &bases,
+							  const std::vector<ElementBases> &gbases,
+							  BlockSparseMatrix &stiffness) const;
+		//matrix-free product y = K x of the linear problem, assembler is the name of the formulation
+		void apply_problem(const std::string &assembler,
+						   const bool is_volume,
+						   const int n_basis,
+						   const std::vector<ElementBases> &bases,
+						   const std::vector<ElementBases> &gbases,
+						   const Eigen::VectorXd &x,
+						   Eigen::VectorXd &y) const;
+		//diagonal of the linear problem without assembling it, assembler is the name of the formulation
+		void assemble_problem_diagonal(const std::string &assembler,
+									   const bool is_volume,
+									   const int n_basis,
+									   const std::vector<ElementBases> &bases,
+									   const std::vector<ElementBases> &gbases,
+									   Eigen::VectorXd &diag) const;
 		//mass matrix assembler, assembler is the name of the formulation
 		void assemble_mass_matrix(const std::string &assembler,
 								  const bool is_volume,
@@ -45,6 +69,14 @@ namespace polyfem
 								  const std::vector<ElementBases> &bases,
 								  const std::vector<ElementBases> &gbases,
 								  StiffnessMatrix &mass) const;
+		//diagonal lumped mass, one entry per dof, assembler is the name of the formulation
+		void assemble_lumped_mass_matrix(const std::string &assembler,
+										 const bool is_volume,
+										 const int n_basis,
+										 const Density &density,
+										 const std::vector<ElementBases> &bases,
+										 const std::vector<ElementBases> &gbases,
+										 Eigen::VectorXd &mass) const;
 
 		//mixed assembler phi is the tensor, psi the scalar, assembler is the name of the formulation
 		void assemble_mixed_problem(const std::string &assembler,
@@ -78,6 +110,15 @@ namespace polyfem
 									  const std::vector<ElementBases> &gbases,
 									  const Eigen::MatrixXd &displacement,
 									  Eigen::MatrixXd &grad) const;
+		//non linear energy and gradient in one pass over the elements, assembler is the name of the formulation
+		void assemble_energy_gradient(const std::string &assembler,
+									  const bool is_volume,
+									  const int n_basis,
+									  const std::vector<ElementBases> &bases,
+									  const std::vector<ElementBases> &gbases,
+									  const Eigen::MatrixXd &displacement,
+									  double &energy,
+									  Eigen::MatrixXd &grad) const;
 		//non-linear hessian, assembler is the name of the formulation
 		void assemble_energy_hessian(const std::string &assembler,
 									 const bool is_volume,
@@ -87,6 +128,28 @@ namespace polyfem
 									 const std::vector<ElementBases> &gbases,
 									 const Eigen::MatrixXd &displacement,
 									 StiffnessMatrix &hessian) const;
+		//non-linear hessian refilled in place on a fixed pattern, assembler is the name of the formulation
+		void assemble_energy_hessian(const std::string &assembler,
+									 const bool is_volume,
+									 const int n_basis,
+									 const bool project_to_psd,
+									 const std::vector<ElementBases> &bases,
+									 const std::vector<ElementBases> &gbases,
+									 const SparsityPattern &pattern,
+									 const Eigen::MatrixXd &displacement,
+									 StiffnessMatrix &hessian) const;
+		//non-linear energy, gradient, and hessian on a fixed pattern in one pass over the elements, assembler is the name of the formulation
+		void assemble_energy_all(const std::string &assembler,
+								 const bool is_volume,
+								 const int n_basis,
+								 const bool project_to_psd,
+								 const std::vector<ElementBases> &bases,
+								 const std::vector<ElementBases> &gbases,
+								 const SparsityPattern &pattern,
+								 const Eigen::MatrixXd &displacement,
+								 double &energy,
+								 Eigen::MatrixXd &grad,
+								 StiffnessMatrix &hessian) const;
 
 		//plotting (eg von mises), assembler is the name of the formulation
 		void compute_scalar_value(const std::string &assembler,
@@ -126,6 +189,8 @@ namespace polyfem
 
 		//checks if assembler is linear
 		static bool is_linear(const std::string &assembler);
+		//checks if assembler supports matrix-free products
+		static bool is_matrix_free(const std::string &assembler);
 
 		//checks if assembler solution is displacement (true for elasticty)
 		static bool is_solution_displacement(const std::string &assembler);
@@ -144,8 +209,12 @@ namespace polyfem
 		static std::vector<std::string> tensor_assemblers();
 		// const std::vector<std::string> &mixed_assemblers() const { return mixed_assemblers_; }
 
-		//not used
+		//clears the per element assembly values cached by the non-linear assemblers, the matrix-free product does not store them
 		void clear_cache();
+		//memory budget in MB of each assembler cache, 0 (the default of assembly_cache_max_memory) disables them
+		void set_cache_max_memory(const double max_memory_mb);
+		//with project_to_psd, project the non linear hessians per quadrature point instead of per element (if supported)
+		void set_quadrature_psd_projection(const bool val);
 
 		//utility to merge 3 blocks of mixed matrices, A=velocity_stiffness, B=mixed_stiffness, and C=pressure_stiffness
 		// A   B
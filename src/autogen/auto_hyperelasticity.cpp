@@ -0,0 +1,666 @@
+#include <polyfem/auto_hyperelasticity.hpp>
+
+#include <cmath>
+
+namespace polyfem {
+namespace autogen {
+double saint_venant_2d_energy(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const ElasticityTensor &C) {
+const auto helper_0 = F(0,0)*F(0,1) + F(1,0)*F(1,1);
+const auto helper_1 = pow(F(0,0), 2) + pow(F(1,0), 2) - 1;
+const auto helper_2 = pow(F(0,1), 2) + pow(F(1,1), 2) - 1;
+const auto helper_3 = 2*helper_0;
+return (1.0/4.0)*helper_0*(C(0,2)*helper_1 + C(1,2)*helper_2 + C(2,2)*helper_3) + (1.0/8.0)*helper_1*(C(0,0)*helper_1 + C(0,1)*helper_2 + C(0,2)*helper_3) + (1.0/8.0)*helper_2*(C(0,1)*helper_1 + C(1,1)*helper_2 + C(1,2)*helper_3);
+}
+
+void saint_venant_2d_stress(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const ElasticityTensor &C, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &res) {
+res.resize(2, 2);
+const auto helper_0 = pow(F(0,0), 2) + pow(F(1,0), 2) - 1;
+const auto helper_1 = C(1,2)*F(0,1);
+const auto helper_2 = pow(F(0,1), 2) + pow(F(1,1), 2) - 1;
+const auto helper_3 = C(0,2)*F(0,0);
+const auto helper_4 = 2*F(0,0)*F(0,1) + 2*F(1,0)*F(1,1);
+const auto helper_5 = C(0,0)*helper_0 + C(0,1)*helper_2 + C(0,2)*helper_4;
+const auto helper_6 = C(0,2)*helper_0 + C(1,2)*helper_2 + C(2,2)*helper_4;
+const auto helper_7 = C(1,2)*F(1,1);
+const auto helper_8 = C(0,2)*F(1,0);
+const auto helper_9 = C(0,1)*helper_0 + C(1,1)*helper_2 + C(1,2)*helper_4;
+res(0) = (1.0/4.0)*F(0,0)*helper_5 + (1.0/4.0)*F(0,1)*helper_6 + (1.0/4.0)*helper_0*(C(0,0)*F(0,0) + C(0,2)*F(0,1)) + (1.0/4.0)*helper_2*(C(0,1)*F(0,0) + helper_1) + (1.0/4.0)*helper_4*(C(2,2)*F(0,1) + helper_3);
+res(1) = (1.0/4.0)*F(1,0)*helper_5 + (1.0/4.0)*F(1,1)*helper_6 + (1.0/4.0)*helper_0*(C(0,0)*F(1,0) + C(0,2)*F(1,1)) + (1.0/4.0)*helper_2*(C(0,1)*F(1,0) + helper_7) + (1.0/4.0)*helper_4*(C(2,2)*F(1,1) + helper_8);
+res(2) = (1.0/4.0)*F(0,0)*helper_6 + (1.0/4.0)*F(0,1)*helper_9 + (1.0/4.0)*helper_0*(C(0,1)*F(0,1) + helper_3) + (1.0/4.0)*helper_2*(C(1,1)*F(0,1) + C(1,2)*F(0,0)) + (1.0/4.0)*helper_4*(C(2,2)*F(0,0) + helper_1);
+res(3) = (1.0/4.0)*F(1,0)*helper_6 + (1.0/4.0)*F(1,1)*helper_9 + (1.0/4.0)*helper_0*(C(0,1)*F(1,1) + helper_8) + (1.0/4.0)*helper_2*(C(1,1)*F(1,1) + C(1,2)*F(1,0)) + (1.0/4.0)*helper_4*(C(2,2)*F(1,0) + helper_7);
+}
+
+void saint_venant_2d_stress_grad(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const ElasticityTensor &C, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 9, 9> &res) {
+res.resize(4, 4);
+const auto helper_0 = C(0,0)*F(0,0) + C(0,2)*F(0,1);
+const auto helper_1 = C(0,2)*F(0,0);
+const auto helper_2 = C(2,2)*F(0,1) + helper_1;
+const auto helper_3 = F(0,0)*F(0,1) + F(1,0)*F(1,1);
+const auto helper_4 = (1.0/2.0)*pow(F(0,0), 2) + (1.0/2.0)*pow(F(1,0), 2) - 1.0/2.0;
+const auto helper_5 = (1.0/2.0)*pow(F(0,1), 2) + (1.0/2.0)*pow(F(1,1), 2) - 1.0/2.0;
+const auto helper_6 = C(0,0)*helper_4 + C(0,1)*helper_5 + C(0,2)*helper_3;
+const auto helper_7 = C(0,0)*F(1,0) + C(0,2)*F(1,1);
+const auto helper_8 = C(0,2)*F(1,0);
+const auto helper_9 = C(2,2)*F(1,1) + helper_8;
+const auto helper_10 = (1.0/2.0)*F(0,0)*helper_7 + (1.0/2.0)*F(0,1)*helper_9 + (1.0/2.0)*F(1,0)*helper_0 + (1.0/2.0)*F(1,1)*helper_2;
+const auto helper_11 = C(0,1)*F(0,1) + helper_1;
+const auto helper_12 = (1.0/2.0)*F(0,0);
+const auto helper_13 = C(1,2)*F(0,1);
+const auto helper_14 = C(0,1)*F(0,0) + helper_13;
+const auto helper_15 = (1.0/2.0)*F(0,1);
+const auto helper_16 = C(2,2)*F(0,0) + helper_13;
+const auto helper_17 = C(0,2)*helper_4 + C(1,2)*helper_5 + C(2,2)*helper_3;
+const auto helper_18 = helper_11*helper_12 + helper_12*helper_2 + helper_14*helper_15 + helper_15*helper_16 + helper_17;
+const auto helper_19 = C(0,1)*F(1,1) + helper_8;
+const auto helper_20 = C(1,2)*F(1,1);
+const auto helper_21 = C(2,2)*F(1,0) + helper_20;
+const auto helper_22 = (1.0/2.0)*F(0,0)*helper_19 + (1.0/2.0)*F(0,1)*helper_21 + (1.0/2.0)*F(1,0)*helper_2 + (1.0/2.0)*F(1,1)*helper_14;
+const auto helper_23 = C(0,1)*F(1,0) + helper_20;
+const auto helper_24 = (1.0/2.0)*F(0,0)*helper_9 + (1.0/2.0)*F(0,1)*helper_23 + (1.0/2.0)*F(1,0)*helper_11 + (1.0/2.0)*F(1,1)*helper_16;
+const auto helper_25 = (1.0/2.0)*F(1,0);
+const auto helper_26 = (1.0/2.0)*F(1,1);
+const auto helper_27 = helper_17 + helper_19*helper_25 + helper_21*helper_26 + helper_23*helper_26 + helper_25*helper_9;
+const auto helper_28 = C(1,1)*F(0,1) + C(1,2)*F(0,0);
+const auto helper_29 = C(0,1)*helper_4 + C(1,1)*helper_5 + C(1,2)*helper_3;
+const auto helper_30 = C(1,1)*F(1,1) + C(1,2)*F(1,0);
+const auto helper_31 = (1.0/2.0)*F(0,0)*helper_21 + (1.0/2.0)*F(0,1)*helper_30 + (1.0/2.0)*F(1,0)*helper_16 + (1.0/2.0)*F(1,1)*helper_28;
+res(0) = F(0,0)*helper_0 + F(0,1)*helper_2 + helper_6;
+res(1) = helper_10;
+res(2) = helper_18;
+res(3) = helper_22;
+res(4) = helper_10;
+res(5) = F(1,0)*helper_7 + F(1,1)*helper_9 + helper_6;
+res(6) = helper_24;
+res(7) = helper_27;
+res(8) = helper_18;
+res(9) = helper_24;
+res(10) = F(0,0)*helper_16 + F(0,1)*helper_28 + helper_29;
+res(11) = helper_31;
+res(12) = helper_22;
+res(13) = helper_27;
+res(14) = helper_31;
+res(15) = F(1,0)*helper_21 + F(1,1)*helper_30 + helper_29;
+}
+
+double saint_venant_3d_energy(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const ElasticityTensor &C) {
+const auto helper_0 = F(0,0)*F(0,1) + F(1,0)*F(1,1) + F(2,0)*F(2,1);
+const auto helper_1 = pow(F(0,0), 2) + pow(F(1,0), 2) + pow(F(2,0), 2) - 1;
+const auto helper_2 = pow(F(0,1), 2) + pow(F(1,1), 2) + pow(F(2,1), 2) - 1;
+const auto helper_3 = pow(F(0,2), 2) + pow(F(1,2), 2) + pow(F(2,2), 2) - 1;
+const auto helper_4 = F(0,1)*F(0,2) + F(1,1)*F(1,2) + F(2,1)*F(2,2);
+const auto helper_5 = 2*helper_4;
+const auto helper_6 = F(0,0)*F(0,2) + F(1,0)*F(1,2) + F(2,0)*F(2,2);
+const auto helper_7 = 2*helper_6;
+const auto helper_8 = 2*helper_0;
+return (1.0/4.0)*helper_0*(C(0,5)*helper_1 + C(1,5)*helper_2 + C(2,5)*helper_3 + C(3,5)*helper_5 + C(4,5)*helper_7 + C(5,5)*helper_8) + (1.0/8.0)*helper_1*(C(0,0)*helper_1 + C(0,1)*helper_2 + C(0,2)*helper_3 + C(0,3)*helper_5 + C(0,4)*helper_7 + C(0,5)*helper_8) + (1.0/8.0)*helper_2*(C(0,1)*helper_1 + C(1,1)*helper_2 + C(1,2)*helper_3 + C(1,3)*helper_5 + C(1,4)*helper_7 + C(1,5)*helper_8) + (1.0/8.0)*helper_3*(C(0,2)*helper_1 + C(1,2)*helper_2 + C(2,2)*helper_3 + C(2,3)*helper_5 + C(2,4)*helper_7 + C(2,5)*helper_8) + (1.0/4.0)*helper_4*(C(0,3)*helper_1 + C(1,3)*helper_2 + C(2,3)*helper_3 + C(3,3)*helper_5 + C(3,4)*helper_7 + C(3,5)*helper_8) + (1.0/4.0)*helper_6*(C(0,4)*helper_1 + C(1,4)*helper_2 + C(2,4)*helper_3 + C(3,4)*helper_5 + C(4,4)*helper_7 + C(4,5)*helper_8);
+}
+
+void saint_venant_3d_stress(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const ElasticityTensor &C, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &res) {
+res.resize(3, 3);
+const auto helper_0 = pow(F(0,0), 2) + pow(F(1,0), 2) + pow(F(2,0), 2) - 1;
+const auto helper_1 = C(1,5)*F(0,1);
+const auto helper_2 = pow(F(0,1), 2) + pow(F(1,1), 2) + pow(F(2,1), 2) - 1;
+const auto helper_3 = C(2,4)*F(0,2);
+const auto helper_4 = pow(F(0,2), 2) + pow(F(1,2), 2) + pow(F(2,2), 2) - 1;
+const auto helper_5 = C(3,4)*F(0,2);
+const auto helper_6 = C(3,5)*F(0,1);
+const auto helper_7 = 2*F(0,1)*F(0,2) + 2*F(1,1)*F(1,2) + 2*F(2,1)*F(2,2);
+const auto helper_8 = C(0,4)*F(0,0);
+const auto helper_9 = 2*F(0,0)*F(0,2) + 2*F(1,0)*F(1,2) + 2*F(2,0)*F(2,2);
+const auto helper_10 = C(0,5)*F(0,0);
+const auto helper_11 = 2*F(0,0)*F(0,1) + 2*F(1,0)*F(1,1) + 2*F(2,0)*F(2,1);
+const auto helper_12 = C(0,0)*helper_0 + C(0,1)*helper_2 + C(0,2)*helper_4 + C(0,3)*helper_7 + C(0,4)*helper_9 + C(0,5)*helper_11;
+const auto helper_13 = C(0,5)*helper_0 + C(1,5)*helper_2 + C(2,5)*helper_4 + C(3,5)*helper_7 + C(4,5)*helper_9 + C(5,5)*helper_11;
+const auto helper_14 = C(0,4)*helper_0 + C(1,4)*helper_2 + C(2,4)*helper_4 + C(3,4)*helper_7 + C(4,4)*helper_9 + C(4,5)*helper_11;
+const auto helper_15 = C(1,5)*F(1,1);
+const auto helper_16 = C(2,4)*F(1,2);
+const auto helper_17 = C(3,4)*F(1,2);
+const auto helper_18 = C(3,5)*F(1,1);
+const auto helper_19 = C(0,4)*F(1,0);
+const auto helper_20 = C(0,5)*F(1,0);
+const auto helper_21 = C(1,5)*F(2,1);
+const auto helper_22 = C(2,4)*F(2,2);
+const auto helper_23 = C(3,4)*F(2,2);
+const auto helper_24 = C(3,5)*F(2,1);
+const auto helper_25 = C(0,4)*F(2,0);
+const auto helper_26 = C(0,5)*F(2,0);
+const auto helper_27 = C(2,3)*F(0,2);
+const auto helper_28 = C(1,3)*F(0,1);
+const auto helper_29 = C(4,5)*F(0,0);
+const auto helper_30 = C(0,1)*helper_0 + C(1,1)*helper_2 + C(1,2)*helper_4 + C(1,3)*helper_7 + C(1,4)*helper_9 + C(1,5)*helper_11;
+const auto helper_31 = C(0,3)*helper_0 + C(1,3)*helper_2 + C(2,3)*helper_4 + C(3,3)*helper_7 + C(3,4)*helper_9 + C(3,5)*helper_11;
+const auto helper_32 = C(2,3)*F(1,2);
+const auto helper_33 = C(1,3)*F(1,1);
+const auto helper_34 = C(4,5)*F(1,0);
+const auto helper_35 = C(2,3)*F(2,2);
+const auto helper_36 = C(1,3)*F(2,1);
+const auto helper_37 = C(4,5)*F(2,0);
+const auto helper_38 = C(0,2)*helper_0 + C(1,2)*helper_2 + C(2,2)*helper_4 + C(2,3)*helper_7 + C(2,4)*helper_9 + C(2,5)*helper_11;
+res(0) = (1.0/4.0)*F(0,0)*helper_12 + (1.0/4.0)*F(0,1)*helper_13 + (1.0/4.0)*F(0,2)*helper_14 + (1.0/4.0)*helper_0*(C(0,0)*F(0,0) + C(0,4)*F(0,2) + C(0,5)*F(0,1)) + (1.0/4.0)*helper_11*(C(4,5)*F(0,2) + C(5,5)*F(0,1) + helper_10) + (1.0/4.0)*helper_2*(C(0,1)*F(0,0) + C(1,4)*F(0,2) + helper_1) + (1.0/4.0)*helper_4*(C(0,2)*F(0,0) + C(2,5)*F(0,1) + helper_3) + (1.0/4.0)*helper_7*(C(0,3)*F(0,0) + helper_5 + helper_6) + (1.0/4.0)*helper_9*(C(4,4)*F(0,2) + C(4,5)*F(0,1) + helper_8);
+res(1) = (1.0/4.0)*F(1,0)*helper_12 + (1.0/4.0)*F(1,1)*helper_13 + (1.0/4.0)*F(1,2)*helper_14 + (1.0/4.0)*helper_0*(C(0,0)*F(1,0) + C(0,4)*F(1,2) + C(0,5)*F(1,1)) + (1.0/4.0)*helper_11*(C(4,5)*F(1,2) + C(5,5)*F(1,1) + helper_20) + (1.0/4.0)*helper_2*(C(0,1)*F(1,0) + C(1,4)*F(1,2) + helper_15) + (1.0/4.0)*helper_4*(C(0,2)*F(1,0) + C(2,5)*F(1,1) + helper_16) + (1.0/4.0)*helper_7*(C(0,3)*F(1,0) + helper_17 + helper_18) + (1.0/4.0)*helper_9*(C(4,4)*F(1,2) + C(4,5)*F(1,1) + helper_19);
+res(2) = (1.0/4.0)*F(2,0)*helper_12 + (1.0/4.0)*F(2,1)*helper_13 + (1.0/4.0)*F(2,2)*helper_14 + (1.0/4.0)*helper_0*(C(0,0)*F(2,0) + C(0,4)*F(2,2) + C(0,5)*F(2,1)) + (1.0/4.0)*helper_11*(C(4,5)*F(2,2) + C(5,5)*F(2,1) + helper_26) + (1.0/4.0)*helper_2*(C(0,1)*F(2,0) + C(1,4)*F(2,2) + helper_21) + (1.0/4.0)*helper_4*(C(0,2)*F(2,0) + C(2,5)*F(2,1) + helper_22) + (1.0/4.0)*helper_7*(C(0,3)*F(2,0) + helper_23 + helper_24) + (1.0/4.0)*helper_9*(C(4,4)*F(2,2) + C(4,5)*F(2,1) + helper_25);
+res(3) = (1.0/4.0)*F(0,0)*helper_13 + (1.0/4.0)*F(0,1)*helper_30 + (1.0/4.0)*F(0,2)*helper_31 + (1.0/4.0)*helper_0*(C(0,1)*F(0,1) + C(0,3)*F(0,2) + helper_10) + (1.0/4.0)*helper_11*(C(3,5)*F(0,2) + C(5,5)*F(0,0) + helper_1) + (1.0/4.0)*helper_2*(C(1,1)*F(0,1) + C(1,3)*F(0,2) + C(1,5)*F(0,0)) + (1.0/4.0)*helper_4*(C(1,2)*F(0,1) + C(2,5)*F(0,0) + helper_27) + (1.0/4.0)*helper_7*(C(3,3)*F(0,2) + C(3,5)*F(0,0) + helper_28) + (1.0/4.0)*helper_9*(C(1,4)*F(0,1) + helper_29 + helper_5);
+res(4) = (1.0/4.0)*F(1,0)*helper_13 + (1.0/4.0)*F(1,1)*helper_30 + (1.0/4.0)*F(1,2)*helper_31 + (1.0/4.0)*helper_0*(C(0,1)*F(1,1) + C(0,3)*F(1,2) + helper_20) + (1.0/4.0)*helper_11*(C(3,5)*F(1,2) + C(5,5)*F(1,0) + helper_15) + (1.0/4.0)*helper_2*(C(1,1)*F(1,1) + C(1,3)*F(1,2) + C(1,5)*F(1,0)) + (1.0/4.0)*helper_4*(C(1,2)*F(1,1) + C(2,5)*F(1,0) + helper_32) + (1.0/4.0)*helper_7*(C(3,3)*F(1,2) + C(3,5)*F(1,0) + helper_33) + (1.0/4.0)*helper_9*(C(1,4)*F(1,1) + helper_17 + helper_34);
+res(5) = (1.0/4.0)*F(2,0)*helper_13 + (1.0/4.0)*F(2,1)*helper_30 + (1.0/4.0)*F(2,2)*helper_31 + (1.0/4.0)*helper_0*(C(0,1)*F(2,1) + C(0,3)*F(2,2) + helper_26) + (1.0/4.0)*helper_11*(C(3,5)*F(2,2) + C(5,5)*F(2,0) + helper_21) + (1.0/4.0)*helper_2*(C(1,1)*F(2,1) + C(1,3)*F(2,2) + C(1,5)*F(2,0)) + (1.0/4.0)*helper_4*(C(1,2)*F(2,1) + C(2,5)*F(2,0) + helper_35) + (1.0/4.0)*helper_7*(C(3,3)*F(2,2) + C(3,5)*F(2,0) + helper_36) + (1.0/4.0)*helper_9*(C(1,4)*F(2,1) + helper_23 + helper_37);
+res(6) = (1.0/4.0)*F(0,0)*helper_14 + (1.0/4.0)*F(0,1)*helper_31 + (1.0/4.0)*F(0,2)*helper_38 + (1.0/4.0)*helper_0*(C(0,2)*F(0,2) + C(0,3)*F(0,1) + helper_8) + (1.0/4.0)*helper_11*(C(2,5)*F(0,2) + helper_29 + helper_6) + (1.0/4.0)*helper_2*(C(1,2)*F(0,2) + C(1,4)*F(0,0) + helper_28) + (1.0/4.0)*helper_4*(C(2,2)*F(0,2) + C(2,3)*F(0,1) + C(2,4)*F(0,0)) + (1.0/4.0)*helper_7*(C(3,3)*F(0,1) + C(3,4)*F(0,0) + helper_27) + (1.0/4.0)*helper_9*(C(3,4)*F(0,1) + C(4,4)*F(0,0) + helper_3);
+res(7) = (1.0/4.0)*F(1,0)*helper_14 + (1.0/4.0)*F(1,1)*helper_31 + (1.0/4.0)*F(1,2)*helper_38 + (1.0/4.0)*helper_0*(C(0,2)*F(1,2) + C(0,3)*F(1,1) + helper_19) + (1.0/4.0)*helper_11*(C(2,5)*F(1,2) + helper_18 + helper_34) + (1.0/4.0)*helper_2*(C(1,2)*F(1,2) + C(1,4)*F(1,0) + helper_33) + (1.0/4.0)*helper_4*(C(2,2)*F(1,2) + C(2,3)*F(1,1) + C(2,4)*F(1,0)) + (1.0/4.0)*helper_7*(C(3,3)*F(1,1) + C(3,4)*F(1,0) + helper_32) + (1.0/4.0)*helper_9*(C(3,4)*F(1,1) + C(4,4)*F(1,0) + helper_16);
+res(8) = (1.0/4.0)*F(2,0)*helper_14 + (1.0/4.0)*F(2,1)*helper_31 + (1.0/4.0)*F(2,2)*helper_38 + (1.0/4.0)*helper_0*(C(0,2)*F(2,2) + C(0,3)*F(2,1) + helper_25) + (1.0/4.0)*helper_11*(C(2,5)*F(2,2) + helper_24 + helper_37) + (1.0/4.0)*helper_2*(C(1,2)*F(2,2) + C(1,4)*F(2,0) + helper_36) + (1.0/4.0)*helper_4*(C(2,2)*F(2,2) + C(2,3)*F(2,1) + C(2,4)*F(2,0)) + (1.0/4.0)*helper_7*(C(3,3)*F(2,1) + C(3,4)*F(2,0) + helper_35) + (1.0/4.0)*helper_9*(C(3,4)*F(2,1) + C(4,4)*F(2,0) + helper_22);
+}
+
+void saint_venant_3d_stress_grad(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const ElasticityTensor &C, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 9, 9> &res) {
+res.resize(9, 9);
+const auto helper_0 = C(0,0)*F(0,0) + C(0,4)*F(0,2) + C(0,5)*F(0,1);
+const auto helper_1 = C(0,5)*F(0,0);
+const auto helper_2 = C(4,5)*F(0,2) + C(5,5)*F(0,1) + helper_1;
+const auto helper_3 = C(0,4)*F(0,0);
+const auto helper_4 = C(4,4)*F(0,2) + C(4,5)*F(0,1) + helper_3;
+const auto helper_5 = F(0,1)*F(0,2) + F(1,1)*F(1,2) + F(2,1)*F(2,2);
+const auto helper_6 = F(0,0)*F(0,2) + F(1,0)*F(1,2) + F(2,0)*F(2,2);
+const auto helper_7 = F(0,0)*F(0,1) + F(1,0)*F(1,1) + F(2,0)*F(2,1);
+const auto helper_8 = (1.0/2.0)*pow(F(0,0), 2) + (1.0/2.0)*pow(F(1,0), 2) + (1.0/2.0)*pow(F(2,0), 2) - 1.0/2.0;
+const auto helper_9 = (1.0/2.0)*pow(F(0,1), 2) + (1.0/2.0)*pow(F(1,1), 2) + (1.0/2.0)*pow(F(2,1), 2) - 1.0/2.0;
+const auto helper_10 = (1.0/2.0)*pow(F(0,2), 2) + (1.0/2.0)*pow(F(1,2), 2) + (1.0/2.0)*pow(F(2,2), 2) - 1.0/2.0;
+const auto helper_11 = C(0,0)*helper_8 + C(0,1)*helper_9 + C(0,2)*helper_10 + C(0,3)*helper_5 + C(0,4)*helper_6 + C(0,5)*helper_7;
+const auto helper_12 = C(0,0)*F(1,0) + C(0,4)*F(1,2) + C(0,5)*F(1,1);
+const auto helper_13 = C(0,5)*F(1,0);
+const auto helper_14 = C(4,5)*F(1,2) + C(5,5)*F(1,1) + helper_13;
+const auto helper_15 = C(0,4)*F(1,0);
+const auto helper_16 = C(4,4)*F(1,2) + C(4,5)*F(1,1) + helper_15;
+const auto helper_17 = (1.0/2.0)*F(0,0)*helper_12 + (1.0/2.0)*F(0,1)*helper_14 + (1.0/2.0)*F(0,2)*helper_16 + (1.0/2.0)*F(1,0)*helper_0 + (1.0/2.0)*F(1,1)*helper_2 + (1.0/2.0)*F(1,2)*helper_4;
+const auto helper_18 = C(0,0)*F(2,0) + C(0,4)*F(2,2) + C(0,5)*F(2,1);
+const auto helper_19 = C(0,5)*F(2,0);
+const auto helper_20 = C(4,5)*F(2,2) + C(5,5)*F(2,1) + helper_19;
+const auto helper_21 = C(0,4)*F(2,0);
+const auto helper_22 = C(4,4)*F(2,2) + C(4,5)*F(2,1) + helper_21;
+const auto helper_23 = (1.0/2.0)*F(0,0)*helper_18 + (1.0/2.0)*F(0,1)*helper_20 + (1.0/2.0)*F(0,2)*helper_22 + (1.0/2.0)*F(2,0)*helper_0 + (1.0/2.0)*F(2,1)*helper_2 + (1.0/2.0)*F(2,2)*helper_4;
+const auto helper_24 = C(0,1)*F(0,1) + C(0,3)*F(0,2) + helper_1;
+const auto helper_25 = (1.0/2.0)*F(0,0);
+const auto helper_26 = C(1,5)*F(0,1);
+const auto helper_27 = C(0,1)*F(0,0) + C(1,4)*F(0,2) + helper_26;
+const auto helper_28 = (1.0/2.0)*F(0,1);
+const auto helper_29 = C(3,5)*F(0,2) + C(5,5)*F(0,0) + helper_26;
+const auto helper_30 = C(3,4)*F(0,2);
+const auto helper_31 = C(3,5)*F(0,1);
+const auto helper_32 = C(0,3)*F(0,0) + helper_30 + helper_31;
+const auto helper_33 = (1.0/2.0)*F(0,2);
+const auto helper_34 = C(4,5)*F(0,0);
+const auto helper_35 = C(1,4)*F(0,1) + helper_30 + helper_34;
+const auto helper_36 = C(0,5)*helper_8 + C(1,5)*helper_9 + C(2,5)*helper_10 + C(3,5)*helper_5 + C(4,5)*helper_6 + C(5,5)*helper_7;
+const auto helper_37 = helper_2*helper_25 + helper_24*helper_25 + helper_27*helper_28 + helper_28*helper_29 + helper_32*helper_33 + helper_33*helper_35 + helper_36;
+const auto helper_38 = C(0,1)*F(1,1) + C(0,3)*F(1,2) + helper_13;
+const auto helper_39 = C(1,5)*F(1,1);
+const auto helper_40 = C(3,5)*F(1,2) + C(5,5)*F(1,0) + helper_39;
+const auto helper_41 = C(3,4)*F(1,2);
+const auto helper_42 = C(4,5)*F(1,0);
+const auto helper_43 = C(1,4)*F(1,1) + helper_41 + helper_42;
+const auto helper_44 = (1.0/2.0)*F(0,0)*helper_38 + (1.0/2.0)*F(0,1)*helper_40 + (1.0/2.0)*F(0,2)*helper_43 + (1.0/2.0)*F(1,0)*helper_2 + (1.0/2.0)*F(1,1)*helper_27 + (1.0/2.0)*F(1,2)*helper_32;
+const auto helper_45 = C(0,1)*F(2,1) + C(0,3)*F(2,2) + helper_19;
+const auto helper_46 = C(1,5)*F(2,1);
+const auto helper_47 = C(3,5)*F(2,2) + C(5,5)*F(2,0) + helper_46;
+const auto helper_48 = C(3,4)*F(2,2);
+const auto helper_49 = C(4,5)*F(2,0);
+const auto helper_50 = C(1,4)*F(2,1) + helper_48 + helper_49;
+const auto helper_51 = (1.0/2.0)*F(0,0)*helper_45 + (1.0/2.0)*F(0,1)*helper_47 + (1.0/2.0)*F(0,2)*helper_50 + (1.0/2.0)*F(2,0)*helper_2 + (1.0/2.0)*F(2,1)*helper_27 + (1.0/2.0)*F(2,2)*helper_32;
+const auto helper_52 = C(0,2)*F(0,2) + C(0,3)*F(0,1) + helper_3;
+const auto helper_53 = C(2,5)*F(0,2) + helper_31 + helper_34;
+const auto helper_54 = C(2,4)*F(0,2);
+const auto helper_55 = C(0,2)*F(0,0) + C(2,5)*F(0,1) + helper_54;
+const auto helper_56 = C(3,4)*F(0,1) + C(4,4)*F(0,0) + helper_54;
+const auto helper_57 = C(0,4)*helper_8 + C(1,4)*helper_9 + C(2,4)*helper_10 + C(3,4)*helper_5 + C(4,4)*helper_6 + C(4,5)*helper_7;
+const auto helper_58 = helper_25*helper_4 + helper_25*helper_52 + helper_28*helper_32 + helper_28*helper_53 + helper_33*helper_55 + helper_33*helper_56 + helper_57;
+const auto helper_59 = C(0,2)*F(1,2) + C(0,3)*F(1,1) + helper_15;
+const auto helper_60 = C(3,5)*F(1,1);
+const auto helper_61 = C(2,5)*F(1,2) + helper_42 + helper_60;
+const auto helper_62 = C(2,4)*F(1,2);
+const auto helper_63 = C(3,4)*F(1,1) + C(4,4)*F(1,0) + helper_62;
+const auto helper_64 = (1.0/2.0)*F(0,0)*helper_59 + (1.0/2.0)*F(0,1)*helper_61 + (1.0/2.0)*F(0,2)*helper_63 + (1.0/2.0)*F(1,0)*helper_4 + (1.0/2.0)*F(1,1)*helper_32 + (1.0/2.0)*F(1,2)*helper_55;
+const auto helper_65 = C(0,2)*F(2,2) + C(0,3)*F(2,1) + helper_21;
+const auto helper_66 = C(3,5)*F(2,1);
+const auto helper_67 = C(2,5)*F(2,2) + helper_49 + helper_66;
+const auto helper_68 = C(2,4)*F(2,2);
+const auto helper_69 = C(3,4)*F(2,1) + C(4,4)*F(2,0) + helper_68;
+const auto helper_70 = (1.0/2.0)*F(0,0)*helper_65 + (1.0/2.0)*F(0,1)*helper_67 + (1.0/2.0)*F(0,2)*helper_69 + (1.0/2.0)*F(2,0)*helper_4 + (1.0/2.0)*F(2,1)*helper_32 + (1.0/2.0)*F(2,2)*helper_55;
+const auto helper_71 = (1.0/2.0)*F(1,0)*helper_18 + (1.0/2.0)*F(1,1)*helper_20 + (1.0/2.0)*F(1,2)*helper_22 + (1.0/2.0)*F(2,0)*helper_12 + (1.0/2.0)*F(2,1)*helper_14 + (1.0/2.0)*F(2,2)*helper_16;
+const auto helper_72 = C(0,1)*F(1,0) + C(1,4)*F(1,2) + helper_39;
+const auto helper_73 = C(0,3)*F(1,0) + helper_41 + helper_60;
+const auto helper_74 = (1.0/2.0)*F(0,0)*helper_14 + (1.0/2.0)*F(0,1)*helper_72 + (1.0/2.0)*F(0,2)*helper_73 + (1.0/2.0)*F(1,0)*helper_24 + (1.0/2.0)*F(1,1)*helper_29 + (1.0/2.0)*F(1,2)*helper_35;
+const auto helper_75 = (1.0/2.0)*F(1,0);
+const auto helper_76 = (1.0/2.0)*F(1,1);
+const auto helper_77 = (1.0/2.0)*F(1,2);
+const auto helper_78 = helper_14*helper_75 + helper_36 + helper_38*helper_75 + helper_40*helper_76 + helper_43*helper_77 + helper_72*helper_76 + helper_73*helper_77;
+const auto helper_79 = (1.0/2.0)*F(1,0)*helper_45 + (1.0/2.0)*F(1,1)*helper_47 + (1.0/2.0)*F(1,2)*helper_50 + (1.0/2.0)*F(2,0)*helper_14 + (1.0/2.0)*F(2,1)*helper_72 + (1.0/2.0)*F(2,2)*helper_73;
+const auto helper_80 = C(0,2)*F(1,0) + C(2,5)*F(1,1) + helper_62;
+const auto helper_81 = (1.0/2.0)*F(0,0)*helper_16 + (1.0/2.0)*F(0,1)*helper_73 + (1.0/2.0)*F(0,2)*helper_80 + (1.0/2.0)*F(1,0)*helper_52 + (1.0/2.0)*F(1,1)*helper_53 + (1.0/2.0)*F(1,2)*helper_56;
+const auto helper_82 = helper_16*helper_75 + helper_57 + helper_59*helper_75 + helper_61*helper_76 + helper_63*helper_77 + helper_73*helper_76 + helper_77*helper_80;
+const auto helper_83 = (1.0/2.0)*F(1,0)*helper_65 + (1.0/2.0)*F(1,1)*helper_67 + (1.0/2.0)*F(1,2)*helper_69 + (1.0/2.0)*F(2,0)*helper_16 + (1.0/2.0)*F(2,1)*helper_73 + (1.0/2.0)*F(2,2)*helper_80;
+const auto helper_84 = C(0,1)*F(2,0) + C(1,4)*F(2,2) + helper_46;
+const auto helper_85 = C(0,3)*F(2,0) + helper_48 + helper_66;
+const auto helper_86 = (1.0/2.0)*F(0,0)*helper_20 + (1.0/2.0)*F(0,1)*helper_84 + (1.0/2.0)*F(0,2)*helper_85 + (1.0/2.0)*F(2,0)*helper_24 + (1.0/2.0)*F(2,1)*helper_29 + (1.0/2.0)*F(2,2)*helper_35;
+const auto helper_87 = (1.0/2.0)*F(1,0)*helper_20 + (1.0/2.0)*F(1,1)*helper_84 + (1.0/2.0)*F(1,2)*helper_85 + (1.0/2.0)*F(2,0)*helper_38 + (1.0/2.0)*F(2,1)*helper_40 + (1.0/2.0)*F(2,2)*helper_43;
+const auto helper_88 = (1.0/2.0)*F(2,0);
+const auto helper_89 = (1.0/2.0)*F(2,1);
+const auto helper_90 = (1.0/2.0)*F(2,2);
+const auto helper_91 = helper_20*helper_88 + helper_36 + helper_45*helper_88 + helper_47*helper_89 + helper_50*helper_90 + helper_84*helper_89 + helper_85*helper_90;
+const auto helper_92 = C(0,2)*F(2,0) + C(2,5)*F(2,1) + helper_68;
+const auto helper_93 = (1.0/2.0)*F(0,0)*helper_22 + (1.0/2.0)*F(0,1)*helper_85 + (1.0/2.0)*F(0,2)*helper_92 + (1.0/2.0)*F(2,0)*helper_52 + (1.0/2.0)*F(2,1)*helper_53 + (1.0/2.0)*F(2,2)*helper_56;
+const auto helper_94 = (1.0/2.0)*F(1,0)*helper_22 + (1.0/2.0)*F(1,1)*helper_85 + (1.0/2.0)*F(1,2)*helper_92 + (1.0/2.0)*F(2,0)*helper_59 + (1.0/2.0)*F(2,1)*helper_61 + (1.0/2.0)*F(2,2)*helper_63;
+const auto helper_95 = helper_22*helper_88 + helper_57 + helper_65*helper_88 + helper_67*helper_89 + helper_69*helper_90 + helper_85*helper_89 + helper_90*helper_92;
+const auto helper_96 = C(1,1)*F(0,1) + C(1,3)*F(0,2) + C(1,5)*F(0,0);
+const auto helper_97 = C(1,3)*F(0,1);
+const auto helper_98 = C(3,3)*F(0,2) + C(3,5)*F(0,0) + helper_97;
+const auto helper_99 = C(0,1)*helper_8 + C(1,1)*helper_9 + C(1,2)*helper_10 + C(1,3)*helper_5 + C(1,4)*helper_6 + C(1,5)*helper_7;
+const auto helper_100 = C(1,1)*F(1,1) + C(1,3)*F(1,2) + C(1,5)*F(1,0);
+const auto helper_101 = C(1,3)*F(1,1);
+const auto helper_102 = C(3,3)*F(1,2) + C(3,5)*F(1,0) + helper_101;
+const auto helper_103 = (1.0/2.0)*F(0,0)*helper_40 + (1.0/2.0)*F(0,1)*helper_100 + (1.0/2.0)*F(0,2)*helper_102 + (1.0/2.0)*F(1,0)*helper_29 + (1.0/2.0)*F(1,1)*helper_96 + (1.0/2.0)*F(1,2)*helper_98;
+const auto helper_104 = C(1,1)*F(2,1) + C(1,3)*F(2,2) + C(1,5)*F(2,0);
+const auto helper_105 = C(1,3)*F(2,1);
+const auto helper_106 = C(3,3)*F(2,2) + C(3,5)*F(2,0) + helper_105;
+const auto helper_107 = (1.0/2.0)*F(0,0)*helper_47 + (1.0/2.0)*F(0,1)*helper_104 + (1.0/2.0)*F(0,2)*helper_106 + (1.0/2.0)*F(2,0)*helper_29 + (1.0/2.0)*F(2,1)*helper_96 + (1.0/2.0)*F(2,2)*helper_98;
+const auto helper_108 = C(1,2)*F(0,2) + C(1,4)*F(0,0) + helper_97;
+const auto helper_109 = C(2,3)*F(0,2);
+const auto helper_110 = C(1,2)*F(0,1) + C(2,5)*F(0,0) + helper_109;
+const auto helper_111 = C(3,3)*F(0,1) + C(3,4)*F(0,0) + helper_109;
+const auto helper_112 = C(0,3)*helper_8 + C(1,3)*helper_9 + C(2,3)*helper_10 + C(3,3)*helper_5 + C(3,4)*helper_6 + C(3,5)*helper_7;
+const auto helper_113 = helper_108*helper_28 + helper_110*helper_33 + helper_111*helper_33 + helper_112 + helper_25*helper_35 + helper_25*helper_53 + helper_28*helper_98;
+const auto helper_114 = C(1,2)*F(1,2) + C(1,4)*F(1,0) + helper_101;
+const auto helper_115 = C(2,3)*F(1,2);
+const auto helper_116 = C(3,3)*F(1,1) + C(3,4)*F(1,0) + helper_115;
+const auto helper_117 = (1.0/2.0)*F(0,0)*helper_61 + (1.0/2.0)*F(0,1)*helper_114 + (1.0/2.0)*F(0,2)*helper_116 + (1.0/2.0)*F(1,0)*helper_35 + (1.0/2.0)*F(1,1)*helper_98 + (1.0/2.0)*F(1,2)*helper_110;
+const auto helper_118 = C(1,2)*F(2,2) + C(1,4)*F(2,0) + helper_105;
+const auto helper_119 = C(2,3)*F(2,2);
+const auto helper_120 = C(3,3)*F(2,1) + C(3,4)*F(2,0) + helper_119;
+const auto helper_121 = (1.0/2.0)*F(0,0)*helper_67 + (1.0/2.0)*F(0,1)*helper_118 + (1.0/2.0)*F(0,2)*helper_120 + (1.0/2.0)*F(2,0)*helper_35 + (1.0/2.0)*F(2,1)*helper_98 + (1.0/2.0)*F(2,2)*helper_110;
+const auto helper_122 = (1.0/2.0)*F(1,0)*helper_47 + (1.0/2.0)*F(1,1)*helper_104 + (1.0/2.0)*F(1,2)*helper_106 + (1.0/2.0)*F(2,0)*helper_40 + (1.0/2.0)*F(2,1)*helper_100 + (1.0/2.0)*F(2,2)*helper_102;
+const auto helper_123 = C(1,2)*F(1,1) + C(2,5)*F(1,0) + helper_115;
+const auto helper_124 = (1.0/2.0)*F(0,0)*helper_43 + (1.0/2.0)*F(0,1)*helper_102 + (1.0/2.0)*F(0,2)*helper_123 + (1.0/2.0)*F(1,0)*helper_53 + (1.0/2.0)*F(1,1)*helper_108 + (1.0/2.0)*F(1,2)*helper_111;
+const auto helper_125 = helper_102*helper_76 + helper_112 + helper_114*helper_76 + helper_116*helper_77 + helper_123*helper_77 + helper_43*helper_75 + helper_61*helper_75;
+const auto helper_126 = (1.0/2.0)*F(1,0)*helper_67 + (1.0/2.0)*F(1,1)*helper_118 + (1.0/2.0)*F(1,2)*helper_120 + (1.0/2.0)*F(2,0)*helper_43 + (1.0/2.0)*F(2,1)*helper_102 + (1.0/2.0)*F(2,2)*helper_123;
+const auto helper_127 = C(1,2)*F(2,1) + C(2,5)*F(2,0) + helper_119;
+const auto helper_128 = (1.0/2.0)*F(0,0)*helper_50 + (1.0/2.0)*F(0,1)*helper_106 + (1.0/2.0)*F(0,2)*helper_127 + (1.0/2.0)*F(2,0)*helper_53 + (1.0/2.0)*F(2,1)*helper_108 + (1.0/2.0)*F(2,2)*helper_111;
+const auto helper_129 = (1.0/2.0)*F(1,0)*helper_50 + (1.0/2.0)*F(1,1)*helper_106 + (1.0/2.0)*F(1,2)*helper_127 + (1.0/2.0)*F(2,0)*helper_61 + (1.0/2.0)*F(2,1)*helper_114 + (1.0/2.0)*F(2,2)*helper_116;
+const auto helper_130 = helper_106*helper_89 + helper_112 + helper_118*helper_89 + helper_120*helper_90 + helper_127*helper_90 + helper_50*helper_88 + helper_67*helper_88;
+const auto helper_131 = C(2,2)*F(0,2) + C(2,3)*F(0,1) + C(2,4)*F(0,0);
+const auto helper_132 = C(0,2)*helper_8 + C(1,2)*helper_9 + C(2,2)*helper_10 + C(2,3)*helper_5 + C(2,4)*helper_6 + C(2,5)*helper_7;
+const auto helper_133 = C(2,2)*F(1,2) + C(2,3)*F(1,1) + C(2,4)*F(1,0);
+const auto helper_134 = (1.0/2.0)*F(0,0)*helper_63 + (1.0/2.0)*F(0,1)*helper_116 + (1.0/2.0)*F(0,2)*helper_133 + (1.0/2.0)*F(1,0)*helper_56 + (1.0/2.0)*F(1,1)*helper_111 + (1.0/2.0)*F(1,2)*helper_131;
+const auto helper_135 = C(2,2)*F(2,2) + C(2,3)*F(2,1) + C(2,4)*F(2,0);
+const auto helper_136 = (1.0/2.0)*F(0,0)*helper_69 + (1.0/2.0)*F(0,1)*helper_120 + (1.0/2.0)*F(0,2)*helper_135 + (1.0/2.0)*F(2,0)*helper_56 + (1.0/2.0)*F(2,1)*helper_111 + (1.0/2.0)*F(2,2)*helper_131;
+const auto helper_137 = (1.0/2.0)*F(1,0)*helper_69 + (1.0/2.0)*F(1,1)*helper_120 + (1.0/2.0)*F(1,2)*helper_135 + (1.0/2.0)*F(2,0)*helper_63 + (1.0/2.0)*F(2,1)*helper_116 + (1.0/2.0)*F(2,2)*helper_133;
+res(0) = F(0,0)*helper_0 + F(0,1)*helper_2 + F(0,2)*helper_4 + helper_11;
+res(1) = helper_17;
+res(2) = helper_23;
+res(3) = helper_37;
+res(4) = helper_44;
+res(5) = helper_51;
+res(6) = helper_58;
+res(7) = helper_64;
+res(8) = helper_70;
+res(9) = helper_17;
+res(10) = F(1,0)*helper_12 + F(1,1)*helper_14 + F(1,2)*helper_16 + helper_11;
+res(11) = helper_71;
+res(12) = helper_74;
+res(13) = helper_78;
+res(14) = helper_79;
+res(15) = helper_81;
+res(16) = helper_82;
+res(17) = helper_83;
+res(18) = helper_23;
+res(19) = helper_71;
+res(20) = F(2,0)*helper_18 + F(2,1)*helper_20 + F(2,2)*helper_22 + helper_11;
+res(21) = helper_86;
+res(22) = helper_87;
+res(23) = helper_91;
+res(24) = helper_93;
+res(25) = helper_94;
+res(26) = helper_95;
+res(27) = helper_37;
+res(28) = helper_74;
+res(29) = helper_86;
+res(30) = F(0,0)*helper_29 + F(0,1)*helper_96 + F(0,2)*helper_98 + helper_99;
+res(31) = helper_103;
+res(32) = helper_107;
+res(33) = helper_113;
+res(34) = helper_117;
+res(35) = helper_121;
+res(36) = helper_44;
+res(37) = helper_78;
+res(38) = helper_87;
+res(39) = helper_103;
+res(40) = F(1,0)*helper_40 + F(1,1)*helper_100 + F(1,2)*helper_102 + helper_99;
+res(41) = helper_122;
+res(42) = helper_124;
+res(43) = helper_125;
+res(44) = helper_126;
+res(45) = helper_51;
+res(46) = helper_79;
+res(47) = helper_91;
+res(48) = helper_107;
+res(49) = helper_122;
+res(50) = F(2,0)*helper_47 + F(2,1)*helper_104 + F(2,2)*helper_106 + helper_99;
+res(51) = helper_128;
+res(52) = helper_129;
+res(53) = helper_130;
+res(54) = helper_58;
+res(55) = helper_81;
+res(56) = helper_93;
+res(57) = helper_113;
+res(58) = helper_124;
+res(59) = helper_128;
+res(60) = F(0,0)*helper_56 + F(0,1)*helper_111 + F(0,2)*helper_131 + helper_132;
+res(61) = helper_134;
+res(62) = helper_136;
+res(63) = helper_64;
+res(64) = helper_82;
+res(65) = helper_94;
+res(66) = helper_117;
+res(67) = helper_125;
+res(68) = helper_129;
+res(69) = helper_134;
+res(70) = F(1,0)*helper_63 + F(1,1)*helper_116 + F(1,2)*helper_133 + helper_132;
+res(71) = helper_137;
+res(72) = helper_70;
+res(73) = helper_83;
+res(74) = helper_95;
+res(75) = helper_121;
+res(76) = helper_126;
+res(77) = helper_130;
+res(78) = helper_136;
+res(79) = helper_137;
+res(80) = F(2,0)*helper_69 + F(2,1)*helper_120 + F(2,2)*helper_135 + helper_132;
+}
+
+
+double neo_hookean_2d_energy(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const double lambda, const double mu) {
+const auto helper_0 = log(F(0,0)*F(1,1) - F(0,1)*F(1,0));
+return (1.0/2.0)*pow(helper_0, 2)*lambda + (1.0/2.0)*mu*(pow(F(0,0), 2) + pow(F(0,1), 2) + pow(F(1,0), 2) + pow(F(1,1), 2) - 2*helper_0 - 2);
+}
+
+void neo_hookean_2d_stress(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const double lambda, const double mu, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &res) {
+res.resize(2, 2);
+const auto helper_0 = F(0,0)*F(1,1) - F(0,1)*F(1,0);
+const auto helper_1 = 1.0/helper_0;
+const auto helper_2 = F(1,1)*helper_1;
+const auto helper_3 = lambda*log(helper_0);
+const auto helper_4 = F(0,1)*helper_1;
+const auto helper_5 = F(1,0)*helper_1;
+const auto helper_6 = F(0,0)*helper_1;
+res(0) = helper_2*helper_3 + mu*(F(0,0) - helper_2);
+res(1) = -helper_3*helper_4 + mu*(F(1,0) + helper_4);
+res(2) = -helper_3*helper_5 + mu*(F(0,1) + helper_5);
+res(3) = helper_3*helper_6 - mu*(-F(1,1) + helper_6);
+}
+
+void neo_hookean_2d_stress_grad(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const double lambda, const double mu, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 9, 9> &res) {
+res.resize(4, 4);
+const auto helper_0 = F(0,0)*F(1,1);
+const auto helper_1 = F(0,1)*F(1,0);
+const auto helper_2 = helper_0 - helper_1;
+const auto helper_3 = pow(helper_2, -2);
+const auto helper_4 = pow(F(1,1), 2)*helper_3;
+const auto helper_5 = lambda*log(helper_2);
+const auto helper_6 = helper_3*(helper_5 - lambda - mu);
+const auto helper_7 = F(1,1)*helper_6;
+const auto helper_8 = F(0,1)*helper_7;
+const auto helper_9 = F(1,0)*helper_7;
+const auto helper_10 = 1.0/helper_2;
+const auto helper_11 = helper_0*helper_10;
+const auto helper_12 = helper_10*(-helper_11*helper_5 + helper_11*lambda + helper_5 + mu*(helper_11 - 1));
+const auto helper_13 = pow(F(0,1), 2)*helper_3;
+const auto helper_14 = helper_1*helper_10;
+const auto helper_15 = helper_10*(F(0,1)*F(1,0)*helper_10*lambda - helper_14*helper_5 - helper_5 + mu*(helper_14 + 1));
+const auto helper_16 = F(0,0)*helper_6;
+const auto helper_17 = F(0,1)*helper_16;
+const auto helper_18 = pow(F(1,0), 2)*helper_3;
+const auto helper_19 = F(1,0)*helper_16;
+const auto helper_20 = pow(F(0,0), 2)*helper_3;
+res(0) = -helper_4*helper_5 + helper_4*lambda + mu*(helper_4 + 1);
+res(1) = helper_8;
+res(2) = helper_9;
+res(3) = helper_12;
+res(4) = helper_8;
+res(5) = -helper_13*helper_5 + helper_13*lambda + mu*(helper_13 + 1);
+res(6) = helper_15;
+res(7) = helper_17;
+res(8) = helper_9;
+res(9) = helper_15;
+res(10) = -helper_18*helper_5 + helper_18*lambda + mu*(helper_18 + 1);
+res(11) = helper_19;
+res(12) = helper_12;
+res(13) = helper_17;
+res(14) = helper_19;
+res(15) = -helper_20*helper_5 + helper_20*lambda + mu*(helper_20 + 1);
+}
+
+double neo_hookean_3d_energy(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const double lambda, const double mu) {
+const auto helper_0 = log(F(0,0)*(F(1,1)*F(2,2) - F(1,2)*F(2,1)) - F(0,1)*(F(1,0)*F(2,2) - F(1,2)*F(2,0)) + F(0,2)*(F(1,0)*F(2,1) - F(1,1)*F(2,0)));
+return (1.0/2.0)*pow(helper_0, 2)*lambda + (1.0/2.0)*mu*(pow(F(0,0), 2) + pow(F(0,1), 2) + pow(F(0,2), 2) + pow(F(1,0), 2) + pow(F(1,1), 2) + pow(F(1,2), 2) + pow(F(2,0), 2) + pow(F(2,1), 2) + pow(F(2,2), 2) - 2*helper_0 - 3);
+}
+
+void neo_hookean_3d_stress(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const double lambda, const double mu, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &res) {
+res.resize(3, 3);
+const auto helper_0 = F(1,1)*F(2,2) - F(1,2)*F(2,1);
+const auto helper_1 = F(1,0)*F(2,1) - F(1,1)*F(2,0);
+const auto helper_2 = F(1,0)*F(2,2) - F(1,2)*F(2,0);
+const auto helper_3 = F(0,0)*helper_0 - F(0,1)*helper_2 + F(0,2)*helper_1;
+const auto helper_4 = 1.0/helper_3;
+const auto helper_5 = helper_0*helper_4;
+const auto helper_6 = lambda*log(helper_3);
+const auto helper_7 = helper_4*(F(0,1)*F(2,2) - F(0,2)*F(2,1));
+const auto helper_8 = helper_4*(F(0,1)*F(1,2) - F(0,2)*F(1,1));
+const auto helper_9 = helper_2*helper_4;
+const auto helper_10 = helper_4*(F(0,0)*F(2,2) - F(0,2)*F(2,0));
+const auto helper_11 = helper_4*(F(0,0)*F(1,2) - F(0,2)*F(1,0));
+const auto helper_12 = helper_1*helper_4;
+const auto helper_13 = helper_4*(F(0,0)*F(2,1) - F(0,1)*F(2,0));
+const auto helper_14 = helper_4*(F(0,0)*F(1,1) - F(0,1)*F(1,0));
+res(0) = helper_5*helper_6 + mu*(F(0,0) - helper_5);
+res(1) = -helper_6*helper_7 + mu*(F(1,0) + helper_7);
+res(2) = helper_6*helper_8 + mu*(F(2,0) - helper_8);
+res(3) = -helper_6*helper_9 + mu*(F(0,1) + helper_9);
+res(4) = helper_10*helper_6 + mu*(F(1,1) - helper_10);
+res(5) = -helper_11*helper_6 + mu*(F(2,1) + helper_11);
+res(6) = helper_12*helper_6 + mu*(F(0,2) - helper_12);
+res(7) = -helper_13*helper_6 + mu*(F(1,2) + helper_13);
+res(8) = helper_14*helper_6 + mu*(F(2,2) - helper_14);
+}
+
+void neo_hookean_3d_stress_grad(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const double lambda, const double mu, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 9, 9> &res) {
+res.resize(9, 9);
+const auto helper_0 = F(1,1)*F(2,2) - F(1,2)*F(2,1);
+const auto helper_1 = pow(helper_0, 2);
+const auto helper_2 = F(1,0)*F(2,1) - F(1,1)*F(2,0);
+const auto helper_3 = F(1,0)*F(2,2) - F(1,2)*F(2,0);
+const auto helper_4 = F(0,0)*helper_0 - F(0,1)*helper_3 + F(0,2)*helper_2;
+const auto helper_5 = pow(helper_4, -2);
+const auto helper_6 = helper_0*helper_5;
+const auto helper_7 = log(helper_4);
+const auto helper_8 = helper_7*lambda;
+const auto helper_9 = helper_5*helper_8;
+const auto helper_10 = F(0,1)*F(2,2) - F(0,2)*F(2,1);
+const auto helper_11 = -helper_7*lambda + lambda + mu;
+const auto helper_12 = -helper_11;
+const auto helper_13 = helper_12*helper_6;
+const auto helper_14 = helper_10*helper_13;
+const auto helper_15 = F(0,1)*F(1,2) - F(0,2)*F(1,1);
+const auto helper_16 = helper_11*helper_6;
+const auto helper_17 = helper_15*helper_16;
+const auto helper_18 = helper_13*helper_3;
+const auto helper_19 = 1.0/helper_4;
+const auto helper_20 = F(2,2)*helper_8;
+const auto helper_21 = F(0,0)*F(2,2) - F(0,2)*F(2,0);
+const auto helper_22 = helper_0*helper_19;
+const auto helper_23 = helper_21*helper_22;
+const auto helper_24 = helper_19*(helper_20 - helper_23*helper_8 + helper_23*lambda - mu*(F(2,2) - helper_23));
+const auto helper_25 = F(1,2)*helper_8;
+const auto helper_26 = F(0,0)*F(1,2) - F(0,2)*F(1,0);
+const auto helper_27 = helper_22*helper_26;
+const auto helper_28 = helper_19*(helper_0*helper_19*helper_26*helper_7*lambda - helper_25 - helper_27*lambda + mu*(F(1,2) - helper_27));
+const auto helper_29 = helper_16*helper_2;
+const auto helper_30 = F(2,1)*helper_8;
+const auto helper_31 = F(0,0)*F(2,1) - F(0,1)*F(2,0);
+const auto helper_32 = helper_22*helper_31;
+const auto helper_33 = helper_19*(helper_0*helper_19*helper_31*helper_7*lambda - helper_30 - helper_32*lambda + mu*(F(2,1) - helper_32));
+const auto helper_34 = F(1,1)*helper_8;
+const auto helper_35 = F(0,0)*F(1,1) - F(0,1)*F(1,0);
+const auto helper_36 = helper_22*helper_35;
+const auto helper_37 = helper_19*(helper_34 - helper_36*helper_8 + helper_36*lambda - mu*(F(1,1) - helper_36));
+const auto helper_38 = pow(helper_10, 2);
+const auto helper_39 = helper_10*helper_5;
+const auto helper_40 = helper_12*helper_39;
+const auto helper_41 = helper_15*helper_40;
+const auto helper_42 = helper_10*helper_19;
+const auto helper_43 = helper_3*helper_42;
+const auto helper_44 = helper_19*(helper_10*helper_19*helper_3*lambda - helper_20 - helper_43*helper_8 + mu*(F(2,2) + helper_43));
+const auto helper_45 = helper_21*helper_40;
+const auto helper_46 = F(0,2)*helper_8;
+const auto helper_47 = helper_26*helper_42;
+const auto helper_48 = helper_19*(helper_46 - helper_47*helper_8 + helper_47*lambda - mu*(F(0,2) - helper_47));
+const auto helper_49 = helper_2*helper_42;
+const auto helper_50 = helper_19*(helper_30 + helper_49*helper_8 - helper_49*lambda - mu*(F(2,1) + helper_49));
+const auto helper_51 = helper_11*helper_31*helper_39;
+const auto helper_52 = F(0,1)*helper_8;
+const auto helper_53 = helper_35*helper_42;
+const auto helper_54 = helper_19*(helper_10*helper_19*helper_35*helper_7*lambda - helper_52 - helper_53*lambda + mu*(F(0,1) - helper_53));
+const auto helper_55 = pow(helper_15, 2);
+const auto helper_56 = helper_15*helper_5;
+const auto helper_57 = helper_15*helper_19;
+const auto helper_58 = helper_3*helper_57;
+const auto helper_59 = helper_19*(helper_25 + helper_58*helper_8 - helper_58*lambda - mu*(F(1,2) + helper_58));
+const auto helper_60 = helper_21*helper_57;
+const auto helper_61 = helper_19*(helper_15*helper_19*helper_21*lambda - helper_46 - helper_60*helper_8 + mu*(F(0,2) + helper_60));
+const auto helper_62 = helper_12*helper_26;
+const auto helper_63 = helper_56*helper_62;
+const auto helper_64 = helper_2*helper_57;
+const auto helper_65 = helper_19*(helper_15*helper_19*helper_2*lambda - helper_34 - helper_64*helper_8 + mu*(F(1,1) + helper_64));
+const auto helper_66 = helper_31*helper_57;
+const auto helper_67 = helper_19*(helper_52 + helper_66*helper_8 - helper_66*lambda - mu*(F(0,1) + helper_66));
+const auto helper_68 = helper_11*helper_35;
+const auto helper_69 = helper_56*helper_68;
+const auto helper_70 = pow(helper_3, 2);
+const auto helper_71 = helper_3*helper_5;
+const auto helper_72 = helper_12*helper_71;
+const auto helper_73 = helper_21*helper_72;
+const auto helper_74 = helper_11*helper_26*helper_71;
+const auto helper_75 = helper_2*helper_72;
+const auto helper_76 = F(2,0)*helper_8;
+const auto helper_77 = helper_19*helper_3;
+const auto helper_78 = helper_31*helper_77;
+const auto helper_79 = helper_19*(helper_76 - helper_78*helper_8 + helper_78*lambda - mu*(F(2,0) - helper_78));
+const auto helper_80 = F(1,0)*helper_8;
+const auto helper_81 = helper_35*helper_77;
+const auto helper_82 = helper_19*(helper_19*helper_3*helper_35*helper_7*lambda - helper_80 - helper_81*lambda + mu*(F(1,0) - helper_81));
+const auto helper_83 = pow(helper_21, 2);
+const auto helper_84 = helper_21*helper_5;
+const auto helper_85 = helper_62*helper_84;
+const auto helper_86 = helper_19*helper_21;
+const auto helper_87 = helper_2*helper_86;
+const auto helper_88 = helper_19*(helper_19*helper_2*helper_21*lambda - helper_76 - helper_8*helper_87 + mu*(F(2,0) + helper_87));
+const auto helper_89 = helper_12*helper_31;
+const auto helper_90 = helper_84*helper_89;
+const auto helper_91 = F(0,0)*helper_8;
+const auto helper_92 = helper_35*helper_86;
+const auto helper_93 = helper_19*(-helper_8*helper_92 + helper_91 + helper_92*lambda - mu*(F(0,0) - helper_92));
+const auto helper_94 = pow(helper_26, 2);
+const auto helper_95 = helper_26*helper_5;
+const auto helper_96 = helper_19*helper_26;
+const auto helper_97 = helper_2*helper_96;
+const auto helper_98 = helper_19*(helper_8*helper_97 + helper_80 - helper_97*lambda - mu*(F(1,0) + helper_97));
+const auto helper_99 = helper_31*helper_96;
+const auto helper_100 = helper_19*(helper_19*helper_26*helper_31*lambda - helper_8*helper_99 - helper_91 + mu*(F(0,0) + helper_99));
+const auto helper_101 = helper_12*helper_35;
+const auto helper_102 = helper_101*helper_95;
+const auto helper_103 = pow(helper_2, 2);
+const auto helper_104 = helper_2*helper_5;
+const auto helper_105 = helper_104*helper_89;
+const auto helper_106 = helper_104*helper_68;
+const auto helper_107 = pow(helper_31, 2);
+const auto helper_108 = helper_31*helper_5;
+const auto helper_109 = helper_101*helper_108;
+const auto helper_110 = pow(helper_35, 2);
+res(0) = helper_1*helper_5*lambda - helper_1*helper_9 - mu*(-helper_0*helper_6 - 1);
+res(1) = helper_14;
+res(2) = helper_17;
+res(3) = helper_18;
+res(4) = helper_24;
+res(5) = helper_28;
+res(6) = helper_29;
+res(7) = helper_33;
+res(8) = helper_37;
+res(9) = helper_14;
+res(10) = helper_38*helper_5*lambda - helper_38*helper_9 - mu*(-helper_10*helper_39 - 1);
+res(11) = helper_41;
+res(12) = helper_44;
+res(13) = helper_45;
+res(14) = helper_48;
+res(15) = helper_50;
+res(16) = helper_51;
+res(17) = helper_54;
+res(18) = helper_17;
+res(19) = helper_41;
+res(20) = helper_5*helper_55*lambda - helper_55*helper_9 - mu*(-helper_15*helper_56 - 1);
+res(21) = helper_59;
+res(22) = helper_61;
+res(23) = helper_63;
+res(24) = helper_65;
+res(25) = helper_67;
+res(26) = helper_69;
+res(27) = helper_18;
+res(28) = helper_44;
+res(29) = helper_59;
+res(30) = helper_5*helper_70*lambda - helper_70*helper_9 - mu*(-helper_3*helper_71 - 1);
+res(31) = helper_73;
+res(32) = helper_74;
+res(33) = helper_75;
+res(34) = helper_79;
+res(35) = helper_82;
+res(36) = helper_24;
+res(37) = helper_45;
+res(38) = helper_61;
+res(39) = helper_73;
+res(40) = helper_5*helper_83*lambda - helper_83*helper_9 - mu*(-helper_21*helper_84 - 1);
+res(41) = helper_85;
+res(42) = helper_88;
+res(43) = helper_90;
+res(44) = helper_93;
+res(45) = helper_28;
+res(46) = helper_48;
+res(47) = helper_63;
+res(48) = helper_74;
+res(49) = helper_85;
+res(50) = helper_5*helper_94*lambda - helper_9*helper_94 - mu*(-helper_26*helper_95 - 1);
+res(51) = helper_98;
+res(52) = helper_100;
+res(53) = helper_102;
+res(54) = helper_29;
+res(55) = helper_50;
+res(56) = helper_65;
+res(57) = helper_75;
+res(58) = helper_88;
+res(59) = helper_98;
+res(60) = helper_103*helper_5*lambda - helper_103*helper_9 - mu*(-helper_104*helper_2 - 1);
+res(61) = helper_105;
+res(62) = helper_106;
+res(63) = helper_33;
+res(64) = helper_51;
+res(65) = helper_67;
+res(66) = helper_79;
+res(67) = helper_90;
+res(68) = helper_100;
+res(69) = helper_105;
+res(70) = helper_107*helper_5*lambda - helper_107*helper_9 - mu*(-helper_108*helper_31 - 1);
+res(71) = helper_109;
+res(72) = helper_37;
+res(73) = helper_54;
+res(74) = helper_69;
+res(75) = helper_82;
+res(76) = helper_93;
+res(77) = helper_102;
+res(78) = helper_106;
+res(79) = helper_109;
+res(80) = helper_110*helper_5*lambda - helper_110*helper_9 - mu*(-pow(helper_35, 2)*helper_5 - 1);
+}
+
+
+
+}}
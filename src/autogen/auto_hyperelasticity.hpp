@@ -0,0 +1,23 @@
+#pragma once
+
+#include <polyfem/ElasticityUtils.hpp>
+#include <Eigen/Dense>
+
+namespace polyfem {
+namespace autogen {
+double saint_venant_2d_energy(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const ElasticityTensor &C);
+void saint_venant_2d_stress(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const ElasticityTensor &C, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &res);
+void saint_venant_2d_stress_grad(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const ElasticityTensor &C, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 9, 9> &res);
+double saint_venant_3d_energy(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const ElasticityTensor &C);
+void saint_venant_3d_stress(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const ElasticityTensor &C, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &res);
+void saint_venant_3d_stress_grad(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const ElasticityTensor &C, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 9, 9> &res);
+
+double neo_hookean_2d_energy(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const double lambda, const double mu);
+void neo_hookean_2d_stress(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const double lambda, const double mu, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &res);
+void neo_hookean_2d_stress_grad(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const double lambda, const double mu, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 9, 9> &res);
+double neo_hookean_3d_energy(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const double lambda, const double mu);
+void neo_hookean_3d_stress(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const double lambda, const double mu, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &res);
+void neo_hookean_3d_stress_grad(const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> &F, const double lambda, const double mu, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 9, 9> &res);
+
+
+}}
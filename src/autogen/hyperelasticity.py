@@ -0,0 +1,150 @@
+from sympy import *
+from sympy.matrices import *
+import os
+import re
+import argparse
+
+# local
+import pretty_print
+
+
+def Det(mat):
+    assert(mat.rows == mat.cols)
+
+    if(mat.rows == 2):
+        return mat[0, 0] * mat[1, 1] - mat[0, 1] * mat[1, 0]
+    elif(mat.rows == 3):
+        return mat[0, 0] * (mat[1, 1] * mat[2, 2] - mat[1, 2] * mat[2, 1]) - mat[0, 1] * (mat[1, 0] * mat[2, 2] - mat[1, 2] * mat[2, 0]) + mat[0, 2] * (mat[1, 0] * mat[2, 1] - mat[1, 1] * mat[2, 0])
+
+    assert(False)
+    return 0
+
+
+# the elasticity tensor in Voigt notation is symmetric, only C(i, j) with i <= j are used
+def C(i, j):
+    return Symbol('C[' + str(min(i, j)) + ',' + str(max(i, j)) + ']', real=True)
+
+
+def sigma_fun(j, ee, dim):
+    res = 0
+
+    for k in range(dim):
+        res += C(j, k) * ee[k]
+    return res
+
+
+# W = 1/2 (C:E):E, E = 1/2 (F^T F - I)
+def saint_venant(def_grad):
+    l_dim = def_grad.rows
+
+    eps = (Transpose(def_grad) * def_grad - eye(l_dim)) / 2
+
+    if l_dim == 2:
+        ee = [eps[0, 0], eps[1, 1], 2 * eps[0, 1]]
+        n_voigt = 3
+    else:
+        ee = [eps[0, 0], eps[1, 1], eps[2, 2], 2 * eps[1, 2], 2 * eps[0, 2], 2 * eps[0, 1]]
+        n_voigt = 6
+
+    energy = 0
+    for j in range(n_voigt):
+        energy += sigma_fun(j, ee, n_voigt) * ee[j]
+
+    return energy / 2
+
+
+# W = mu/2 (tr(F^T F) - dim - 2 ln J) + lambda/2 ln(J)^2
+def neo_hookean(def_grad):
+    l_dim = def_grad.rows
+
+    mu = Symbol('mu')
+    llambda = Symbol('lambda')
+
+    log_det_j = log(Det(def_grad))
+
+    return mu / 2 * ((Transpose(def_grad) * def_grad).trace() - l_dim - 2 * log_det_j) + llambda / 2 * log_det_j**2
+
+
+def to_cpp(expr):
+    c99 = pretty_print.C99_print(expr)
+
+    c99 = re.sub(r"F\[(\d{1}),(\d{1})\]", r'F(\1,\2)', c99)
+    c99 = re.sub(r"C\[(\d{1}),(\d{1})\]", r'C(\1,\2)', c99)
+    c99 = re.sub(r"result_(\d+)", r'res(\1)', c99)
+
+    return c99
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("output", type=str, help="path to the output folder")
+    return parser.parse_args()
+
+
+if __name__ == "__main__":
+    args = parse_args()
+    dims = [2, 3]
+    names = ["saint_venant", "neo_hookean"]
+    cpp = "#include <polyfem/auto_hyperelasticity.hpp>\n\n#include <cmath>\n\n"
+    hpp = "#pragma once\n\n#include <polyfem/ElasticityUtils.hpp>\n#include <Eigen/Dense>\n\n"
+    cpp = cpp + "namespace polyfem {\nnamespace autogen " + "{\n"
+    hpp = hpp + "namespace polyfem {\nnamespace autogen " + "{\n"
+
+    # energy density W(F), first Piola-Kirchhoff stress P = dW/dF, and dP/dF
+    # P and dP/dF are flattened column major, the entry (i, j) of F has index i + j * dim
+    for name in names:
+        for dim in dims:
+            print("processing " + name + " in " + str(dim) + "D")
+
+            def_grad = zeros(dim, dim)
+            for i in range(0, dim):
+                for j in range(0, dim):
+                    def_grad[i, j] = Symbol('F[' + str(i) + ',' + str(j) + ']', real=True)
+
+            if name == "saint_venant":
+                energy = saint_venant(def_grad)
+                params = ", const ElasticityTensor &C"
+            elif name == "neo_hookean":
+                energy = neo_hookean(def_grad)
+                params = ", const double lambda, const double mu"
+
+            # column major flattening
+            flat = [def_grad[i, j] for j in range(dim) for i in range(dim)]
+            stress = [diff(energy, f) for f in flat]
+            stress_grad = [diff(stress[a], flat[b]) for b in range(len(flat)) for a in range(len(flat))]
+
+            mat_type = "Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3>"
+            grad_type = "Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 9, 9>"
+            base = name + "_" + str(dim) + "d_"
+            args_sig = "(const " + mat_type + " &F" + params
+
+            signature = "double " + base + "energy" + args_sig + ")"
+            c99 = to_cpp([energy]).replace("res(0) = ", "return ")
+            cpp = cpp + signature + " {\n" + c99 + "\n}\n\n"
+            hpp = hpp + signature + ";\n"
+
+            signature = "void " + base + "stress" + args_sig + ", " + mat_type + " &res)"
+            cpp = cpp + signature + " {\nres.resize(" + str(dim) + ", " + str(dim) + ");\n" + to_cpp(stress) + "\n}\n\n"
+            hpp = hpp + signature + ";\n"
+
+            signature = "void " + base + "stress_grad" + args_sig + ", " + grad_type + " &res)"
+            cpp = cpp + signature + " {\nres.resize(" + str(dim * dim) + ", " + str(dim * dim) + ");\n" + to_cpp(stress_grad) + "\n}\n\n"
+            hpp = hpp + signature + ";\n"
+
+        cpp = cpp + "\n"
+        hpp = hpp + "\n"
+
+    cpp = cpp + "\n}}\n"
+    hpp = hpp + "\n}}\n"
+    path = os.path.abspath(args.output)
+
+    print("saving...")
+    with open(os.path.join(path, "auto_hyperelasticity.cpp"), "w") as file:
+        file.write(cpp)
+
+    with open(os.path.join(path, "auto_hyperelasticity.hpp"), "w") as file:
+        file.write(hpp)
+
+    print("done!")
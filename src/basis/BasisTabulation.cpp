@@ -0,0 +1,45 @@
+#include <polyfem/BasisTabulation.hpp>
+
+#include <polyfem/ElementBases.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace polyfem
+{
+	const BasisTabulation &BasisTabulation::get(const Type type, const int order, const Quadrature &quad, const ElementBases &bases)
+	{
+		assert(type != Type::None);
+
+		//heap allocated so that the references survive insertions
+		static std::map<std::tuple<int, int, const Quadrature *>, std::unique_ptr<BasisTabulation>> tabulations;
+		static std::mutex mutex;
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		std::unique_ptr<BasisTabulation> &tab = tabulations[std::make_tuple(int(type), order, &quad)];
+		if (!tab)
+		{
+			tab.reset(new BasisTabulation());
+			tab->type = type;
+			tab->order = order;
+			tab->quadrature = &quad;
+
+			std::vector<AssemblyValues> values;
+			bases.evaluate_bases(quad.points, values);
+			bases.evaluate_grads(quad.points, values);
+
+			tab->val.resize(values.size());
+			tab->grad.resize(values.size());
+			for (size_t i = 0; i < values.size(); ++i)
+			{
+				tab->val[i] = values[i].val;
+				tab->grad[i] = values[i].grad;
+			}
+		}
+
+		return *tab;
+	}
+} // namespace polyfem
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <polyfem/Quadrature.hpp>
+
+#include <Eigen/Dense>
+#include <vector>
+
+namespace polyfem
+{
+	class ElementBases;
+
+	//values and gradients of the local bases of a reference element at the points of a shared quadrature rule
+	//they are the same for all the elements with the same type and order, only the geometric mapping is per element
+	class BasisTabulation
+	{
+	public:
+		enum class Type
+		{
+			None,
+			P2d,
+			Q2d,
+			P3d,
+			Q3d
+		};
+
+		Type type = Type::None;
+		int order = -1;
+		const Quadrature *quadrature = nullptr;
+
+		//one entry per local basis, n_points x 1 and n_points x dim
+		std::vector<Eigen::MatrixXd> val;
+		std::vector<Eigen::MatrixXd> grad;
+
+		//process wide tabulation of the bases of type and order at the points of quad, evaluated with bases the first time
+		//quad must be a shared rule (see QuadratureCache), the returned reference stays valid for the whole run, lookups are thread safe
+		static const BasisTabulation &get(const Type type, const int order, const Quadrature &quad, const ElementBases &bases);
+	};
+} // namespace polyfem
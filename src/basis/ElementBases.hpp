@@ -2,6 +2,7 @@
 #define ELEMENT_BASES_HPP
 
 #include <polyfem/Basis.hpp>
+#include <polyfem/BasisTabulation.hpp>
 #include <polyfem/Quadrature.hpp>
 #include <polyfem/Mesh.hpp>
 
@@ -26,13 +27,32 @@ namespace polyfem
 		std::vector<Basis> bases;
 
 		// quadrature points to evaluate the basis functions inside the element
-		void compute_quadrature(Quadrature &quadrature) const { quadrature_builder_(quadrature); }
+		void compute_quadrature(Quadrature &quadrature) const
+		{
+			if (shared_quadrature_)
+				quadrature = *shared_quadrature_;
+			else
+				quadrature_builder_(quadrature);
+		}
+		// the rule shared with the other elements (see QuadratureCache), nullptr if the quadrature is built per element
+		const Quadrature *shared_quadrature() const { return shared_quadrature_; }
 		Eigen::VectorXi local_nodes_for_primitive(const int local_index, const Mesh &mesh) const { return local_node_from_primitive_(local_index, mesh); }
 
 		// whether the basis functions should be evaluated in the parametric domain (FE bases),
 		// or directly in the object domain (harmonic bases)
 		bool has_parameterization = true;
 
+		// order of the lagrange bases if they are a tensor product on a hex with the tensor product
+		// HexQuadrature of order tensor_quadrature_order (used by sum factorization), -1 otherwise
+		int tensor_order = -1;
+		int tensor_quadrature_order = -1;
+
+		// type and order of the reference element if the local bases are the standard lagrange ones
+		// (the same functions for all the elements), their values at the shared quadrature points are
+		// tabulated once (see BasisTabulation), None if the bases are element specific
+		BasisTabulation::Type reference_type = BasisTabulation::Type::None;
+		int reference_order = -1;
+
 		///
 		/// @brief      { Map the sample positions in the parametric domain to
 		///             the object domain (if the element has no
@@ -67,7 +87,17 @@ namespace polyfem
 			return os;
 		}
 
-		void set_quadrature(const QuadratureFunction &fun) { quadrature_builder_ = fun; }
+		void set_quadrature(const QuadratureFunction &fun)
+		{
+			quadrature_builder_ = fun;
+			shared_quadrature_ = nullptr;
+		}
+		// quad must outlive the bases, typically it comes from QuadratureCache
+		void set_quadrature(const Quadrature &quad)
+		{
+			quadrature_builder_ = nullptr;
+			shared_quadrature_ = &quad;
+		}
 
 		//evaluation functions
 		void evaluate_bases(const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &basis_values) const
@@ -107,6 +137,7 @@ namespace polyfem
 		EvalBasesFunc eval_bases_func_;
 		EvalBasesFunc eval_grads_func_;
 		QuadratureFunction quadrature_builder_;
+		const Quadrature *shared_quadrature_ = nullptr;
 
 		LocalNodeFromPrimitiveFunc local_node_from_primitive_;
 	};
@@ -1,7 +1,6 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <polyfem/FEBasis2d.hpp>
-#include <polyfem/TriQuadrature.hpp>
-#include <polyfem/QuadQuadrature.hpp>
+#include <polyfem/QuadratureCache.hpp>
 #include <polyfem/auto_p_bases.hpp>
 #include <polyfem/auto_q_bases.hpp>
 
@@ -584,10 +583,7 @@ int polyfem::FEBasis2d::build_bases(
 		}
 
 		if (mesh.is_cube(e)) {
-			b.set_quadrature([quadrature_order](Quadrature &quad){
-				QuadQuadrature quad_quadrature;
-				quad_quadrature.get_quadrature(quadrature_order, quad);
-			});
+			b.set_quadrature(QuadratureCache::quad(quadrature_order));
 			// quad_quadrature.get_quadrature(quadrature_order, b.quadrature);
 
 			b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh)
@@ -616,13 +612,13 @@ int polyfem::FEBasis2d::build_bases(
 				b.bases[j].set_basis([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { polyfem::autogen::q_basis_value_2d     (dtmp, j, uv, val); });
 				b.bases[j].set_grad ([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { polyfem::autogen::q_grad_basis_value_2d(dtmp, j, uv, val); });
 			}
+
+			b.reference_type = BasisTabulation::Type::Q2d;
+			b.reference_order = serendipity ? -2 : discr_order;
 		} else if(mesh.is_simplex(e))
 		{
 			const int real_order = std::max(quadrature_order, (discr_order - 1) * (discr_order - 1));
-			b.set_quadrature([real_order](Quadrature &quad){
-				TriQuadrature tri_quadrature;
-				tri_quadrature.get_quadrature(real_order, quad);
-			});
+			b.set_quadrature(QuadratureCache::tri(real_order));
 
 			b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh)
 			{
@@ -698,6 +694,12 @@ int polyfem::FEBasis2d::build_bases(
 					b.bases[j].set_grad ([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { polyfem::autogen::p_grad_basis_value_2d(discr_order, j, uv, val); });
 				}
 			}
+
+			if(!rational)
+			{
+				b.reference_type = BasisTabulation::Type::P2d;
+				b.reference_order = discr_order;
+			}
 		}
 		else {
 			// Polygon bases are built later on
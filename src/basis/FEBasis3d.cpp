@@ -2,8 +2,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <polyfem/FEBasis3d.hpp>
 #include <polyfem/MeshNodes.hpp>
-#include <polyfem/TetQuadrature.hpp>
-#include <polyfem/HexQuadrature.hpp>
+#include <polyfem/QuadratureCache.hpp>
 
 #include <polyfem/auto_p_bases.hpp>
 #include <polyfem/auto_q_bases.hpp>
@@ -1003,10 +1002,13 @@ int polyfem::FEBasis3d::build_bases(
 
 		if (mesh.is_cube(e)) {
 			// hex_quadrature.get_quadrature(quadrature_order, b.quadrature);
-			b.set_quadrature([quadrature_order](Quadrature &quad){
-				HexQuadrature hex_quadrature;
-				hex_quadrature.get_quadrature(quadrature_order, quad);
-			});
+			b.set_quadrature(QuadratureCache::hex(quadrature_order));
+
+			if (!serendipity && discr_order >= 1)
+			{
+				b.tensor_order = discr_order;
+				b.tensor_quadrature_order = quadrature_order;
+			}
 
 
 			b.set_local_node_from_primitive_func([serendipity, discr_order, e](const int primitive_id, const Mesh &mesh)
@@ -1034,14 +1036,14 @@ int polyfem::FEBasis3d::build_bases(
 				b.bases[j].set_basis([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { polyfem::autogen::q_basis_value_3d     (dtmp, j, uv, val); });
 				b.bases[j].set_grad ([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { polyfem::autogen::q_grad_basis_value_3d(dtmp, j, uv, val); });
 			}
+
+			b.reference_type = BasisTabulation::Type::Q3d;
+			b.reference_order = serendipity ? -2 : discr_order;
 		}
 		else if(mesh.is_simplex(e)) {
 			const int real_order = std::max(quadrature_order, (discr_order - 1) * (discr_order - 1));
 
-			b.set_quadrature([real_order](Quadrature &quad){
-				TetQuadrature tet_quadrature;
-				tet_quadrature.get_quadrature(real_order, quad);
-			});
+			b.set_quadrature(QuadratureCache::tet(real_order));
 
 
 			b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh)
@@ -1074,6 +1076,9 @@ int polyfem::FEBasis3d::build_bases(
 				b.bases[j].set_grad ([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { polyfem::autogen::p_grad_basis_value_3d(discr_order, j, uv, val); });
 			}
 
+			b.reference_type = BasisTabulation::Type::P3d;
+			b.reference_order = discr_order;
+
 		}
 		else {
 			// Polyhedra bases are built later on
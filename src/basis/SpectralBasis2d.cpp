@@ -1,7 +1,7 @@
 #include <polyfem/SpectralBasis2d.hpp>
 
 #include <polyfem/QuadraticBSpline2d.hpp>
-#include <polyfem/QuadQuadrature.hpp>
+#include <polyfem/QuadratureCache.hpp>
 #include <polyfem/MeshNodes.hpp>
 
 #include <polyfem/FEBasis2d.hpp>
@@ -69,10 +69,7 @@ namespace polyfem
         const int n_bases = order * order;
 
         b.bases.resize(n_bases);
-        b.set_quadrature([quadrature_order](Quadrature &quad){
-            QuadQuadrature quad_quadrature;
-            quad_quadrature.get_quadrature(quadrature_order, quad);
-        });
+        b.set_quadrature(QuadratureCache::quad(quadrature_order));
 
 
         for (int i = 0; i < order; ++i) {
@@ -1,7 +1,7 @@
 #include <polyfem/SplineBasis2d.hpp>
 
 #include <polyfem/QuadraticBSpline2d.hpp>
-#include <polyfem/QuadQuadrature.hpp>
+#include <polyfem/QuadratureCache.hpp>
 #include <polyfem/MeshNodes.hpp>
 
 #include <polysolve/LinearSolver.hpp>
@@ -704,10 +704,7 @@ namespace polyfem
 
             ElementBases &b=bases[e];
             // quad_quadrature.get_quadrature(quadrature_order, b.quadrature);
-            b.set_quadrature([quadrature_order](Quadrature &quad){
-                QuadQuadrature quad_quadrature;
-                quad_quadrature.get_quadrature(quadrature_order, quad);
-            });
+            b.set_quadrature(QuadratureCache::quad(quadrature_order));
             b.bases.resize(9);
 
             b.set_local_node_from_primitive_func([e](const int primitive_id, const Mesh &mesh)
@@ -760,10 +757,7 @@ namespace polyfem
 
             ElementBases &b=bases[e];
             // quad_quadrature.get_quadrature(quadrature_order, b.quadrature);
-            b.set_quadrature([quadrature_order](Quadrature &quad){
-                QuadQuadrature quad_quadrature;
-                quad_quadrature.get_quadrature(quadrature_order, quad);
-            });
+            b.set_quadrature(QuadratureCache::quad(quadrature_order));
 
             b.set_local_node_from_primitive_func([e](const int primitive_id, const Mesh &mesh)
             {
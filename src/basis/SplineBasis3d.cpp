@@ -1,7 +1,7 @@
 #include <polyfem/SplineBasis3d.hpp>
 
 #include <polyfem/QuadraticBSpline3d.hpp>
-#include <polyfem/HexQuadrature.hpp>
+#include <polyfem/QuadratureCache.hpp>
 
 
 #include <polysolve/LinearSolver.hpp>
@@ -1070,10 +1070,7 @@ void basis_for_regular_hex(MeshNodes &mesh_nodes, const SpaceMatrix &space, cons
             build_local_space(mesh, mesh_nodes, e, space, local_boundary, poly_face_to_data);
 
             ElementBases &b=bases[e];
-            b.set_quadrature([quadrature_order](Quadrature &quad){
-                HexQuadrature hex_quadrature;
-                hex_quadrature.get_quadrature(quadrature_order, quad);
-            });
+            b.set_quadrature(QuadratureCache::hex(quadrature_order));
             // hex_quadrature.get_quadrature(quadrature_order, b.quadrature);
             b.bases.resize(27);
 
@@ -1138,10 +1135,7 @@ void basis_for_regular_hex(MeshNodes &mesh_nodes, const SpaceMatrix &space, cons
 
             ElementBases &b=bases[e];
             // hex_quadrature.get_quadrature(quadrature_order, b.quadrature);
-            b.set_quadrature([quadrature_order](Quadrature &quad){
-                HexQuadrature hex_quadrature;
-                hex_quadrature.get_quadrature(quadrature_order, quad);
-            });
+            b.set_quadrature(QuadratureCache::hex(quadrature_order));
 
             b.set_local_node_from_primitive_func([e](const int primitive_id, const Mesh &mesh)
             {
@@ -5,6 +5,35 @@
 
 namespace polyfem
 {
+	namespace
+	{
+		//rows of the points grouped by the first position in ids of their boundary id, points with another id are skipped
+		std::vector<std::vector<int>> rows_per_boundary(const Mesh &mesh, const Eigen::MatrixXi &global_ids, const long n_pts, const std::vector<int> &ids)
+		{
+			std::vector<std::vector<int>> rows(ids.size());
+			for (long i = 0; i < n_pts; ++i)
+			{
+				const int id = mesh.get_boundary_id(global_ids(i));
+				for (size_t b = 0; b < ids.size(); ++b)
+				{
+					if (id == ids[b])
+					{
+						rows[b].push_back(i);
+						break;
+					}
+				}
+			}
+			return rows;
+		}
+
+		Eigen::MatrixXd select_rows(const Eigen::MatrixXd &mat, const std::vector<int> &rows)
+		{
+			Eigen::MatrixXd res(rows.size(), mat.cols());
+			for (size_t k = 0; k < rows.size(); ++k)
+				res.row(k) = mat.row(rows[k]);
+			return res;
+		}
+	} // namespace
 
 	std::shared_ptr<Interpolation> Interpolation::build(const json &params)
 	{
@@ -50,11 +79,11 @@ namespace polyfem
 			return;
 		}
 
-		const bool planar = pts.cols() == 2;
-		for (int i = 0; i < pts.rows(); ++i)
+		Eigen::VectorXd tmp;
+		for (int j = 0; j < pts.cols(); ++j)
 		{
-			for (int j = 0; j < pts.cols(); ++j)
-				val(i, j) = planar ? rhs_[j](pts(i, 0), pts(i, 1)) : rhs_[j](pts(i, 0), pts(i, 1), pts(i, 2));
+			rhs_[j].eval(pts, t, tmp);
+			val.col(j) = tmp;
 		}
 
 		// val.col(i).setConstant(rhs_(i));
@@ -89,28 +118,34 @@ namespace polyfem
 	{
 		val = Eigen::MatrixXd::Zero(pts.rows(), mesh.dimension());
 
-		for (long i = 0; i < pts.rows(); ++i)
+		Eigen::VectorXd tmp;
+		if (is_all_)
 		{
-			if (is_all_)
+			assert(displacements_.size() == 1);
+			const double scaling = displacements_interpolation_[0]->eval(t);
+			for (int d = 0; d < val.cols(); ++d)
 			{
-				assert(displacements_.size() == 1);
-				for (int d = 0; d < val.cols(); ++d)
-					val(i, d) = pts.cols() == 2 ? displacements_[0][d](pts(i, 0), pts(i, 1)) : displacements_[0][d](pts(i, 0), pts(i, 1), pts(i, 2));
-				val.row(i) *= displacements_interpolation_[0]->eval(t);
+				displacements_[0][d].eval(pts, t, tmp);
+				val.col(d) = tmp * (displacements_[0][d].depends_on_t() ? 1 : scaling);
 			}
-			else
+			return;
+		}
+
+		//the points of each boundary are evaluated together
+		const auto rows = rows_per_boundary(mesh, global_ids, pts.rows(), boundary_ids_);
+		for (size_t b = 0; b < rows.size(); ++b)
+		{
+			if (rows[b].empty())
+				continue;
+
+			const Eigen::MatrixXd b_pts = select_rows(pts, rows[b]);
+			const double scaling = displacements_interpolation_[b]->eval(t);
+			for (int d = 0; d < val.cols(); ++d)
 			{
-				const int id = mesh.get_boundary_id(global_ids(i));
-				for (size_t b = 0; b < boundary_ids_.size(); ++b)
-				{
-					if (id == boundary_ids_[b])
-					{
-						for (int d = 0; d < val.cols(); ++d)
-							val(i, d) = pts.cols() == 2 ? displacements_[b][d](pts(i, 0), pts(i, 1)) : displacements_[b][d](pts(i, 0), pts(i, 1), pts(i, 2));
-						val.row(i) *= displacements_interpolation_[b]->eval(t);
-						break;
-					}
-				}
+				displacements_[b][d].eval(b_pts, t, tmp);
+				const double s = displacements_[b][d].depends_on_t() ? 1 : scaling;
+				for (size_t k = 0; k < rows[b].size(); ++k)
+					val(rows[b][k], d) = tmp(k) * s;
 			}
 		}
 
@@ -121,30 +156,38 @@ namespace polyfem
 	{
 		val = Eigen::MatrixXd::Zero(pts.rows(), mesh.dimension());
 
-		for (long i = 0; i < pts.rows(); ++i)
+		Eigen::VectorXd tmp;
+		const auto force_rows = rows_per_boundary(mesh, global_ids, pts.rows(), neumann_boundary_ids_);
+		for (size_t b = 0; b < force_rows.size(); ++b)
 		{
-			const int id = mesh.get_boundary_id(global_ids(i));
+			if (force_rows[b].empty())
+				continue;
 
-			for (size_t b = 0; b < neumann_boundary_ids_.size(); ++b)
+			const Eigen::MatrixXd b_pts = select_rows(pts, force_rows[b]);
+			const double scaling = forces_interpolation_[b]->eval(t);
+			for (int d = 0; d < val.cols(); ++d)
 			{
-				if (id == neumann_boundary_ids_[b])
-				{
-					for (int d = 0; d < val.cols(); ++d)
-						val(i, d) = pts.cols() == 2 ? forces_[b][d](pts(i, 0), pts(i, 1)) : forces_[b][d](pts(i, 0), pts(i, 1), pts(i, 2));
-					val.row(i) *= forces_interpolation_[b]->eval(t);
-					break;
-				}
+				forces_[b][d].eval(b_pts, t, tmp);
+				const double s = forces_[b][d].depends_on_t() ? 1 : scaling;
+				for (size_t k = 0; k < force_rows[b].size(); ++k)
+					val(force_rows[b][k], d) = tmp(k) * s;
 			}
+		}
+
+		//pressures overwrite the forces
+		const auto pressure_rows = rows_per_boundary(mesh, global_ids, pts.rows(), pressure_boundary_ids_);
+		for (size_t b = 0; b < pressure_rows.size(); ++b)
+		{
+			if (pressure_rows[b].empty())
+				continue;
 
-			for (size_t b = 0; b < pressure_boundary_ids_.size(); ++b)
+			pressures_[b].eval(select_rows(pts, pressure_rows[b]), t, tmp);
+			if (!pressures_[b].depends_on_t())
+				tmp *= pressure_interpolation_[b]->eval(t);
+			for (size_t k = 0; k < pressure_rows[b].size(); ++k)
 			{
-				if (id == pressure_boundary_ids_[b])
-				{
-					for (int d = 0; d < val.cols(); ++d)
-						val(i, d) = (pts.cols() == 2 ? pressures_[b](pts(i, 0), pts(i, 1)) : pressures_[b](pts(i, 0), pts(i, 1), pts(i, 2))) * normals(i, d);
-					val.row(i) *= pressure_interpolation_[b]->eval(t);
-					break;
-				}
+				const int i = pressure_rows[b][k];
+				val.row(i) = tmp(k) * normals.row(i);
 			}
 		}
 
@@ -154,13 +197,13 @@ namespace polyfem
 	void GenericTensorProblem::exact(const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
 	{
 		assert(has_exact_sol());
-		const bool planar = pts.cols() == 2;
 		val.resize(pts.rows(), pts.cols());
 
-		for (int i = 0; i < pts.rows(); ++i)
+		Eigen::VectorXd tmp;
+		for (int j = 0; j < pts.cols(); ++j)
 		{
-			for (int j = 0; j < pts.cols(); ++j)
-				val(i, j) = planar ? exact_[j](pts(i, 0), pts(i, 1)) : exact_[j](pts(i, 0), pts(i, 1), pts(i, 2));
+			exact_[j].eval(pts, t, tmp);
+			val.col(j) = tmp;
 		}
 	}
 
@@ -171,11 +214,11 @@ namespace polyfem
 		if (!has_exact_grad_)
 			return;
 
-		const bool planar = size == 2;
-		for (int i = 0; i < pts.rows(); ++i)
+		Eigen::VectorXd tmp;
+		for (int j = 0; j < pts.cols() * size; ++j)
 		{
-			for (int j = 0; j < pts.cols() * size; ++j)
-				val(i, j) = planar ? exact_grad_[j](pts(i, 0), pts(i, 1)) : exact_grad_[j](pts(i, 0), pts(i, 1), pts(i, 2));
+			exact_grad_[j].eval(pts, t, tmp);
+			val.col(j) = tmp;
 		}
 	}
 
@@ -658,11 +701,9 @@ namespace polyfem
 			val.setZero();
 			return;
 		}
-		const bool planar = pts.cols() == 2;
-		for (int i = 0; i < pts.rows(); ++i)
-		{
-			val(i) = planar ? rhs_(pts(i, 0), pts(i, 1)) : rhs_(pts(i, 0), pts(i, 1), pts(i, 2));
-		}
+		Eigen::VectorXd tmp;
+		rhs_.eval(pts, t, tmp);
+		val.col(0) = tmp;
 		// val = Eigen::MatrixXd::Constant(pts.rows(), 1, rhs_);
 		// val *= t;
 	}
@@ -671,61 +712,55 @@ namespace polyfem
 	{
 		val = Eigen::MatrixXd::Zero(pts.rows(), 1);
 
-		for (long i = 0; i < pts.rows(); ++i)
+		Eigen::VectorXd tmp;
+		if (is_all_)
 		{
-			const int id = mesh.get_boundary_id(global_ids(i));
-			if (is_all_)
-			{
-				assert(dirichlet_.size() == 1);
-				val(i) = pts.cols() == 2 ? dirichlet_[0](pts(i, 0), pts(i, 1)) : dirichlet_[0](pts(i, 0), pts(i, 1), pts(i, 2));
-			}
-			else
+			assert(dirichlet_.size() == 1);
+			dirichlet_[0].eval(pts, t, tmp);
+			val.col(0) = tmp * (dirichlet_[0].depends_on_t() ? 1 : t);
+		}
+		else
+		{
+			const auto rows = rows_per_boundary(mesh, global_ids, pts.rows(), boundary_ids_);
+			for (size_t b = 0; b < rows.size(); ++b)
 			{
-				for (size_t b = 0; b < boundary_ids_.size(); ++b)
-				{
-					if (id == boundary_ids_[b])
-					{
-						val(i) = pts.cols() == 2 ? dirichlet_[b](pts(i, 0), pts(i, 1)) : dirichlet_[b](pts(i, 0), pts(i, 1), pts(i, 2));
-						break;
-					}
-				}
+				if (rows[b].empty())
+					continue;
+
+				dirichlet_[b].eval(select_rows(pts, rows[b]), t, tmp);
+				const double s = dirichlet_[b].depends_on_t() ? 1 : t;
+				for (size_t k = 0; k < rows[b].size(); ++k)
+					val(rows[b][k]) = tmp(k) * s;
 			}
 		}
-
-		val *= t;
 	}
 
 	void GenericScalarProblem::neumann_bc(const Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &normals, const double t, Eigen::MatrixXd &val) const
 	{
 		val = Eigen::MatrixXd::Zero(pts.rows(), 1);
 
-		for (long i = 0; i < pts.rows(); ++i)
+		Eigen::VectorXd tmp;
+		const auto rows = rows_per_boundary(mesh, global_ids, pts.rows(), neumann_boundary_ids_);
+		for (size_t b = 0; b < rows.size(); ++b)
 		{
-			const int id = mesh.get_boundary_id(global_ids(i));
+			if (rows[b].empty())
+				continue;
 
-			for (size_t b = 0; b < neumann_boundary_ids_.size(); ++b)
-			{
-				if (id == neumann_boundary_ids_[b])
-				{
-					val(i) = pts.cols() == 2 ? neumann_[b](pts(i, 0), pts(i, 1)) : neumann_[b](pts(i, 0), pts(i, 1), pts(i, 2));
-					break;
-				}
-			}
+			neumann_[b].eval(select_rows(pts, rows[b]), t, tmp);
+			const double s = neumann_[b].depends_on_t() ? 1 : t;
+			for (size_t k = 0; k < rows[b].size(); ++k)
+				val(rows[b][k]) = tmp(k) * s;
 		}
-
-		val *= t;
 	}
 
 	void GenericScalarProblem::exact(const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
 	{
 		assert(has_exact_sol());
-		const bool planar = pts.cols() == 2;
 		val.resize(pts.rows(), 1);
 
-		for (int i = 0; i < pts.rows(); ++i)
-		{
-			val(i) = planar ? exact_(pts(i, 0), pts(i, 1)) : exact_(pts(i, 0), pts(i, 1), pts(i, 2));
-		}
+		Eigen::VectorXd tmp;
+		exact_.eval(pts, t, tmp);
+		val.col(0) = tmp;
 	}
 
 	void GenericScalarProblem::exact_grad(const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
@@ -734,11 +769,11 @@ namespace polyfem
 		if (!has_exact_grad_)
 			return;
 
-		const bool planar = pts.cols() == 2;
-		for (int i = 0; i < pts.rows(); ++i)
+		Eigen::VectorXd tmp;
+		for (int j = 0; j < pts.cols(); ++j)
 		{
-			for (int j = 0; j < pts.cols(); ++j)
-				val(i, j) = planar ? exact_grad_[j](pts(i, 0), pts(i, 1)) : exact_grad_[j](pts(i, 0), pts(i, 1), pts(i, 2));
+			exact_grad_[j].eval(pts, t, tmp);
+			val.col(j) = tmp;
 		}
 	}
 
@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <array>
+#include <cassert>
+#include <cmath>
 
 namespace polyfem
 {
@@ -25,10 +27,61 @@ BDF::BDF(int order) : order_(order)
     order_ = std::max(1, std::min(order_, 6));
 }
 
+int BDF::current_order() const
+{
+    return std::min(int(history_.size()), order_);
+}
+
+bool BDF::is_uniform() const
+{
+    for (size_t i = 1; i < times_.size(); ++i)
+    {
+        if (std::abs(times_[i] - times_[i - 1] - dt_) > 1e-12 * dt_)
+            return false;
+    }
+
+    return true;
+}
+
+void BDF::variable_coefficients(Eigen::VectorXd &coeffs) const
+{
+    //nodes: the next time then the previous ones, from the most recent
+    const int q = current_order();
+    const int n = int(times_.size());
+    Eigen::VectorXd tau(q + 1);
+    tau(0) = times_.back() + dt_;
+    for (int j = 1; j <= q; ++j)
+        tau(j) = times_[n - j];
+
+    //derivative at tau(0) of the lagrange polynomials, scaled by dt
+    coeffs.resize(q + 1);
+    coeffs(0) = 0;
+    for (int j = 1; j <= q; ++j)
+        coeffs(0) += dt_ / (tau(0) - tau(j));
+
+    for (int j = 1; j <= q; ++j)
+    {
+        double num = 1, den = tau(j) - tau(0);
+        for (int m = 1; m <= q; ++m)
+        {
+            if (m == j)
+                continue;
+            num *= tau(0) - tau(m);
+            den *= tau(j) - tau(m);
+        }
+        coeffs(j) = dt_ * num / den;
+    }
+}
+
 double BDF::alpha() const
 {
     assert(history_.size() > 0);
-    return alphas[history_.size() - 1];
+    if (is_uniform())
+        return alphas[current_order() - 1];
+
+    Eigen::VectorXd coeffs;
+    variable_coefficients(coeffs);
+    return coeffs(0);
 }
 
 void BDF::rhs(Eigen::VectorXd &rhs) const
@@ -36,21 +89,74 @@ void BDF::rhs(Eigen::VectorXd &rhs) const
     assert(history_.size() > 0);
     rhs.resize(history_.front().size());
     rhs.setZero();
-    const auto &w = weights[history_.size() - 1];
-    for (int i = 0; i < history_.size(); ++i)
+
+    const int q = current_order();
+    const int offset = int(history_.size()) - q;
+    if (is_uniform())
     {
-        rhs += history_[i] * w[i];
+        const auto &w = weights[q - 1];
+        for (int i = 0; i < q; ++i)
+        {
+            rhs += history_[offset + i] * w[i];
+        }
+        return;
     }
+
+    Eigen::VectorXd coeffs;
+    variable_coefficients(coeffs);
+    for (int j = 1; j <= q; ++j)
+        rhs -= coeffs(j) * history_[history_.size() - j];
+}
+
+void BDF::set_dt(const double dt)
+{
+    assert(dt > 0);
+    dt_ = dt;
+}
+
+bool BDF::has_error_estimate() const
+{
+    return int(history_.size()) > current_order();
+}
+
+void BDF::predictor(Eigen::VectorXd &pred) const
+{
+    assert(history_.size() > 0);
+    const int n = int(history_.size());
+    const double t = times_.back() + dt_;
+
+    pred.resize(history_.front().size());
+    pred.setZero();
+    for (int i = 0; i < n; ++i)
+    {
+        double l = 1;
+        for (int m = 0; m < n; ++m)
+        {
+            if (m != i)
+                l *= (t - times_[m]) / (times_[i] - times_[m]);
+        }
+        pred += l * history_[i];
+    }
+}
+
+void BDF::error_estimate(const Eigen::VectorXd &sol, Eigen::VectorXd &err) const
+{
+    //the constant of BDF-q is 1/(alpha (q+1)), eg 1/2 for implicit euler and 2/9 for BDF2
+    predictor(err);
+    err = (sol - err) / (alpha() * (current_order() + 1));
 }
 
 void BDF::new_solution(Eigen::VectorXd &rhs)
 {
-    if (history_.size() >= order_)
+    //one more solution than the order is kept for the predictor
+    if (history_.size() > order_)
     {
         history_.pop_front();
+        times_.pop_front();
     }
 
+    times_.push_back(times_.empty() ? 0 : times_.back() + dt_);
     history_.push_back(rhs);
-    assert(history_.size() <= order_);
+    assert(history_.size() <= order_ + 1);
 }
 } // namespace polyfem
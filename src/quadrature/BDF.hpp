@@ -11,13 +11,33 @@ class BDF
 public:
     BDF(int order);
 
+    //alpha/dt u_{n+1} - rhs/dt approximates the time derivative at the next step
+    //with uniform steps these are the classic coefficients, otherwise the ones of the variable step formula
     double alpha() const;
     void rhs(Eigen::VectorXd &rhs) const;
 
+    //size of the next step, the default (1) with no other call gives uniform steps
+    void set_dt(const double dt);
+    //order of the formula of the next step, it is lower for the first steps
+    int current_order() const;
+    //extrapolation of the previous solutions to the next step, with one more point than the formula
+    //its difference with the solution estimates the local error
+    void predictor(Eigen::VectorXd &pred) const;
+    //true if there are enough previous solutions for the predictor to be one order higher than the formula
+    bool has_error_estimate() const;
+    //local error of the solution of the next step, (sol - predictor) times the error constant of the formula
+    void error_estimate(const Eigen::VectorXd &sol, Eigen::VectorXd &err) const;
+
     void new_solution(Eigen::VectorXd &rhs);
 
 private:
+    //coefficients of the derivative of the interpolant through the next step and the last current_order() solutions
+    bool is_uniform() const;
+    void variable_coefficients(Eigen::VectorXd &coeffs) const;
+
     std::deque<Eigen::VectorXd> history_;
+    std::deque<double> times_;
+    double dt_ = 1;
     int order_;
 };
 } // namespace polyfem
@@ -0,0 +1,72 @@
+#include <polyfem/QuadratureCache.hpp>
+
+#include <polyfem/LineQuadrature.hpp>
+#include <polyfem/TriQuadrature.hpp>
+#include <polyfem/QuadQuadrature.hpp>
+#include <polyfem/TetQuadrature.hpp>
+#include <polyfem/HexQuadrature.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace polyfem
+{
+	namespace
+	{
+		void compute_rule(const QuadratureCache::Type type, const int order, Quadrature &quad)
+		{
+			switch (type)
+			{
+			case QuadratureCache::Type::Line:
+			{
+				LineQuadrature rule;
+				rule.get_quadrature(order, quad);
+				break;
+			}
+			case QuadratureCache::Type::Tri:
+			{
+				TriQuadrature rule;
+				rule.get_quadrature(order, quad);
+				break;
+			}
+			case QuadratureCache::Type::Quad:
+			{
+				QuadQuadrature rule;
+				rule.get_quadrature(order, quad);
+				break;
+			}
+			case QuadratureCache::Type::Tet:
+			{
+				TetQuadrature rule;
+				rule.get_quadrature(order, quad);
+				break;
+			}
+			case QuadratureCache::Type::Hex:
+			{
+				HexQuadrature rule;
+				rule.get_quadrature(order, quad);
+				break;
+			}
+			}
+		}
+	} // namespace
+
+	const Quadrature &QuadratureCache::get(const Type type, const int order)
+	{
+		//the rules are heap allocated so that the references survive insertions
+		static std::map<std::pair<int, int>, std::unique_ptr<Quadrature>> rules;
+		static std::mutex mutex;
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		std::unique_ptr<Quadrature> &rule = rules[std::make_pair(int(type), order)];
+		if (!rule)
+		{
+			rule.reset(new Quadrature());
+			compute_rule(type, order, *rule);
+		}
+
+		return *rule;
+	}
+} // namespace polyfem
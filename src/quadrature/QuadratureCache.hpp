@@ -0,0 +1,29 @@
+#pragma once
+
+#include <polyfem/Quadrature.hpp>
+
+namespace polyfem
+{
+	//process wide rules of the reference elements, each rule is computed once per order and shared by all the elements
+	//the returned references stay valid for the whole run and are never modified, lookups are thread safe
+	class QuadratureCache
+	{
+	public:
+		enum class Type
+		{
+			Line,
+			Tri,
+			Quad,
+			Tet,
+			Hex
+		};
+
+		static const Quadrature &get(const Type type, const int order);
+
+		static inline const Quadrature &line(const int order) { return get(Type::Line, order); }
+		static inline const Quadrature &tri(const int order) { return get(Type::Tri, order); }
+		static inline const Quadrature &quad(const int order) { return get(Type::Quad, order); }
+		static inline const Quadrature &tet(const int order) { return get(Type::Tet, order); }
+		static inline const Quadrature &hex(const int order) { return get(Type::Hex, order); }
+	};
+} // namespace polyfem
@@ -0,0 +1,77 @@
+#include <polyfem/AdaptiveTimeStep.hpp>
+
+#include <polyfem/Logger.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace polyfem
+{
+	AdaptiveTimeStep::AdaptiveTimeStep(const json &params, const double dt, const double tend)
+		: tend_(tend), dt_(dt)
+	{
+		rtol_ = params.count("rtol") ? double(params["rtol"]) : 1e-3;
+		atol_ = params.count("atol") ? double(params["atol"]) : 1e-6;
+		dt_min_ = params.count("dt_min") ? double(params["dt_min"]) : 0;
+		dt_max_ = params.count("dt_max") ? double(params["dt_max"]) : 0;
+		safety_ = params.count("safety") ? double(params["safety"]) : 0.9;
+		max_growth_ = params.count("max_growth") ? double(params["max_growth"]) : 2;
+		max_shrink_ = params.count("max_shrink") ? double(params["max_shrink"]) : 0.2;
+
+		if (dt_min_ <= 0)
+			dt_min_ = 1e-8 * tend;
+		if (dt_max_ <= 0)
+			dt_max_ = tend;
+		dt_ = std::max(dt_min_, std::min(dt_, dt_max_));
+		min_accepted_dt_ = std::numeric_limits<double>::max();
+	}
+
+	double AdaptiveTimeStep::next_dt() const
+	{
+		//avoids a tiny last step
+		const double remaining = tend_ - time_;
+		return remaining < 1.1 * dt_ ? remaining : dt_;
+	}
+
+	void AdaptiveTimeStep::accept()
+	{
+		const double dt = next_dt();
+		time_ += dt;
+		++accepted_;
+		min_accepted_dt_ = std::min(min_accepted_dt_, dt);
+		max_accepted_dt_ = std::max(max_accepted_dt_, dt);
+	}
+
+	bool AdaptiveTimeStep::step(const Eigen::VectorXd &error, const Eigen::VectorXd &sol, const int order)
+	{
+		const double dt = next_dt();
+		const double tol = atol_ + rtol_ * sol.lpNorm<Eigen::Infinity>();
+		const double err = error.lpNorm<Eigen::Infinity>() / tol;
+
+		const double factor = err > 0 ? std::max(max_shrink_, std::min(max_growth_, safety_ * std::pow(err, -1. / (order + 1)))) : max_growth_;
+		const bool accepted = err <= 1 || dt <= dt_min_;
+		if (err > 1 && accepted)
+			logger().warn("Time step {} reached dt_min, accepting it with error {}", dt, err);
+
+		if (accepted)
+			accept();
+		else
+		{
+			++rejected_;
+			logger().debug("Rejected step t={} dt={} err={}", time_ + dt, dt, err);
+		}
+
+		//the step is not allowed to grow right after a rejection
+		dt_ = std::max(dt_min_, std::min(dt_max_, dt * (accepted ? factor : std::min(1., factor))));
+		return accepted;
+	}
+
+	void AdaptiveTimeStep::get_info(json &info) const
+	{
+		info["accepted_steps"] = accepted_;
+		info["rejected_steps"] = rejected_;
+		info["min_dt"] = accepted_ > 0 ? min_accepted_dt_ : 0;
+		info["max_dt"] = max_accepted_dt_;
+	}
+} // namespace polyfem
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+
+#include <Eigen/Dense>
+
+namespace polyfem
+{
+	//step size control of the transient solvers from an estimate of the local error
+	//a step is accepted if the error is below atol + rtol |u|, the next step is scaled by safety (1/err)^(1/(order+1))
+	class AdaptiveTimeStep
+	{
+	public:
+		//params: rtol, atol, dt_min (0 is 1e-8 tend), dt_max (0 is tend), safety, max_growth, max_shrink
+		AdaptiveTimeStep(const json &params, const double dt, const double tend);
+
+		//current time, and size of the next step (shortened to end at tend)
+		inline double time() const { return time_; }
+		double next_dt() const;
+		inline bool finished() const { return time_ >= tend_ - 1e-12 * tend_; }
+
+		//error is the estimate of the local error of the step of size next_dt(), sol the new solution and order the one of the method
+		//returns true if the step is accepted, in this case time() is advanced, in both cases the step size is updated
+		bool step(const Eigen::VectorXd &error, const Eigen::VectorXd &sol, const int order);
+		//accepts the step of size next_dt() without an error estimate (e.g., the first steps of BDF)
+		void accept();
+
+		//accepted and rejected steps, smallest and largest accepted step
+		void get_info(json &info) const;
+
+	private:
+		double rtol_, atol_;
+		double dt_min_, dt_max_;
+		double safety_, max_growth_, max_shrink_;
+
+		double tend_;
+		double time_ = 0;
+		double dt_;
+
+		int accepted_ = 0;
+		int rejected_ = 0;
+		double min_accepted_dt_;
+		double max_accepted_dt_ = 0;
+	};
+} // namespace polyfem
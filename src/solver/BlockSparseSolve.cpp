@@ -0,0 +1,14 @@
+#include <polyfem/BlockSparseSolve.hpp>
+
+#include <polysolve/FEMSolver.hpp>
+
+namespace polyfem
+{
+	Eigen::Vector4d dirichlet_solve(polysolve::LinearSolver &solver, const BlockSparseMatrix &A, Eigen::VectorXd &f, const std::vector<int> &dirichlet_nodes, Eigen::VectorXd &u, const int precond_num, const std::string &save_path, bool compute_spectrum)
+	{
+		StiffnessMatrix mat;
+		A.to_sparse(mat);
+
+		return polysolve::dirichlet_solve(solver, mat, f, dirichlet_nodes, u, precond_num, save_path, compute_spectrum);
+	}
+} // namespace polyfem
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <polyfem/BlockSparseMatrix.hpp>
+
+#include <polysolve/LinearSolver.hpp>
+
+#include <Eigen/Dense>
+#include <string>
+#include <vector>
+
+namespace polyfem
+{
+	//dirichlet_solve for a block sparse matrix, the linear solvers get its scalar compressed conversion
+	//which is freed after the solve
+	Eigen::Vector4d dirichlet_solve(polysolve::LinearSolver &solver, const BlockSparseMatrix &A, Eigen::VectorXd &f, const std::vector<int> &dirichlet_nodes, Eigen::VectorXd &u, const int precond_num, const std::string &save_path = "", bool compute_spectrum = false);
+} // namespace polyfem
@@ -0,0 +1,50 @@
+#include <polyfem/FactorizedDirichletSolve.hpp>
+
+#include <polysolve/FEMSolver.hpp>
+
+namespace polyfem
+{
+	Eigen::Vector4d FactorizedDirichletSolve::factorize_and_solve(polysolve::LinearSolver &solver, StiffnessMatrix &A, Eigen::VectorXd &f, const std::vector<int> &dirichlet_nodes, Eigen::VectorXd &u, const int precond_num, const std::string &save_path, bool compute_spectrum)
+	{
+		const int n = int(A.rows());
+
+		std::vector<bool> is_dirichlet(n, false);
+		for (const int i : dirichlet_nodes)
+			is_dirichlet[i] = true;
+
+		//the entries of A dropped by dirichlet_solve that move the dirichlet values to the right hand side
+		std::vector<Eigen::Triplet<double>> entries;
+		for (int k = 0; k < A.outerSize(); ++k)
+		{
+			for (StiffnessMatrix::InnerIterator it(A, k); it; ++it)
+			{
+				if (!is_dirichlet[it.row()] && is_dirichlet[it.col()])
+					entries.emplace_back(it.row(), it.col(), it.value());
+			}
+		}
+		coupling_.resize(n, n);
+		coupling_.setFromTriplets(entries.begin(), entries.end());
+		coupling_.makeCompressed();
+
+		factorized_ = true;
+		return polysolve::dirichlet_solve(solver, A, f, dirichlet_nodes, u, precond_num, save_path, compute_spectrum);
+	}
+
+	void FactorizedDirichletSolve::solve(polysolve::LinearSolver &solver, Eigen::VectorXd &f, Eigen::VectorXd &u) const
+	{
+		assert(factorized_);
+		assert(f.size() == coupling_.rows());
+
+		const Eigen::VectorXd g = f - coupling_ * f;
+
+		u.resize(g.size());
+		solver.solve(g, u);
+		f = g;
+	}
+
+	void FactorizedDirichletSolve::clear()
+	{
+		coupling_.resize(0, 0);
+		factorized_ = false;
+	}
+} // namespace polyfem
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <polyfem/Types.hpp>
+
+#include <polysolve/LinearSolver.hpp>
+
+#include <Eigen/Dense>
+#include <string>
+#include <vector>
+
+namespace polyfem
+{
+	//dirichlet_solve for many right hand sides with the same matrix, e.g. linear transient problems with a fixed time step
+	//the matrix with the dirichlet rows and columns eliminated is factorized once, the other solves only
+	//move the dirichlet values to the right hand side and call the solver with the existing factorization
+	class FactorizedDirichletSolve
+	{
+	public:
+		//same as dirichlet_solve (A is modified in the same way), the solver keeps the factorization
+		Eigen::Vector4d factorize_and_solve(polysolve::LinearSolver &solver, StiffnessMatrix &A, Eigen::VectorXd &f, const std::vector<int> &dirichlet_nodes, Eigen::VectorXd &u, const int precond_num, const std::string &save_path = "", bool compute_spectrum = false);
+		//same result as dirichlet_solve with the last factorized matrix, solver must be the one passed to factorize_and_solve
+		void solve(polysolve::LinearSolver &solver, Eigen::VectorXd &f, Eigen::VectorXd &u) const;
+
+		inline bool is_factorized() const { return factorized_; }
+		void clear();
+
+	private:
+		//(I-N) A N with N the diagonal of the dirichlet dofs, g = f - coupling_ f
+		StiffnessMatrix coupling_;
+		bool factorized_ = false;
+	};
+} // namespace polyfem
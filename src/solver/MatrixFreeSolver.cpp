@@ -0,0 +1,202 @@
+#include <polyfem/MatrixFreeSolver.hpp>
+
+#include <polyfem/Logger.hpp>
+
+#include <igl/Timer.h>
+
+#include <cmath>
+
+namespace polyfem
+{
+	MatrixFreeSolver::MatrixFreeSolver(const json &params)
+	{
+		precond = params.count("precond") ? params["precond"].get<std::string>() : "jacobi";
+		max_iter = params.count("max_iter") ? int(params["max_iter"]) : 1000;
+		conv_tol = params.count("conv_tol") ? double(params["conv_tol"]) : 1e-10;
+		chebyshev_degree = params.count("chebyshev_degree") ? int(params["chebyshev_degree"]) : 3;
+		chebyshev_range = params.count("chebyshev_range") ? double(params["chebyshev_range"]) : 30;
+		eigen_iter = params.count("eigen_iter") ? int(params["eigen_iter"]) : 10;
+
+		if (precond != "none" && precond != "jacobi" && precond != "chebyshev_jacobi")
+		{
+			logger().warn("Unknown matrix-free preconditioner {}, using jacobi", precond);
+			precond = "jacobi";
+		}
+	}
+
+	void MatrixFreeSolver::set_operator(const int n_, const Operator &op_, const std::vector<int> &boundary_nodes)
+	{
+		n = n_;
+		op = op_;
+
+		dirichlet.setZero(n);
+		for (const int b : boundary_nodes)
+			dirichlet(b) = 1;
+
+		inv_diag.setOnes(n);
+		lambda_max = -1;
+	}
+
+	void MatrixFreeSolver::set_operator(const BlockSparseMatrix &A, const std::vector<int> &boundary_nodes)
+	{
+		set_operator(A.rows(), [&A](const Eigen::VectorXd &x, Eigen::VectorXd &y) { A.multiply(x, y); }, boundary_nodes);
+		set_diagonal(A.diagonal());
+	}
+
+	void MatrixFreeSolver::set_diagonal(const Eigen::VectorXd &diag)
+	{
+		assert(diag.size() == n);
+
+		inv_diag.resize(n);
+		for (int i = 0; i < n; ++i)
+		{
+			if (dirichlet(i) > 0 || std::abs(diag(i)) < 1e-16)
+				inv_diag(i) = 1;
+			else
+				inv_diag(i) = 1. / diag(i);
+		}
+
+		lambda_max = -1;
+	}
+
+	void MatrixFreeSolver::apply(const Eigen::VectorXd &x, Eigen::VectorXd &y) const
+	{
+		const Eigen::VectorXd free_x = (1 - dirichlet.array()) * x.array();
+		op(free_x, y);
+		y.array() = (1 - dirichlet.array()) * y.array() + dirichlet.array() * x.array();
+	}
+
+	double MatrixFreeSolver::estimate_max_eigenvalue() const
+	{
+		Eigen::VectorXd v = Eigen::VectorXd::Ones(n) + 0.1 * Eigen::VectorXd::Random(n);
+		v.normalize();
+
+		Eigen::VectorXd w;
+		double lambda = 1;
+		for (int i = 0; i < eigen_iter; ++i)
+		{
+			apply(v, w);
+			w.array() *= inv_diag.array();
+
+			lambda = v.dot(w);
+			const double norm = w.norm();
+			if (norm <= 0)
+				break;
+			v = w / norm;
+		}
+
+		return lambda;
+	}
+
+	void MatrixFreeSolver::precondition(const Eigen::VectorXd &r, Eigen::VectorXd &z) const
+	{
+		if (precond == "none")
+		{
+			z = r;
+			return;
+		}
+
+		if (precond == "jacobi")
+		{
+			z.array() = inv_diag.array() * r.array();
+			return;
+		}
+
+		//chebyshev iteration on D^-1 K z = D^-1 r, starting from zero, in [lambda_max/range, lambda_max]
+		const double b = lambda_max;
+		const double a = lambda_max / chebyshev_range;
+		const double theta = (b + a) / 2;
+		const double delta = (b - a) / 2;
+		const double sigma = theta / delta;
+		double rho = 1 / sigma;
+
+		Eigen::VectorXd res = inv_diag.array() * r.array();
+		Eigen::VectorXd d = res / theta;
+		Eigen::VectorXd kd;
+		z = d;
+
+		for (int k = 1; k < chebyshev_degree; ++k)
+		{
+			apply(d, kd);
+			res.array() -= inv_diag.array() * kd.array();
+
+			const double rho_new = 1 / (2 * sigma - rho);
+			d = (rho_new * rho) * d + (2 * rho_new / delta) * res;
+			z += d;
+			rho = rho_new;
+		}
+	}
+
+	void MatrixFreeSolver::solve(const Eigen::VectorXd &b, Eigen::VectorXd &x)
+	{
+		assert(b.size() == n);
+
+		igl::Timer timer;
+		timer.start();
+
+		if (precond == "chebyshev_jacobi" && lambda_max <= 0)
+		{
+			//safety factor, the power iterations underestimate the largest eigenvalue
+			lambda_max = 1.2 * estimate_max_eigenvalue();
+			logger().debug("chebyshev lambda max {}", lambda_max);
+		}
+
+		//moves the dirichlet values to the rhs: g = b - (I-N) K N b
+		Eigen::VectorXd g;
+		{
+			const Eigen::VectorXd bc = dirichlet.array() * b.array();
+			Eigen::VectorXd kbc;
+			op(bc, kbc);
+			g = b.array() - (1 - dirichlet.array()) * kbc.array();
+		}
+
+		x = dirichlet.array() * b.array();
+
+		Eigen::VectorXd r, z, p, q;
+		apply(x, q);
+		r = g - q;
+		precondition(r, z);
+		p = z;
+		double rz = r.dot(z);
+
+		const double g_norm = g.norm();
+		const double tol = conv_tol * (g_norm > 0 ? g_norm : 1);
+		double res_norm = r.norm();
+
+		int it = 0;
+		for (; it < max_iter && res_norm > tol; ++it)
+		{
+			apply(p, q);
+			const double alpha = rz / p.dot(q);
+			x += alpha * p;
+			r -= alpha * q;
+			res_norm = r.norm();
+
+			if (res_norm <= tol)
+			{
+				++it;
+				break;
+			}
+
+			precondition(r, z);
+			const double rz_new = r.dot(z);
+			p = z + (rz_new / rz) * p;
+			rz = rz_new;
+		}
+
+		timer.stop();
+
+		if (res_norm > tol)
+			logger().warn("Matrix-free CG did not converge after {} iterations, residual {}", it, res_norm);
+		logger().debug("Matrix-free CG {} iterations, residual {}, {}s", it, res_norm, timer.getElapsedTime());
+
+		solver_info = json::object();
+		solver_info["solver"] = name();
+		solver_info["precond"] = precond;
+		solver_info["num_iterations"] = it;
+		solver_info["final_res_norm"] = res_norm;
+		solver_info["solve_time"] = timer.getElapsedTime();
+		if (precond == "chebyshev_jacobi")
+			solver_info["lambda_max"] = lambda_max;
+	}
+} // namespace polyfem
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <polyfem/Common.hpp>
+#include <polyfem/BlockSparseMatrix.hpp>
+
+#include <Eigen/Dense>
+
+#include <functional>
+#include <vector>
+
+namespace polyfem
+{
+	//preconditioned conjugate gradient on an operator given as a function y = K x
+	//K is not assembled or only in block sparse storage, dirichlet nodes are eliminated like in dirichlet_solve
+	class MatrixFreeSolver
+	{
+	public:
+		typedef std::function<void(const Eigen::VectorXd &, Eigen::VectorXd &)> Operator;
+
+		//params: precond (none, jacobi, chebyshev_jacobi), max_iter, conv_tol, chebyshev_degree, chebyshev_range, eigen_iter
+		MatrixFreeSolver(const json &params);
+
+		//sets the operator (of size n) and the nodes with dirichlet conditions
+		void set_operator(const int n, const Operator &op, const std::vector<int> &boundary_nodes);
+		//uses the block product and the diagonal of an assembled matrix, A must outlive the solver
+		void set_operator(const BlockSparseMatrix &A, const std::vector<int> &boundary_nodes);
+		//sets the diagonal of K, needed by the jacobi and chebyshev preconditioners
+		void set_diagonal(const Eigen::VectorXd &diag);
+
+		//solves K x = b, the dirichlet entries of x are the one of b
+		void solve(const Eigen::VectorXd &b, Eigen::VectorXd &x);
+
+		void getInfo(json &params) const { params = solver_info; }
+		std::string name() const { return "MatrixFree"; }
+
+	private:
+		//K with rows and cols of dirichlet nodes replaced by the identity
+		void apply(const Eigen::VectorXd &x, Eigen::VectorXd &y) const;
+		//z = P^-1 r
+		void precondition(const Eigen::VectorXd &r, Eigen::VectorXd &z) const;
+		//largest eigenvalue of D^-1 K with power iterations
+		double estimate_max_eigenvalue() const;
+
+		std::string precond;
+		int max_iter;
+		double conv_tol;
+		int chebyshev_degree;
+		double chebyshev_range;
+		int eigen_iter;
+
+		int n = 0;
+		Operator op;
+		//1 for dirichlet dofs
+		Eigen::VectorXd dirichlet;
+		Eigen::VectorXd inv_diag;
+		double lambda_max = -1;
+
+		json solver_info;
+	};
+} // namespace polyfem
@@ -244,7 +244,7 @@ namespace polyfem
 
 		const auto &gbases = state.iso_parametric() ? state.bases : state.geom_bases;
 
-		const double elastic_energy = assembler.assemble_energy(rhs_assembler.formulation(), state.mesh->is_volume(), state.bases, gbases, full);
+		const double elastic_energy = is_cached(full) ? cached_energy : assembler.assemble_energy(rhs_assembler.formulation(), state.mesh->is_volume(), state.bases, gbases, full);
 		const double body_energy = rhs_assembler.compute_energy(full, state.local_neumann_boundary, state.density, state.args["n_boundary_samples"], t);
 
 		double intertia_energy = 0;
@@ -296,6 +296,32 @@ namespace polyfem
 		}
 	}
 
+	bool NLProblem::is_cached(const Eigen::MatrixXd &full) const
+	{
+		return cached_x.size() == full.size() && cached_x == full;
+	}
+
+	void NLProblem::compute_cached_quantities(const Eigen::MatrixXd &full, const bool with_hessian)
+	{
+		const bool cached = is_cached(full);
+		if (cached && (has_cached_hessian || !with_hessian))
+			return;
+
+		const auto &gbases = state.iso_parametric() ? state.bases : state.geom_bases;
+		if (with_hessian && hessian_pattern.empty())
+			hessian_pattern.init(state.n_bases, state.mesh->dimension(), state.bases);
+
+		if (cached)
+			assembler.assemble_energy_hessian(rhs_assembler.formulation(), state.mesh->is_volume(), state.n_bases, project_to_psd, state.bases, gbases, hessian_pattern, full, cached_hessian);
+		else if (with_hessian)
+			assembler.assemble_energy_all(rhs_assembler.formulation(), state.mesh->is_volume(), state.n_bases, project_to_psd, state.bases, gbases, hessian_pattern, full, cached_energy, cached_grad, cached_hessian);
+		else
+			assembler.assemble_energy_gradient(rhs_assembler.formulation(), state.mesh->is_volume(), state.n_bases, state.bases, gbases, full, cached_energy, cached_grad);
+
+		cached_x = full;
+		has_cached_hessian = with_hessian;
+	}
+
 	void NLProblem::gradient(const TVector &x, TVector &gradv)
 	{
 		Eigen::MatrixXd grad;
@@ -320,7 +346,13 @@ namespace polyfem
 		assert(full.size() == full_size);
 
 		const auto &gbases = state.iso_parametric() ? state.bases : state.geom_bases;
-		assembler.assemble_energy_gradient(rhs_assembler.formulation(), state.mesh->is_volume(), state.n_bases, state.bases, gbases, full, grad);
+		if (fused_assembly)
+		{
+			compute_cached_quantities(full, false);
+			grad = cached_grad;
+		}
+		else
+			assembler.assemble_energy_gradient(rhs_assembler.formulation(), state.mesh->is_volume(), state.n_bases, state.bases, gbases, full, grad);
 
 		if (is_time_dependent)
 		{
@@ -347,54 +379,75 @@ namespace polyfem
 
 	void NLProblem::hessian(const TVector &x, THessian &hessian)
 	{
-		THessian tmp;
-		hessian_full(x, tmp);
+		hessian_full(x, full_hessian);
+		full_hessian.makeCompressed();
 
-		std::vector<Eigen::Triplet<double>> entries;
+		//without collisions the pattern of the full hessian is fixed, the map to the reduced one can be reused
+		const bool has_collision = !disable_collision && state.args["has_collision"];
+		const bool pattern_changed = has_collision || full_hessian.nonZeros() != reduced_hessian_full_nnz;
 
-		Eigen::VectorXi indices(full_size);
+		full_to_reduced_hessian(full_hessian, pattern_changed, hessian);
+	}
 
-		int index = 0;
-		size_t kk = 0;
-		for (int i = 0; i < full_size; ++i)
+	void NLProblem::full_to_reduced_hessian(const THessian &full, const bool pattern_changed, THessian &reduced)
+	{
+		if (pattern_changed || reduced.rows() != reduced_size || reduced.cols() != reduced_size || !reduced.isCompressed() || reduced.nonZeros() != long(reduced_hessian_entries.size()))
 		{
-			if (kk < state.boundary_nodes.size() && state.boundary_nodes[kk] == i)
+			Eigen::VectorXi indices(full_size);
+
+			int index = 0;
+			size_t kk = 0;
+			for (int i = 0; i < full_size; ++i)
 			{
-				++kk;
-				indices(i) = -1;
-				continue;
+				if (kk < state.boundary_nodes.size() && state.boundary_nodes[kk] == i)
+				{
+					++kk;
+					indices(i) = -1;
+					continue;
+				}
+
+				indices(i) = index++;
 			}
+			assert(index == reduced_size);
 
-			indices(i) = index++;
-		}
-		assert(index == reduced_size);
+			//the map from full to reduced indices is monotone, so the column major order is preserved
+			reduced_hessian_entries.clear();
+			reduced_hessian_entries.reserve(full.nonZeros());
 
-		for (int k = 0; k < tmp.outerSize(); ++k)
-		{
-			if (indices(k) < 0)
-			{
-				continue;
-			}
+			std::vector<THessian::StorageIndex> outer(reduced_size + 1, 0);
+			std::vector<THessian::StorageIndex> inner;
+			inner.reserve(full.nonZeros());
 
-			for (THessian::InnerIterator it(tmp, k); it; ++it)
+			for (int k = 0; k < full.outerSize(); ++k)
 			{
-				// std::cout<<it.row()<<" "<<it.col()<<" "<<k<<std::endl;
-				assert(it.col() == k);
-				if (indices(it.row()) < 0 || indices(it.col()) < 0)
-				{
+				if (indices(k) < 0)
 					continue;
-				}
 
-				assert(indices(it.row()) >= 0);
-				assert(indices(it.col()) >= 0);
+				for (auto l = full.outerIndexPtr()[k]; l < full.outerIndexPtr()[k + 1]; ++l)
+				{
+					const int row = indices(full.innerIndexPtr()[l]);
+					if (row < 0)
+						continue;
 
-				entries.emplace_back(indices(it.row()), indices(it.col()), it.value());
+					inner.push_back(row);
+					reduced_hessian_entries.push_back(l);
+				}
+
+				outer[indices(k) + 1] = inner.size();
 			}
+
+			reduced.resize(reduced_size, reduced_size);
+			reduced.resizeNonZeros(inner.size());
+			std::copy(outer.begin(), outer.end(), reduced.outerIndexPtr());
+			std::copy(inner.begin(), inner.end(), reduced.innerIndexPtr());
+
+			reduced_hessian_full_nnz = full.nonZeros();
 		}
 
-		hessian.resize(reduced_size, reduced_size);
-		hessian.setFromTriplets(entries.begin(), entries.end());
-		hessian.makeCompressed();
+		const double *full_values = full.valuePtr();
+		double *values = reduced.valuePtr();
+		for (size_t k = 0; k < reduced_hessian_entries.size(); ++k)
+			values[k] = full_values[reduced_hessian_entries[k]];
 	}
 
 	void NLProblem::hessian_full(const TVector &x, THessian &hessian)
@@ -409,14 +462,17 @@ namespace polyfem
 
 		assert(full.size() == full_size);
 
-		const auto &gbases = state.iso_parametric() ? state.bases : state.geom_bases;
 		if (assembler.is_linear(rhs_assembler.formulation()))
 		{
 			compute_cached_stiffness();
 			hessian = cached_stiffness;
 		}
 		else
-			assembler.assemble_energy_hessian(rhs_assembler.formulation(), state.mesh->is_volume(), state.n_bases, project_to_psd, state.bases, gbases, full, hessian);
+		{
+			fused_assembly = true;
+			compute_cached_quantities(full, true);
+			hessian = cached_hessian;
+		}
 		if (is_time_dependent)
 		{
 			hessian *= dt * dt; // / 2.0;
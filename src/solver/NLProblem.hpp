@@ -28,6 +28,7 @@ namespace polyfem
 		double max_step_size(const TVector &x0, const TVector &x1);
 
 #include <polyfem/DisableWarnings.hpp>
+		//reduced hessian, if hessian comes from a previous call and the pattern did not change only its values are refilled
 		void hessian(const TVector &x, THessian &hessian);
 		void hessian_full(const TVector &x, THessian &gradv);
 #include <polyfem/EnableWarnings.hpp>
@@ -97,6 +98,22 @@ namespace polyfem
 		Eigen::MatrixXd _current_rhs;
 		StiffnessMatrix cached_stiffness;
 
+		//persistent full hessian, its pattern is computed once and the values are refilled at every call
+		SparsityPattern hessian_pattern;
+		THessian full_hessian;
+		//for every entry of the reduced hessian, the index of the corresponding value in full_hessian
+		std::vector<long> reduced_hessian_entries;
+		long reduced_hessian_full_nnz = -1;
+
+		//elastic energy and gradient of cached_x from a single pass over the elements, enabled at the first hessian
+		//the hessian of cached_x is assembled only when it is asked for, in the same pass if cached_x is new
+		bool fused_assembly = false;
+		Eigen::MatrixXd cached_x;
+		double cached_energy;
+		Eigen::MatrixXd cached_grad;
+		THessian cached_hessian;
+		bool has_cached_hessian = false;
+
 		const int full_size, reduced_size;
 		double t;
 		bool rhs_computed;
@@ -110,6 +127,9 @@ namespace polyfem
 		TVector x_prev, v_prev, a_prev;
 
 		void compute_cached_stiffness();
+		bool is_cached(const Eigen::MatrixXd &full) const;
+		void compute_cached_quantities(const Eigen::MatrixXd &full, const bool with_hessian);
+		void full_to_reduced_hessian(const THessian &full, const bool pattern_changed, THessian &reduced);
 		void compute_displaced_points(const Eigen::MatrixXd &full, Eigen::MatrixXd &displaced);
 	};
 } // namespace polyfem
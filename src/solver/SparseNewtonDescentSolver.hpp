@@ -48,6 +48,13 @@ namespace cppoptlib
 
 			use_gradient_norm_ = solver_param.count("useGradNorm") ? bool(solver_param["useGradNorm"]) : true;
 			this->setStopCriteria(criteria);
+
+			//inexact newton: the newton systems are solved with preconditioned CG to the eisenstat-walker tolerance
+			//the linear solver is the preconditioner, it is factorized again only every precondReuse newton iterations
+			inexact_ = solver_param.count("inexactNewton") ? bool(solver_param["inexactNewton"]) : false;
+			forcing_max_ = solver_param.count("forcingMax") ? double(solver_param["forcingMax"]) : 0.9;
+			precond_reuse_ = solver_param.count("precondReuse") ? int(solver_param["precondReuse"]) : 5;
+			krylov_max_iter_ = solver_param.count("krylovMaxIter") ? int(solver_param["krylovMaxIter"]) : 1000;
 		}
 
 		void setLineSearch(const std::string &name)
@@ -188,9 +195,29 @@ namespace cppoptlib
 			// const json &params = State::state().solver_params();
 			// auto solver = LinearSolver::create(State::state().solver_type(), State::state().precond_type());
 
-			auto solver = polysolve::LinearSolver::create(solver_type, precond_type);
-			solver->setParameters(solver_param);
+			//the linear solver is kept across calls so that the symbolic factorization can be reused
+			if (!linear_solver_)
+			{
+				linear_solver_ = polysolve::LinearSolver::create(solver_type, precond_type);
+				if (inexact_)
+				{
+					//an iterative solver is applied as a preconditioner, with a few iterations
+					json precond_param = solver_param;
+					precond_param["max_iter"] = solver_param.count("precondIterations") ? int(solver_param["precondIterations"]) : 1;
+					linear_solver_->setParameters(precond_param);
+				}
+				else
+					linear_solver_->setParameters(solver_param);
+			}
+			auto &solver = linear_solver_;
 			polyfem::logger().debug("\tinternal solver {}", solver->name());
+			internal_solver = json::array();
+			linear_iterations = json::array();
+			int n_precond_updates = 0;
+			//the preconditioner is always updated at the first iteration
+			int precond_age = precond_reuse_;
+			double forcing = std::min(0.5, forcing_max_);
+			double prev_grad_norm = -1;
 
 			const int reduced_size = x0.rows();
 
@@ -269,13 +296,59 @@ namespace cppoptlib
 				// std::cout<<hessian<<std::endl;
 				time.start();
 
-				if (new_hessian && !line_search_failed)
+				if (new_hessian && !line_search_failed && inexact_ && precond_age < precond_reuse_)
 				{
-					//TODO: get the correct size
-					solver->analyzePattern(hessian, hessian.rows());
+					//the preconditioner of a previous hessian is kept
+					++precond_age;
+				}
+				else if (new_hessian && !line_search_failed)
+				{
+					precond_age = 0;
+					++n_precond_updates;
+
+					//skip the symbolic analysis if the pattern is the same as the last analyzed one
+					const std::size_t pattern_hash = polyfem::sparse_pattern_hash(hessian);
+					if (hessian.nonZeros() != analyzed_nnz_ || pattern_hash != analyzed_pattern_hash_)
+					{
+						//TODO: get the correct size
+						solver->analyzePattern(hessian, hessian.rows());
+						analyzed_nnz_ = hessian.nonZeros();
+						analyzed_pattern_hash_ = pattern_hash;
+						++n_analyze_pattern_;
+					}
+					else
+					{
+						++n_analyze_pattern_skipped_;
+						polyfem::logger().trace("\tsame hessian pattern, skipping analyze pattern");
+					}
 					solver->factorize(hessian);
+					factorized_ = true;
+				}
+				if (!line_search_failed && inexact_)
+				{
+					//eisenstat-walker (choice 2) forcing term, safeguarded not to decrease too fast and not to oversolve near convergence
+					const double grad_norm = grad.norm();
+					if (prev_grad_norm > 0)
+					{
+						const double prev_forcing = forcing;
+						forcing = 0.9 * std::pow(grad_norm / prev_grad_norm, 2);
+						if (0.9 * prev_forcing * prev_forcing > 0.1)
+							forcing = std::max(forcing, 0.9 * prev_forcing * prev_forcing);
+						forcing = std::min(forcing, forcing_max_);
+						forcing = std::max(forcing, 0.5 * this->m_stop.gradNorm / grad_norm);
+					}
+					prev_grad_norm = grad_norm;
+
+					bool converged;
+					const int lin_iter = inexact_solve(hessian, grad, forcing, delta_x, converged);
+					linear_iterations.push_back(lin_iter);
+					polyfem::logger().debug("	inexact solve, forcing {} linear iterations {} converged {}", forcing, lin_iter, converged);
+
+					//a stale preconditioner that is not good enough is updated at the next iteration
+					if (!converged)
+						precond_age = precond_reuse_;
 				}
-				if (!line_search_failed)
+				else if (!line_search_failed)
 					solver->solve(grad, delta_x);
 
 				//gradient descent, check descent direction
@@ -409,6 +482,16 @@ namespace cppoptlib
 			solver_info["time_assembly"] = assembly_time;
 			solver_info["time_inverting"] = inverting_time;
 			solver_info["time_linesearch"] = linesearch_time;
+
+			solver_info["analyze_pattern"] = n_analyze_pattern_;
+			solver_info["analyze_pattern_skipped"] = n_analyze_pattern_skipped_;
+
+			solver_info["inexact_newton"] = inexact_;
+			if (inexact_)
+			{
+				solver_info["linear_iterations"] = linear_iterations;
+				solver_info["preconditioner_updates"] = n_precond_updates;
+			}
 		}
 
 		void getInfo(json &params)
@@ -417,6 +500,69 @@ namespace cppoptlib
 		}
 
 		int error_code() const { return error_code_; }
+		//true if the newton systems are solved with CG, the last factorization is then of a preconditioner, not of the last hessian
+		bool is_inexact() const { return inexact_; }
+
+		//solves hessian x = b with the factorization of the last hessian of minimize, false if there is none
+		bool solve_with_last_factorization(const TVector &b, TVector &x)
+		{
+			if (!factorized_)
+				return false;
+
+			x.resize(b.size());
+			linear_solver_->solve(b, x);
+			return true;
+		}
+
+		//flexible preconditioned CG for hessian x = b, the preconditioner is the linear solver with the factorization of the last updated hessian of minimize
+		//the polak-ribiere beta keeps it convergent when the preconditioner is not a fixed operator (eg, an iterative solver truncated to precondIterations)
+		//stops when ||r|| <= tol ||b||, at krylovMaxIter, or at a direction of negative curvature, returns the number of iterations
+		int inexact_solve(const polyfem::StiffnessMatrix &hessian, const TVector &b, const double tol, TVector &x, bool &converged)
+		{
+			assert(factorized_);
+			x.setZero(b.size());
+			converged = true;
+			const double b_norm = b.norm();
+			if (b_norm == 0)
+				return 0;
+
+			TVector r = b;
+			TVector z(b.size());
+			linear_solver_->solve(r, z);
+			TVector p = z;
+			TVector q, r_old;
+			double rz = r.dot(z);
+
+			for (int it = 0; it < krylov_max_iter_; ++it)
+			{
+				q = hessian * p;
+				const double pq = p.dot(q);
+				if (!(pq > 0))
+				{
+					//the first direction is still a descent direction
+					if (it == 0)
+						x = p;
+					converged = false;
+					return it;
+				}
+
+				const double alpha = rz / pq;
+				x += alpha * p;
+				r_old = r;
+				r -= alpha * q;
+
+				if (r.norm() <= tol * b_norm)
+					return it + 1;
+
+				linear_solver_->solve(r, z);
+				const double beta = z.dot(r - r_old) / rz;
+				p = z + beta * p;
+				rz = r.dot(z);
+			}
+
+			converged = false;
+			return krylov_max_iter_;
+		}
 
 	private:
 		const json solver_param;
@@ -428,6 +574,19 @@ namespace cppoptlib
 		json solver_info;
 
 		json internal_solver = json::array();
+		json linear_iterations = json::array();
+
+		bool inexact_;
+		double forcing_max_;
+		int precond_reuse_;
+		int krylov_max_iter_;
+
+		std::unique_ptr<polysolve::LinearSolver> linear_solver_;
+		long analyzed_nnz_ = -1;
+		std::size_t analyzed_pattern_hash_ = 0;
+		int n_analyze_pattern_ = 0;
+		int n_analyze_pattern_skipped_ = 0;
+		bool factorized_ = false;
 
 		LineSearch line_search = LineSearch::Armijo;
 
@@ -0,0 +1,92 @@
+#include <polyfem/SymmetricSolve.hpp>
+
+#include <polyfem/MatrixUtils.hpp>
+
+#include <unsupported/Eigen/SparseExtra>
+
+#include <vector>
+
+namespace polyfem
+{
+	bool is_symmetric_solver(const std::string &solver_type)
+	{
+		return solver_type == "Pardiso"
+			|| solver_type == "Eigen::PardisoLLT" || solver_type == "Eigen::PardisoLDLT"
+			|| solver_type == "Eigen::SimplicialLLT" || solver_type == "Eigen::SimplicialLDLT"
+			|| solver_type == "Eigen::CholmodSupernodalLLT" || solver_type == "Eigen::CholmodSimplicialLLT" || solver_type == "Eigen::CholmodSimplicialLDLT";
+	}
+
+	Eigen::Vector4d dirichlet_solve_symmetric(polysolve::LinearSolver &solver, const std::string &solver_type, const StiffnessMatrix &upper, Eigen::VectorXd &f, const std::vector<int> &dirichlet_nodes, Eigen::VectorXd &u, const int precond_num, const std::string &save_path, bool compute_spectrum)
+	{
+		const int n = int(upper.rows());
+		assert(upper.cols() == n);
+		assert(f.size() == n);
+
+		//g = f - (I-N) A N f, as in dirichlet_solve
+		Eigen::VectorXd N = Eigen::VectorXd::Zero(n);
+		for (const int i : dirichlet_nodes)
+			N(i) = 1;
+
+		Eigen::VectorXd af;
+		symmetric_multiply(upper, (N.array() * f.array()).matrix(), af);
+		const Eigen::VectorXd g = f.array() - (1 - N.array()) * af.array();
+
+		//removes the dirichlet rows and columns and puts 1 on their diagonal, the triangle stays a triangle
+		std::vector<Eigen::Triplet<double>> entries;
+		entries.reserve(upper.nonZeros());
+		for (int k = 0; k < upper.outerSize(); ++k)
+		{
+			for (StiffnessMatrix::InnerIterator it(upper, k); it; ++it)
+			{
+				if (N(it.row()) != 1 && N(it.col()) != 1)
+					entries.emplace_back(it.row(), it.col(), it.value());
+			}
+		}
+		for (const int i : dirichlet_nodes)
+			entries.emplace_back(i, i, 1);
+
+		StiffnessMatrix A(n, n);
+		A.setFromTriplets(entries.begin(), entries.end());
+		entries.clear();
+		entries.shrink_to_fit();
+
+		//the exports see the same full matrix as the unsymmetric dirichlet_solve
+		Eigen::Vector4d spectrum = Eigen::Vector4d::Zero();
+		if (!save_path.empty() || compute_spectrum)
+		{
+			StiffnessMatrix full;
+			symmetric_to_full(A, full);
+			if (!save_path.empty())
+				Eigen::saveMarket(full, save_path);
+			if (compute_spectrum)
+				spectrum = compute_specturm(full);
+		}
+
+		if (solver_type == "Pardiso" || solver_type == "Eigen::PardisoLLT" || solver_type == "Eigen::PardisoLDLT")
+		{
+			//pardiso reads the upper triangle
+		}
+		else if (is_symmetric_solver(solver_type))
+		{
+			//the eigen and cholmod solvers read the lower triangle by default
+			const StiffnessMatrix lower = A.transpose();
+			A = lower;
+		}
+		else
+		{
+			StiffnessMatrix full;
+			symmetric_to_full(A, full);
+			A = full;
+		}
+		A.makeCompressed();
+
+		solver.analyzePattern(A, precond_num);
+		solver.factorize(A);
+
+		u.resize(n);
+		solver.solve(g, u);
+		f = g;
+
+		return spectrum;
+	}
+} // namespace polyfem
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <polyfem/Types.hpp>
+
+#include <polysolve/LinearSolver.hpp>
+
+#include <Eigen/Dense>
+#include <string>
+#include <vector>
+
+namespace polyfem
+{
+	//true if solver_type is a cholesky type solver that reads a single triangle of a symmetric matrix
+	bool is_symmetric_solver(const std::string &solver_type);
+
+	//dirichlet_solve for a symmetric matrix of which only the upper triangle is stored
+	//the dirichlet rows and columns are eliminated on the triangle, the cholesky type solvers get only one triangle
+	//(the upper for pardiso, the lower for the eigen and cholmod ones), the others the full matrix
+	//save_path and compute_spectrum export the full eliminated matrix and its spectrum
+	Eigen::Vector4d dirichlet_solve_symmetric(polysolve::LinearSolver &solver, const std::string &solver_type, const StiffnessMatrix &upper, Eigen::VectorXd &f, const std::vector<int> &dirichlet_nodes, Eigen::VectorXd &u, const int precond_num, const std::string &save_path = "", bool compute_spectrum = false);
+} // namespace polyfem
@@ -104,12 +104,17 @@ namespace polyfem
 
             {"count_flipped_els", false},
             {"project_to_psd", false},
+            {"quadrature_psd_projection", false},
+            {"assembly_cache_max_memory", 0},
 
             {"has_collision", false},
             {"dhat", 0.03},
 
             {"tend", 1},
             {"time_steps", 10},
+            {"time_integrator", "Implicit"},
+            {"cfl_factor", 0.5},
+            {"time_adaptivity", {{"enabled", false}, {"rtol", 1e-3}, {"atol", 1e-6}, {"dt_min", 0}, {"dt_max", 0}, {"safety", 0.9}, {"max_growth", 2}, {"max_shrink", 0.2}}},
 
             {"scalar_formulation", "Laplacian"},
             {"tensor_formulation", "LinearElasticity"},
@@ -137,6 +142,13 @@ namespace polyfem
             {"precond_type", LinearSolver::defaultPrecond()},
             {"solver_params", json({})},
 
+            {"matrix_free", false},
+            {"matrix_free_params", {{"precond", "jacobi"}, {"max_iter", 1000}, {"conv_tol", 1e-10}, {"chebyshev_degree", 3}}},
+            {"block_matrix", false},
+            {"block_matrix_solver", "linear_solver"},
+            {"symmetric_storage", false},
+            {"symmetric_storage_solver", "linear_solver"},
+
             {"rhs_solver_type", LinearSolver::defaultSolver()},
             {"rhs_precond_type", LinearSolver::defaultPrecond()},
             {"rhs_solver_params", json({})},
@@ -144,6 +156,7 @@ namespace polyfem
             {"line_search", "armijo"},
             {"nl_solver", "newton"},
             {"nl_solver_rhs_steps", 1},
+            {"nl_solver_predictor", "tangent"},
             {"save_solve_sequence", false},
             {"save_solve_sequence_debug", false},
             {"save_time_sequence", true},
@@ -1,8 +1,6 @@
 #include <polyfem/BoundarySampler.hpp>
 
-#include <polyfem/LineQuadrature.hpp>
-#include <polyfem/TriQuadrature.hpp>
-#include <polyfem/QuadQuadrature.hpp>
+#include <polyfem/QuadratureCache.hpp>
 
 #include <polyfem/auto_p_bases.hpp>
 #include <polyfem/auto_q_bases.hpp>
@@ -96,8 +94,7 @@ namespace polyfem
 	{
 		auto endpoints = quad_local_node_coordinates_from_edge(index);
 
-		Quadrature quad;
-		LineQuadrature quad_rule; quad_rule.get_quadrature(order, quad);
+		const Quadrature &quad = QuadratureCache::line(order);
 
 		points.resize(quad.points.rows(), endpoints.cols());
 		uv.resize(quad.points.rows(), 2);
@@ -117,8 +114,7 @@ namespace polyfem
 	{
 		auto endpoints = tri_local_node_coordinates_from_edge(index);
 
-		Quadrature quad;
-		LineQuadrature quad_rule; quad_rule.get_quadrature(order, quad);
+		const Quadrature &quad = QuadratureCache::line(order);
 
 		points.resize(quad.points.rows(), endpoints.cols());
 		uv.resize(quad.points.rows(), 2);
@@ -138,8 +134,7 @@ namespace polyfem
 	{
 		auto endpoints = hex_local_node_coordinates_from_face(index);
 
-		Quadrature quad;
-		QuadQuadrature quad_rule; quad_rule.get_quadrature(order, quad);
+		const Quadrature &quad = QuadratureCache::quad(order);
 
 		const int n_pts = quad.points.rows();
 		points.resize(n_pts, endpoints.cols());
@@ -169,8 +164,7 @@ namespace polyfem
 	void BoundarySampler::quadrature_for_tri_face(int index, int order, int gid, const Mesh &mesh, Eigen::MatrixXd &uv, Eigen::MatrixXd &points, Eigen::VectorXd &weights)
 	{
 		auto endpoints = tet_local_node_coordinates_from_face(index);
-		Quadrature quad;
-		TriQuadrature quad_rule; quad_rule.get_quadrature(order, quad);
+		const Quadrature &quad = QuadratureCache::tri(order);
 
 		const int n_pts = quad.points.rows();
 		points.resize(n_pts, endpoints.cols());
@@ -341,8 +335,7 @@ namespace polyfem
 
 		auto p0 = mesh2d.point(index.vertex);
 		auto p1 = mesh2d.point(mesh2d.switch_edge(index).vertex);
-		Quadrature quad;
-		LineQuadrature quad_rule; quad_rule.get_quadrature(order, quad);
+		const Quadrature &quad = QuadratureCache::line(order);
 
 		points.resize(quad.points.rows(), p0.cols());
 		uv.resize(quad.points.rows(), 2);
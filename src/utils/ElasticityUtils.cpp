@@ -2,6 +2,10 @@
 #include <polyfem/MatrixUtils.hpp>
 #include <polyfem/Logger.hpp>
 
+#ifdef POLYFEM_WITH_TBB
+#include <tbb/parallel_for.h>
+#endif
+
 namespace polyfem
 {
 	Eigen::VectorXd gradient_from_energy(const int size, const int n_bases, const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da,
@@ -101,68 +105,81 @@ namespace polyfem
 		return grad;
 	}
 
-	Eigen::MatrixXd hessian_from_energy(const int size, const int n_bases, const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da,
-										const std::function<DScalar2<double, Eigen::Matrix<double, 6, 1>, Eigen::Matrix<double, 6, 6>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun6,
-										const std::function<DScalar2<double, Eigen::Matrix<double, 8, 1>, Eigen::Matrix<double, 8, 8>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun8,
-										const std::function<DScalar2<double, Eigen::Matrix<double, 12, 1>, Eigen::Matrix<double, 12, 12>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun12,
-										const std::function<DScalar2<double, Eigen::Matrix<double, 18, 1>, Eigen::Matrix<double, 18, 18>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun18,
-										const std::function<DScalar2<double, Eigen::Matrix<double, 24, 1>, Eigen::Matrix<double, 24, 24>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun24,
-										const std::function<DScalar2<double, Eigen::Matrix<double, 30, 1>, Eigen::Matrix<double, 30, 30>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun30,
-										const std::function<DScalar2<double, Eigen::Matrix<double, 60, 1>, Eigen::Matrix<double, 60, 60>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun60,
-										const std::function<DScalar2<double, Eigen::Matrix<double, 81, 1>, Eigen::Matrix<double, 81, 81>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun81,
-										const std::function<DScalar2<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, SMALL_N, SMALL_N>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &funN,
-										const std::function<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &funn)
+	namespace
 	{
-		Eigen::MatrixXd hessian;
+		//the DScalar2 evaluation of the energy also has its value and gradient
+		template <typename T>
+		void assign_derivatives(const T &auto_diff_energy, double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian)
+		{
+			energy = auto_diff_energy.getValue();
+			grad = auto_diff_energy.getGradient();
+			hessian = auto_diff_energy.getHessian();
+		}
+	} // namespace
+
+	void all_from_energy(const int size, const int n_bases, const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, 6, 1>, Eigen::Matrix<double, 6, 6>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun6,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, 8, 1>, Eigen::Matrix<double, 8, 8>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun8,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, 12, 1>, Eigen::Matrix<double, 12, 12>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun12,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, 18, 1>, Eigen::Matrix<double, 18, 18>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun18,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, 24, 1>, Eigen::Matrix<double, 24, 24>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun24,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, 30, 1>, Eigen::Matrix<double, 30, 30>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun30,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, 60, 1>, Eigen::Matrix<double, 60, 60>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun60,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, 81, 1>, Eigen::Matrix<double, 81, 81>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun81,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, SMALL_N, SMALL_N>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &funN,
+						 const std::function<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &funn,
+						 double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian)
+	{
+		hessian.resize(0, 0);
 
 		switch (size * n_bases)
 		{
 		case 6:
 		{
 			auto auto_diff_energy = fun6(vals, displacement, da);
-			hessian = auto_diff_energy.getHessian();
+			assign_derivatives(auto_diff_energy, energy, grad, hessian);
 			break;
 		}
 		case 8:
 		{
 			auto auto_diff_energy = fun8(vals, displacement, da);
-			hessian = auto_diff_energy.getHessian();
+			assign_derivatives(auto_diff_energy, energy, grad, hessian);
 			break;
 		}
 		case 12:
 		{
 			auto auto_diff_energy = fun12(vals, displacement, da);
-			hessian = auto_diff_energy.getHessian();
+			assign_derivatives(auto_diff_energy, energy, grad, hessian);
 			break;
 		}
 		case 18:
 		{
 			auto auto_diff_energy = fun18(vals, displacement, da);
-			hessian = auto_diff_energy.getHessian();
+			assign_derivatives(auto_diff_energy, energy, grad, hessian);
 			break;
 		}
 		case 24:
 		{
 			auto auto_diff_energy = fun24(vals, displacement, da);
-			hessian = auto_diff_energy.getHessian();
+			assign_derivatives(auto_diff_energy, energy, grad, hessian);
 			break;
 		}
 		case 30:
 		{
 			auto auto_diff_energy = fun30(vals, displacement, da);
-			hessian = auto_diff_energy.getHessian();
+			assign_derivatives(auto_diff_energy, energy, grad, hessian);
 			break;
 		}
 		case 60:
 		{
 			auto auto_diff_energy = fun60(vals, displacement, da);
-			hessian = auto_diff_energy.getHessian();
+			assign_derivatives(auto_diff_energy, energy, grad, hessian);
 			break;
 		}
 		case 81:
 		{
 			auto auto_diff_energy = fun81(vals, displacement, da);
-			hessian = auto_diff_energy.getHessian();
+			assign_derivatives(auto_diff_energy, energy, grad, hessian);
 			break;
 		}
 		}
@@ -174,7 +191,7 @@ namespace polyfem
 			if (n_bases * size <= SMALL_N)
 			{
 				auto auto_diff_energy = funN(vals, displacement, da);
-				hessian = auto_diff_energy.getHessian();
+				assign_derivatives(auto_diff_energy, energy, grad, hessian);
 			}
 			else
 			// #endif
@@ -188,16 +205,132 @@ namespace polyfem
 				}
 
 				auto auto_diff_energy = funn(vals, displacement, da);
-				hessian = auto_diff_energy.getHessian();
+				assign_derivatives(auto_diff_energy, energy, grad, hessian);
 			}
 		}
 
 		// time.stop();
 		// std::cout << "-- hessian: " << time.getElapsedTime() << std::endl;
+	}
+
+	Eigen::MatrixXd hessian_from_energy(const int size, const int n_bases, const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da,
+										const std::function<DScalar2<double, Eigen::Matrix<double, 6, 1>, Eigen::Matrix<double, 6, 6>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun6,
+										const std::function<DScalar2<double, Eigen::Matrix<double, 8, 1>, Eigen::Matrix<double, 8, 8>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun8,
+										const std::function<DScalar2<double, Eigen::Matrix<double, 12, 1>, Eigen::Matrix<double, 12, 12>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun12,
+										const std::function<DScalar2<double, Eigen::Matrix<double, 18, 1>, Eigen::Matrix<double, 18, 18>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun18,
+										const std::function<DScalar2<double, Eigen::Matrix<double, 24, 1>, Eigen::Matrix<double, 24, 24>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun24,
+										const std::function<DScalar2<double, Eigen::Matrix<double, 30, 1>, Eigen::Matrix<double, 30, 30>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun30,
+										const std::function<DScalar2<double, Eigen::Matrix<double, 60, 1>, Eigen::Matrix<double, 60, 60>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun60,
+										const std::function<DScalar2<double, Eigen::Matrix<double, 81, 1>, Eigen::Matrix<double, 81, 81>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun81,
+										const std::function<DScalar2<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, SMALL_N, SMALL_N>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &funN,
+										const std::function<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &funn)
+	{
+		double energy;
+		Eigen::VectorXd grad;
+		Eigen::MatrixXd hessian;
+		all_from_energy(size, n_bases, vals, displacement, da, fun6, fun8, fun12, fun18, fun24, fun30, fun60, fun81, funN, funn, energy, grad, hessian);
 
 		return hessian;
 	}
 
+	void derivatives_from_def_grad(const int size, const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da,
+								   const bool with_grad, const bool with_hessian,
+								   const std::function<void(const int, const DefGradMatrix &, double &, DefGradMatrix &, StressGradMatrix &)> &fun,
+								   double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian)
+	{
+		assert(displacement.cols() == 1);
+
+		const int n_bases = int(vals.basis_values.size());
+		const int n_pts = da.size();
+
+		Eigen::VectorXd local_disp = Eigen::VectorXd::Zero(n_bases * size);
+		for (int i = 0; i < n_bases; ++i)
+		{
+			for (const auto &g : vals.basis_values[i].global)
+			{
+				for (int d = 0; d < size; ++d)
+					local_disp(i * size + d) += g.val * displacement(g.index * size + d);
+			}
+		}
+
+		energy = 0;
+		if (with_grad)
+			grad.setZero(n_bases * size);
+		if (with_hessian)
+			hessian.setZero(n_bases * size, n_bases * size);
+
+		Eigen::MatrixXd grads(n_bases, size);
+		DefGradMatrix def_grad(size, size);
+		DefGradMatrix stress(size, size);
+		StressGradMatrix stress_grad(size * size, size * size);
+		Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 9> tmp(size, size * size);
+
+		for (int p = 0; p < n_pts; ++p)
+		{
+			//gradients of the bases in the physical element
+			for (int i = 0; i < n_bases; ++i)
+				grads.row(i) = vals.basis_values[i].grad.row(p) * vals.jac_it[p];
+
+			//F = Id + grad u
+			def_grad.setIdentity();
+			for (int i = 0; i < n_bases; ++i)
+			{
+				for (int d = 0; d < size; ++d)
+					def_grad.row(d) += local_disp(i * size + d) * grads.row(i);
+			}
+
+			double density;
+			fun(p, def_grad, density, stress, stress_grad);
+			energy += density * da(p);
+
+			//dF(d, c)/du(i*size+d) = grads(i, c)
+			if (with_grad)
+			{
+				for (int i = 0; i < n_bases; ++i)
+				{
+					for (int d = 0; d < size; ++d)
+						grad(i * size + d) += da(p) * stress.row(d).dot(grads.row(i));
+				}
+			}
+
+			if (with_hessian)
+			{
+				for (int i = 0; i < n_bases; ++i)
+				{
+					//tmp(d, b) = sum_c grads(i, c) dP(d, c)/dF_b
+					tmp.setZero();
+					for (int c = 0; c < size; ++c)
+						tmp += grads(i, c) * stress_grad.middleRows(c * size, size);
+
+					//only the upper triangle, the hessian is symmetric
+					for (int j = i; j < n_bases; ++j)
+					{
+						for (int e = 0; e < size; ++e)
+						{
+							for (int d = 0; d < size; ++d)
+							{
+								double val = 0;
+								for (int f = 0; f < size; ++f)
+									val += tmp(d, e + f * size) * grads(j, f);
+
+								hessian(i * size + d, j * size + e) += da(p) * val;
+							}
+						}
+					}
+				}
+			}
+		}
+
+		if (with_hessian)
+		{
+			for (int i = 0; i < n_bases; ++i)
+			{
+				for (int j = 0; j < i; ++j)
+					hessian.block(i * size, j * size, size, size) = hessian.block(j * size, i * size, size, size).transpose();
+			}
+		}
+	}
+
 	double convert_to_lambda(const bool is_volume, const double E, const double nu)
 	{
 		if (is_volume)
@@ -474,32 +607,116 @@ namespace polyfem
 		return res;
 	}
 
-	LameParameters::~LameParameters()
+	void MaterialCache::init(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases, const EvalFunction &fun)
 	{
-		te_free(lambda_expr_);
-		te_free(mu_expr_);
-		delete vals_;
+		clear();
+
+		const int n_elements = int(bases.size());
+		std::vector<Eigen::MatrixXd> points(n_elements);
+		std::vector<Eigen::MatrixXd> values(n_elements);
+
+		//same points as ElementAssemblyValues::compute
+		const auto compute_element = [&](const int e) {
+			Quadrature quadrature;
+			bases[e].compute_quadrature(quadrature);
+			gbases[e].eval_geom_mapping(quadrature.points, points[e]);
+			fun(points[e], e, values[e]);
+			assert(values[e].rows() == points[e].rows());
+		};
+
+#ifdef POLYFEM_WITH_TBB
+		tbb::parallel_for(tbb::blocked_range<int>(0, n_elements), [&](const tbb::blocked_range<int> &r) {
+			for (int e = r.begin(); e != r.end(); ++e)
+				compute_element(e);
+		});
+#else
+		for (int e = 0; e < n_elements; ++e)
+			compute_element(e);
+#endif
+
+		offsets_.resize(n_elements + 1);
+		offsets_[0] = 0;
+		for (int e = 0; e < n_elements; ++e)
+			offsets_[e + 1] = offsets_[e] + points[e].rows();
+
+		const int n_fields = n_elements > 0 ? int(values[0].cols()) : 0;
+		values_.resize(offsets_.back(), n_fields);
+		points_.resize(offsets_.back(), is_volume ? 3 : 2);
+		for (int e = 0; e < n_elements; ++e)
+		{
+			values_.middleRows(offsets_[e], points[e].rows()) = values[e];
+			points_.middleRows(offsets_[e], points[e].rows()) = points[e];
+		}
+
+		is_volume_ = is_volume;
+		bases_ = &bases;
+		gbases_ = &gbases;
+		n_elements_ = bases.size();
+	}
+
+	void MaterialCache::clear()
+	{
+		offsets_.clear();
+		values_.resize(0, 0);
+		points_.resize(0, 0);
+
+		bases_ = nullptr;
+		gbases_ = nullptr;
+		n_elements_ = 0;
+		miss_.logged = false;
+	}
+
+	void MaterialCache::log_miss(const int el_id) const
+	{
+		if (!miss_.logged.exchange(true))
+			logger().debug("material of element {} is not cached at the requested points (other points or bases refilled at the same address), evaluating it directly", el_id);
+	}
+
+	bool MaterialCache::is_initialized(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases) const
+	{
+		return bases_ == &bases && gbases_ == &gbases && is_volume_ == is_volume && n_elements_ == bases.size();
+	}
+
+	bool MaterialCache::has(const int el_id, const Eigen::Ref<const Eigen::MatrixXd> &pts) const
+	{
+		if (el_id < 0 || el_id + 1 >= long(offsets_.size()))
+			return false;
+
+		const long n_pts = offsets_[el_id + 1] - offsets_[el_id];
+		if (n_pts == 0 || pts.rows() != n_pts || pts.cols() != points_.cols())
+			return false;
+
+		const auto cached = points_.middleRows(offsets_[el_id], n_pts);
+		const double scale = 1 + cached.cwiseAbs().maxCoeff();
+		return (pts - cached).cwiseAbs().maxCoeff() <= 1e-12 * scale;
+	}
+
+	bool MaterialCache::has(const int el_id, const int p, const Eigen::Ref<const RowVectorNd> &pt) const
+	{
+		if (el_id < 0 || el_id + 1 >= long(offsets_.size()))
+			return false;
+
+		if (p < 0 || p >= offsets_[el_id + 1] - offsets_[el_id] || pt.size() != points_.cols())
+			return false;
+
+		const auto cached = points_.row(offsets_[el_id] + p);
+		const double scale = 1 + cached.cwiseAbs().maxCoeff();
+		return (pt - cached).cwiseAbs().maxCoeff() <= 1e-12 * scale;
 	}
 
 	LameParameters::LameParameters()
 	{
-		lambda_expr_ = nullptr;
-		mu_expr_ = nullptr;
-		vals_ = new Internal();
 		initialized_ = false;
 	}
 
 	void LameParameters::lambda_mu(double x, double y, double z, int el_id, double &lambda, double &mu) const
 	{
-		if (lambda_expr_)
+		if (!lambda_expr_.empty())
 		{
-			assert(mu_expr_);
-			vals_->x = x;
-			vals_->y = y;
-			vals_->z = z;
+			assert(!mu_expr_.empty());
 
-			double tmpl = te_eval(lambda_expr_);
-			double tmpm = te_eval(mu_expr_);
+			double tmpl = lambda_expr_(x, y, z);
+			double tmpm = mu_expr_(x, y, z);
 			if (!is_lambda_mu_)
 			{
 				lambda = convert_to_lambda(size_ == 3, tmpl, tmpm);
@@ -525,9 +742,103 @@ namespace polyfem
 		}
 	}
 
-	double iflargerthanzerothenelse(double check, double ttrue, double ffalse)
+	void LameParameters::lambda_mu(const Eigen::MatrixXd &pts, int el_id, Eigen::VectorXd &lambda, Eigen::VectorXd &mu) const
+	{
+		if (cache_.has(el_id, pts))
+		{
+			lambda = cache_.values(el_id).col(0);
+			mu = cache_.values(el_id).col(1);
+			return;
+		}
+
+		if (lambda_expr_.empty())
+		{
+			double l, m;
+			lambda_mu(0, 0, 0, el_id, l, m);
+			lambda.setConstant(pts.rows(), l);
+			mu.setConstant(pts.rows(), m);
+			return;
+		}
+
+		lambda_expr_.eval(pts, 0, lambda);
+		mu_expr_.eval(pts, 0, mu);
+
+		if (!is_lambda_mu_)
+		{
+			for (long i = 0; i < pts.rows(); ++i)
+			{
+				const double E = lambda(i);
+				const double nu = mu(i);
+				lambda(i) = convert_to_lambda(size_ == 3, E, nu);
+				mu(i) = convert_to_mu(E, nu);
+			}
+		}
+	}
+
+	void LameParameters::lambda_mu(const ElementAssemblyValues &vals, const int p, double &lambda, double &mu) const
+	{
+		lambda_mu(vals.element_id, p, vals.val.row(p), lambda, mu);
+	}
+
+	void LameParameters::lambda_mu(const int el_id, const int p, const RowVectorNd &pt, double &lambda, double &mu) const
 	{
-		return check >= 0 ? ttrue : ffalse;
+		if (!lambda_expr_.empty())
+		{
+			if (cache_.has(el_id, p, pt))
+			{
+				lambda = cache_.value(el_id, p, 0);
+				mu = cache_.value(el_id, p, 1);
+				return;
+			}
+
+			cache_.log_miss(el_id);
+		}
+
+		lambda_mu(pt(0), pt(1), pt.size() == 2 ? 0. : pt(2), el_id, lambda, mu);
+	}
+
+	void LameParameters::init_cache(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases) const
+	{
+		//constants and per element values are already cheap to evaluate
+		if (lambda_expr_.empty() || cache_.is_initialized(is_volume, bases, gbases))
+			return;
+
+		cache_.init(is_volume, bases, gbases, [&](const Eigen::MatrixXd &pts, const int el_id, Eigen::MatrixXd &values) {
+			Eigen::VectorXd lambda, mu;
+			lambda_mu(pts, el_id, lambda, mu);
+			values.resize(pts.rows(), 2);
+			values.col(0) = lambda;
+			values.col(1) = mu;
+		});
+	}
+
+	bool LameParameters::set_expressions(const std::string &first, const std::string &second, const bool is_lambda_mu)
+	{
+		int err;
+		if (!lambda_expr_.compile(first, err) || !mu_expr_.compile(second, err))
+		{
+			lambda_expr_.clear();
+			mu_expr_.clear();
+			return false;
+		}
+
+		is_lambda_mu_ = is_lambda_mu;
+
+		lambda_mat_.resize(0, 0);
+		mu_mat_.resize(0, 0);
+		cache_.clear();
+
+		//constant expressions, eg "2e11/2", do not need to be evaluated at every point
+		if (lambda_expr_.is_constant() && mu_expr_.is_constant())
+		{
+			lambda_ = is_lambda_mu_ ? lambda_expr_.constant() : convert_to_lambda(size_ == 3, lambda_expr_.constant(), mu_expr_.constant());
+			mu_ = is_lambda_mu_ ? mu_expr_.constant() : convert_to_mu(lambda_expr_.constant(), mu_expr_.constant());
+
+			lambda_expr_.clear();
+			mu_expr_.clear();
+		}
+
+		return true;
 	}
 
 	void LameParameters::init_multimaterial(const Eigen::MatrixXd &Es, const Eigen::MatrixXd &nus)
@@ -545,15 +856,18 @@ namespace polyfem
 		lambda_ = -1;
 		mu_ = -1;
 		initialized_ = true;
+
+		lambda_expr_.clear();
+		mu_expr_.clear();
+		cache_.clear();
 	}
 
 	void LameParameters::init(const json &params)
 	{
 		size_ = params["size"];
-		te_free(lambda_expr_);
-		te_free(mu_expr_);
-		lambda_expr_ = nullptr;
-		mu_expr_ = nullptr;
+		lambda_expr_.clear();
+		mu_expr_.clear();
+		cache_.clear();
 
 		if (initialized_)
 			return;
@@ -594,50 +908,21 @@ namespace polyfem
 				lambda_ = -1;
 				mu_ = -1;
 			}
-			else if (params["lambda"].is_string())
-			{
-				read_matrix(params["lambda"], lambda_mat_);
-				read_matrix(params["mu"], mu_mat_);
-
-				assert(lambda_mat_.size() == mu_mat_.size());
-
-				lambda_ = -1;
-				mu_ = -1;
-			}
 			else
 			{
-				te_variable vars[4];
-				vars[0] = {"x", &vals_->x};
-				vars[1] = {"y", &vals_->y};
-				vars[2] = {"z", &vals_->z};
-				vars[3].name = "if";
-				vars[3].address = (void *)&iflargerthanzerothenelse;
-				vars[3].type = TE_FUNCTION3;
-
 				assert(params["lambda"].is_string());
 				assert(params["mu"].is_string());
 
-				const std::string lambdas = params["lambda"];
-				const std::string mus = params["mu"];
-
-				int err;
-				lambda_expr_ = te_compile(lambdas.c_str(), vars, 4, &err);
-				mu_expr_ = te_compile(mus.c_str(), vars, 4, &err);
-
-				is_lambda_mu_ = true;
-
-				if (!lambda_expr_)
+				//expressions of x, y, z, otherwise files with the per element values
+				if (!set_expressions(params["lambda"], params["mu"], true))
 				{
-					logger().error("Unable to parse {}, error, {}", lambdas, err);
+					read_matrix(params["lambda"], lambda_mat_);
+					read_matrix(params["mu"], mu_mat_);
 
-					assert(false);
-				}
-
-				if (!mu_expr_)
-				{
-					logger().error("Unable to parse {}, error, {}", mus, err);
+					assert(lambda_mat_.size() == mu_mat_.size());
 
-					assert(false);
+					lambda_ = -1;
+					mu_ = -1;
 				}
 			}
 		}
@@ -670,85 +955,44 @@ namespace polyfem
 			lambda_ = -1;
 			mu_ = -1;
 		}
-		else if (E.is_string())
-		{
-			Eigen::MatrixXd e_mat, nu_mat;
-			read_matrix(E, e_mat);
-			read_matrix(nu, nu_mat);
-
-			lambda_mat_.resize(e_mat.size(), 1);
-			mu_mat_.resize(nu_mat.size(), 1);
-			assert(lambda_mat_.size() == mu_mat_.size());
-
-			for (int i = 0; i < lambda_mat_.size(); ++i)
-			{
-				lambda_mat_(i) = convert_to_lambda(size_ == 3, e_mat(i), nu_mat(i));
-				mu_mat_(i) = convert_to_mu(e_mat(i), nu_mat(i));
-			}
-
-			lambda_ = -1;
-			mu_ = -1;
-		}
 		else
 		{
-			te_variable vars[4];
-			vars[0] = {"x", &vals_->x};
-			vars[1] = {"y", &vals_->y};
-			vars[2] = {"z", &vals_->z};
-			vars[3].name = "if";
-			vars[3].address = (void *)&iflargerthanzerothenelse;
-			vars[3].type = TE_FUNCTION3;
-
 			assert(E.is_string());
 			assert(nu.is_string());
 
-			const std::string Es = E;
-			const std::string nus = nu;
-
-			int err;
-			lambda_expr_ = te_compile(Es.c_str(), vars, 4, &err);
-			mu_expr_ = te_compile(nus.c_str(), vars, 4, &err);
-
-			is_lambda_mu_ = false;
-
-			if (!lambda_expr_)
+			//expressions of x, y, z, otherwise files with the per element values
+			if (!set_expressions(E, nu, false))
 			{
-				logger().error("Unable to parse {}, error, {}", Es, err);
+				Eigen::MatrixXd e_mat, nu_mat;
+				read_matrix(E, e_mat);
+				read_matrix(nu, nu_mat);
 
-				assert(false);
-			}
+				lambda_mat_.resize(e_mat.size(), 1);
+				mu_mat_.resize(nu_mat.size(), 1);
+				assert(lambda_mat_.size() == mu_mat_.size());
 
-			if (!mu_expr_)
-			{
-				logger().error("Unable to parse {}, error, {}", nus, err);
+				for (int i = 0; i < lambda_mat_.size(); ++i)
+				{
+					lambda_mat_(i) = convert_to_lambda(size_ == 3, e_mat(i), nu_mat(i));
+					mu_mat_(i) = convert_to_mu(e_mat(i), nu_mat(i));
+				}
 
-				assert(false);
+				lambda_ = -1;
+				mu_ = -1;
 			}
 		}
 	}
 
-	Density::~Density()
-	{
-		te_free(rho_expr_);
-		delete vals_;
-	}
-
 	Density::Density()
 	{
-		rho_expr_ = nullptr;
-		vals_ = new Internal();
 		initialized_ = false;
 	}
 
 	double Density::operator()(double x, double y, double z, int el_id) const
 	{
-		if (rho_expr_)
+		if (!rho_expr_.empty())
 		{
-			vals_->x = x;
-			vals_->y = y;
-			vals_->z = z;
-
-			return te_eval(rho_expr_);
+			return rho_expr_(x, y, z);
 		}
 		else if (rho_mat_.size() > 0)
 		{
@@ -760,17 +1004,55 @@ namespace polyfem
 		}
 	}
 
+	void Density::operator()(const Eigen::MatrixXd &pts, int el_id, Eigen::VectorXd &rho) const
+	{
+		if (cache_.has(el_id, pts))
+			rho = cache_.values(el_id).col(0);
+		else if (!rho_expr_.empty())
+			rho_expr_.eval(pts, 0, rho);
+		else
+			rho.setConstant(pts.rows(), (*this)(0, 0, 0, el_id));
+	}
+
+	double Density::operator()(const ElementAssemblyValues &vals, const int p) const
+	{
+		if (!rho_expr_.empty())
+		{
+			if (cache_.has(vals.element_id, p, vals.val.row(p)))
+				return cache_.value(vals.element_id, p, 0);
+
+			cache_.log_miss(vals.element_id);
+		}
+
+		return (*this)(vals.val(p, 0), vals.val(p, 1), vals.val.cols() == 2 ? 0. : vals.val(p, 2), vals.element_id);
+	}
+
+	void Density::init_cache(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases) const
+	{
+		if (rho_expr_.empty() || cache_.is_initialized(is_volume, bases, gbases))
+			return;
+
+		cache_.init(is_volume, bases, gbases, [&](const Eigen::MatrixXd &pts, const int el_id, Eigen::MatrixXd &values) {
+			Eigen::VectorXd rho;
+			(*this)(pts, el_id, rho);
+			values = rho;
+		});
+	}
+
 	void Density::init_multimaterial(const Eigen::MatrixXd &rho)
 	{
 		rho_mat_ = rho;
 		rho_ = -1;
 		initialized_ = true;
+
+		rho_expr_.clear();
+		cache_.clear();
 	}
 
 	void Density::init(const json &params)
 	{
-		te_free(rho_expr_);
-		rho_expr_ = nullptr;
+		rho_expr_.clear();
+		cache_.clear();
 
 		if (initialized_)
 			return;
@@ -805,23 +1087,20 @@ namespace polyfem
 		}
 		else if (rho.is_string())
 		{
-			te_variable vars[4];
-			vars[0] = {"x", &vals_->x};
-			vars[1] = {"y", &vals_->y};
-			vars[2] = {"z", &vals_->z};
-			vars[3].name = "if";
-			vars[3].address = (void *)&iflargerthanzerothenelse;
-			vars[3].type = TE_FUNCTION3;
-
 			const std::string rhos = rho;
 
 			int err;
-			rho_expr_ = te_compile(rhos.c_str(), vars, 4, &err);
-			if (!rho_expr_)
+			if (!rho_expr_.compile(rhos, err))
 			{
 				read_matrix(rho, rho_mat_);
 				rho_ = -1;
 			}
+			else if (rho_expr_.is_constant())
+			{
+				rho_ = rho_expr_.constant();
+				rho_mat_.resize(0, 0);
+				rho_expr_.clear();
+			}
 		}
 	}
 
@@ -4,12 +4,13 @@
 #include <polyfem/ElementAssemblyValues.hpp>
 #include <polyfem/ElementBases.hpp>
 #include <polyfem/AutodiffTypes.hpp>
+#include <polyfem/Expression.hpp>
 #include <polyfem/Types.hpp>
 
 #include <Eigen/Dense>
-#include <tinyexpr.h>
 #include <vector>
 #include <array>
+#include <atomic>
 #include <functional>
 
 namespace polyfem
@@ -42,6 +43,31 @@ namespace polyfem
 										const std::function<DScalar2<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, SMALL_N, SMALL_N>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &funN,
 										const std::function<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &funn);
 
+	//energy, gradient, and hessian from a single DScalar2 evaluation
+	void all_from_energy(const int size, const int n_bases, const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, 6, 1>, Eigen::Matrix<double, 6, 6>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun6,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, 8, 1>, Eigen::Matrix<double, 8, 8>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun8,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, 12, 1>, Eigen::Matrix<double, 12, 12>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun12,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, 18, 1>, Eigen::Matrix<double, 18, 18>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun18,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, 24, 1>, Eigen::Matrix<double, 24, 24>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun24,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, 30, 1>, Eigen::Matrix<double, 30, 30>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun30,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, 60, 1>, Eigen::Matrix<double, 60, 60>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun60,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, 81, 1>, Eigen::Matrix<double, 81, 81>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &fun81,
+						 const std::function<DScalar2<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, SMALL_N, SMALL_N>>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &funN,
+						 const std::function<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>(const ElementAssemblyValues &, const Eigen::MatrixXd &, const QuadratureVector &)> &funn,
+						 double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian);
+
+	typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> DefGradMatrix;
+	typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 9, 9> StressGradMatrix;
+
+	//element energy, gradient, and hessian from closed form expressions at the quadrature points
+	//fun(p, def_grad, energy, stress, stress_grad) computes the energy density W(F), the first Piola-Kirchhoff stress P = dW/dF, and dP/dF
+	//P and dP/dF are column major in F, they are chained with the basis gradients, the stress (gradient) is only needed if with_grad (with_hessian)
+	void derivatives_from_def_grad(const int size, const ElementAssemblyValues &vals, const Eigen::MatrixXd &displacement, const QuadratureVector &da,
+								   const bool with_grad, const bool with_hessian,
+								   const std::function<void(const int, const DefGradMatrix &, double &, DefGradMatrix &, StressGradMatrix &)> &fun,
+								   double &energy, Eigen::VectorXd &grad, Eigen::MatrixXd &hessian);
+
 	double von_mises_stress_for_stress_tensor(const Eigen::MatrixXd &stress);
 	void compute_diplacement_grad(const int size, const ElementBases &bs, const ElementAssemblyValues &vals, const Eigen::MatrixXd &local_pts, const int p, const Eigen::MatrixXd &displacement, Eigen::MatrixXd &displacement_grad);
 
@@ -74,58 +100,120 @@ namespace polyfem
 		int size_;
 	};
 
+	//material values evaluated once at the quadrature points of every element, flat with per element offsets
+	//the points are the ones of the assembly values of bases and gbases, the values of an element are only used for the same points
+	class MaterialCache
+	{
+	public:
+		//computes the n_fields values at the rows of pts of element el_id, called concurrently
+		typedef std::function<void(const Eigen::MatrixXd &pts, const int el_id, Eigen::MatrixXd &values)> EvalFunction;
+
+		void init(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases, const EvalFunction &fun);
+		void clear();
+
+		//true if the cache has been built for these bases
+		bool is_initialized(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases) const;
+		//true if the values of element el_id have been computed at all the rows of pts
+		bool has(const int el_id, const Eigen::Ref<const Eigen::MatrixXd> &pts) const;
+		//true if the value p of element el_id has been computed at pt, a single point lookup of quadrature point p
+		bool has(const int el_id, const int p, const Eigen::Ref<const RowVectorNd> &pt) const;
+
+		inline double value(const int el_id, const int p, const int field) const { return values_(offsets_[el_id] + p, field); }
+
+		//logs once per build that a lookup missed and the material is evaluated directly, called concurrently
+		void log_miss(const int el_id) const;
+		inline Eigen::Block<const Eigen::MatrixXd> values(const int el_id) const { return values_.middleRows(offsets_[el_id], offsets_[el_id + 1] - offsets_[el_id]); }
+
+	private:
+		//values of element e are the rows [offsets_[e], offsets_[e+1])
+		std::vector<long> offsets_;
+		Eigen::MatrixXd values_;
+		//points of the values, a lookup is a hit only if it uses the same points
+		Eigen::MatrixXd points_;
+
+		bool is_volume_ = false;
+		const std::vector<ElementBases> *bases_ = nullptr;
+		const std::vector<ElementBases> *gbases_ = nullptr;
+		size_t n_elements_ = 0;
+
+		//atomic flag that copies as unset
+		struct MissFlag
+		{
+			mutable std::atomic<bool> logged{false};
+
+			MissFlag() = default;
+			MissFlag(const MissFlag &) {}
+			MissFlag &operator=(const MissFlag &) { return *this; }
+		};
+		MissFlag miss_;
+	};
+
 	class LameParameters
 	{
 	public:
 		LameParameters();
-		~LameParameters();
 
 		void init(const json &params);
+		//per element E and nu, they replace the parameters (also the expressions) and clear the cache
 		void init_multimaterial(const Eigen::MatrixXd &Es, const Eigen::MatrixXd &nus);
 
 		void lambda_mu(double x, double y, double z, int el_id, double &lambda, double &mu) const;
+		//parameters at all the rows of pts (2 or 3 columns) of element el_id
+		void lambda_mu(const Eigen::MatrixXd &pts, int el_id, Eigen::VectorXd &lambda, Eigen::VectorXd &mu) const;
+		//parameters at the quadrature point p of vals, read from the cache if it has the element
+		void lambda_mu(const ElementAssemblyValues &vals, const int p, double &lambda, double &mu) const;
+		//same at the quadrature point p of element el_id, at pt
+		void lambda_mu(const int el_id, const int p, const RowVectorNd &pt, double &lambda, double &mu) const;
+
+		//evaluates the parameters at the quadrature points of all the elements, only if they are expressions
+		//the cache is rebuilt if the bases change and cleared when the parameters change
+		void init_cache(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases) const;
 
 	private:
-		struct Internal
-		{
-			double x, y, z;
-		};
 		void set_e_nu(const json &E, const json &nu);
+		//compiles the two expressions, if they are both constant the parameters are stored as numbers
+		//false if one of them is not an expression (eg a file name), the parameters are then unchanged
+		bool set_expressions(const std::string &first, const std::string &second, const bool is_lambda_mu);
 
 		int size_;
 		double lambda_ = 1, mu_ = 1;
 		Eigen::MatrixXd lambda_mat_, mu_mat_;
 
-		te_expr *lambda_expr_, *mu_expr_;
-		Internal *vals_;
+		Expression lambda_expr_, mu_expr_;
 		bool is_lambda_mu_;
 		bool initialized_;
+
+		//lambda and mu at the quadrature points
+		mutable MaterialCache cache_;
 	};
 
 	class Density
 	{
 	public:
 		Density();
-		~Density();
 
 		void init(const json &params);
+		//per element density, it replaces the density (also the expression) and clears the cache
 		void init_multimaterial(const Eigen::MatrixXd &rho);
 
 		double operator()(double x, double y, double z, int el_id) const;
+		//density at all the rows of pts (2 or 3 columns) of element el_id
+		void operator()(const Eigen::MatrixXd &pts, int el_id, Eigen::VectorXd &rho) const;
+		//density at the quadrature point p of vals, read from the cache if it has the element
+		double operator()(const ElementAssemblyValues &vals, const int p) const;
+
+		//same as LameParameters::init_cache
+		void init_cache(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases) const;
 
 	private:
 		void set_rho(const json &rho);
 
-		struct Internal
-		{
-			double x, y, z;
-		};
-
 		double rho_ = 1;
 		Eigen::MatrixXd rho_mat_;
 
-		te_expr *rho_expr_;
-		Internal *vals_;
+		Expression rho_expr_;
 		bool initialized_;
+
+		mutable MaterialCache cache_;
 	};
 } // namespace polyfem
@@ -0,0 +1,550 @@
+#include <polyfem/Expression.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace polyfem
+{
+	namespace
+	{
+		typedef Expression::Op Op;
+		typedef Expression::Instruction Instruction;
+
+		//points evaluated together, every register is a column of this many values
+		const int BLOCK_SIZE = 64;
+		typedef Eigen::Array<double, BLOCK_SIZE, Eigen::Dynamic> BlockRegisters;
+
+		//scratch registers, one per thread
+		struct EvaluationContext
+		{
+			std::vector<double> registers;
+			BlockRegisters block_registers;
+		};
+
+		EvaluationContext &local_context()
+		{
+			thread_local EvaluationContext context;
+			return context;
+		}
+
+		int arity(const Op op)
+		{
+			if (op <= Op::T)
+				return 0;
+			if (op <= Op::Tanh)
+				return 1;
+			if (op <= Op::Npr)
+				return 2;
+			return 3;
+		}
+
+		double factorial(const double a)
+		{
+			if (a < 0)
+				return std::numeric_limits<double>::quiet_NaN();
+			return std::tgamma(std::floor(a) + 1);
+		}
+
+		double n_choose_r(const double n, const double r)
+		{
+			if (n < 0 || r < 0 || n < r)
+				return std::numeric_limits<double>::quiet_NaN();
+
+			const double un = std::floor(n);
+			double ur = std::floor(r);
+			if (ur > un / 2)
+				ur = un - ur;
+
+			double res = 1;
+			for (double i = 1; i <= ur; ++i)
+				res = res * (un - ur + i) / i;
+			return res;
+		}
+
+		double apply(const Op op, const double a, const double b, const double c)
+		{
+			switch (op)
+			{
+			case Op::Neg: return -a;
+			case Op::Abs: return std::abs(a);
+			case Op::Acos: return std::acos(a);
+			case Op::Asin: return std::asin(a);
+			case Op::Atan: return std::atan(a);
+			case Op::Ceil: return std::ceil(a);
+			case Op::Cos: return std::cos(a);
+			case Op::Cosh: return std::cosh(a);
+			case Op::Exp: return std::exp(a);
+			case Op::Fac: return factorial(a);
+			case Op::Floor: return std::floor(a);
+			case Op::Ln: return std::log(a);
+			case Op::Log10: return std::log10(a);
+			case Op::Sin: return std::sin(a);
+			case Op::Sinh: return std::sinh(a);
+			case Op::Sqrt: return std::sqrt(a);
+			case Op::Tan: return std::tan(a);
+			case Op::Tanh: return std::tanh(a);
+			case Op::Add: return a + b;
+			case Op::Sub: return a - b;
+			case Op::Mul: return a * b;
+			case Op::Div: return a / b;
+			case Op::Mod: return std::fmod(a, b);
+			case Op::Pow: return std::pow(a, b);
+			case Op::Atan2: return std::atan2(a, b);
+			case Op::Ncr: return n_choose_r(a, b);
+			case Op::Npr: return n_choose_r(a, b) * factorial(b);
+			case Op::If: return a >= 0 ? b : c;
+			default:
+				assert(false);
+				return 0;
+			}
+		}
+
+		struct Function
+		{
+			const char *name;
+			Op op;
+		};
+
+		const Function FUNCTIONS[] = {
+			{"abs", Op::Abs}, {"acos", Op::Acos}, {"asin", Op::Asin}, {"atan", Op::Atan}, {"ceil", Op::Ceil}, {"cos", Op::Cos}, {"cosh", Op::Cosh}, {"exp", Op::Exp}, {"fac", Op::Fac}, {"floor", Op::Floor}, {"ln", Op::Ln}, {"log", Op::Log10}, {"log10", Op::Log10}, {"sin", Op::Sin}, {"sinh", Op::Sinh}, {"sqrt", Op::Sqrt}, {"tan", Op::Tan}, {"tanh", Op::Tanh}, {"atan2", Op::Atan2}, {"ncr", Op::Ncr}, {"npr", Op::Npr}, {"pow", Op::Pow}, {"if", Op::If}};
+
+		//recursive descent parser with the grammar of tinyexpr
+		//list = expr {"," expr}, expr = term {("+" | "-") term}, term = factor {("*" | "/" | "%") factor}
+		//factor = power {"^" power}, power = {("-" | "+")} base
+		//base = number | variable | constant | function1 power | functionN "(" expr {"," expr} ")" | "(" list ")"
+		class Parser
+		{
+		public:
+			Parser(const std::string &str, std::vector<Instruction> &program)
+				: str_(str), program_(program)
+			{
+				std::fill(variables_, variables_ + 4, -1);
+			}
+
+			//res is the register of the result
+			bool parse(int &res)
+			{
+				if (!list(res))
+					return false;
+				skip_spaces();
+				return pos_ == str_.size();
+			}
+
+			int error_position() const { return int(pos_) + 1; }
+
+		private:
+			const std::string &str_;
+			std::vector<Instruction> &program_;
+			size_t pos_ = 0;
+			//register of x, y, z, and t, they are loaded once
+			int variables_[4];
+
+			void skip_spaces()
+			{
+				while (pos_ < str_.size() && std::isspace(static_cast<unsigned char>(str_[pos_])))
+					++pos_;
+			}
+
+			bool accept(const char c)
+			{
+				skip_spaces();
+				if (pos_ < str_.size() && str_[pos_] == c)
+				{
+					++pos_;
+					return true;
+				}
+				return false;
+			}
+
+			//appends the instruction and returns its register, if all arguments are constants the result is folded
+			int emit(const Op op, const int a = -1, const int b = -1, const int c = -1, const double value = 0)
+			{
+				if (op >= Op::X && op <= Op::T)
+				{
+					int &reg = variables_[int(op) - int(Op::X)];
+					if (reg < 0)
+					{
+						reg = int(program_.size());
+						program_.push_back({op, -1, -1, -1, 0});
+					}
+					return reg;
+				}
+
+				const int n_args = arity(op);
+				const int args[3] = {a, b, c};
+				bool constant = true;
+				for (int i = 0; i < n_args; ++i)
+					constant = constant && program_[args[i]].op == Op::Constant;
+
+				if (n_args > 0 && constant)
+				{
+					const double va = program_[a].value;
+					const double vb = n_args > 1 ? program_[b].value : 0;
+					const double vc = n_args > 2 ? program_[c].value : 0;
+					program_.push_back({Op::Constant, -1, -1, -1, apply(op, va, vb, vc)});
+				}
+				else
+					program_.push_back({op, a, b, c, value});
+
+				return int(program_.size()) - 1;
+			}
+
+			bool list(int &res)
+			{
+				if (!expr(res))
+					return false;
+				//as in tinyexpr the value of a list is its last expression
+				while (accept(','))
+				{
+					if (!expr(res))
+						return false;
+				}
+				return true;
+			}
+
+			bool expr(int &res)
+			{
+				if (!term(res))
+					return false;
+				while (true)
+				{
+					const Op op = accept('+') ? Op::Add : (accept('-') ? Op::Sub : Op::Constant);
+					if (op == Op::Constant)
+						return true;
+
+					int rhs;
+					if (!term(rhs))
+						return false;
+					res = emit(op, res, rhs);
+				}
+			}
+
+			bool term(int &res)
+			{
+				if (!factor(res))
+					return false;
+				while (true)
+				{
+					const Op op = accept('*') ? Op::Mul : (accept('/') ? Op::Div : (accept('%') ? Op::Mod : Op::Constant));
+					if (op == Op::Constant)
+						return true;
+
+					int rhs;
+					if (!factor(rhs))
+						return false;
+					res = emit(op, res, rhs);
+				}
+			}
+
+			bool factor(int &res)
+			{
+				if (!power(res))
+					return false;
+				while (accept('^'))
+				{
+					int rhs;
+					if (!power(rhs))
+						return false;
+					res = emit(Op::Pow, res, rhs);
+				}
+				return true;
+			}
+
+			bool power(int &res)
+			{
+				bool negative = false;
+				while (true)
+				{
+					if (accept('-'))
+						negative = !negative;
+					else if (!accept('+'))
+						break;
+				}
+
+				if (!base(res))
+					return false;
+				if (negative)
+					res = emit(Op::Neg, res);
+				return true;
+			}
+
+			bool base(int &res)
+			{
+				skip_spaces();
+				if (pos_ >= str_.size())
+					return false;
+
+				const char c = str_[pos_];
+				if (std::isdigit(static_cast<unsigned char>(c)) || c == '.')
+				{
+					const char *begin = str_.c_str() + pos_;
+					char *end;
+					const double value = std::strtod(begin, &end);
+					if (end == begin)
+						return false;
+					pos_ += end - begin;
+					res = emit(Op::Constant, -1, -1, -1, value);
+					return true;
+				}
+
+				if (c == '(')
+				{
+					++pos_;
+					return list(res) && accept(')');
+				}
+
+				if (!std::isalpha(static_cast<unsigned char>(c)))
+					return false;
+
+				const size_t start = pos_;
+				while (pos_ < str_.size() && (std::isalnum(static_cast<unsigned char>(str_[pos_])) || str_[pos_] == '_'))
+					++pos_;
+				const std::string name = str_.substr(start, pos_ - start);
+
+				if (name == "x" || name == "y" || name == "z" || name == "t")
+				{
+					const Op vars[] = {Op::X, Op::Y, Op::Z, Op::T};
+					res = emit(vars[name == "x" ? 0 : (name == "y" ? 1 : (name == "z" ? 2 : 3))]);
+					return true;
+				}
+
+				if (name == "pi" || name == "e")
+				{
+					//constants can be called as functions without arguments
+					const size_t next = pos_;
+					if (!(accept('(') && accept(')')))
+						pos_ = next;
+					res = emit(Op::Constant, -1, -1, -1, name == "pi" ? std::acos(-1.0) : std::exp(1.0));
+					return true;
+				}
+
+				const Function *fun = nullptr;
+				for (const auto &f : FUNCTIONS)
+				{
+					if (name == f.name)
+					{
+						fun = &f;
+						break;
+					}
+				}
+				if (!fun)
+				{
+					pos_ = start;
+					return false;
+				}
+
+				const int n_args = arity(fun->op);
+				if (n_args == 1)
+				{
+					int arg;
+					if (!power(arg))
+						return false;
+					res = emit(fun->op, arg);
+					return true;
+				}
+
+				int args[3] = {-1, -1, -1};
+				if (!accept('('))
+					return false;
+				for (int i = 0; i < n_args; ++i)
+				{
+					if (i > 0 && !accept(','))
+						return false;
+					if (!expr(args[i]))
+						return false;
+				}
+				if (!accept(')'))
+					return false;
+
+				res = emit(fun->op, args[0], args[1], args[2]);
+				return true;
+			}
+		};
+
+		//removes the instructions not needed by the result, ie the arguments of folded operations and unused list entries
+		//arguments always come before an instruction so the result becomes the last instruction
+		void remove_dead_code(const int res, std::vector<Instruction> &program)
+		{
+			const int n = int(program.size());
+			std::vector<int> index(n, -1);
+			index[res] = 0;
+			for (int i = res; i >= 0; --i)
+			{
+				if (index[i] < 0)
+					continue;
+				const Instruction &ins = program[i];
+				const int args[3] = {ins.a, ins.b, ins.c};
+				for (int k = 0; k < arity(ins.op); ++k)
+					index[args[k]] = 0;
+			}
+
+			int n_live = 0;
+			for (int i = 0; i < n; ++i)
+			{
+				if (index[i] < 0)
+					continue;
+
+				Instruction ins = program[i];
+				if (ins.a >= 0)
+					ins.a = index[ins.a];
+				if (ins.b >= 0)
+					ins.b = index[ins.b];
+				if (ins.c >= 0)
+					ins.c = index[ins.c];
+
+				index[i] = n_live;
+				program[n_live++] = ins;
+			}
+			program.resize(n_live);
+		}
+	} // namespace
+
+	bool Expression::compile(const std::string &expr, int &err)
+	{
+		program_.clear();
+		err = 0;
+
+		Parser parser(expr, program_);
+		int res;
+		if (!parser.parse(res))
+		{
+			err = parser.error_position();
+			program_.clear();
+			return false;
+		}
+
+		remove_dead_code(res, program_);
+		return true;
+	}
+
+	void Expression::set_constant(const double val)
+	{
+		program_.assign(1, {Op::Constant, -1, -1, -1, val});
+	}
+
+	bool Expression::depends_on_t() const
+	{
+		//dead instructions are removed when compiling, a T instruction is always used
+		for (const Instruction &ins : program_)
+		{
+			if (ins.op == Op::T)
+				return true;
+		}
+		return false;
+	}
+
+	double Expression::operator()(const double x, const double y, const double z, const double t) const
+	{
+		if (empty())
+			return 0;
+		if (is_constant())
+			return constant();
+
+		std::vector<double> &regs = local_context().registers;
+		regs.resize(program_.size());
+
+		for (size_t i = 0; i < program_.size(); ++i)
+		{
+			const Instruction &ins = program_[i];
+			switch (ins.op)
+			{
+			case Op::Constant: regs[i] = ins.value; break;
+			case Op::X: regs[i] = x; break;
+			case Op::Y: regs[i] = y; break;
+			case Op::Z: regs[i] = z; break;
+			case Op::T: regs[i] = t; break;
+			default:
+			{
+				const int n_args = arity(ins.op);
+				regs[i] = apply(ins.op, regs[ins.a], n_args > 1 ? regs[ins.b] : 0, n_args > 2 ? regs[ins.c] : 0);
+			}
+			}
+		}
+
+		return regs.back();
+	}
+
+	void Expression::eval(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &out) const
+	{
+		assert(pts.cols() == 2 || pts.cols() == 3);
+		out.resize(pts.rows());
+
+		if (empty())
+		{
+			out.setZero();
+			return;
+		}
+		if (is_constant())
+		{
+			out.setConstant(constant());
+			return;
+		}
+
+		BlockRegisters &regs = local_context().block_registers;
+		regs.resize(Eigen::NoChange, program_.size());
+
+		//the program is run one instruction at a time on blocks of points, each instruction is a loop over a contiguous column
+		for (long start = 0; start < pts.rows(); start += BLOCK_SIZE)
+		{
+			const int n = int(std::min<long>(BLOCK_SIZE, pts.rows() - start));
+
+			for (size_t i = 0; i < program_.size(); ++i)
+			{
+				const Instruction &ins = program_[i];
+				auto r = regs.col(i);
+
+				switch (ins.op)
+				{
+				case Op::Constant: r.setConstant(ins.value); break;
+				case Op::X:
+				case Op::Y:
+				case Op::Z:
+				{
+					//unused entries of the last block are set to zero
+					const int coord = int(ins.op) - int(Op::X);
+					r.setZero();
+					if (coord < pts.cols())
+						r.head(n) = pts.col(coord).segment(start, n).array();
+					break;
+				}
+				case Op::T: r.setConstant(t); break;
+				case Op::Neg: r = -regs.col(ins.a); break;
+				case Op::Abs: r = regs.col(ins.a).abs(); break;
+				case Op::Acos: r = regs.col(ins.a).acos(); break;
+				case Op::Asin: r = regs.col(ins.a).asin(); break;
+				case Op::Atan: r = regs.col(ins.a).atan(); break;
+				case Op::Ceil: r = regs.col(ins.a).ceil(); break;
+				case Op::Cos: r = regs.col(ins.a).cos(); break;
+				case Op::Cosh: r = regs.col(ins.a).cosh(); break;
+				case Op::Exp: r = regs.col(ins.a).exp(); break;
+				case Op::Floor: r = regs.col(ins.a).floor(); break;
+				case Op::Ln: r = regs.col(ins.a).log(); break;
+				case Op::Log10: r = regs.col(ins.a).log10(); break;
+				case Op::Sin: r = regs.col(ins.a).sin(); break;
+				case Op::Sinh: r = regs.col(ins.a).sinh(); break;
+				case Op::Sqrt: r = regs.col(ins.a).sqrt(); break;
+				case Op::Tan: r = regs.col(ins.a).tan(); break;
+				case Op::Tanh: r = regs.col(ins.a).tanh(); break;
+				case Op::Add: r = regs.col(ins.a) + regs.col(ins.b); break;
+				case Op::Sub: r = regs.col(ins.a) - regs.col(ins.b); break;
+				case Op::Mul: r = regs.col(ins.a) * regs.col(ins.b); break;
+				case Op::Div: r = regs.col(ins.a) / regs.col(ins.b); break;
+				case Op::Pow: r = regs.col(ins.a).pow(regs.col(ins.b)); break;
+				case Op::If: r = (regs.col(ins.a) >= 0).select(regs.col(ins.b), regs.col(ins.c)); break;
+				default:
+				{
+					//no vectorized version
+					const int n_args = arity(ins.op);
+					for (int k = 0; k < BLOCK_SIZE; ++k)
+						r(k) = apply(ins.op, regs(k, ins.a), n_args > 1 ? regs(k, ins.b) : 0, n_args > 2 ? regs(k, ins.c) : 0);
+				}
+				}
+			}
+
+			out.segment(start, n) = regs.col(program_.size() - 1).head(n).matrix();
+		}
+	}
+} // namespace polyfem
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+namespace polyfem
+{
+	//math expression of x, y, z, and t compiled to a flat program, constant sub-expressions are folded when compiling
+	//the syntax is the one of tinyexpr: + - * / % ^, unary signs, parentheses, pi, e, the usual math functions, and if(c, a, b) = c >= 0 ? a : b
+	//evaluation does not modify the expression, the registers live in a per-thread context so it can be evaluated concurrently
+	class Expression
+	{
+	public:
+		enum class Op : unsigned char
+		{
+			Constant,
+			X,
+			Y,
+			Z,
+			T,
+			//unary
+			Neg,
+			Abs,
+			Acos,
+			Asin,
+			Atan,
+			Ceil,
+			Cos,
+			Cosh,
+			Exp,
+			Fac,
+			Floor,
+			Ln,
+			Log10,
+			Sin,
+			Sinh,
+			Sqrt,
+			Tan,
+			Tanh,
+			//binary
+			Add,
+			Sub,
+			Mul,
+			Div,
+			Mod,
+			Pow,
+			Atan2,
+			Ncr,
+			Npr,
+			//ternary
+			If
+		};
+
+		//the result of instruction i is stored in register i, a, b, c are the registers of the arguments
+		struct Instruction
+		{
+			Op op;
+			int a, b, c;
+			double value;
+		};
+
+		//returns false if the string cannot be parsed, err is the position (starting from 1) of the error
+		bool compile(const std::string &expr, int &err);
+		void set_constant(const double val);
+		void clear() { program_.clear(); }
+
+		inline bool empty() const { return program_.empty(); }
+		//true if the expression depends on none of x, y, z, and t
+		inline bool is_constant() const { return program_.size() == 1 && program_.front().op == Op::Constant; }
+		inline double constant() const
+		{
+			assert(is_constant());
+			return program_.front().value;
+		}
+		//true if the expression uses t
+		bool depends_on_t() const;
+
+		//an empty expression evaluates to zero
+		double operator()(const double x, const double y, const double z, const double t = 0) const;
+		//evaluates the expression at every row of pts (2 or 3 columns, z = 0 in 2d) at time t
+		void eval(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &out) const;
+
+		inline const std::vector<Instruction> &program() const { return program_; }
+
+	private:
+		std::vector<Instruction> program_;
+	};
+} // namespace polyfem
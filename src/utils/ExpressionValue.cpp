@@ -3,62 +3,39 @@
 
 namespace polyfem
 {
-	ExpressionValue::~ExpressionValue()
-	{
-		te_free(expr_);
-		expr_ = nullptr;
-		sfunc_ = nullptr;
-		tfunc_ = nullptr;
-	}
-
 	ExpressionValue::ExpressionValue()
 	{
-		expr_ = nullptr;
-		value_ = 0;
-		vals_ = new Internal();
+		expr_.set_constant(0);
 	}
 
 	void ExpressionValue::clear()
 	{
-		te_free(expr_);
-		expr_ = nullptr;
 		sfunc_ = nullptr;
 		tfunc_ = nullptr;
-		value_ = 0;
+		expr_.set_constant(0);
 	}
 
 	void ExpressionValue::init(const double val)
 	{
-		te_free(expr_);
 		sfunc_ = nullptr;
 		tfunc_ = nullptr;
-		expr_ = nullptr;
 
-		value_ = val;
+		expr_.set_constant(val);
 	}
 
 	void ExpressionValue::init(const std::string &expr)
 	{
-		value_ = 0;
 		sfunc_ = nullptr;
 		tfunc_ = nullptr;
-		te_free(expr_);
 
 		if(expr.empty())
 		{
-			expr_ = nullptr;
+			expr_.set_constant(0);
 			return;
 		}
 
-		te_variable vars[3];
-		vars[0] = {"x", &vals_->x};
-		vars[1] = {"y", &vals_->y};
-		vars[2] = {"z", &vals_->z};
-
 		int err;
-		expr_ = te_compile(expr.c_str(), vars, 3, &err);
-
-		if(!expr_)
+		if(!expr_.compile(expr, err))
 		{
 			logger().error("Unable to parse {}, error, {}", expr, err);
 
@@ -81,20 +58,16 @@ namespace polyfem
 
 	void ExpressionValue::init(const std::function<double(double x, double y, double z)> &func)
 	{
-		te_free(expr_);
-		expr_ = nullptr;
 		tfunc_ = nullptr;
-		value_ = 0;
+		expr_.set_constant(0);
 
 		sfunc_ = func;
 	}
 
 	void ExpressionValue::init(const std::function<Eigen::MatrixXd(double x, double y, double z)> &func, const int coo)
 	{
-		te_free(expr_);
-		expr_ = nullptr;
 		sfunc_ = nullptr;
-		value_ = 0;
+		expr_.set_constant(0);
 
 		tfunc_ = func;
 		tfunc_coo_ = coo;
@@ -102,40 +75,30 @@ namespace polyfem
 
 	double ExpressionValue::operator()(double x, double y) const
 	{
-		if(!expr_){
-			if(sfunc_)
-				return sfunc_(x, y, 0);
-
-			if (tfunc_)
-				return tfunc_(x, y, 0)(tfunc_coo_);
+		return (*this)(x, y, 0);
+	}
 
-			return value_;
-		}
+	double ExpressionValue::operator()(double x, double y, double z) const
+	{
+		if (sfunc_)
+			return sfunc_(x, y, z);
 
-		vals_->x = x;
-		vals_->y = y;
+		if (tfunc_)
+			return tfunc_(x, y, z)(tfunc_coo_);
 
-		return te_eval(expr_);
+		return expr_(x, y, z);
 	}
 
-	double ExpressionValue::operator()(double x, double y, double z) const
+	void ExpressionValue::eval(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &out) const
 	{
-		if (!expr_)
+		if (!sfunc_ && !tfunc_)
 		{
-			if (sfunc_)
-				return sfunc_(x, y, z);
-
-			if (tfunc_)
-				return tfunc_(x, y, z)(tfunc_coo_);
-
-			return value_;
+			expr_.eval(pts, t, out);
+			return;
 		}
 
-		vals_->x = x;
-		vals_->y = y;
-		vals_->z = z;
-
-		return te_eval(expr_);
+		out.resize(pts.rows());
+		for (long i = 0; i < pts.rows(); ++i)
+			out(i) = (*this)(pts(i, 0), pts(i, 1), pts.cols() == 2 ? 0 : pts(i, 2));
 	}
-
-}
\ No newline at end of file
+}
@@ -1,16 +1,15 @@
 #pragma once
 
 #include <polyfem/Common.hpp>
+#include <polyfem/Expression.hpp>
 
-#include <tinyexpr.h>
-
+#include <functional>
 
 namespace polyfem {
 
 	class ExpressionValue
 	{
 	public:
-		~ExpressionValue();
 		ExpressionValue();
 		void init(const json &vals);
 		void init(const double val);
@@ -21,24 +20,22 @@ namespace polyfem {
 
 		double operator()(double x, double y) const;
 		double operator()(double x, double y, double z) const;
+		//values at the rows of pts at time t, thread safe
+		void eval(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &out) const;
 
 		void clear();
 
-		bool is_zero() const { return !expr_ && fabs(value_) < 1e-10; }
+		bool is_zero() const { return expr_.is_constant() && fabs(expr_.constant()) < 1e-10; }
+		//true if the value is an expression that uses t, functions do not depend on t
+		bool depends_on_t() const { return !sfunc_ && !tfunc_ && expr_.depends_on_t(); }
 
 	private:
-		struct Internal
-		{
-			double x, y, z;
-		};
-
 		std::function<double(double x, double y, double z)> sfunc_;
 		std::function<Eigen::MatrixXd(double x, double y, double z)> tfunc_;
 		int tfunc_coo_;
 
-		te_expr *expr_;
-		double value_;
-		Internal *vals_;
+		//constants are stored as a folded expression
+		Expression expr_;
 	};
 
 } // namespace polyfem
@@ -14,6 +14,11 @@
 #include <fstream>
 #include <vector>
 
+#ifdef POLYFEM_WITH_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/enumerable_thread_specific.h>
+#endif
+
 void polyfem::show_matrix_stats(const Eigen::MatrixXd &M)
 {
 	Eigen::FullPivLU<Eigen::MatrixXd> lu(M);
@@ -68,6 +73,70 @@ Eigen::Vector4d polyfem::compute_specturm(const StiffnessMatrix &mat)
 #endif
 }
 
+std::size_t polyfem::sparse_pattern_hash(const StiffnessMatrix &mat)
+{
+	assert(mat.isCompressed());
+
+	std::size_t seed = 0;
+	const auto combine = [&seed](const std::size_t v) { seed ^= v + 0x9e3779b9 + (seed << 6) + (seed >> 2); };
+
+	combine(mat.rows());
+	combine(mat.cols());
+	combine(mat.nonZeros());
+
+	for (long i = 0; i <= mat.outerSize(); ++i)
+		combine(mat.outerIndexPtr()[i]);
+	for (long i = 0; i < mat.nonZeros(); ++i)
+		combine(mat.innerIndexPtr()[i]);
+
+	return seed;
+}
+
+void polyfem::symmetric_multiply(const StiffnessMatrix &upper, const Eigen::VectorXd &x, Eigen::VectorXd &y)
+{
+	assert(upper.rows() == upper.cols());
+	assert(upper.isCompressed());
+	assert(x.size() == upper.cols());
+
+	const int n = int(upper.cols());
+	const auto *outer = upper.outerIndexPtr();
+	const auto *inner = upper.innerIndexPtr();
+	const double *values = upper.valuePtr();
+
+#ifdef POLYFEM_WITH_TBB
+	// column j gives y_j += a_ij x_i (a gather, no conflicts) and y_i += a_ij x_j for i < j (a scatter, one buffer per thread)
+	y.resize(n);
+	tbb::enumerable_thread_specific<Eigen::VectorXd> storages(Eigen::VectorXd::Zero(n));
+
+	tbb::parallel_for(tbb::blocked_range<int>(0, n), [&](const tbb::blocked_range<int> &r) {
+		Eigen::VectorXd &local = storages.local();
+		for (int j = r.begin(); j != r.end(); ++j)
+		{
+			double sum = 0;
+			for (auto k = outer[j]; k < outer[j + 1]; ++k)
+			{
+				const int i = inner[k];
+				sum += values[k] * x(i);
+				if (i != j)
+					local(i) += values[k] * x(j);
+			}
+			y(j) = sum;
+		}
+	});
+
+	for (auto it = storages.begin(); it != storages.end(); ++it)
+		y += *it;
+#else
+	y = upper.selfadjointView<Eigen::Upper>() * x;
+#endif
+}
+
+void polyfem::symmetric_to_full(const StiffnessMatrix &upper, StiffnessMatrix &full)
+{
+	full = upper.selfadjointView<Eigen::Upper>();
+	full.makeCompressed();
+}
+
 template <typename T>
 void polyfem::read_matrix(const std::string &path, Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &mat)
 {
@@ -32,4 +32,13 @@ namespace polyfem {
 
 	Eigen::Vector4d compute_specturm(const StiffnessMatrix &mat);
 
+	// Hash of the sparsity structure (size, outer and inner indices) of a compressed matrix, values are ignored
+	std::size_t sparse_pattern_hash(const StiffnessMatrix &mat);
+
+	// y = A x for a symmetric A of which only the upper triangle is stored
+	void symmetric_multiply(const StiffnessMatrix &upper, const Eigen::VectorXd &x, Eigen::VectorXd &y);
+
+	// Full symmetric matrix from its upper triangle
+	void symmetric_to_full(const StiffnessMatrix &upper, StiffnessMatrix &full);
+
 } // namespace polyfem
@@ -0,0 +1,1011 @@
+////////////////////////////////////////////////////////////////////////////////
+#include <polyfem/Assembler.hpp>
+#include <polyfem/MassMatrixAssembler.hpp>
+#include <polyfem/NeoHookeanElasticity.hpp>
+#include <polyfem/SaintVenantElasticity.hpp>
+#include <polyfem/LinearElasticity.hpp>
+#include <polyfem/HookeLinearElasticity.hpp>
+#include <polyfem/Laplacian.hpp>
+#include <polyfem/SparsityPattern.hpp>
+#include <polyfem/BlockSparseMatrix.hpp>
+#include <polyfem/MatrixUtils.hpp>
+#include <polyfem/SumFactorization.hpp>
+#include <polyfem/HexQuadrature.hpp>
+#include <polyfem/QuadQuadrature.hpp>
+#include <polyfem/QuadratureCache.hpp>
+#include <polyfem/auto_q_bases.hpp>
+#include <polyfem/auto_hyperelasticity.hpp>
+
+#include <catch.hpp>
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <map>
+#include <random>
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace polyfem;
+
+namespace
+{
+    //random elements, every local basis is a combination of up to 3 global nodes
+    std::vector<ElementBases> random_bases(const int n_elements, const int n_basis)
+    {
+        std::mt19937 gen(42);
+        std::vector<ElementBases> bases(n_elements);
+        for (auto &eb : bases)
+        {
+            eb.bases.resize(2 + gen() % 5);
+            for (auto &b : eb.bases)
+            {
+                auto &global = b.global();
+                global.resize(1 + gen() % 3);
+                for (auto &g : global)
+                {
+                    g.index = gen() % n_basis;
+                    g.val = (gen() % 100) / 50.;
+                }
+            }
+        }
+
+        return bases;
+    }
+
+    //two unit hexes sharing a face, with trilinear isoparametric bases
+    std::vector<ElementBases> hex_bases()
+    {
+        Eigen::MatrixXd nodes;
+        autogen::q_nodes_3d(1, nodes);
+
+        std::vector<ElementBases> bases(2);
+        for (int e = 0; e < 2; ++e)
+        {
+            ElementBases &b = bases[e];
+            b.set_quadrature([](Quadrature &quad) {
+                HexQuadrature hex_quadrature;
+                hex_quadrature.get_quadrature(3, quad);
+            });
+
+            b.bases.resize(nodes.rows());
+            for (int i = 0; i < nodes.rows(); ++i)
+            {
+                RowVectorNd node = nodes.row(i);
+                node(0) += e;
+                const int index = int(std::round(node(0) + 3 * (node(1) + 2 * node(2))));
+
+                b.bases[i].init(1, index, i, node);
+                b.bases[i].set_basis([i](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_basis_value_3d(1, i, uv, val); });
+                b.bases[i].set_grad([i](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_grad_basis_value_3d(1, i, uv, val); });
+            }
+        }
+
+        return bases;
+    }
+
+    //a trilinear and a triquadratic hex sharing the face x=1, the quadratic nodes on that face
+    //are constrained to the bilinear interpolation of the shared corners
+    std::vector<ElementBases> mixed_order_hex_bases(int &n_basis)
+    {
+        std::map<std::array<int, 3>, int> node_index;
+        const auto index = [&](const RowVectorNd &node) {
+            const std::array<int, 3> key = {{int(std::round(2 * node(0))), int(std::round(2 * node(1))), int(std::round(2 * node(2)))}};
+            const auto it = node_index.find(key);
+            if (it != node_index.end())
+                return it->second;
+            const int id = int(node_index.size());
+            node_index[key] = id;
+            return id;
+        };
+
+        std::vector<ElementBases> bases(2);
+        for (int e = 0; e < 2; ++e)
+        {
+            const int order = e + 1;
+            Eigen::MatrixXd nodes;
+            autogen::q_nodes_3d(order, nodes);
+
+            ElementBases &b = bases[e];
+            b.set_quadrature([](Quadrature &quad) {
+                HexQuadrature hex_quadrature;
+                hex_quadrature.get_quadrature(4, quad);
+            });
+
+            b.bases.resize(nodes.rows());
+            for (int i = 0; i < nodes.rows(); ++i)
+            {
+                RowVectorNd node = nodes.row(i);
+                node(0) += e;
+
+                const bool hanging = e == 1 && node(0) == 1 && (std::round(2 * node(1)) == 1 || std::round(2 * node(2)) == 1);
+                b.bases[i].init(order, hanging ? -1 : index(node), i, node);
+                b.bases[i].set_basis([order, i](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_basis_value_3d(order, i, uv, val); });
+                b.bases[i].set_grad([order, i](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_grad_basis_value_3d(order, i, uv, val); });
+
+                if (!hanging)
+                    continue;
+
+                auto &global = b.bases[i].global();
+                global.clear();
+                for (int cy = 0; cy < 2; ++cy)
+                {
+                    for (int cz = 0; cz < 2; ++cz)
+                    {
+                        const double w = (cy ? node(1) : 1 - node(1)) * (cz ? node(2) : 1 - node(2));
+                        if (w == 0)
+                            continue;
+
+                        RowVectorNd corner(3);
+                        corner << 1, cy, cz;
+                        global.emplace_back(index(corner), corner, w);
+                    }
+                }
+            }
+        }
+
+        n_basis = int(node_index.size());
+        return bases;
+    }
+
+    //one distorted isoparametric quad or hex of the given order
+    ElementBases distorted_q_element(const int dim, const int order)
+    {
+        Eigen::MatrixXd nodes;
+        if (dim == 2)
+            autogen::q_nodes_2d(order, nodes);
+        else
+            autogen::q_nodes_3d(order, nodes);
+
+        std::mt19937 gen(order * dim);
+        std::uniform_real_distribution<double> noise(-0.1, 0.1);
+
+        ElementBases b;
+        b.set_quadrature([dim, order](Quadrature &quad) {
+            if (dim == 2)
+            {
+                QuadQuadrature quad_quadrature;
+                quad_quadrature.get_quadrature(2 * order, quad);
+            }
+            else
+            {
+                HexQuadrature hex_quadrature;
+                hex_quadrature.get_quadrature(2 * order, quad);
+            }
+        });
+
+        b.bases.resize(nodes.rows());
+        for (int i = 0; i < nodes.rows(); ++i)
+        {
+            RowVectorNd node = nodes.row(i);
+            for (int d = 0; d < dim; ++d)
+                node(d) = 1.5 * node(d) + noise(gen);
+
+            b.bases[i].init(order, i, i, node);
+            b.bases[i].set_basis([dim, order, i](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) {
+                if (dim == 2)
+                    autogen::q_basis_value_2d(order, i, uv, val);
+                else
+                    autogen::q_basis_value_3d(order, i, uv, val);
+            });
+            b.bases[i].set_grad([dim, order, i](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) {
+                if (dim == 2)
+                    autogen::q_grad_basis_value_2d(order, i, uv, val);
+                else
+                    autogen::q_grad_basis_value_3d(order, i, uv, val);
+            });
+        }
+
+        return b;
+    }
+
+    //reference hessian assembled with triplets, as the hessian assembly did before the fixed pattern
+    template <class LocalAssembler>
+    StiffnessMatrix triplet_hessian(const LocalAssembler &local_assembler, const int n_basis, const std::vector<ElementBases> &bases, const Eigen::MatrixXd &displacement)
+    {
+        const int size = local_assembler.size();
+        std::vector<Eigen::Triplet<double>> entries;
+        ElementAssemblyValues vals;
+        for (int e = 0; e < int(bases.size()); ++e)
+        {
+            vals.compute(e, true, bases[e], bases[e]);
+            const QuadratureVector da = vals.det.array() * vals.quadrature.weights.array();
+            const Eigen::MatrixXd local = local_assembler.assemble_hessian(vals, displacement, da);
+
+            const int n_loc_bases = int(vals.basis_values.size());
+            for (int i = 0; i < n_loc_bases; ++i)
+            {
+                for (int j = 0; j < n_loc_bases; ++j)
+                {
+                    for (const auto &gi : vals.basis_values[i].global)
+                    {
+                        for (const auto &gj : vals.basis_values[j].global)
+                        {
+                            for (int m = 0; m < size; ++m)
+                            {
+                                for (int n = 0; n < size; ++n)
+                                    entries.emplace_back(gi.index * size + m, gj.index * size + n, local(i * size + m, j * size + n) * gi.val * gj.val);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        StiffnessMatrix hessian(n_basis * size, n_basis * size);
+        hessian.setFromTriplets(entries.begin(), entries.end());
+        return hessian;
+    }
+}
+
+TEST_CASE("sparsity_pattern", "[assembler]")
+{
+    const int n_basis = 50;
+    const int size = 3;
+    const auto bases = random_bases(30, n_basis);
+
+    SparsityPattern pattern;
+    pattern.init(n_basis, size, bases);
+
+    StiffnessMatrix mat;
+    pattern.create_matrix(mat);
+    REQUIRE(mat.nonZeros() == pattern.non_zeros());
+
+    std::vector<Eigen::Triplet<double>> entries;
+    for (const auto &eb : bases)
+    {
+        for (const auto &bi : eb.bases)
+        {
+            for (const auto &bj : eb.bases)
+            {
+                const Eigen::MatrixXd local = Eigen::MatrixXd::Random(size, size);
+                for (const auto &gi : bi.global())
+                {
+                    for (const auto &gj : bj.global())
+                    {
+                        const long pos = pattern.find(gi.index, gj.index);
+                        REQUIRE(pos >= 0);
+
+                        for (int m = 0; m < size; ++m)
+                        {
+                            for (int n = 0; n < size; ++n)
+                            {
+                                const double val = local(m, n) * gi.val * gj.val;
+                                mat.valuePtr()[pattern.value_index(pos, gj.index, m, n)] += val;
+                                entries.emplace_back(gi.index * size + m, gj.index * size + n, val);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    StiffnessMatrix expected(n_basis * size, n_basis * size);
+    expected.setFromTriplets(entries.begin(), entries.end());
+
+    const Eigen::MatrixXd diff = Eigen::MatrixXd(mat) - Eigen::MatrixXd(expected);
+    REQUIRE(diff.norm() < 1e-12);
+
+    //every element has exactly one color and elements of the same color share no node
+    std::vector<int> n_colored(bases.size(), 0);
+    for (const auto &color : pattern.colors())
+    {
+        std::vector<int> used(n_basis, 0);
+        for (const int e : color)
+        {
+            ++n_colored[e];
+
+            std::vector<int> nodes;
+            for (const auto &b : bases[e].bases)
+            {
+                for (const auto &g : b.global())
+                    nodes.push_back(g.index);
+            }
+            std::sort(nodes.begin(), nodes.end());
+            nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+            for (const int n : nodes)
+            {
+                REQUIRE(used[n] == 0);
+                used[n] = 1;
+            }
+        }
+    }
+
+    for (const int c : n_colored)
+        REQUIRE(c == 1);
+}
+
+TEST_CASE("symmetric_sparsity_pattern", "[assembler]")
+{
+    const int n_basis = 50;
+    const auto bases = random_bases(30, n_basis);
+
+    for (int size = 1; size <= 3; ++size)
+    {
+        SparsityPattern pattern;
+        pattern.init(n_basis, size, bases, true);
+        REQUIRE(pattern.is_symmetric());
+
+        StiffnessMatrix mat;
+        pattern.create_matrix(mat);
+        REQUIRE(mat.nonZeros() == pattern.non_zeros());
+        REQUIRE(pattern.matches(mat));
+
+        //symmetric element matrices, only the upper triangle is scattered
+        std::vector<Eigen::Triplet<double>> entries;
+        for (const auto &eb : bases)
+        {
+            const int n_loc = int(eb.bases.size());
+            Eigen::MatrixXd local = Eigen::MatrixXd::Random(n_loc * size, n_loc * size);
+            local = (local + local.transpose()).eval();
+
+            for (int i = 0; i < n_loc; ++i)
+            {
+                for (int j = 0; j < n_loc; ++j)
+                {
+                    for (const auto &gi : eb.bases[i].global())
+                    {
+                        for (const auto &gj : eb.bases[j].global())
+                        {
+                            const long pos = pattern.find(gi.index, gj.index);
+                            REQUIRE((pos >= 0) == (gi.index <= gj.index));
+
+                            for (int m = 0; m < size; ++m)
+                            {
+                                for (int n = 0; n < size; ++n)
+                                {
+                                    const double val = local(i * size + m, j * size + n) * gi.val * gj.val;
+                                    entries.emplace_back(gi.index * size + m, gj.index * size + n, val);
+
+                                    if (pattern.stores(gi.index, gj.index, m, n))
+                                        mat.valuePtr()[pattern.value_index(pos, gj.index, m, n)] += val;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        StiffnessMatrix expected(n_basis * size, n_basis * size);
+        expected.setFromTriplets(entries.begin(), entries.end());
+
+        const Eigen::MatrixXd upper = Eigen::MatrixXd(expected).triangularView<Eigen::Upper>();
+        REQUIRE((Eigen::MatrixXd(mat) - upper).norm() < 1e-12);
+
+        StiffnessMatrix full;
+        symmetric_to_full(mat, full);
+        REQUIRE((Eigen::MatrixXd(full) - Eigen::MatrixXd(expected)).norm() < 1e-12);
+
+        const Eigen::VectorXd x = Eigen::VectorXd::Random(mat.cols());
+        Eigen::VectorXd y;
+        symmetric_multiply(mat, x, y);
+        REQUIRE((y - expected * x).norm() < 1e-12);
+    }
+}
+
+TEST_CASE("block_sparse_matrix", "[assembler]")
+{
+    const int n_basis = 50;
+    const auto bases = random_bases(30, n_basis);
+
+    for (int size = 1; size <= 4; ++size)
+    {
+        SparsityPattern pattern;
+        pattern.init(n_basis, size, bases);
+
+        BlockSparseMatrix mat;
+        mat.init(pattern);
+        REQUIRE(mat.matches(pattern));
+        REQUIRE(mat.non_zeros() == pattern.non_zeros());
+
+        std::vector<Eigen::Triplet<double>> entries;
+        for (const auto &eb : bases)
+        {
+            for (const auto &bi : eb.bases)
+            {
+                for (const auto &bj : eb.bases)
+                {
+                    const Eigen::MatrixXd local = Eigen::MatrixXd::Random(size, size);
+                    for (const auto &gi : bi.global())
+                    {
+                        for (const auto &gj : bj.global())
+                        {
+                            const long k = mat.find(gi.index, gj.index);
+                            REQUIRE(k >= 0);
+
+                            for (int m = 0; m < size; ++m)
+                            {
+                                for (int n = 0; n < size; ++n)
+                                {
+                                    const double val = local(m, n) * gi.val * gj.val;
+                                    mat.block(k)[n * size + m] += val;
+                                    entries.emplace_back(gi.index * size + m, gj.index * size + n, val);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        StiffnessMatrix expected(n_basis * size, n_basis * size);
+        expected.setFromTriplets(entries.begin(), entries.end());
+
+        StiffnessMatrix converted;
+        mat.to_sparse(converted);
+        REQUIRE(converted.nonZeros() == mat.non_zeros());
+        REQUIRE((Eigen::MatrixXd(converted) - Eigen::MatrixXd(expected)).norm() < 1e-12);
+
+        const Eigen::VectorXd x = Eigen::VectorXd::Random(mat.cols());
+        Eigen::VectorXd y;
+        mat.multiply(x, y);
+        REQUIRE((y - expected * x).norm() < 1e-12);
+
+        const Eigen::VectorXd diag = expected.diagonal();
+        REQUIRE((mat.diagonal() - diag).norm() < 1e-12);
+    }
+}
+
+TEST_CASE("hex_sum_factorization", "[assembler]")
+{
+    for (int q = 1; q <= 3; ++q)
+    {
+        const int quadrature_order = 2 * q + 1;
+
+        HexSumFactorization kernel;
+        kernel.init(q, quadrature_order);
+
+        Quadrature quad;
+        HexQuadrature hex_quadrature;
+        hex_quadrature.get_quadrature(quadrature_order, quad);
+        REQUIRE(kernel.n_quadrature_points() == quad.weights.size());
+        REQUIRE((kernel.weights() - quad.weights).norm() < 1e-14);
+
+        const Eigen::MatrixXd coeffs = Eigen::MatrixXd::Random(kernel.n_bases(), 2);
+
+        //dense evaluation with the autogen bases
+        Eigen::MatrixXd expected_val = Eigen::MatrixXd::Zero(quad.weights.size(), 2);
+        std::array<Eigen::MatrixXd, 3> expected_grad;
+        for (auto &g : expected_grad)
+            g = expected_val;
+
+        for (int i = 0; i < kernel.n_bases(); ++i)
+        {
+            Eigen::MatrixXd val, grad;
+            autogen::q_basis_value_3d(q, i, quad.points, val);
+            autogen::q_grad_basis_value_3d(q, i, quad.points, grad);
+
+            for (int c = 0; c < 2; ++c)
+            {
+                expected_val.col(c) += coeffs(i, c) * val;
+                for (int d = 0; d < 3; ++d)
+                    expected_grad[d].col(c) += coeffs(i, c) * grad.col(d);
+            }
+        }
+
+        Eigen::MatrixXd val;
+        std::array<Eigen::MatrixXd, 3> grad;
+        kernel.interpolate(coeffs, val, grad);
+
+        REQUIRE((val - expected_val).norm() < 1e-10);
+        for (int d = 0; d < 3; ++d)
+            REQUIRE((grad[d] - expected_grad[d]).norm() < 1e-10);
+
+        //integrate_grad is the transpose of the gradient interpolation
+        std::array<Eigen::MatrixXd, 3> g;
+        for (auto &gd : g)
+            gd = Eigen::MatrixXd::Random(quad.weights.size(), 2);
+
+        Eigen::MatrixXd res;
+        kernel.integrate_grad(g, res);
+
+        double lhs = (res.array() * coeffs.array()).sum();
+        double rhs = 0;
+        for (int d = 0; d < 3; ++d)
+            rhs += (g[d].array() * grad[d].array()).sum();
+
+        REQUIRE(lhs == Approx(rhs));
+    }
+}
+
+TEST_CASE("matrix_free_apply", "[assembler]")
+{
+    const int n_basis = 12;
+    auto bases = hex_bases();
+    for (auto &b : bases)
+    {
+        b.tensor_order = 1;
+        b.tensor_quadrature_order = 3;
+    }
+
+    const json params = {{"size", 3}, {"lambda", 1.5}, {"mu", 0.7}, {"elasticity_tensor", {}}};
+    const Eigen::VectorXd x = Eigen::VectorXd::Random(n_basis * 3);
+
+    //linear elasticity is applied with sum factorization, hooke has no flux and falls back to the element matrices
+    Assembler<LinearElasticity> elasticity;
+    elasticity.local_assembler().set_parameters(params);
+    Assembler<HookeLinearElasticity> hooke;
+    hooke.local_assembler().set_parameters(params);
+
+    StiffnessMatrix stiffness;
+    elasticity.assemble(true, n_basis, bases, bases, stiffness);
+    const Eigen::VectorXd expected = stiffness * x;
+
+    Eigen::VectorXd y;
+    elasticity.apply(true, n_basis, bases, bases, x, y);
+    REQUIRE((y - expected).norm() < 1e-10 * expected.norm());
+
+    StiffnessMatrix hooke_stiffness;
+    hooke.assemble(true, n_basis, bases, bases, hooke_stiffness);
+    REQUIRE((Eigen::MatrixXd(hooke_stiffness) - Eigen::MatrixXd(stiffness)).norm() < 1e-10 * Eigen::MatrixXd(stiffness).norm());
+
+    hooke.apply(true, n_basis, bases, bases, x, y);
+    REQUIRE((y - expected).norm() < 1e-10 * expected.norm());
+
+    //the sum factorized flux reads the material from the cache of the quadrature points
+    Assembler<LinearElasticity> varying;
+    varying.local_assembler().set_parameters({{"size", 3}, {"lambda", "1 + x * y + z"}, {"mu", "2 + x * x"}});
+    StiffnessMatrix varying_stiffness;
+    varying.assemble(true, n_basis, bases, bases, varying_stiffness);
+    varying.apply(true, n_basis, bases, bases, x, y);
+    const Eigen::VectorXd varying_expected = varying_stiffness * x;
+    REQUIRE((y - varying_expected).norm() < 1e-10 * varying_expected.norm());
+
+    Eigen::VectorXd diag;
+    hooke.assemble_diagonal(true, n_basis, bases, bases, diag);
+    REQUIRE((diag - Eigen::VectorXd(stiffness.diagonal())).norm() < 1e-10 * diag.norm());
+}
+
+TEST_CASE("nl_assemble_all", "[assembler]")
+{
+    const int n_basis = 12;
+    const auto bases = hex_bases();
+
+    NLAssembler<NeoHookeanElasticity> assembler;
+    assembler.local_assembler().set_size(3);
+    assembler.local_assembler().init_multimaterial(Eigen::Vector2d(200, 150), Eigen::Vector2d(0.35, 0.3));
+
+    SparsityPattern pattern;
+    pattern.init(n_basis, 3, bases);
+
+    const Eigen::MatrixXd displacement = 0.05 * Eigen::MatrixXd::Random(n_basis * 3, 1);
+
+    double energy;
+    Eigen::MatrixXd grad;
+    StiffnessMatrix hessian;
+    assembler.assemble_all(true, n_basis, false, bases, bases, pattern, displacement, energy, grad, hessian);
+
+    const double expected_energy = assembler.assemble(true, bases, bases, displacement);
+    Eigen::MatrixXd expected_grad;
+    assembler.assemble_grad(true, n_basis, bases, bases, displacement, expected_grad);
+    StiffnessMatrix expected_hessian;
+    assembler.assemble_hessian(true, n_basis, false, bases, bases, pattern, displacement, expected_hessian);
+
+    REQUIRE(energy == Approx(expected_energy));
+    REQUIRE((grad - expected_grad).norm() < 1e-10 * expected_grad.norm());
+    REQUIRE(pattern.matches(hessian));
+    REQUIRE((Eigen::MatrixXd(hessian) - Eigen::MatrixXd(expected_hessian)).norm() < 1e-10 * expected_hessian.norm());
+
+    //energy and gradient without the hessian
+    double fused_energy;
+    Eigen::MatrixXd fused_grad;
+    assembler.assemble_energy_grad(true, n_basis, bases, bases, displacement, fused_energy, fused_grad);
+    REQUIRE(fused_energy == Approx(expected_energy));
+    REQUIRE((fused_grad - expected_grad).norm() < 1e-10 * expected_grad.norm());
+
+    //the values are refilled in place on the second call
+    const double *values = hessian.valuePtr();
+    assembler.assemble_all(true, n_basis, false, bases, bases, pattern, displacement, energy, grad, hessian);
+    REQUIRE(hessian.valuePtr() == values);
+    REQUIRE(energy == Approx(expected_energy));
+}
+
+TEST_CASE("hessian_pattern_refill", "[assembler]")
+{
+    int n_basis;
+    const auto bases = mixed_order_hex_bases(n_basis);
+    //8 + 27 nodes, 4 shared corners and 5 hanging nodes
+    REQUIRE(n_basis == 26);
+
+    NLAssembler<NeoHookeanElasticity> assembler;
+    assembler.local_assembler().set_size(3);
+    assembler.local_assembler().init_multimaterial(Eigen::Vector2d(200, 150), Eigen::Vector2d(0.35, 0.3));
+
+    SparsityPattern pattern;
+    pattern.init(n_basis, 3, bases);
+
+    const Eigen::MatrixXd displacement = 0.05 * Eigen::MatrixXd::Random(n_basis * 3, 1);
+    StiffnessMatrix hessian;
+    assembler.assemble_hessian(true, n_basis, false, bases, bases, pattern, displacement, hessian);
+    REQUIRE(pattern.matches(hessian));
+
+    Eigen::MatrixXd expected = triplet_hessian(assembler.local_assembler(), n_basis, bases, displacement);
+    REQUIRE((Eigen::MatrixXd(hessian) - expected).norm() < 1e-10 * expected.norm());
+
+    //the second assembly reuses the pattern and only refills the values
+    const double *values = hessian.valuePtr();
+    const Eigen::MatrixXd other = 0.05 * Eigen::MatrixXd::Random(n_basis * 3, 1);
+    assembler.assemble_hessian(true, n_basis, false, bases, bases, pattern, other, hessian);
+    REQUIRE(hessian.valuePtr() == values);
+    REQUIRE(pattern.matches(hessian));
+
+    expected = triplet_hessian(assembler.local_assembler(), n_basis, bases, other);
+    REQUIRE((Eigen::MatrixXd(hessian) - expected).norm() < 1e-10 * expected.norm());
+}
+
+TEST_CASE("assembly_vals_cache", "[assembler]")
+{
+    auto bases = hex_bases();
+
+    AssemblyValsCache cache;
+    cache.set_max_memory(1);
+    cache.init(true, bases, bases);
+    REQUIRE(cache.is_initialized(true, bases, bases));
+    REQUIRE(cache.is_cached(1));
+
+    //same vectors refilled with other bases
+    bases.pop_back();
+    REQUIRE(!cache.is_initialized(true, bases, bases));
+
+    bases = hex_bases();
+    bases[1].bases.pop_back();
+    REQUIRE(!cache.is_initialized(true, bases, bases));
+
+    //the non linear hessian rebuilds its pattern for the refilled bases
+    bases = hex_bases();
+    NLAssembler<NeoHookeanElasticity> assembler;
+    assembler.set_cache_max_memory(1);
+    assembler.local_assembler().set_size(3);
+    assembler.local_assembler().init_multimaterial(Eigen::Vector2d(200, 150), Eigen::Vector2d(0.35, 0.3));
+
+    const Eigen::MatrixXd displacement = 0.05 * Eigen::MatrixXd::Random(12 * 3, 1);
+    StiffnessMatrix hessian;
+    assembler.assemble_hessian(true, 12, false, bases, bases, displacement, hessian);
+
+    bases.pop_back();
+    StiffnessMatrix expected;
+    NLAssembler<NeoHookeanElasticity> fresh;
+    fresh.local_assembler().set_size(3);
+    fresh.local_assembler().init_multimaterial(Eigen::Vector2d(200, 150), Eigen::Vector2d(0.35, 0.3));
+    fresh.assemble_hessian(true, 12, false, bases, bases, displacement, expected);
+
+    assembler.assemble_hessian(true, 12, false, bases, bases, displacement, hessian);
+    REQUIRE(hessian.nonZeros() == expected.nonZeros());
+    REQUIRE((Eigen::MatrixXd(hessian) - Eigen::MatrixXd(expected)).norm() < 1e-10 * Eigen::MatrixXd(expected).norm());
+}
+
+TEST_CASE("element_stiffness_kernels", "[assembler]")
+{
+    for (const int dim : {2, 3})
+    {
+        for (const int order : {1, 2})
+        {
+            const ElementBases b = distorted_q_element(dim, order);
+            ElementAssemblyValues vals;
+            vals.compute(0, dim == 3, b, b);
+            REQUIRE(vals.det.minCoeff() > 0);
+            const QuadratureVector da = vals.det.array() * vals.quadrature.weights.array();
+            const int n_bases = int(vals.basis_values.size());
+
+            //B^T D B against the pairwise kernel, entry (i*dim+m, j*dim+n) is entry n*dim+m of the block i, j
+            LinearElasticity elasticity;
+            elasticity.set_parameters({{"size", dim}, {"lambda", 1.5}, {"mu", 0.7}});
+            const Eigen::MatrixXd stiffness = elasticity.assemble_element(vals, da);
+            REQUIRE(stiffness.rows() == n_bases * dim);
+            REQUIRE(stiffness.cols() == n_bases * dim);
+
+            Eigen::MatrixXd expected(n_bases * dim, n_bases * dim);
+            for (int i = 0; i < n_bases; ++i)
+            {
+                for (int j = 0; j < n_bases; ++j)
+                {
+                    const auto local = elasticity.assemble(vals, i, j, da);
+                    for (int m = 0; m < dim; ++m)
+                    {
+                        for (int n = 0; n < dim; ++n)
+                            expected(i * dim + m, j * dim + n) = local(n * dim + m);
+                    }
+                }
+            }
+            REQUIRE((stiffness - expected).norm() < 1e-12 * expected.norm());
+
+            Laplacian laplacian;
+            const Eigen::MatrixXd laplacian_stiffness = laplacian.assemble_element(vals, da);
+            Eigen::MatrixXd laplacian_expected(n_bases, n_bases);
+            for (int i = 0; i < n_bases; ++i)
+            {
+                for (int j = 0; j < n_bases; ++j)
+                    laplacian_expected(i, j) = laplacian.assemble(vals, i, j, da)(0);
+            }
+            REQUIRE((laplacian_stiffness - laplacian_expected).norm() < 1e-12 * laplacian_expected.norm());
+        }
+    }
+}
+
+TEST_CASE("basis_tabulation", "[assembler]")
+{
+    const auto bases = hex_bases();
+
+    //same bases, with the shared rule and the reference tabulation
+    auto tab_bases = hex_bases();
+    for (auto &b : tab_bases)
+    {
+        b.set_quadrature(QuadratureCache::hex(3));
+        b.reference_type = BasisTabulation::Type::Q3d;
+        b.reference_order = 1;
+    }
+
+    ElementAssemblyValues vals, tab_vals;
+    for (int e = 0; e < 2; ++e)
+    {
+        vals.compute(e, true, bases[e], bases[e]);
+        tab_vals.compute(e, true, tab_bases[e], tab_bases[e]);
+
+        REQUIRE(tab_vals.quadrature.points == vals.quadrature.points);
+        REQUIRE((tab_vals.val - vals.val).norm() < 1e-14);
+        REQUIRE((tab_vals.det - vals.det).norm() < 1e-14);
+        REQUIRE(tab_vals.basis_values.size() == vals.basis_values.size());
+        for (size_t i = 0; i < vals.basis_values.size(); ++i)
+        {
+            REQUIRE(tab_vals.basis_values[i].val == vals.basis_values[i].val);
+            REQUIRE(tab_vals.basis_values[i].grad_t_m == vals.basis_values[i].grad_t_m);
+            REQUIRE(tab_vals.basis_values[i].global[0].index == vals.basis_values[i].global[0].index);
+        }
+    }
+}
+
+TEST_CASE("lumped_mass", "[assembler]")
+{
+    const auto bases = hex_bases();
+    const int n_basis = 12;
+    const int size = 3;
+
+    Density density;
+    density.init({{"density", 2}});
+
+    MassMatrixAssembler assembler;
+    StiffnessMatrix mass;
+    Eigen::VectorXd lumped;
+    assembler.assemble(true, size, n_basis, density, bases, bases, mass);
+    assembler.assemble_lumped(true, size, n_basis, density, bases, bases, lumped);
+
+    REQUIRE(lumped.size() == mass.rows());
+    //two unit cubes of density 2, for every component
+    REQUIRE(lumped.sum() == Approx(size * 2 * 2).margin(1e-12));
+    REQUIRE(lumped.minCoeff() > 0);
+
+    //for affine trilinear elements it is the row-sum of the consistent mass
+    const Eigen::VectorXd row_sum = mass * Eigen::VectorXd::Ones(mass.cols());
+    REQUIRE((lumped - row_sum).norm() < 1e-12);
+}
+
+TEST_CASE("hyperelasticity_closed_form", "[assembler]")
+{
+    const auto bases = hex_bases();
+
+    ElementAssemblyValues vals;
+    vals.compute(0, true, bases[0], bases[0]);
+    const QuadratureVector da = vals.det.array() * vals.quadrature.weights.array();
+
+    NeoHookeanElasticity neo_hookean;
+    neo_hookean.set_size(3);
+    neo_hookean.init_multimaterial(Eigen::Vector2d(200, 150), Eigen::Vector2d(0.35, 0.3));
+
+    SaintVenantElasticity saint_venant;
+    saint_venant.set_parameters({{"size", 3}, {"lambda", 1.5}, {"mu", 0.7}, {"elasticity_tensor", {}}});
+
+    const Eigen::MatrixXd displacement = 0.05 * Eigen::MatrixXd::Random(12 * 3, 1);
+    const double h = 1e-6;
+
+    //gradient and hessian against central differences of the energy and the gradient
+    const auto check = [&](const auto &assembler) {
+        const Eigen::VectorXd grad = assembler.assemble_grad(vals, displacement, da);
+        const Eigen::MatrixXd hessian = assembler.assemble_hessian(vals, displacement, da);
+        REQUIRE((hessian - hessian.transpose()).norm() < 1e-12 * hessian.norm());
+
+        Eigen::VectorXd fd_grad(grad.size());
+        Eigen::MatrixXd fd_hessian(hessian.rows(), hessian.cols());
+        for (int i = 0; i < int(vals.basis_values.size()); ++i)
+        {
+            for (int d = 0; d < 3; ++d)
+            {
+                const int k = vals.basis_values[i].global[0].index * 3 + d;
+                Eigen::MatrixXd plus = displacement, minus = displacement;
+                plus(k) += h;
+                minus(k) -= h;
+
+                fd_grad(i * 3 + d) = (assembler.compute_energy(vals, plus, da) - assembler.compute_energy(vals, minus, da)) / (2 * h);
+                fd_hessian.col(i * 3 + d) = (assembler.assemble_grad(vals, plus, da) - assembler.assemble_grad(vals, minus, da)) / (2 * h);
+            }
+        }
+
+        REQUIRE((grad - fd_grad).norm() < 1e-6 * grad.norm());
+        REQUIRE((hessian - fd_hessian).norm() < 1e-6 * hessian.norm());
+
+        double energy;
+        Eigen::VectorXd all_grad;
+        Eigen::MatrixXd all_hessian;
+        assembler.assemble_all(vals, displacement, da, false, energy, all_grad, all_hessian);
+        REQUIRE(energy == Approx(assembler.compute_energy(vals, displacement, da)));
+        REQUIRE((all_grad - grad).norm() < 1e-12 * grad.norm());
+        REQUIRE((all_hessian - hessian).norm() < 1e-12 * hessian.norm());
+
+        assembler.assemble_energy_grad(vals, displacement, da, energy, all_grad);
+        REQUIRE(energy == Approx(assembler.compute_energy(vals, displacement, da)));
+        REQUIRE((all_grad - grad).norm() < 1e-12 * grad.norm());
+    };
+
+    check(neo_hookean);
+    check(saint_venant);
+}
+
+TEST_CASE("quadrature_psd_projection", "[assembler]")
+{
+    const double lambda = 3, mu = 0.5;
+
+    //closed form against the eigen decomposition of dP/dF, for compressed, stretched, and sheared deformations
+    for (int size = 2; size <= 3; ++size)
+    {
+        for (const double scale : {0.3, 0.7, 1.0, 1.8})
+        {
+            const DefGradMatrix def_grad = scale * DefGradMatrix::Identity(size, size) + 0.2 * DefGradMatrix::Random(size, size);
+            REQUIRE(def_grad.determinant() > 0);
+
+            StressGradMatrix stress_grad;
+            if (size == 2)
+                autogen::neo_hookean_2d_stress_grad(def_grad, lambda, mu, stress_grad);
+            else
+                autogen::neo_hookean_3d_stress_grad(def_grad, lambda, mu, stress_grad);
+
+            Eigen::SelfAdjointEigenSolver<StressGradMatrix> eigs(stress_grad);
+            const StressGradMatrix expected = eigs.eigenvectors() * eigs.eigenvalues().cwiseMax(0).asDiagonal() * eigs.eigenvectors().transpose();
+
+            NeoHookeanElasticity::project_stress_grad_to_psd(def_grad, lambda, mu, stress_grad);
+            REQUIRE((stress_grad - expected).norm() < 1e-10 * expected.norm());
+        }
+    }
+
+    //the element hessian is psd by construction
+    const auto bases = hex_bases();
+    ElementAssemblyValues vals;
+    vals.compute(0, true, bases[0], bases[0]);
+    const QuadratureVector da = vals.det.array() * vals.quadrature.weights.array();
+    const Eigen::MatrixXd displacement = 0.3 * Eigen::MatrixXd::Random(12 * 3, 1);
+
+    NeoHookeanElasticity neo_hookean;
+    neo_hookean.set_size(3);
+    neo_hookean.init_multimaterial(Eigen::Vector2d(200, 150), Eigen::Vector2d(0.35, 0.3));
+
+    SaintVenantElasticity saint_venant;
+    saint_venant.set_parameters({{"size", 3}, {"lambda", 1.5}, {"mu", 0.7}, {"elasticity_tensor", {}}});
+
+    const auto check = [&](const auto &assembler) {
+        const Eigen::MatrixXd hessian = assembler.assemble_hessian(vals, displacement, da, true);
+        REQUIRE((hessian - hessian.transpose()).norm() < 1e-12 * hessian.norm());
+        REQUIRE(Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd>(hessian).eigenvalues().minCoeff() > -1e-10 * hessian.norm());
+
+        double energy;
+        Eigen::VectorXd grad;
+        Eigen::MatrixXd all_hessian;
+        assembler.assemble_all(vals, displacement, da, true, energy, grad, all_hessian);
+        REQUIRE((all_hessian - hessian).norm() < 1e-12 * hessian.norm());
+    };
+
+    check(neo_hookean);
+    check(saint_venant);
+
+    //the global assembly sums the projected element hessians, without projecting them again
+    NLAssembler<NeoHookeanElasticity> assembler;
+    assembler.local_assembler().set_size(3);
+    assembler.local_assembler().init_multimaterial(Eigen::Vector2d(200, 150), Eigen::Vector2d(0.35, 0.3));
+    assembler.set_quadrature_psd_projection(true);
+
+    SparsityPattern pattern;
+    pattern.init(12, 3, bases);
+    StiffnessMatrix hessian;
+    assembler.assemble_hessian(true, 12, true, bases, bases, pattern, displacement, hessian);
+
+    Eigen::MatrixXd expected = Eigen::MatrixXd::Zero(12 * 3, 12 * 3);
+    for (int e = 0; e < 2; ++e)
+    {
+        ElementAssemblyValues e_vals;
+        e_vals.compute(e, true, bases[e], bases[e]);
+        const QuadratureVector e_da = e_vals.det.array() * e_vals.quadrature.weights.array();
+        const Eigen::MatrixXd local = assembler.local_assembler().assemble_hessian(e_vals, displacement, e_da, true);
+
+        for (int i = 0; i < int(e_vals.basis_values.size()); ++i)
+        {
+            for (int j = 0; j < int(e_vals.basis_values.size()); ++j)
+                expected.block<3, 3>(e_vals.basis_values[i].global[0].index * 3, e_vals.basis_values[j].global[0].index * 3) += local.block<3, 3>(i * 3, j * 3);
+        }
+    }
+
+    REQUIRE((Eigen::MatrixXd(hessian) - expected).norm() < 1e-10 * expected.norm());
+}
+
+TEST_CASE("material_cache", "[assembler]")
+{
+    const auto bases = hex_bases();
+
+    //as many points as the quadrature, only the first one is the same
+    Quadrature quadrature;
+    bases[0].compute_quadrature(quadrature);
+    Eigen::MatrixXd other_points = quadrature.points;
+    other_points.bottomRows(other_points.rows() - 1) *= 0.5;
+
+    std::vector<ElementAssemblyValues> all_vals(4);
+    for (int e = 0; e < 2; ++e)
+    {
+        all_vals[2 * e].compute(e, true, bases[e], bases[e]);
+        all_vals[2 * e + 1].compute(e, true, other_points, bases[e], bases[e]);
+    }
+
+    const auto check_lame = [&](const LameParameters &params) {
+        for (const auto &vals : all_vals)
+        {
+            for (int p = 0; p < vals.val.rows(); ++p)
+            {
+                double lambda, mu, expected_lambda, expected_mu;
+                params.lambda_mu(vals, p, lambda, mu);
+                params.lambda_mu(vals.val(p, 0), vals.val(p, 1), vals.val(p, 2), vals.element_id, expected_lambda, expected_mu);
+
+                REQUIRE(lambda == Approx(expected_lambda).epsilon(1e-12));
+                REQUIRE(mu == Approx(expected_mu).epsilon(1e-12));
+            }
+        }
+    };
+
+    const auto check_density = [&](const Density &density) {
+        for (const auto &vals : all_vals)
+        {
+            for (int p = 0; p < vals.val.rows(); ++p)
+                REQUIRE(density(vals, p) == Approx(density(vals.val(p, 0), vals.val(p, 1), vals.val(p, 2), vals.element_id)).epsilon(1e-12));
+        }
+    };
+
+    for (const json &params : {json({{"size", 3}, {"lambda", "1 + x * y + z"}, {"mu", "2 + x * x"}}),
+                               json({{"size", 3}, {"E", "100 + x"}, {"nu", "0.3 + 0.01 * y"}})})
+    {
+        LameParameters lame;
+        lame.init(params);
+        check_lame(lame);
+
+        //the strings are expressions of the point
+        double lambda0, mu0, lambda1, mu1;
+        lame.lambda_mu(0, 0, 0, 0, lambda0, mu0);
+        lame.lambda_mu(1, 1, 1, 0, lambda1, mu1);
+        REQUIRE(lambda0 != Approx(lambda1));
+        REQUIRE(mu0 != Approx(mu1));
+        lame.init_cache(true, bases, bases);
+        check_lame(lame);
+
+        //what State::set_multimaterial does, it must drop the cached expression values
+        Eigen::MatrixXd Es(2, 1), nus(2, 1);
+        Es << 10, 20;
+        nus << 0.2, 0.4;
+        lame.init_multimaterial(Es, nus);
+        check_lame(lame);
+        for (const auto &vals : all_vals)
+        {
+            const int e = vals.element_id;
+            double lambda, mu;
+            lame.lambda_mu(vals, 0, lambda, mu);
+            REQUIRE(lambda == Approx(convert_to_lambda(true, Es(e), nus(e))));
+            REQUIRE(mu == Approx(convert_to_mu(Es(e), nus(e))));
+        }
+    }
+
+    Density density;
+    density.init({{"density", "1 + x * y * z"}});
+    check_density(density);
+    density.init_cache(true, bases, bases);
+    check_density(density);
+
+    Eigen::MatrixXd rhos(2, 1);
+    rhos << 3, 5;
+    density.init_multimaterial(rhos);
+    check_density(density);
+    for (const auto &vals : all_vals)
+        REQUIRE(density(vals, 0) == Approx(rhos(vals.element_id)));
+}
@@ -196,3 +196,45 @@ TEST_CASE("eigs3idautodiff", "[matrix]") {
     	}
     }
 }
+
+TEST_CASE("sparse_pattern_hash", "[matrix]") {
+    const auto tridiagonal = [](const int n, const double val) {
+        std::vector<Eigen::Triplet<double>> entries;
+        for (int i = 0; i < n; ++i)
+        {
+            entries.emplace_back(i, i, val);
+            if (i > 0)
+                entries.emplace_back(i, i - 1, -val);
+        }
+        StiffnessMatrix mat(n, n);
+        mat.setFromTriplets(entries.begin(), entries.end());
+        return mat;
+    };
+
+    //the values do not matter
+    const StiffnessMatrix a = tridiagonal(10, 1);
+    const StiffnessMatrix b = tridiagonal(10, 3);
+    REQUIRE(polyfem::sparse_pattern_hash(a) == polyfem::sparse_pattern_hash(b));
+
+    //explicit zeros are part of the pattern
+    StiffnessMatrix zero = a;
+    zero.coeffs().setZero();
+    REQUIRE(polyfem::sparse_pattern_hash(a) == polyfem::sparse_pattern_hash(zero));
+
+    //same number of non zeros at other positions
+    const StiffnessMatrix transposed = a.transpose();
+    REQUIRE(transposed.nonZeros() == a.nonZeros());
+    REQUIRE(polyfem::sparse_pattern_hash(a) != polyfem::sparse_pattern_hash(transposed));
+
+    //one more entry, another size
+    StiffnessMatrix more = a;
+    more.coeffRef(0, 9) = 1;
+    more.makeCompressed();
+    REQUIRE(polyfem::sparse_pattern_hash(a) != polyfem::sparse_pattern_hash(more));
+    REQUIRE(polyfem::sparse_pattern_hash(a) != polyfem::sparse_pattern_hash(tridiagonal(11, 1)));
+
+    StiffnessMatrix wider = a;
+    wider.conservativeResize(10, 11);
+    wider.makeCompressed();
+    REQUIRE(polyfem::sparse_pattern_hash(a) != polyfem::sparse_pattern_hash(wider));
+}
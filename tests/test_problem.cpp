@@ -1,9 +1,13 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <polyfem/Problem.hpp>
+#include <polyfem/GenericProblem.hpp>
 #include <polyfem/AssemblerUtils.hpp>
+#include <polyfem/Mesh2D.hpp>
 #include <polyfem/Common.hpp>
 
 #include <catch.hpp>
+#include <cmath>
+#include <functional>
 #include <iostream>
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -513,4 +517,90 @@ TEST_CASE("elasticity 3d", "[problem]")
 
         REQUIRE(diff.array().abs().maxCoeff() < 1e-10);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("generic bc time", "[problem]")
+{
+    //unit square, boundary ids 1 left, 2 bottom, 3 right, 4 top
+    Eigen::MatrixXd V(4, 2);
+    V << 0, 0, 1, 0, 1, 1, 0, 1;
+    Eigen::MatrixXi F(1, 4);
+    F << 0, 1, 2, 3;
+
+    Mesh2D mesh;
+    mesh.build_from_matrices(V, F);
+    mesh.compute_boundary_ids(1e-8);
+
+    Eigen::MatrixXd pts;
+    mesh.edge_barycenters(pts);
+    Eigen::MatrixXi global_ids(mesh.n_edges(), 1);
+    for (int e = 0; e < mesh.n_edges(); ++e)
+        global_ids(e) = e;
+
+    //values that do not use t are scaled by the load, the others are already the value at t
+    const auto expected = [&](const std::vector<std::function<double(double, double, double)>> &funs, const double t) {
+        Eigen::MatrixXd val(pts.rows(), 1);
+        for (int e = 0; e < pts.rows(); ++e)
+            val(e) = funs[mesh.get_boundary_id(e) - 1](pts(e, 0), pts(e, 1), t);
+        return val;
+    };
+
+    {
+        GenericScalarProblem probl("GenericScalar");
+        probl.set_parameters(json::parse(R"json({
+            "dirichlet_boundary": [{"id": 1, "value": "sin(t)"}, {"id": 3, "value": "2 + y"}],
+            "neumann_boundary": [{"id": 2, "value": "t^2 * x"}, {"id": 4, "value": 3}]
+        })json"));
+
+        const std::vector<std::function<double(double, double, double)>> dirichlet = {
+            [](double x, double y, double t) { return std::sin(t); },
+            [](double x, double y, double t) { return 0.; },
+            [](double x, double y, double t) { return t * (2 + y); },
+            [](double x, double y, double t) { return 0.; }};
+        const std::vector<std::function<double(double, double, double)>> neumann = {
+            [](double x, double y, double t) { return 0.; },
+            [](double x, double y, double t) { return t * t * x; },
+            [](double x, double y, double t) { return 0.; },
+            [](double x, double y, double t) { return 3 * t; }};
+
+        for (const double t : {0.5, 1., 2.})
+        {
+            Eigen::MatrixXd val;
+            probl.bc(mesh, global_ids, pts, pts, t, val);
+            REQUIRE((val - expected(dirichlet, t)).norm() < 1e-12);
+
+            probl.neumann_bc(mesh, global_ids, pts, pts, pts, t, val);
+            REQUIRE((val - expected(neumann, t)).norm() < 1e-12);
+        }
+    }
+
+    {
+        GenericTensorProblem probl("GenericTensor");
+        probl.set_parameters(json::parse(R"json({
+            "dirichlet_boundary": [{"id": 1, "value": ["cos(t)", "x + 1"]}],
+            "neumann_boundary": [{"id": 3, "value": ["t * y", 4]}]
+        })json"));
+
+        for (const double t : {0.5, 2.})
+        {
+            Eigen::MatrixXd val;
+            probl.neumann_bc(mesh, global_ids, pts, pts, pts, t, val);
+            for (int e = 0; e < pts.rows(); ++e)
+            {
+                const double y = pts(e, 1);
+                const bool right = mesh.get_boundary_id(e) == 3;
+                REQUIRE(val(e, 0) == Approx(right ? t * y : 0).margin(1e-12));
+                REQUIRE(val(e, 1) == Approx(right ? 4 * t : 0).margin(1e-12));
+            }
+
+            probl.bc(mesh, global_ids, pts, pts, t, val);
+            for (int e = 0; e < pts.rows(); ++e)
+            {
+                const double x = pts(e, 0);
+                const bool left = mesh.get_boundary_id(e) == 1;
+                REQUIRE(val(e, 0) == Approx(left ? std::cos(t) : 0).margin(1e-12));
+                REQUIRE(val(e, 1) == Approx(left ? t * (x + 1) : 0).margin(1e-12));
+            }
+        }
+    }
+}
@@ -2,6 +2,9 @@
 #include <polyfem/LineQuadrature.hpp>
 #include <polyfem/TriQuadrature.hpp>
 #include <polyfem/TetQuadrature.hpp>
+#include <polyfem/HexQuadrature.hpp>
+#include <polyfem/QuadratureCache.hpp>
+#include <polyfem/BDF.hpp>
 #include <iostream>
 #include <cmath>
 #include <Eigen/Dense>
@@ -69,6 +72,63 @@ TEST_CASE("weights", "[quadrature]") {
 	}
 }
 
+TEST_CASE("cache", "[quadrature]") {
+	for (int order = 1; order < 8; ++order) {
+		const Quadrature &cached = QuadratureCache::hex(order);
+		REQUIRE(&cached == &QuadratureCache::hex(order));
+		REQUIRE(&cached != &QuadratureCache::tet(order));
+
+		HexQuadrature hex;
+		Quadrature quadr;
+		hex.get_quadrature(order, quadr);
+		REQUIRE(cached.points == quadr.points);
+		REQUIRE(cached.weights == quadr.weights);
+	}
+}
+
+TEST_CASE("bdf_variable_step", "[quadrature]") {
+	const std::vector<double> dts = {0.1, 0.13, 0.07, 0.2, 0.05, 0.11, 0.09};
+
+	for (int order = 1; order <= 4; ++order) {
+		//polynomial of degree order, its derivative is exact and so is the predictor
+		const auto p = [order](const double t) { return std::pow(t + 0.3, order); };
+		const auto dp = [order](const double t) { return order * std::pow(t + 0.3, order - 1); };
+
+		BDF bdf(order);
+		Eigen::VectorXd x(1), rhs, err;
+		double t = 0;
+		x(0) = p(t);
+		bdf.new_solution(x);
+
+		for (const double dt : dts) {
+			bdf.set_dt(dt);
+			t += dt;
+			x(0) = p(t);
+
+			if (bdf.current_order() == order) {
+				bdf.rhs(rhs);
+				REQUIRE((bdf.alpha() * x(0) - rhs(0)) / dt == Approx(dp(t)).margin(1e-10));
+			}
+			if (bdf.has_error_estimate()) {
+				bdf.error_estimate(x, err);
+				REQUIRE(err(0) == Approx(0).margin(1e-10));
+			}
+			bdf.new_solution(x);
+		}
+	}
+
+	//uniform steps give the classic coefficients
+	BDF bdf(2);
+	Eigen::VectorXd x = Eigen::VectorXd::Ones(1), rhs;
+	bdf.set_dt(0.1);
+	bdf.new_solution(x);
+	bdf.new_solution(x);
+	bdf.new_solution(x);
+	REQUIRE(bdf.alpha() == 3. / 2.);
+	bdf.rhs(rhs);
+	REQUIRE(rhs(0) == Approx(-1. / 2. + 2));
+}
+
 //TEST_CASE("triangle", "[quadrature]") {
 //	for (int order = 1; order < 10; ++order) {
 //		Quadrature quadr;
@@ -0,0 +1,327 @@
+////////////////////////////////////////////////////////////////////////////////
+#include <polyfem/RhsAssembler.hpp>
+#include <polyfem/AssemblerUtils.hpp>
+#include <polyfem/ElasticityUtils.hpp>
+#include <polyfem/FEBasis2d.hpp>
+#include <polyfem/Mesh2D.hpp>
+#include <polyfem/Problem.hpp>
+#include <polyfem/ElementAssemblyValues.hpp>
+
+#include <polysolve/LinearSolver.hpp>
+
+#include <Eigen/Sparse>
+
+#include <catch.hpp>
+#include <iostream>
+
+#ifdef POLYFEM_WITH_TBB
+#include <tbb/task_scheduler_init.h>
+#endif
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace polyfem;
+using namespace polysolve;
+
+namespace
+{
+    //time dependent elasticity problem with non zero body force, dirichlet (position, velocity, acceleration), and neumann data
+    class BoundaryProblem : public Problem
+    {
+    public:
+        BoundaryProblem() : Problem("BoundaryProblem") {}
+
+        void set_boundary_ids(const std::vector<int> &dirichlet, const std::vector<int> &neumann)
+        {
+            boundary_ids_ = dirichlet;
+            neumann_boundary_ids_ = neumann;
+        }
+
+        void rhs(const AssemblerUtils &assembler, const std::string &formulation, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const override
+        {
+            val.resize(pts.rows(), pts.cols());
+            val.col(0) = t * pts.col(0).array() * pts.col(1).array();
+            val.col(1) = pts.col(0).array().sin() + t * t;
+        }
+        bool is_rhs_zero() const override { return false; }
+
+        void bc(const Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const override
+        {
+            val.resize(pts.rows(), pts.cols());
+            val.col(0) = pts.col(0).array() + t * pts.col(1).array().square();
+            val.col(1) = pts.col(0).array() * pts.col(1).array() - t;
+        }
+        void velocity_bc(const Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const override
+        {
+            val.resize(pts.rows(), pts.cols());
+            val.col(0) = pts.col(1);
+            val.col(1) = t * pts.col(0);
+        }
+        void acceleration_bc(const Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const override
+        {
+            val.resize(pts.rows(), pts.cols());
+            val.col(0).setConstant(t);
+            val.col(1) = pts.col(0).array().square();
+        }
+
+        void neumann_bc(const Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &normals, const double t, Eigen::MatrixXd &val) const override
+        {
+            val.resize(pts.rows(), pts.cols());
+            val.col(0) = normals.col(0).array() * (1 + pts.col(1).array());
+            val.col(1) = t * normals.col(1).array() * pts.col(0).array() + 0.5;
+        }
+        void neumann_velocity_bc(const Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &normals, const double t, Eigen::MatrixXd &val) const override
+        {
+            val = t * normals;
+        }
+        void neumann_acceleration_bc(const Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &normals, const double t, Eigen::MatrixXd &val) const override
+        {
+            val = pts.array().square().matrix() + normals;
+        }
+
+        bool has_exact_sol() const override { return false; }
+        bool is_scalar() const override { return false; }
+        bool is_time_dependent() const override { return true; }
+
+        void initial_solution(const Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) const override
+        {
+            val.resize(pts.rows(), pts.cols());
+            val.col(0) = pts.col(0).array() * pts.col(1).array();
+            val.col(1) = pts.col(1).array() - pts.col(0).array().square();
+        }
+    };
+
+    //n x n quads on the unit square, the sides are tagged 1 (left), 2 (bottom), 3 (right), 4 (top)
+    int square_mesh(const int n, Mesh2D &mesh, std::vector<ElementBases> &bases, std::vector<LocalBoundary> &local_boundary)
+    {
+        Eigen::MatrixXd V((n + 1) * (n + 1), 2);
+        for (int j = 0; j <= n; ++j)
+        {
+            for (int i = 0; i <= n; ++i)
+                V.row(j * (n + 1) + i) << i / double(n), j / double(n);
+        }
+
+        Eigen::MatrixXi F(n * n, 4);
+        for (int j = 0; j < n; ++j)
+        {
+            for (int i = 0; i < n; ++i)
+            {
+                const int v = j * (n + 1) + i;
+                F.row(j * n + i) << v, v + 1, v + n + 2, v + n + 1;
+            }
+        }
+
+        mesh.build_from_matrices(V, F);
+        mesh.compute_boundary_ids([](const RowVectorNd &p) {
+            if (p(0) < 1e-8)
+                return 1;
+            if (p(1) < 1e-8)
+                return 2;
+            if (p(0) > 1 - 1e-8)
+                return 3;
+            return 4;
+        });
+
+        std::map<int, InterfaceData> poly_edge_to_data;
+        return FEBasis2d::build_bases(mesh, 4, 1, false, false, false, bases, local_boundary, poly_edge_to_data);
+    }
+
+    //per element \int \phi rho fun, as assemble and time_bc did before the quadrature cache
+    Eigen::MatrixXd element_integral(const Mesh &mesh, const int n_bases, const std::vector<ElementBases> &bases, const Density *density,
+                                     const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &fun)
+    {
+        Eigen::MatrixXd res = Eigen::MatrixXd::Zero(n_bases * 2, 1);
+        Eigen::MatrixXd loc_val;
+        Eigen::MatrixXi ids;
+        ElementAssemblyValues vals;
+        for (int e = 0; e < int(bases.size()); ++e)
+        {
+            vals.compute(e, mesh.is_volume(), bases[e], bases[e]);
+            ids.setConstant(vals.val.rows(), 1, e);
+            fun(ids, vals.val, loc_val);
+
+            for (int q = 0; q < vals.val.rows(); ++q)
+            {
+                const double rho = density ? (*density)(vals.val(q, 0), vals.val(q, 1), 0., e) : 1.;
+                loc_val.row(q) *= vals.det(q) * vals.quadrature.weights(q) * rho;
+            }
+
+            for (const auto &v : vals.basis_values)
+            {
+                for (int d = 0; d < 2; ++d)
+                {
+                    const double value = (loc_val.col(d).array() * v.val.array()).sum();
+                    for (const auto &g : v.global)
+                        res(g.index * 2 + d) += value * g.val;
+                }
+            }
+        }
+
+        return res;
+    }
+
+    std::unique_ptr<RhsAssembler> rhs_assembler(const AssemblerUtils &assembler, const Mesh &mesh, const int n_bases, const std::vector<ElementBases> &bases, const Problem &problem)
+    {
+        return std::make_unique<RhsAssembler>(assembler, mesh, n_bases, 2, bases, bases, "LinearElasticity", problem,
+                                              LinearSolver::defaultSolver(), LinearSolver::defaultPrecond(), json({}));
+    }
+}
+
+TEST_CASE("dirichlet_cache", "[rhs_assembler]")
+{
+    Mesh2D mesh;
+    std::vector<ElementBases> bases;
+    std::vector<LocalBoundary> all_boundary;
+    const int n_bases = square_mesh(3, mesh, bases, all_boundary);
+
+    AssemblerUtils assembler;
+    BoundaryProblem problem;
+
+    //two boundaries with the same number of edges and nodes, left/bottom (neumann right) and right/top (neumann left)
+    std::vector<LocalBoundary> boundary_a(all_boundary), boundary_b(all_boundary);
+    std::vector<LocalBoundary> neumann_a, neumann_b;
+    std::vector<int> nodes_a, nodes_b;
+    problem.set_boundary_ids({1, 2}, {3});
+    problem.setup_bc(mesh, bases, boundary_a, nodes_a, neumann_a);
+    problem.set_boundary_ids({3, 4}, {1});
+    problem.setup_bc(mesh, bases, boundary_b, nodes_b, neumann_b);
+    REQUIRE(boundary_a.size() == boundary_b.size());
+    REQUIRE(nodes_a.size() == nodes_b.size());
+
+    const auto cached = rhs_assembler(assembler, mesh, n_bases, bases, problem);
+    const Eigen::MatrixXd rhs0 = Eigen::MatrixXd::Random(n_bases * 2, 1);
+
+    //the same vectors are refilled in place, as the temporaries of the caller would be
+    std::vector<LocalBoundary> local_boundary, local_neumann_boundary;
+    std::vector<int> boundary_nodes;
+    for (const double t : {0.5, 1.0})
+    {
+        for (int k = 0; k < 2; ++k)
+        {
+            local_boundary.clear();
+            for (const auto &lb : k == 0 ? boundary_a : boundary_b)
+                local_boundary.push_back(lb);
+            local_neumann_boundary.clear();
+            for (const auto &lb : k == 0 ? neumann_a : neumann_b)
+                local_neumann_boundary.push_back(lb);
+            boundary_nodes = k == 0 ? nodes_a : nodes_b;
+
+            for (int kind = 0; kind < 3; ++kind)
+            {
+                const auto fresh = rhs_assembler(assembler, mesh, n_bases, bases, problem);
+                Eigen::MatrixXd rhs = rhs0, expected = rhs0;
+                if (kind == 0)
+                {
+                    cached->set_bc(local_boundary, boundary_nodes, 6, local_neumann_boundary, rhs, t);
+                    fresh->set_bc(local_boundary, boundary_nodes, 6, local_neumann_boundary, expected, t);
+                }
+                else if (kind == 1)
+                {
+                    cached->set_velocity_bc(local_boundary, boundary_nodes, 6, local_neumann_boundary, rhs, t);
+                    fresh->set_velocity_bc(local_boundary, boundary_nodes, 6, local_neumann_boundary, expected, t);
+                }
+                else
+                {
+                    cached->set_acceleration_bc(local_boundary, boundary_nodes, 6, local_neumann_boundary, rhs, t);
+                    fresh->set_acceleration_bc(local_boundary, boundary_nodes, 6, local_neumann_boundary, expected, t);
+                }
+
+                REQUIRE((rhs - rhs0).norm() > 1e-8);
+                REQUIRE((rhs - expected).norm() < 1e-10);
+            }
+        }
+    }
+
+    //after clearing, the cache is rebuilt from scratch
+    cached->clear_cache();
+    Eigen::MatrixXd rhs = rhs0, expected = rhs0;
+    cached->set_bc(boundary_a, nodes_a, 6, neumann_a, rhs, 1);
+    rhs_assembler(assembler, mesh, n_bases, bases, problem)->set_bc(boundary_a, nodes_a, 6, neumann_a, expected, 1);
+    REQUIRE((rhs - expected).norm() < 1e-10);
+}
+
+TEST_CASE("neumann_parallel", "[rhs_assembler]")
+{
+    Mesh2D mesh;
+    std::vector<ElementBases> bases;
+    std::vector<LocalBoundary> local_boundary;
+    const int n_bases = square_mesh(6, mesh, bases, local_boundary);
+
+    AssemblerUtils assembler;
+    Density density;
+    BoundaryProblem problem;
+
+    //neumann everywhere, no dirichlet
+    std::vector<LocalBoundary> local_neumann_boundary;
+    std::vector<int> boundary_nodes;
+    problem.set_boundary_ids({-1}, {1, 2, 3, 4});
+    problem.setup_bc(mesh, bases, local_boundary, boundary_nodes, local_neumann_boundary);
+    REQUIRE(local_boundary.empty());
+    REQUIRE(local_neumann_boundary.size() == 20);
+
+    const Eigen::MatrixXd displacement = Eigen::MatrixXd::Random(n_bases * 2, 1);
+    const double t = 0.7;
+
+    const auto compute = [&](Eigen::MatrixXd &rhs, double &energy) {
+        const auto rhs_assembler_ptr = rhs_assembler(assembler, mesh, n_bases, bases, problem);
+        rhs_assembler_ptr->assemble(density, rhs, t);
+        rhs *= -1;
+        rhs_assembler_ptr->set_bc(local_boundary, boundary_nodes, 6, local_neumann_boundary, rhs, t);
+        energy = rhs_assembler_ptr->compute_energy(displacement, local_neumann_boundary, density, 6, t);
+    };
+
+    Eigen::MatrixXd serial_rhs, rhs;
+    double serial_energy, energy;
+    {
+#ifdef POLYFEM_WITH_TBB
+        tbb::task_scheduler_init scheduler(1);
+#endif
+        compute(serial_rhs, serial_energy);
+    }
+    compute(rhs, energy);
+
+    REQUIRE((rhs - serial_rhs).norm() < 1e-12 * serial_rhs.norm());
+    REQUIRE(energy == Approx(serial_energy).epsilon(1e-12));
+
+    //the energy is -rhs . u, the body force is assembled with the opposite sign of the neumann forces
+    REQUIRE(energy == Approx(-serial_rhs.col(0).dot(displacement.col(0))).epsilon(1e-10));
+}
+
+TEST_CASE("cached_quadrature", "[rhs_assembler]")
+{
+    Mesh2D mesh;
+    std::vector<ElementBases> bases;
+    std::vector<LocalBoundary> local_boundary;
+    const int n_bases = square_mesh(4, mesh, bases, local_boundary);
+
+    AssemblerUtils assembler;
+    BoundaryProblem problem;
+    Density density;
+    density.init({{"density", "1 + x * y"}});
+
+    StiffnessMatrix mass;
+    assembler.assemble_mass_matrix("LinearElasticity", false, n_bases, Density(), bases, bases, mass);
+    Eigen::SimplicialLDLT<StiffnessMatrix> mass_solver(mass);
+    REQUIRE(mass_solver.info() == Eigen::Success);
+
+    const Eigen::MatrixXd expected_initial = mass_solver.solve(element_integral(mesh, n_bases, bases, nullptr, [&](const Eigen::MatrixXi &ids, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) {
+        problem.initial_solution(mesh, ids, pts, val);
+    }));
+
+    //the same assembler is reused across times, the quadrature and the mass factorization are cached
+    const auto cached = rhs_assembler(assembler, mesh, n_bases, bases, problem);
+    for (const double t : {0.25, 1.0, 0.25})
+    {
+        const Eigen::MatrixXd expected = element_integral(mesh, n_bases, bases, &density, [&](const Eigen::MatrixXi &ids, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) {
+            problem.rhs(assembler, "LinearElasticity", pts, t, val);
+        });
+
+        Eigen::MatrixXd rhs;
+        cached->assemble(density, rhs, t);
+        REQUIRE(expected.norm() > 1e-8);
+        REQUIRE((rhs - expected).norm() < 1e-12 * expected.norm());
+
+        Eigen::MatrixXd sol;
+        cached->initial_solution(sol);
+        REQUIRE((sol - expected_initial).norm() < 1e-10 * expected_initial.norm());
+    }
+}
@@ -2,6 +2,11 @@
 
 #include <polyfem/TriQuadrature.hpp>
 #include <polyfem/FEBasis2d.hpp>
+#include <polyfem/MatrixFreeSolver.hpp>
+#include <polyfem/FactorizedDirichletSolve.hpp>
+#include <polyfem/SparseNewtonDescentSolver.hpp>
+
+#include <polysolve/FEMSolver.hpp>
 
 #include <catch.hpp>
 #include <iostream>
@@ -26,6 +31,51 @@ public:
     }
 };
 
+//0.5 x^T K x - b^T x + c/4 \sum x_i^4, convex with a hessian that changes along the newton iterations
+class QuarticProblem : public cppoptlib::Problem<double> {
+public:
+    typedef StiffnessMatrix THessian;
+
+    QuarticProblem(const StiffnessMatrix &K, const Eigen::VectorXd &b, const double c) : K(K), b(b), c(c) {}
+
+    double value(const Eigen::VectorXd &x) override {
+        return 0.5 * x.dot(K * x) - b.dot(x) + c / 4 * x.array().pow(4).sum();
+    }
+    void gradient(const Eigen::VectorXd &x, Eigen::VectorXd &grad) override {
+        grad = K * x - b;
+        grad.array() += c * x.array().cube();
+    }
+    void hessian(const Eigen::VectorXd &x, THessian &hessian) {
+        hessian = K;
+        for (int i = 0; i < x.size(); ++i)
+            hessian.coeffRef(i, i) += 3 * c * x(i) * x(i);
+    }
+
+    bool is_step_valid(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) { return true; }
+    double max_step_size(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) { return 1; }
+
+private:
+    const StiffnessMatrix K;
+    const Eigen::VectorXd b;
+    const double c;
+};
+
+StiffnessMatrix tridiagonal_spd(const int n) {
+    std::vector<Eigen::Triplet<double>> entries;
+    for (int i = 0; i < n; ++i)
+    {
+        entries.emplace_back(i, i, 2 + 0.01 * i);
+        if (i > 0)
+        {
+            entries.emplace_back(i, i - 1, -1);
+            entries.emplace_back(i - 1, i, -1);
+        }
+    }
+    StiffnessMatrix K(n, n);
+    K.setFromTriplets(entries.begin(), entries.end());
+    return K;
+}
+
 TEST_CASE("solver", "[solver]") {
     Rosenbrock f;
     cppoptlib::BfgsSolver<Rosenbrock> solver;
@@ -36,3 +86,212 @@ TEST_CASE("solver", "[solver]") {
     REQUIRE(f(x) < 1e-10);
 }
 
+TEST_CASE("matrix_free_cg", "[solver]") {
+    const int n = 200;
+    std::vector<Eigen::Triplet<double>> entries;
+    for (int i = 0; i < n; ++i)
+    {
+        entries.emplace_back(i, i, 2 + 0.01 * i);
+        if (i > 0)
+        {
+            entries.emplace_back(i, i - 1, -1);
+            entries.emplace_back(i - 1, i, -1);
+        }
+    }
+    StiffnessMatrix K(n, n);
+    K.setFromTriplets(entries.begin(), entries.end());
+
+    const std::vector<int> boundary_nodes = {0, n - 1};
+    Eigen::VectorXd b = Eigen::VectorXd::Random(n);
+    b(0) = 1;
+    b(n - 1) = 2;
+
+    for (const std::string precond : {"none", "jacobi", "chebyshev_jacobi"})
+    {
+        json params;
+        params["precond"] = precond;
+        MatrixFreeSolver solver(params);
+        solver.set_operator(n, [&](const Eigen::VectorXd &x, Eigen::VectorXd &y) { y = K * x; }, boundary_nodes);
+        solver.set_diagonal(K.diagonal());
+
+        Eigen::VectorXd x;
+        solver.solve(b, x);
+
+        REQUIRE(x(0) == Approx(1));
+        REQUIRE(x(n - 1) == Approx(2));
+
+        const Eigen::VectorXd res = K * x - b;
+        REQUIRE(res.segment(1, n - 2).norm() < 1e-8);
+    }
+}
+
+TEST_CASE("factorized_dirichlet_solve", "[solver]") {
+    const int n = 100;
+    std::vector<Eigen::Triplet<double>> entries;
+    for (int i = 0; i < n; ++i)
+    {
+        entries.emplace_back(i, i, 2 + 0.01 * i);
+        if (i > 0)
+        {
+            entries.emplace_back(i, i - 1, -1);
+            entries.emplace_back(i - 1, i, -1);
+        }
+    }
+    StiffnessMatrix K(n, n);
+    K.setFromTriplets(entries.begin(), entries.end());
+    const std::vector<int> boundary_nodes = {0, 50, n - 1};
+
+    auto solver = polysolve::LinearSolver::create("Eigen::SparseLU", "");
+    auto ref_solver = polysolve::LinearSolver::create("Eigen::SparseLU", "");
+    FactorizedDirichletSolve factorized_solve;
+
+    //the first solve factorizes, the others reuse the factorization, they all match dirichlet_solve
+    for (int step = 0; step < 3; ++step)
+    {
+        Eigen::VectorXd b = Eigen::VectorXd::Random(n);
+        Eigen::VectorXd ref_b = b;
+        Eigen::VectorXd x, ref_x;
+
+        StiffnessMatrix A = K, ref_A = K;
+        if (step == 0)
+            factorized_solve.factorize_and_solve(*solver, A, b, boundary_nodes, x, n);
+        else
+            factorized_solve.solve(*solver, b, x);
+        polysolve::dirichlet_solve(*ref_solver, ref_A, ref_b, boundary_nodes, ref_x, n);
+
+        REQUIRE(factorized_solve.is_factorized());
+        REQUIRE((b - ref_b).norm() < 1e-12);
+        REQUIRE((x - ref_x).norm() < 1e-10 * ref_x.norm());
+    }
+}
+
+TEST_CASE("inexact_newton", "[solver]") {
+    const int n = 100;
+    const StiffnessMatrix K = tridiagonal_spd(n);
+    const Eigen::VectorXd b = Eigen::VectorXd::LinSpaced(n, -3, 5);
+    QuarticProblem problem(K, b, 1);
+
+    json params;
+    params["gradNorm"] = 1e-10;
+    params["nl_iterations"] = 100;
+
+    Eigen::VectorXd exact = Eigen::VectorXd::Constant(n, 2);
+    cppoptlib::SparseNewtonDescentSolver<QuarticProblem> newton(params, "Eigen::SimplicialLDLT", "");
+    newton.minimize(problem, exact);
+    Eigen::VectorXd grad;
+    problem.gradient(exact, grad);
+    REQUIRE(grad.norm() < 1e-8);
+
+    //the preconditioner is refactorized only every precondReuse iterations, or when the stale one does not converge
+    params["inexactNewton"] = true;
+    params["precondReuse"] = 3;
+
+    json info, loose_info, tight_info;
+    for (const double forcing_max : {0.9, 1e-12})
+    {
+        params["forcingMax"] = forcing_max;
+        Eigen::VectorXd x = Eigen::VectorXd::Constant(n, 2);
+        cppoptlib::SparseNewtonDescentSolver<QuarticProblem> solver(params, "Eigen::SimplicialLDLT", "");
+        solver.minimize(problem, x);
+        solver.getInfo(info);
+
+        REQUIRE((x - exact).norm() < 1e-8 * exact.norm());
+
+        const json &linear_iterations = info["linear_iterations"];
+        REQUIRE(linear_iterations.size() >= 3);
+        REQUIRE(linear_iterations.size() == info["iterations"].get<size_t>());
+        //at the first iteration the preconditioner is the factorization of the hessian
+        REQUIRE(linear_iterations[0].get<int>() == 1);
+        for (const auto &it : linear_iterations)
+            REQUIRE(it.get<int>() >= 1);
+        REQUIRE(info["preconditioner_updates"].get<int>() >= 1);
+        REQUIRE(info["preconditioner_updates"].get<int>() < int(linear_iterations.size()));
+
+        (forcing_max < 1e-6 ? tight_info : loose_info) = info;
+    }
+
+    //the eisenstat-walker forcing solves the early newton systems loosely
+    int loose_total = 0, tight_total = 0;
+    for (const auto &it : loose_info["linear_iterations"])
+        loose_total += it.get<int>();
+    for (const auto &it : tight_info["linear_iterations"])
+        tight_total += it.get<int>();
+    REQUIRE(loose_info["linear_iterations"][1].get<int>() < tight_info["linear_iterations"][1].get<int>());
+    REQUIRE(loose_total < tight_total);
+}
+
+TEST_CASE("newton_symbolic_reuse", "[solver]") {
+    const int n = 100;
+    const StiffnessMatrix K = tridiagonal_spd(n);
+    const Eigen::VectorXd b = Eigen::VectorXd::LinSpaced(n, -3, 5);
+    QuarticProblem problem(K, b, 1);
+
+    json params;
+    params["gradNorm"] = 1e-10;
+
+    Eigen::VectorXd expected = Eigen::VectorXd::Constant(n, 2);
+    cppoptlib::SparseNewtonDescentSolver<QuarticProblem> fresh(params, "Eigen::SimplicialLDLT", "");
+    fresh.minimize(problem, expected);
+
+    //the hessian pattern never changes, the symbolic factorization is done once for both solves
+    cppoptlib::SparseNewtonDescentSolver<QuarticProblem> solver(params, "Eigen::SimplicialLDLT", "");
+    json info;
+    Eigen::VectorXd x = Eigen::VectorXd::Constant(n, -2);
+    solver.minimize(problem, x);
+    solver.getInfo(info);
+    REQUIRE(info["analyze_pattern"].get<int>() == 1);
+    const int skipped = info["analyze_pattern_skipped"].get<int>();
+    REQUIRE(skipped >= 1);
+
+    x.setConstant(2);
+    solver.minimize(problem, x);
+    solver.getInfo(info);
+    REQUIRE(info["analyze_pattern"].get<int>() == 1);
+    REQUIRE(info["analyze_pattern_skipped"].get<int>() > skipped);
+    REQUIRE((x - expected).norm() < 1e-10 * expected.norm());
+
+    //a hessian with another pattern is analyzed again
+    QuarticProblem other(StiffnessMatrix(K + StiffnessMatrix(K.transpose() * K)), b, 1);
+    x.setConstant(2);
+    solver.minimize(other, x);
+    solver.getInfo(info);
+    REQUIRE(info["analyze_pattern"].get<int>() == 2);
+}
+
+TEST_CASE("inexact_newton_cg", "[solver]") {
+    const int n = 100;
+    const StiffnessMatrix K = tridiagonal_spd(n);
+    const Eigen::VectorXd b = Eigen::VectorXd::LinSpaced(n, -3, 5);
+    QuarticProblem problem(K, b, 1);
+
+    json params;
+    params["inexactNewton"] = true;
+    cppoptlib::SparseNewtonDescentSolver<QuarticProblem> solver(params, "Eigen::SimplicialLDLT", "");
+    Eigen::VectorXd x = Eigen::VectorXd::Zero(n);
+    solver.minimize(problem, x);
+
+    //the hessian at another point, the factorization of the last one of minimize is only a preconditioner
+    StiffnessMatrix hessian;
+    problem.hessian(Eigen::VectorXd::LinSpaced(n, -2, 2), hessian);
+    const Eigen::VectorXd rhs = Eigen::VectorXd::LinSpaced(n, 1, 2);
+
+    int prev_iterations = 0;
+    Eigen::VectorXd delta;
+    for (const double tol : {1e-1, 1e-4, 1e-10})
+    {
+        bool converged;
+        const int iterations = solver.inexact_solve(hessian, rhs, tol, delta, converged);
+        REQUIRE(converged);
+        REQUIRE((hessian * delta - rhs).norm() <= tol * rhs.norm());
+        REQUIRE(iterations >= prev_iterations);
+        prev_iterations = iterations;
+    }
+    REQUIRE(prev_iterations > 1);
+
+    //negative curvature at the first direction, it is returned since it is still a descent direction
+    const StiffnessMatrix negative = -hessian;
+    bool converged;
+    REQUIRE(solver.inexact_solve(negative, rhs, 1e-10, delta, converged) == 0);
+    REQUIRE(!converged);
+    REQUIRE(delta.dot(rhs) > 0);
+}
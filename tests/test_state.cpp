@@ -0,0 +1,261 @@
+////////////////////////////////////////////////////////////////////////////////
+#include <polyfem/State.hpp>
+#include <polyfem/Problem.hpp>
+
+#include <catch.hpp>
+#include <cmath>
+#include <iostream>
+#include <memory>
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace polyfem;
+
+namespace
+{
+    //left side (id 1) fixed, right side (id 3) pulled and sheared proportionally to the load t
+    class PullProblem : public Problem
+    {
+    public:
+        PullProblem(const bool fail_full_load) : Problem("PullProblem"), fail_full_load_(fail_full_load)
+        {
+            boundary_ids_ = {1, 3};
+        }
+
+        void rhs(const AssemblerUtils &assembler, const std::string &formulation, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const override
+        {
+            val = Eigen::MatrixXd::Zero(pts.rows(), pts.cols());
+        }
+        bool is_rhs_zero() const override { return true; }
+
+        void bc(const Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const override
+        {
+            val = Eigen::MatrixXd::Zero(pts.rows(), pts.cols());
+
+            //the first attempt at the full load produces nans, as an inverted element would
+            if (fail_full_load_ && t == 1)
+            {
+                fail_full_load_ = false;
+                val.setConstant(std::nan(""));
+                return;
+            }
+
+            for (int i = 0; i < pts.rows(); ++i)
+            {
+                if (mesh.get_boundary_id(global_ids(i)) == 3)
+                {
+                    val(i, 0) = 0.5 * t;
+                    val(i, 1) = 0.2 * t;
+                }
+            }
+        }
+
+        bool has_exact_sol() const override { return false; }
+        bool is_scalar() const override { return false; }
+
+    private:
+        mutable bool fail_full_load_;
+    };
+
+    //left side (id 1) fixed, released from a uniform stretch at rest
+    class StretchedBarProblem : public Problem
+    {
+    public:
+        StretchedBarProblem() : Problem("StretchedBarProblem")
+        {
+            boundary_ids_ = {1};
+        }
+
+        void rhs(const AssemblerUtils &assembler, const std::string &formulation, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const override
+        {
+            val = Eigen::MatrixXd::Zero(pts.rows(), pts.cols());
+        }
+        bool is_rhs_zero() const override { return true; }
+
+        void bc(const Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const override
+        {
+            val = Eigen::MatrixXd::Zero(pts.rows(), pts.cols());
+        }
+        void velocity_bc(const Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const override
+        {
+            val = Eigen::MatrixXd::Zero(pts.rows(), pts.cols());
+        }
+        void acceleration_bc(const Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const override
+        {
+            val = Eigen::MatrixXd::Zero(pts.rows(), pts.cols());
+        }
+
+        void initial_solution(const Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) const override
+        {
+            val = Eigen::MatrixXd::Zero(pts.rows(), pts.cols());
+            val.col(0) = 0.01 * pts.col(0);
+        }
+        void initial_velocity(const Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) const override
+        {
+            val = Eigen::MatrixXd::Zero(pts.rows(), pts.cols());
+        }
+        void initial_acceleration(const Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &pts, Eigen::MatrixXd &val) const override
+        {
+            val = Eigen::MatrixXd::Zero(pts.rows(), pts.cols());
+        }
+
+        bool has_exact_sol() const override { return false; }
+        bool is_scalar() const override { return false; }
+        bool is_time_dependent() const override { return true; }
+    };
+
+    //n x n quads on [0, 2] x [0, 1]
+    void bar_mesh(const int n, Eigen::MatrixXd &V, Eigen::MatrixXi &F)
+    {
+        V.resize((2 * n + 1) * (n + 1), 2);
+        for (int j = 0; j <= n; ++j)
+        {
+            for (int i = 0; i <= 2 * n; ++i)
+                V.row(j * (2 * n + 1) + i) << i / double(n), j / double(n);
+        }
+
+        F.resize(2 * n * n, 4);
+        for (int j = 0; j < n; ++j)
+        {
+            for (int i = 0; i < 2 * n; ++i)
+            {
+                const int v = j * (2 * n + 1) + i;
+                F.row(j * 2 * n + i) << v, v + 1, v + 2 * n + 2, v + 2 * n + 1;
+            }
+        }
+    }
+
+    //every quad of bar_mesh split in two right triangles
+    void triangulate(const Eigen::MatrixXi &quads, Eigen::MatrixXi &F)
+    {
+        F.resize(2 * quads.rows(), 3);
+        for (int i = 0; i < quads.rows(); ++i)
+        {
+            F.row(2 * i) << quads(i, 0), quads(i, 1), quads(i, 2);
+            F.row(2 * i + 1) << quads(i, 0), quads(i, 2), quads(i, 3);
+        }
+    }
+
+    //linear elastic bar vibrating for tend with central differences
+    void solve_explicit(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const double tend, State &state)
+    {
+        state.init_logger("", 6, true);
+        state.init({{"problem", "GenericTensor"},
+                    {"tensor_formulation", "LinearElasticity"},
+                    {"normalize_mesh", false},
+                    {"discr_order", 1},
+                    {"time_integrator", "CentralDifference"},
+                    {"tend", tend},
+                    {"time_steps", 1}});
+
+        state.load_mesh(V, F);
+        state.problem = std::make_shared<StretchedBarProblem>();
+        state.solve();
+    }
+
+    //neo-hookean bar pulled in load steps
+    void solve_pull(const std::string &predictor, const int steps, const bool fail_full_load, Eigen::MatrixXd &sol, json &solver_info)
+    {
+        State state;
+        state.init_logger("", 6, true);
+        state.init({{"problem", "GenericTensor"},
+                    {"tensor_formulation", "NeoHookean"},
+                    {"normalize_mesh", false},
+                    {"discr_order", 1},
+                    {"nl_solver_rhs_steps", steps},
+                    {"nl_solver_predictor", predictor},
+                    {"solver_params", {{"gradNorm", 1e-10}, {"useGradNorm", true}}}});
+
+        Eigen::MatrixXd V;
+        Eigen::MatrixXi F;
+        bar_mesh(4, V, F);
+        state.load_mesh(V, F);
+        state.problem = std::make_shared<PullProblem>(fail_full_load);
+
+        state.solve();
+        sol = state.sol;
+        solver_info = state.solver_info;
+    }
+}
+
+TEST_CASE("load_step_predictors", "[state]")
+{
+    const int steps = 6;
+    Eigen::MatrixXd ref;
+    json ref_info;
+    solve_pull("tangent", steps, false, ref, ref_info);
+    REQUIRE(ref_info["predictor_assemblies"].get<int>() == steps);
+    REQUIRE(ref_info["load_step_retries"].get<int>() == 0);
+    REQUIRE(ref.norm() > 0);
+
+    for (const std::string predictor : {"tangent_reuse", "linear", "quadratic"})
+    {
+        Eigen::MatrixXd sol;
+        json info;
+        solve_pull(predictor, steps, false, sol, info);
+
+        INFO(predictor);
+        REQUIRE(info["predictor"].get<std::string>() == predictor);
+        REQUIRE((sol - ref).norm() < 1e-6 * ref.norm());
+        //the first step has no previous factorization or converged steps to extrapolate from
+        REQUIRE(info["predictor_assemblies"].get<int>() >= 1);
+        REQUIRE(info["predictor_assemblies"].get<int>() < steps);
+    }
+}
+
+TEST_CASE("load_step_retry", "[state]")
+{
+    Eigen::MatrixXd ref;
+    json ref_info;
+    solve_pull("tangent", 2, false, ref, ref_info);
+
+    //the full load fails, the step is halved and restarted from the undeformed state
+    Eigen::MatrixXd sol;
+    json info;
+    solve_pull("tangent", 1, true, sol, info);
+
+    REQUIRE(info["load_step_retries"].get<int>() == 1);
+    REQUIRE(std::isfinite(sol.norm()));
+    REQUIRE((sol - ref).norm() < 1e-6 * ref.norm());
+}
+
+TEST_CASE("explicit_time_step", "[state]")
+{
+    //default parameters, lambda + 2 mu over the density
+    const double c = std::sqrt(0.32967032967032966 + 2 * 0.3846153846153846);
+    const double tend = 20;
+
+    int prev_steps = 0;
+    for (const int n : {2, 4})
+    {
+        Eigen::MatrixXd V;
+        Eigen::MatrixXi quads;
+        bar_mesh(n, V, quads);
+
+        State state;
+        solve_explicit(V, quads, tend, state);
+
+        //quads use the node spacing
+        const double stable_dt = state.solver_info["explicit_stable_dt"];
+        REQUIRE(stable_dt == Approx(1. / n / c));
+        REQUIRE(state.stable_time_step() == Approx(stable_dt));
+
+        //time_steps is only 1, the number of steps follows the critical step and the mesh size
+        const int n_steps = state.solver_info["explicit_steps"];
+        REQUIRE(n_steps > prev_steps);
+        REQUIRE(n_steps > 1);
+        REQUIRE(state.solver_info["explicit_dt"].get<double>() <= 0.5 * stable_dt);
+        prev_steps = n_steps;
+
+        //the energy is conserved, the displacement stays of the size of the initial stretch after many periods
+        REQUIRE(std::isfinite(state.sol.norm()));
+        REQUIRE(state.sol.cwiseAbs().maxCoeff() < 10 * 0.01 * 2);
+
+        //triangles use the smallest altitude, the one on the diagonal
+        Eigen::MatrixXi tris;
+        triangulate(quads, tris);
+        State tri_state;
+        solve_explicit(V, tris, 1, tri_state);
+        REQUIRE(tri_state.stable_time_step() == Approx(1. / n / std::sqrt(2.) / c));
+        REQUIRE(std::isfinite(tri_state.sol.norm()));
+    }
+}
@@ -2,6 +2,7 @@
 #include <polyfem/InterpolatedFunction.hpp>
 #include <polyfem/RBFInterpolation.hpp>
 #include <polyfem/Bessel.hpp>
+#include <polyfem/Expression.hpp>
 #include <polyfem/ExpressionValue.hpp>
 #include <polyfem/MshReader.hpp>
 #include <polyfem/Mesh.hpp>
@@ -91,6 +92,76 @@ TEST_CASE("expression", "[utils]") {
     REQUIRE(val(2, 3, 4)    == Approx(1).margin(1e-16));
 }
 
+TEST_CASE("expression_batch", "[utils]") {
+    Expression expr;
+    int err;
+
+    REQUIRE(expr.compile("if(x - 0.5, 2*y^2, -z) + sin(t)*cos x + atan2(y, x) - 7%3", err));
+    REQUIRE(!expr.is_constant());
+
+    Eigen::MatrixXd pts(131, 3);
+    pts.setRandom();
+    const double t = 0.3;
+
+    Eigen::VectorXd vals;
+    expr.eval(pts, t, vals);
+    REQUIRE(vals.size() == pts.rows());
+
+    for (int i = 0; i < pts.rows(); ++i)
+    {
+        const double x = pts(i, 0), y = pts(i, 1), z = pts(i, 2);
+        const double expected = (x - 0.5 >= 0 ? 2 * y * y : -z) + sin(t) * cos(x) + atan2(y, x) - 1;
+        REQUIRE(vals(i) == Approx(expected).margin(1e-12));
+        REQUIRE(expr(x, y, z, t) == Approx(expected).margin(1e-12));
+    }
+
+    //in 2d z is zero
+    expr.eval(pts.leftCols(2), t, vals);
+    REQUIRE(vals(0) == Approx(expr(pts(0, 0), pts(0, 1), 0, t)).margin(1e-12));
+
+    REQUIRE(expr.compile("2e11 * (1 + pi^2) / (2, 4)", err));
+    REQUIRE(expr.is_constant());
+    REQUIRE(expr.constant() == Approx(2e11 * (1 + M_PI * M_PI) / 4));
+
+    REQUIRE(!expr.compile("x + foo(y)", err));
+    REQUIRE(err == 5);
+}
+
+TEST_CASE("expression_syntax", "[utils]") {
+    Expression expr;
+    int err;
+
+    //log is log10 as in tinyexpr, ln is the natural log
+    REQUIRE(expr.compile("log(1000)", err));
+    REQUIRE(expr.constant() == Approx(3));
+    REQUIRE(expr.compile("log10(x)", err));
+    REQUIRE(expr(100, 0, 0) == Approx(2));
+    REQUIRE(expr.compile("ln(x)", err));
+    REQUIRE(expr(std::exp(2.), 0, 0) == Approx(2));
+
+    //^ is left associative and the unary minus binds tighter, as in tinyexpr
+    REQUIRE(expr.compile("2^3^2", err));
+    REQUIRE(expr.constant() == Approx(64));
+    REQUIRE(expr.compile("-2^2", err));
+    REQUIRE(expr.constant() == Approx(4));
+    REQUIRE(expr.compile("2*x^2", err));
+    REQUIRE(expr(3, 0, 0) == Approx(18));
+
+    //if(c, a, b) is a when c >= 0
+    REQUIRE(expr.compile("if(x - 1, y, z)", err));
+    REQUIRE(expr(2, 3, 4) == Approx(3));
+    REQUIRE(expr(1, 3, 4) == Approx(3));
+    REQUIRE(expr(0, 3, 4) == Approx(4));
+    REQUIRE(expr.compile("if(-1, 5, 6)", err));
+    REQUIRE(expr.is_constant());
+    REQUIRE(expr.constant() == Approx(6));
+
+    REQUIRE(expr.compile("sin(t) + x", err));
+    REQUIRE(expr.depends_on_t());
+    REQUIRE(expr.compile("sin(x) + 0 * y", err));
+    REQUIRE(!expr.depends_on_t());
+}
+
 TEST_CASE("mshreader", "[utils]") {
     const std::string path = POLYFEM_DATA_DIR;
     Eigen::MatrixXd vertices;